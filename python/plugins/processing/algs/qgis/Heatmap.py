@@ -27,7 +27,6 @@ from collections import OrderedDict
 from qgis.PyQt.QtGui import QIcon
 
 from qgis.core import (QgsApplication,
-                       QgsFeatureRequest,
                        QgsRasterFileWriter,
                        QgsProcessing,
                        QgsProcessingException,
@@ -183,8 +182,6 @@ class Heatmap(QgisAlgorithm):
         weight_field = self.parameterAsString(parameters, self.WEIGHT_FIELD, context)
         radius_field = self.parameterAsString(parameters, self.RADIUS_FIELD, context)
 
-        attrs = []
-
         kde_params = QgsKernelDensityEstimation.Parameters()
         kde_params.source = source
         kde_params.radius = radius
@@ -192,11 +189,9 @@ class Heatmap(QgisAlgorithm):
         # radius field
         if radius_field:
             kde_params.radiusField = radius_field
-            attrs.append(source.fields().lookupField(radius_field))
         # weight field
         if weight_field:
             kde_params.weightField = weight_field
-            attrs.append(source.fields().lookupField(weight_field))
 
         kde_params.shape = kernel_shape
         kde_params.decayRatio = decay
@@ -204,24 +199,13 @@ class Heatmap(QgisAlgorithm):
 
         kde = QgsKernelDensityEstimation(kde_params, outputFile, output_format)
 
-        if kde.prepare() != QgsKernelDensityEstimation.Success:
+        result = kde.runTiled(feedback)
+        if result in (QgsKernelDensityEstimation.DriverError,
+                      QgsKernelDensityEstimation.InvalidParameters,
+                      QgsKernelDensityEstimation.FileCreationError):
             raise QgsProcessingException(
                 self.tr('Could not create destination layer'))
-
-        request = QgsFeatureRequest()
-        request.setSubsetOfAttributes(attrs)
-        features = source.getFeatures(request)
-        total = 100.0 / source.featureCount() if source.featureCount() else 0
-        for current, f in enumerate(features):
-            if feedback.isCanceled():
-                break
-
-            if kde.addFeature(f) != QgsKernelDensityEstimation.Success:
-                feedback.reportError(self.tr('Error adding feature with ID {} to heatmap').format(f.id()))
-
-            feedback.setProgress(int(current * total))
-
-        if kde.finalise() != QgsKernelDensityEstimation.Success:
+        elif result == QgsKernelDensityEstimation.RasterIoError:
             raise QgsProcessingException(
                 self.tr('Could not save destination layer'))
 
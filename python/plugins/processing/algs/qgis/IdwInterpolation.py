@@ -51,6 +51,8 @@ class IdwInterpolation(QgisAlgorithm):
     ROWS = 'ROWS'
     EXTENT = 'EXTENT'
     OUTPUT = 'OUTPUT'
+    SEARCH_RADIUS = 'SEARCH_RADIUS'
+    MAX_POINTS = 'MAX_POINTS'
 
     def icon(self):
         return QIcon(os.path.join(pluginPath, 'images', 'interpolation.png'))
@@ -99,6 +101,19 @@ class IdwInterpolation(QgisAlgorithm):
         self.addParameter(QgsProcessingParameterRasterDestination(self.OUTPUT,
                                                                   self.tr('Interpolated')))
 
+        radius_param = QgsProcessingParameterNumber(self.SEARCH_RADIUS,
+                                                    self.tr('Search radius (0 for unlimited)'),
+                                                    type=QgsProcessingParameterNumber.Double,
+                                                    minValue=0.0, defaultValue=0.0)
+        radius_param.setFlags(radius_param.flags() | QgsProcessingParameterDefinition.FlagAdvanced)
+        self.addParameter(radius_param)
+
+        max_points_param = QgsProcessingParameterNumber(self.MAX_POINTS,
+                                                        self.tr('Maximum number of nearest points (0 for all)'),
+                                                        minValue=0, defaultValue=0)
+        max_points_param.setFlags(max_points_param.flags() | QgsProcessingParameterDefinition.FlagAdvanced)
+        self.addParameter(max_points_param)
+
     def name(self):
         return 'idwinterpolation'
 
@@ -150,6 +165,8 @@ class IdwInterpolation(QgisAlgorithm):
 
         interpolator = QgsIDWInterpolator(layerData)
         interpolator.setDistanceCoefficient(coefficient)
+        interpolator.setSearchRadius(self.parameterAsDouble(parameters, self.SEARCH_RADIUS, context))
+        interpolator.setMaximumPoints(self.parameterAsInt(parameters, self.MAX_POINTS, context))
 
         writer = QgsGridFileWriter(interpolator,
                                    output,
@@ -29,6 +29,7 @@ from qgis.PyQt.QtGui import QIcon
 from qgis.core import (QgsProcessingUtils,
                        QgsProcessing,
                        QgsProcessingParameterEnum,
+                       QgsProcessingParameterBoolean,
                        QgsProcessingParameterNumber,
                        QgsProcessingParameterExtent,
                        QgsProcessingParameterDefinition,
@@ -56,6 +57,7 @@ class TinInterpolation(QgisAlgorithm):
     EXTENT = 'EXTENT'
     OUTPUT = 'OUTPUT'
     TRIANGULATION = 'TRIANGULATION'
+    STREAMING = 'STREAMING'
 
     def icon(self):
         return QIcon(os.path.join(pluginPath, 'images', 'interpolation.png'))
@@ -115,6 +117,12 @@ class TinInterpolation(QgisAlgorithm):
         triangulation_file_param.setCreateByDefault(False)
         self.addParameter(triangulation_file_param)
 
+        streaming_param = QgsProcessingParameterBoolean(self.STREAMING,
+                                                        self.tr('Triangulate in tiles (for large point layers, linear method only)'),
+                                                        defaultValue=False)
+        streaming_param.setFlags(streaming_param.flags() | QgsProcessingParameterDefinition.FlagAdvanced)
+        self.addParameter(streaming_param)
+
     def name(self):
         return 'tininterpolation'
 
@@ -178,6 +186,7 @@ class TinInterpolation(QgisAlgorithm):
         interpolator = QgsTinInterpolator(layerData, interpolationMethod, feedback)
         if triangulation_sink is not None:
             interpolator.setTriangulationSink(triangulation_sink)
+        interpolator.setStreamingTriangulation(self.parameterAsBoolean(parameters, self.STREAMING, context))
 
         writer = QgsGridFileWriter(interpolator,
                                    output,
@@ -21,6 +21,12 @@
 #include "qgsfeedback.h"
 #include <QFile>
 #include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//! Approximate number of cells interpolated at once
+constexpr int STRIP_CELLS = 1 << 20;
 
 QgsGridFileWriter::QgsGridFileWriter( QgsInterpolator *i, const QString &outputPath, const QgsRectangle &extent, int nCols, int nRows )
   : mInterpolator( i )
@@ -51,36 +57,50 @@ int QgsGridFileWriter::writeFile( QgsFeedback *feedback )
   outStream.setRealNumberPrecision( 8 );
   writeHeader( outStream );
 
-  double currentYValue = mInterpolationExtent.yMaximum() - mCellSizeY / 2.0; //calculate value in the center of the cell
-  double currentXValue;
-  double interpolatedValue;
+  // the grid is interpolated in strips of rows, so that interpolators can process a block of cells at once
+  const int stripRows = std::max( 1, std::min( mNumRows, STRIP_CELLS / std::max( 1, mNumColumns ) ) );
+  std::vector< double > values;
 
-  for ( int i = 0; i < mNumRows; ++i )
+  for ( int firstRow = 0; firstRow < mNumRows; firstRow += stripRows )
   {
-    currentXValue = mInterpolationExtent.xMinimum() + mCellSizeX / 2.0; //calculate value in the center of the cell
-    for ( int j = 0; j < mNumColumns; ++j )
+    const int rows = std::min( stripRows, mNumRows - firstRow );
+    values.resize( static_cast< std::size_t >( rows ) * mNumColumns );
+    const int blockResult = mInterpolator->interpolateBlock( mInterpolationExtent.xMinimum(), mInterpolationExtent.yMaximum() - firstRow * mCellSizeY,
+                            mCellSizeX, mCellSizeY, mNumColumns, rows, values.data(), feedback );
+
+    if ( feedback && feedback->isCanceled() )
     {
-      if ( mInterpolator->interpolatePoint( currentXValue, currentYValue, interpolatedValue, feedback ) == 0 )
-      {
-        outStream << interpolatedValue << ' ';
-      }
-      else
+      outputFile.remove();
+      return 3;
+    }
+
+    // the values of a failed block were not calculated, don't write them as valid data
+    if ( blockResult != 0 )
+    {
+      outputFile.remove();
+      return 4;
+    }
+
+    auto value = values.cbegin();
+    for ( int i = 0; i < rows; ++i )
+    {
+      for ( int j = 0; j < mNumColumns; ++j, ++value )
       {
-        outStream << "-9999 ";
+        if ( !std::isnan( *value ) )
+        {
+          outStream << *value << ' ';
+        }
+        else
+        {
+          outStream << "-9999 ";
+        }
       }
-      currentXValue += mCellSizeX;
+      outStream << endl;
     }
-    outStream << endl;
-    currentYValue -= mCellSizeY;
 
     if ( feedback )
     {
-      if ( feedback->isCanceled() )
-      {
-        outputFile.remove();
-        return 3;
-      }
-      feedback->setProgress( 100.0 * i / static_cast< double >( mNumRows ) );
+      feedback->setProgress( 100.0 * ( firstRow + rows ) / static_cast< double >( mNumRows ) );
     }
   }
 
@@ -50,6 +50,9 @@ class ANALYSIS_EXPORT QgsGridFileWriter
      *
      * An optional \a feedback object can be set for progress reports and cancellation support
      *
+     * The grid is interpolated in blocks of rows. If the interpolator fails to calculate a block, the
+     * output file is removed and 4 is returned.
+     *
      * \returns 0 in case of success
     */
     int writeFile( QgsFeedback *feedback = nullptr );
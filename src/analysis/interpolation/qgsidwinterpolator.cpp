@@ -17,34 +17,231 @@
 
 #include "qgsidwinterpolator.h"
 #include "qgis.h"
+#include "qgsfeedback.h"
+#include "kdbush.hpp"
+
+#include <QtConcurrentMap>
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <numeric>
+#include <typeinfo>
+#include <vector>
+
+///@cond PRIVATE
+
+//! Entry of the IDW point index
+struct QgsIDWIndexEntry
+{
+  QgsIDWIndexEntry( double x, double y, double z )
+    : coords( std::make_pair( x, y ) )
+    , z( z )
+  {}
+
+  std::pair< double, double > coords;
+  double z = 0;
+};
+
+/**
+ * KD-tree of the interpolation points, with a search for the nearest points within a radius.
+ */
+class QgsIDWInterpolator::PointIndex : public kdbush::KDBush< std::pair<double, double>, QgsIDWIndexEntry, std::size_t >
+{
+  public:
+
+    explicit PointIndex( const QVector< QgsInterpolatorVertexData > &data )
+    {
+      points.reserve( static_cast< std::size_t >( data.size() ) );
+      for ( const QgsInterpolatorVertexData &vertex : data )
+      {
+        points.emplace_back( vertex.x, vertex.y, vertex.z );
+      }
+      if ( !points.empty() )
+        sortKD( 0, points.size() - 1, 0 );
+    }
+
+    /**
+     * Collects the \a count nearest points to \a x, \a y within \a radius into \a nearest,
+     * as pairs of squared distance and entry. A \a count of 0 collects all points within the radius.
+     */
+    void nearest( double x, double y, int count, double radius, std::vector< std::pair< double, const QgsIDWIndexEntry * > > &nearest ) const
+    {
+      nearest.clear();
+      if ( points.empty() )
+        return;
+
+      if ( count <= 0 )
+      {
+        within( x, y, radius, [&nearest, x, y]( const QgsIDWIndexEntry & entry )
+        {
+          const double dx = entry.coords.first - x;
+          const double dy = entry.coords.second - y;
+          nearest.emplace_back( dx * dx + dy * dy, &entry );
+        } );
+        return;
+      }
+
+      // max-heap on the squared distance, so that the furthest candidate is at the front
+      const double maxDistance2 = radius * radius;
+      nearestNode( x, y, static_cast< std::size_t >( count ), maxDistance2, nearest, 0, points.size() - 1, 0 );
+      std::sort_heap( nearest.begin(), nearest.end() );
+    }
+
+  private:
+
+    void addCandidate( double x, double y, std::size_t count, double maxDistance2, std::vector< std::pair< double, const QgsIDWIndexEntry * > > &heap, const QgsIDWIndexEntry &entry ) const
+    {
+      const double dx = entry.coords.first - x;
+      const double dy = entry.coords.second - y;
+      const double distance2 = dx * dx + dy * dy;
+      if ( distance2 > maxDistance2 )
+        return;
+
+      if ( heap.size() < count )
+      {
+        heap.emplace_back( distance2, &entry );
+        std::push_heap( heap.begin(), heap.end() );
+      }
+      else if ( distance2 < heap.front().first )
+      {
+        std::pop_heap( heap.begin(), heap.end() );
+        heap.back() = std::make_pair( distance2, &entry );
+        std::push_heap( heap.begin(), heap.end() );
+      }
+    }
+
+    void nearestNode( double x, double y, std::size_t count, double maxDistance2, std::vector< std::pair< double, const QgsIDWIndexEntry * > > &heap,
+                      std::size_t left, std::size_t right, std::uint8_t axis ) const
+    {
+      if ( right - left <= nodeSize )
+      {
+        for ( std::size_t i = left; i <= right; i++ )
+          addCandidate( x, y, count, maxDistance2, heap, points[i] );
+        return;
+      }
+
+      const std::size_t m = ( left + right ) >> 1;
+      addCandidate( x, y, count, maxDistance2, heap, points[m] );
+
+      // visit the side of the split containing the search point first, then the other side
+      // only if it can still contain closer points
+      const double split = axis == 0 ? points[m].coords.first : points[m].coords.second;
+      const double delta = ( axis == 0 ? x : y ) - split;
+      const std::uint8_t nextAxis = ( axis + 1 ) % 2;
+      if ( delta <= 0 )
+        nearestNode( x, y, count, maxDistance2, heap, left, m - 1, nextAxis );
+      else
+        nearestNode( x, y, count, maxDistance2, heap, m + 1, right, nextAxis );
+
+      const double bound = heap.size() < count ? maxDistance2 : heap.front().first;
+      if ( delta * delta <= bound )
+      {
+        if ( delta <= 0 )
+          nearestNode( x, y, count, maxDistance2, heap, m + 1, right, nextAxis );
+        else
+          nearestNode( x, y, count, maxDistance2, heap, left, m - 1, nextAxis );
+      }
+    }
+};
+
+///@endcond
 
 QgsIDWInterpolator::QgsIDWInterpolator( const QList<LayerData> &layerData )
   : QgsInterpolator( layerData )
 {}
 
+QgsIDWInterpolator::~QgsIDWInterpolator() = default;
+
 int QgsIDWInterpolator::interpolatePoint( double x, double y, double &result, QgsFeedback *feedback )
+{
+  prepare( feedback );
+  return interpolatePrepared( x, y, result );
+}
+
+int QgsIDWInterpolator::interpolateBlock( double xMin, double yMax, double cellSizeX, double cellSizeY, int columns, int rows, double *values, QgsFeedback *feedback )
+{
+  if ( typeid( *this ) != typeid( QgsIDWInterpolator ) )
+  {
+    // a derived class may override interpolatePoint(), which must then be called for every cell
+    return QgsInterpolator::interpolateBlock( xMin, yMax, cellSizeX, cellSizeY, columns, rows, values, feedback );
+  }
+
+  prepare( feedback );
+
+  // the prepared data is only read, so rows can be calculated concurrently
+  std::vector< int > rowIndexes( static_cast< std::size_t >( rows ) );
+  std::iota( rowIndexes.begin(), rowIndexes.end(), 0 );
+  QtConcurrent::blockingMap( rowIndexes, [ = ]( int row )
+  {
+    if ( feedback && feedback->isCanceled() )
+      return;
+
+    const double y = yMax - ( row + 0.5 ) * cellSizeY;
+    double *rowValues = values + static_cast< std::size_t >( row ) * columns;
+    double interpolatedValue = 0;
+    for ( int column = 0; column < columns; ++column )
+    {
+      const double x = xMin + ( column + 0.5 ) * cellSizeX;
+      rowValues[ column ] = interpolatePrepared( x, y, interpolatedValue ) == 0 ? interpolatedValue : std::numeric_limits< double >::quiet_NaN();
+    }
+  } );
+
+  return feedback && feedback->isCanceled() ? 1 : 0;
+}
+
+void QgsIDWInterpolator::prepare( QgsFeedback *feedback )
 {
   if ( !mDataIsCached )
   {
     cacheBaseData( feedback );
   }
 
+  const bool localSearch = mSearchRadius > 0 || mMaximumPoints > 0;
+  if ( localSearch && !mPointIndex )
+  {
+    mPointIndex = qgis::make_unique< PointIndex >( mCachedBaseData );
+  }
+}
+
+int QgsIDWInterpolator::interpolatePrepared( double x, double y, double &result ) const
+{
   double sumCounter = 0;
   double sumDenominator = 0;
 
-  for ( const QgsInterpolatorVertexData &vertex : qgis::as_const( mCachedBaseData ) )
+  if ( mSearchRadius > 0 || mMaximumPoints > 0 )
+  {
+    std::vector< std::pair< double, const QgsIDWIndexEntry * > > nearest;
+    if ( mMaximumPoints > 0 )
+      nearest.reserve( static_cast< std::size_t >( mMaximumPoints ) );
+    mPointIndex->nearest( x, y, mMaximumPoints, mSearchRadius > 0 ? mSearchRadius : std::numeric_limits< double >::infinity(), nearest );
+
+    for ( const auto &candidate : nearest )
+    {
+      double distance = std::sqrt( candidate.first );
+      if ( qgsDoubleNear( distance, 0.0 ) )
+      {
+        result = candidate.second->z;
+        return 0;
+      }
+      double currentWeight = 1 / ( std::pow( distance, mDistanceCoefficient ) );
+      sumCounter += ( currentWeight * candidate.second->z );
+      sumDenominator += currentWeight;
+    }
+  }
+  else
   {
-    double distance = std::sqrt( ( vertex.x - x ) * ( vertex.x - x ) + ( vertex.y - y ) * ( vertex.y - y ) );
-    if ( qgsDoubleNear( distance, 0.0 ) )
+    for ( const QgsInterpolatorVertexData &vertex : qgis::as_const( mCachedBaseData ) )
     {
-      result = vertex.z;
-      return 0;
+      double distance = std::sqrt( ( vertex.x - x ) * ( vertex.x - x ) + ( vertex.y - y ) * ( vertex.y - y ) );
+      if ( qgsDoubleNear( distance, 0.0 ) )
+      {
+        result = vertex.z;
+        return 0;
+      }
+      double currentWeight = 1 / ( std::pow( distance, mDistanceCoefficient ) );
+      sumCounter += ( currentWeight * vertex.z );
+      sumDenominator += currentWeight;
     }
-    double currentWeight = 1 / ( std::pow( distance, mDistanceCoefficient ) );
-    sumCounter += ( currentWeight * vertex.z );
-    sumDenominator += currentWeight;
   }
 
   if ( sumDenominator == 0.0 )
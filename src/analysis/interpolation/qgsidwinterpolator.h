@@ -21,6 +21,8 @@
 #include "qgsinterpolator.h"
 #include "qgis_analysis.h"
 
+#include <memory>
+
 /**
  * \ingroup analysis
  * \class QgsIDWInterpolator
@@ -35,8 +37,16 @@ class ANALYSIS_EXPORT QgsIDWInterpolator: public QgsInterpolator
      */
     QgsIDWInterpolator( const QList<QgsInterpolator::LayerData> &layerData );
 
+    ~QgsIDWInterpolator() override;
+
     int interpolatePoint( double x, double y, double &result SIP_OUT, QgsFeedback *feedback = nullptr ) override;
 
+    /**
+     * Interpolates the block using a KD-tree of the input points when a search radius or a maximum
+     * number of points is set. Rows of the block are calculated in parallel.
+     */
+    int interpolateBlock( double xMin, double yMax, double cellSizeX, double cellSizeY, int columns, int rows, double *values, QgsFeedback *feedback = nullptr ) override SIP_SKIP;
+
     /**
      * Sets the distance \a coefficient, the parameter that sets how the values are
      * weighted with distance. Smaller values mean sharper peaks at the data points.
@@ -60,11 +70,67 @@ class ANALYSIS_EXPORT QgsIDWInterpolator: public QgsInterpolator
     */
     double distanceCoefficient() const { return mDistanceCoefficient; }
 
+    /**
+     * Sets the search \a radius (in map units). Only points within this distance of a cell
+     * are used to interpolate its value, and cells without any point within the radius
+     * are left empty.
+     *
+     * A radius of 0 (the default) uses points at any distance.
+     *
+     * \see searchRadius()
+     * \see setMaximumPoints()
+     * \since QGIS 3.16
+    */
+    void setSearchRadius( double radius ) { mSearchRadius = radius; }
+
+    /**
+     * Returns the search radius (in map units). Only points within this distance of a cell
+     * are used to interpolate its value. A radius of 0 uses points at any distance.
+     *
+     * \see setSearchRadius()
+     * \since QGIS 3.16
+    */
+    double searchRadius() const { return mSearchRadius; }
+
+    /**
+     * Sets the maximum number of points used to interpolate a cell. If set, only the
+     * \a count nearest points (within the searchRadius(), if set) are used.
+     *
+     * A count of 0 (the default) uses all points.
+     *
+     * \see maximumPoints()
+     * \see setSearchRadius()
+     * \since QGIS 3.16
+    */
+    void setMaximumPoints( int count ) { mMaximumPoints = count; }
+
+    /**
+     * Returns the maximum number of points used to interpolate a cell. A count of 0
+     * uses all points.
+     *
+     * \see setMaximumPoints()
+     * \since QGIS 3.16
+    */
+    int maximumPoints() const { return mMaximumPoints; }
+
   private:
 
+    class PointIndex;
+
     QgsIDWInterpolator() = delete;
 
+    //! Caches the input data and, if a local search is used, builds the point index
+    void prepare( QgsFeedback *feedback );
+
+    //! Calculates the value at \a x, \a y from the prepared data
+    int interpolatePrepared( double x, double y, double &result ) const;
+
     double mDistanceCoefficient = 2.0;
+    double mSearchRadius = 0;
+    int mMaximumPoints = 0;
+
+    //! KD-tree of the cached points, for searches restricted by radius or number of points
+    std::unique_ptr< PointIndex > mPointIndex;
 };
 
 #endif
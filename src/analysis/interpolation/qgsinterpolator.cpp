@@ -22,12 +22,35 @@
 #include "qgsgeometry.h"
 #include "qgsfeedback.h"
 
+#include <limits>
+
 QgsInterpolator::QgsInterpolator( const QList<LayerData> &layerData )
   : mLayerData( layerData )
 {
 
 }
 
+int QgsInterpolator::interpolateBlock( double xMin, double yMax, double cellSizeX, double cellSizeY, int columns, int rows, double *values, QgsFeedback *feedback )
+{
+  double interpolatedValue = 0;
+  for ( int row = 0; row < rows; ++row )
+  {
+    if ( feedback && feedback->isCanceled() )
+    {
+      return 1;
+    }
+
+    const double y = yMax - ( row + 0.5 ) * cellSizeY;
+    double *rowValues = values + static_cast< std::size_t >( row ) * columns;
+    for ( int column = 0; column < columns; ++column )
+    {
+      const double x = xMin + ( column + 0.5 ) * cellSizeX;
+      rowValues[ column ] = interpolatePoint( x, y, interpolatedValue, feedback ) == 0 ? interpolatedValue : std::numeric_limits< double >::quiet_NaN();
+    }
+  }
+  return 0;
+}
+
 QgsInterpolator::Result QgsInterpolator::cacheBaseData( QgsFeedback *feedback )
 {
   if ( mLayerData.empty() )
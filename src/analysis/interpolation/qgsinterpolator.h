@@ -126,6 +126,35 @@ class ANALYSIS_EXPORT QgsInterpolator
      */
     virtual int interpolatePoint( double x, double y, double &result SIP_OUT, QgsFeedback *feedback = nullptr ) = 0;
 
+    /**
+     * Calculates interpolation values for a block of cells.
+     *
+     * The block consists of \a columns by \a rows cells of size \a cellSizeX by \a cellSizeY, with its
+     * top left corner at \a xMin, \a yMax (in map units). Values are calculated at the cell centers and
+     * stored row by row in \a values, which must have room for \a columns * \a rows values. Cells
+     * which could not be interpolated are set to NaN.
+     *
+     * The default implementation calls interpolatePoint() for every cell. Subclasses can override
+     * this method to calculate complete blocks more efficiently.
+     *
+     * The built-in interpolators only use their block implementations for instances of exactly their
+     * own class. Instances of classes derived from them fall back to the default implementation, so that
+     * an overridden interpolatePoint() is still called for every cell.
+     *
+     * \param xMin x-coordinate of the left edge of the block
+     * \param yMax y-coordinate of the top edge of the block
+     * \param cellSizeX cell width
+     * \param cellSizeY cell height
+     * \param columns number of columns in the block
+     * \param rows number of rows in the block
+     * \param values destination for the interpolated values
+     * \param feedback optional feedback object for progress and cancellation support
+     * \returns 0 in case of success
+     * \note Not available in Python bindings
+     * \since QGIS 3.16
+     */
+    virtual int interpolateBlock( double xMin, double yMax, double cellSizeX, double cellSizeY, int columns, int rows, double *values, QgsFeedback *feedback = nullptr ) SIP_SKIP;
+
     //! \note not available in Python bindings
     QList<LayerData> layerData() const { return mLayerData; } SIP_SKIP
 
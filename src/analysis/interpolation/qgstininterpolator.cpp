@@ -31,6 +31,239 @@
 #include "qgsmulticurve.h"
 #include "qgscurvepolygon.h"
 #include "qgsmultisurface.h"
+#include "qgsgeometryutils.h"
+
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeinfo>
+
+///@cond PRIVATE
+
+/**
+ * Compact, spatially sorted storage of the input points for the streaming triangulation.
+ *
+ * The points are sorted into a regular grid of buckets, so that the points inside a rectangle
+ * can be collected without scanning the whole data set. The convex hull of all points is kept
+ * to decide whether a cell outside a tile triangulation is outside the full triangulation too.
+ */
+class QgsTinInterpolator::StreamingPointIndex
+{
+  public:
+
+    //! Sorts \a points in place and builds the index. The points must outlive the index.
+    explicit StreamingPointIndex( QVector< QgsInterpolatorVertexData > &points );
+
+    //! Returns the bounding box of all points
+    QgsRectangle extent() const { return mExtent; }
+
+    //! Returns the average distance between neighboring points
+    double pointSpacing() const { return mPointSpacing; }
+
+    //! Returns the points inside \a rect
+    std::vector< QgsInterpolatorVertexData > pointsInRect( const QgsRectangle &rect ) const;
+
+    //! Returns TRUE if the point at \a x, \a y is outside the convex hull of all points
+    bool isOutsideConvexHull( double x, double y ) const;
+
+  private:
+
+    //! Target average number of points per bucket
+    static constexpr int POINTS_PER_BUCKET = 32;
+
+    int bucketColumn( double x ) const;
+    int bucketRow( double y ) const;
+
+    const QVector< QgsInterpolatorVertexData > &mPoints;
+    QgsRectangle mExtent;
+    double mPointSpacing = 0;
+    double mBucketSize = 1;
+    int mBucketColumns = 0;
+    int mBucketRows = 0;
+    //! Index of the first point of each bucket, with a final entry for the end of the last bucket
+    std::vector< int > mBucketStart;
+    //! Vertices of the convex hull in counter-clockwise order
+    std::vector< QgsPointXY > mHull;
+};
+
+QgsTinInterpolator::StreamingPointIndex::StreamingPointIndex( QVector<QgsInterpolatorVertexData> &points )
+  : mPoints( points )
+{
+  if ( points.isEmpty() )
+  {
+    return;
+  }
+
+  double xMin = std::numeric_limits< double >::max();
+  double yMin = std::numeric_limits< double >::max();
+  double xMax = std::numeric_limits< double >::lowest();
+  double yMax = std::numeric_limits< double >::lowest();
+  for ( const QgsInterpolatorVertexData &p : qgis::as_const( points ) )
+  {
+    xMin = std::min( xMin, p.x );
+    yMin = std::min( yMin, p.y );
+    xMax = std::max( xMax, p.x );
+    yMax = std::max( yMax, p.y );
+  }
+  mExtent = QgsRectangle( xMin, yMin, xMax, yMax );
+
+  const double width = xMax - xMin;
+  const double height = yMax - yMin;
+  const int bucketCount = std::max( 1, points.size() / POINTS_PER_BUCKET );
+  mBucketSize = std::max( std::sqrt( width * height / bucketCount ), std::max( width, height ) / bucketCount );
+  if ( mBucketSize <= 0 )
+  {
+    mBucketSize = 1;
+  }
+  mBucketColumns = std::max( 1, static_cast< int >( std::ceil( width / mBucketSize ) ) );
+  mBucketRows = std::max( 1, static_cast< int >( std::ceil( height / mBucketSize ) ) );
+  mPointSpacing = width * height > 0 ? std::sqrt( width * height / points.size() ) : std::max( width, height ) / points.size();
+
+  // counting sort of the points by bucket
+  std::vector< int > pointBuckets( static_cast< std::size_t >( points.size() ) );
+  mBucketStart.assign( static_cast< std::size_t >( mBucketColumns ) * mBucketRows + 1, 0 );
+  for ( int i = 0; i < points.size(); ++i )
+  {
+    const int bucket = bucketRow( points.at( i ).y ) * mBucketColumns + bucketColumn( points.at( i ).x );
+    pointBuckets[i] = bucket;
+    ++mBucketStart[ bucket + 1 ];
+  }
+  for ( std::size_t i = 1; i < mBucketStart.size(); ++i )
+  {
+    mBucketStart[i] += mBucketStart[i - 1];
+  }
+  {
+    QVector< QgsInterpolatorVertexData > sorted( points.size() );
+    std::vector< int > next( mBucketStart.begin(), mBucketStart.end() - 1 );
+    for ( int i = 0; i < points.size(); ++i )
+    {
+      sorted[ next[ pointBuckets[i] ]++ ] = points.at( i );
+    }
+    points.swap( sorted );
+  }
+
+  // convex hull with Andrew's monotone chain, after discarding the points strictly inside the polygon
+  // of the extreme points in eight directions
+  auto cross = []( const QgsPointXY & o, const QgsPointXY & a, const QgsPointXY & b )
+  {
+    return ( a.x() - o.x() ) * ( b.y() - o.y() ) - ( a.y() - o.y() ) * ( b.x() - o.x() );
+  };
+  auto monotoneChain = [cross]( std::vector< QgsPointXY > &candidates ) -> std::vector< QgsPointXY >
+  {
+    std::sort( candidates.begin(), candidates.end(), []( const QgsPointXY & a, const QgsPointXY & b )
+    {
+      return a.x() < b.x() || ( a.x() == b.x() && a.y() < b.y() );
+    } );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+    if ( candidates.size() < 3 )
+    {
+      return candidates;
+    }
+
+    std::vector< QgsPointXY > hull( 2 * candidates.size() );
+    std::size_t k = 0;
+    for ( std::size_t i = 0; i < candidates.size(); ++i )
+    {
+      while ( k >= 2 && cross( hull[k - 2], hull[k - 1], candidates[i] ) <= 0 )
+        --k;
+      hull[k++] = candidates[i];
+    }
+    for ( std::size_t i = candidates.size() - 1, lower = k + 1; i > 0; --i )
+    {
+      while ( k >= lower && cross( hull[k - 2], hull[k - 1], candidates[i - 1] ) <= 0 )
+        --k;
+      hull[k++] = candidates[i - 1];
+    }
+    hull.resize( k - 1 );
+    return hull;
+  };
+
+  static const double DIRECTIONS[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+  std::vector< QgsPointXY > extremes;
+  for ( const auto &direction : DIRECTIONS )
+  {
+    const QgsInterpolatorVertexData *best = &points.at( 0 );
+    for ( const QgsInterpolatorVertexData &p : qgis::as_const( points ) )
+    {
+      if ( p.x * direction[0] + p.y * direction[1] > best->x * direction[0] + best->y * direction[1] )
+        best = &p;
+    }
+    extremes.emplace_back( best->x, best->y );
+  }
+  const std::vector< QgsPointXY > filter = monotoneChain( extremes );
+
+  std::vector< QgsPointXY > candidates;
+  for ( const QgsInterpolatorVertexData &p : qgis::as_const( points ) )
+  {
+    const QgsPointXY point( p.x, p.y );
+    bool inside = filter.size() >= 3;
+    for ( std::size_t i = 0; inside && i < filter.size(); ++i )
+    {
+      inside = cross( filter[i], filter[( i + 1 ) % filter.size()], point ) > 0;
+    }
+    if ( !inside )
+      candidates.emplace_back( point );
+  }
+  mHull = monotoneChain( candidates );
+}
+
+std::vector< QgsInterpolatorVertexData > QgsTinInterpolator::StreamingPointIndex::pointsInRect( const QgsRectangle &rect ) const
+{
+  std::vector< QgsInterpolatorVertexData > result;
+  if ( mBucketStart.empty() || !rect.intersects( mExtent ) )
+  {
+    return result;
+  }
+
+  const int firstColumn = bucketColumn( rect.xMinimum() );
+  const int lastColumn = bucketColumn( rect.xMaximum() );
+  const int firstRow = bucketRow( rect.yMinimum() );
+  const int lastRow = bucketRow( rect.yMaximum() );
+  for ( int row = firstRow; row <= lastRow; ++row )
+  {
+    const int rowStart = row * mBucketColumns;
+    for ( int i = mBucketStart[ rowStart + firstColumn ]; i < mBucketStart[ rowStart + lastColumn + 1 ]; ++i )
+    {
+      const QgsInterpolatorVertexData &p = mPoints.at( i );
+      if ( p.x >= rect.xMinimum() && p.x <= rect.xMaximum() && p.y >= rect.yMinimum() && p.y <= rect.yMaximum() )
+        result.emplace_back( p );
+    }
+  }
+  return result;
+}
+
+bool QgsTinInterpolator::StreamingPointIndex::isOutsideConvexHull( double x, double y ) const
+{
+  // without a proper hull there are no triangles at all
+  if ( mHull.size() < 3 )
+  {
+    return true;
+  }
+
+  for ( std::size_t i = 0; i < mHull.size(); ++i )
+  {
+    const QgsPointXY &a = mHull[i];
+    const QgsPointXY &b = mHull[( i + 1 ) % mHull.size()];
+    if ( ( b.x() - a.x() ) * ( y - a.y() ) - ( b.y() - a.y() ) * ( x - a.x() ) < 0 )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int QgsTinInterpolator::StreamingPointIndex::bucketColumn( double x ) const
+{
+  return std::max( 0, std::min( mBucketColumns - 1, static_cast< int >( std::floor( ( x - mExtent.xMinimum() ) / mBucketSize ) ) ) );
+}
+
+int QgsTinInterpolator::StreamingPointIndex::bucketRow( double y ) const
+{
+  return std::max( 0, std::min( mBucketRows - 1, static_cast< int >( std::floor( ( y - mExtent.yMinimum() ) / mBucketSize ) ) ) );
+}
+
+///@endcond
 
 QgsTinInterpolator::QgsTinInterpolator( const QList<LayerData> &inputData, TinInterpolation interpolation, QgsFeedback *feedback )
   : QgsInterpolator( inputData )
@@ -67,6 +300,171 @@ int QgsTinInterpolator::interpolatePoint( double x, double y, double &result, Qg
   return 0;
 }
 
+int QgsTinInterpolator::interpolateBlock( double xMin, double yMax, double cellSizeX, double cellSizeY, int columns, int rows, double *values, QgsFeedback *feedback )
+{
+  // a derived class may override interpolatePoint(), which must then be called for every cell
+  if ( !mStreamingTriangulation || !canStream() || typeid( *this ) != typeid( QgsTinInterpolator ) )
+  {
+    return QgsInterpolator::interpolateBlock( xMin, yMax, cellSizeX, cellSizeY, columns, rows, values, feedback );
+  }
+
+  if ( !mStreamingIndex )
+  {
+    if ( cacheBaseData( feedback ) != Success )
+    {
+      return 1;
+    }
+    mStreamingIndex = qgis::make_unique< StreamingPointIndex >( mCachedBaseData );
+  }
+
+  // size of the output tiles which are triangulated independently
+  constexpr int TILE_SIZE = 256;
+  // initial halo around each tile, in multiples of the average point spacing
+  constexpr double INITIAL_HALO_POINT_SPACINGS = 8;
+
+  struct Tile
+  {
+    Tile( int firstColumn, int firstRow, int columns, int rows )
+      : firstColumn( firstColumn )
+      , firstRow( firstRow )
+      , columns( columns )
+      , rows( rows )
+    {}
+
+    int firstColumn = 0;
+    int firstRow = 0;
+    int columns = 0;
+    int rows = 0;
+  };
+
+  std::vector< Tile > tiles;
+  for ( int firstRow = 0; firstRow < rows; firstRow += TILE_SIZE )
+  {
+    for ( int firstColumn = 0; firstColumn < columns; firstColumn += TILE_SIZE )
+    {
+      tiles.emplace_back( firstColumn, firstRow, std::min( TILE_SIZE, columns - firstColumn ), std::min( TILE_SIZE, rows - firstRow ) );
+    }
+  }
+
+  const StreamingPointIndex &index = *mStreamingIndex;
+  const QgsRectangle dataExtent = index.extent();
+
+  auto processTile = [&]( const Tile & tile )
+  {
+    double *tileValues = values + static_cast< std::size_t >( tile.firstRow ) * columns + tile.firstColumn;
+    if ( dataExtent.isNull() )
+    {
+      for ( int row = 0; row < tile.rows; ++row )
+        std::fill( tileValues + static_cast< std::size_t >( row ) * columns, tileValues + static_cast< std::size_t >( row ) * columns + tile.columns, std::numeric_limits< double >::quiet_NaN() );
+      return;
+    }
+
+    const QgsRectangle tileExtent( xMin + tile.firstColumn * cellSizeX, yMax - ( tile.firstRow + tile.rows ) * cellSizeY,
+                                   xMin + ( tile.firstColumn + tile.columns ) * cellSizeX, yMax - tile.firstRow * cellSizeY );
+
+    std::vector< int > pending( static_cast< std::size_t >( tile.columns ) * tile.rows );
+    for ( std::size_t i = 0; i < pending.size(); ++i )
+      pending[i] = static_cast< int >( i );
+
+    double halo = std::max( INITIAL_HALO_POINT_SPACINGS * index.pointSpacing(), 2 * std::max( cellSizeX, cellSizeY ) );
+    QgsPoint pt1( 0, 0, 0 );
+    QgsPoint pt2( 0, 0, 0 );
+    QgsPoint pt3( 0, 0, 0 );
+    while ( !pending.empty() )
+    {
+      if ( feedback && feedback->isCanceled() )
+        return;
+
+      const QgsRectangle region = tileExtent.buffered( halo );
+      // once the region covers all points the tile triangulation is the full triangulation
+      const bool coversData = region.contains( dataExtent );
+
+      const std::vector< QgsInterpolatorVertexData > points = index.pointsInRect( region );
+      QgsDualEdgeTriangulation triangulation( static_cast< int >( points.size() ) );
+      for ( const QgsInterpolatorVertexData &p : points )
+      {
+        triangulation.addPoint( QgsPoint( p.x, p.y, p.z ) );
+      }
+
+      std::vector< int > uncertain;
+      for ( int cell : pending )
+      {
+        const int row = cell / tile.columns;
+        const int column = cell % tile.columns;
+        const double x = xMin + ( tile.firstColumn + column + 0.5 ) * cellSizeX;
+        const double y = yMax - ( tile.firstRow + row + 0.5 ) * cellSizeY;
+        double &value = tileValues[ static_cast< std::size_t >( row ) * columns + column ];
+
+        if ( triangulation.triangleVertices( x, y, pt1, pt2, pt3 ) )
+        {
+          // the triangle is part of the full Delaunay triangulation if no point outside the region can be inside its circumcircle
+          bool certain = coversData;
+          if ( !certain )
+          {
+            double radius = 0;
+            double centerX = 0;
+            double centerY = 0;
+            QgsGeometryUtils::circleCenterRadius( pt1, pt2, pt3, radius, centerX, centerY );
+            const QgsRectangle circleExtent = QgsRectangle( centerX - radius, centerY - radius, centerX + radius, centerY + radius ).intersect( dataExtent );
+            certain = radius > 0 && std::isfinite( radius ) && region.contains( circleExtent );
+          }
+
+          if ( certain )
+          {
+            // same plane equation as LinTriangleInterpolator::calcPoint
+            const double a = ( pt1.z() * ( pt2.y() - pt3.y() ) + pt2.z() * ( pt3.y() - pt1.y() ) + pt3.z() * ( pt1.y() - pt2.y() ) ) / ( ( pt1.x() - pt2.x() ) * ( pt2.y() - pt3.y() ) - ( pt2.x() - pt3.x() ) * ( pt1.y() - pt2.y() ) );
+            const double b = ( pt1.z() * ( pt2.x() - pt3.x() ) + pt2.z() * ( pt3.x() - pt1.x() ) + pt3.z() * ( pt1.x() - pt2.x() ) ) / ( ( pt1.y() - pt2.y() ) * ( pt2.x() - pt3.x() ) - ( pt2.y() - pt3.y() ) * ( pt1.x() - pt2.x() ) );
+            const double c = pt1.z() - a * pt1.x() - b * pt1.y();
+            value = a * x + b * y + c;
+            continue;
+          }
+        }
+        else if ( coversData || index.isOutsideConvexHull( x, y ) )
+        {
+          value = std::numeric_limits< double >::quiet_NaN();
+          continue;
+        }
+        uncertain.push_back( cell );
+      }
+
+      pending.swap( uncertain );
+      halo *= 2;
+    }
+  };
+
+  // each tile triangulation only lives while its tile is processed, so memory use is bounded by the thread count
+  QtConcurrent::blockingMap( tiles, processTile );
+
+  return feedback && feedback->isCanceled() ? 1 : 0;
+}
+
+void QgsTinInterpolator::setStreamingTriangulation( bool enabled )
+{
+  mStreamingTriangulation = enabled;
+}
+
+bool QgsTinInterpolator::streamingTriangulation() const
+{
+  return mStreamingTriangulation;
+}
+
+bool QgsTinInterpolator::canStream() const
+{
+  if ( mInterpolation != Linear || mTriangulationSink )
+  {
+    return false;
+  }
+
+  for ( const LayerData &layer : mLayerData )
+  {
+    if ( layer.sourceType != SourcePoints )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
 QgsFields QgsTinInterpolator::triangulationFields()
 {
   return QgsTriangulation::triangulationFields();
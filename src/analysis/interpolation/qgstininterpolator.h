@@ -22,6 +22,8 @@
 #include <QString>
 #include "qgis_analysis.h"
 
+#include <memory>
+
 class QgsFeatureSink;
 class QgsTriangulation;
 class TriangleInterpolator;
@@ -55,6 +57,39 @@ class ANALYSIS_EXPORT QgsTinInterpolator: public QgsInterpolator
 
     int interpolatePoint( double x, double y, double &result SIP_OUT, QgsFeedback *feedback ) override;
 
+    int interpolateBlock( double xMin, double yMax, double cellSizeX, double cellSizeY, int columns, int rows, double *values, QgsFeedback *feedback = nullptr ) override SIP_SKIP;
+
+    /**
+     * Sets whether a streaming triangulation is used when interpolating blocks of cells, e.g.
+     * when writing a grid with QgsGridFileWriter.
+     *
+     * In streaming mode the full triangulation is never built. The input points are cached in a compact,
+     * spatially sorted form, and the output grid is processed in tiles in parallel. Each tile is triangulated
+     * from the points inside the tile and a surrounding halo, which is grown until every cell of the tile lies
+     * in a triangle whose circumcircle is fully covered by the halo. Such triangles are part of the full Delaunay
+     * triangulation, so the results match the in-memory triangulation while memory use is bounded by the
+     * input points.
+     *
+     * Tiles are at most 256 by 256 cells and never extend across the blocks passed to interpolateBlock().
+     * QgsGridFileWriter interpolates blocks of about a million cells, so grids wider than 4096 columns are
+     * processed in tiles of fewer rows, which are triangulated with a relatively larger halo.
+     *
+     * Streaming is only possible for Linear interpolation of point sources without a triangulation sink. In
+     * other cases the in-memory triangulation is used.
+     *
+     * \see streamingTriangulation()
+     * \since QGIS 3.16
+     */
+    void setStreamingTriangulation( bool enabled );
+
+    /**
+     * Returns TRUE if a streaming triangulation is used when interpolating blocks of cells.
+     *
+     * \see setStreamingTriangulation()
+     * \since QGIS 3.16
+     */
+    bool streamingTriangulation() const;
+
     /**
      * Returns the fields output by features when saving the triangulation.
      * These fields should be used when creating
@@ -76,6 +111,8 @@ class ANALYSIS_EXPORT QgsTinInterpolator: public QgsInterpolator
     void setTriangulationSink( QgsFeatureSink *sink );
 
   private:
+    class StreamingPointIndex;
+
     QgsTriangulation *mTriangulation = nullptr;
     TriangleInterpolator *mTriangleInterpolator = nullptr;
     bool mIsInitialized;
@@ -86,6 +123,14 @@ class ANALYSIS_EXPORT QgsTinInterpolator: public QgsInterpolator
     //! Type of interpolation
     TinInterpolation mInterpolation;
 
+    //! TRUE if blocks are interpolated from tiled triangulations
+    bool mStreamingTriangulation = false;
+    //! Spatially sorted input points for the streaming triangulation
+    std::unique_ptr< StreamingPointIndex > mStreamingIndex;
+
+    //! Returns TRUE if the input data and settings allow a streaming triangulation
+    bool canStream() const;
+
     //! Create dual edge triangulation
     void initialize();
 
@@ -0,0 +1,662 @@
+/***************************************************************************
+  qgscontractionhierarchy.cpp
+  --------------------------------------
+  Date                 : July 2020
+  Copyright            : (C) 2020 by the QGIS project
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include "qgscontractionhierarchy.h"
+#include "qgsgraphsearch_p.h"
+#include "qgsgraph.h"
+#include "qgsfeedback.h"
+#include "qgis.h"
+
+#include <QFile>
+#include <QDataStream>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+///@cond PRIVATE
+
+//! State of a bidirectional query, reused between queries to avoid allocations
+struct QgsContractionHierarchy::SearchState
+{
+  explicit SearchState( int vertexCount )
+    : forwardCost( static_cast< std::size_t >( vertexCount ), std::numeric_limits< double >::infinity() )
+    , backwardCost( static_cast< std::size_t >( vertexCount ), std::numeric_limits< double >::infinity() )
+    , forwardParent( static_cast< std::size_t >( vertexCount ), -1 )
+    , backwardParent( static_cast< std::size_t >( vertexCount ), -1 )
+  {}
+
+  //! Resets the costs of all vertices touched by the last search
+  void reset()
+  {
+    for ( int vertex : touched )
+    {
+      forwardCost[ vertex ] = std::numeric_limits< double >::infinity();
+      backwardCost[ vertex ] = std::numeric_limits< double >::infinity();
+      forwardParent[ vertex ] = -1;
+      backwardParent[ vertex ] = -1;
+    }
+    touched.clear();
+  }
+
+  std::vector< double > forwardCost;
+  std::vector< double > backwardCost;
+  std::vector< int > forwardParent;
+  std::vector< int > backwardParent;
+  std::vector< int > touched;
+};
+
+namespace
+{
+  //! Arc of the graph while the hierarchy is built
+  struct BuildArc
+  {
+    BuildArc( int vertex, double cost, int middle )
+      : vertex( vertex )
+      , cost( cost )
+      , middle( middle )
+    {}
+
+    int vertex = -1;
+    double cost = 0;
+    int middle = -1;
+  };
+
+  typedef std::pair< double, int > QueueEntry;
+  typedef std::priority_queue< QueueEntry, std::vector< QueueEntry >, std::greater< QueueEntry > > MinQueue;
+
+  //! Magic number at the start of hierarchy files
+  constexpr quint32 FILE_MAGIC = 0x51434831;
+  //! Version of the hierarchy file format
+  constexpr quint32 FILE_VERSION = 1;
+
+  //! Maximum number of vertices settled by a witness search while estimating the priority of a vertex
+  constexpr int PRIORITY_WITNESS_LIMIT = 50;
+  //! Maximum number of vertices settled by a witness search while contracting a vertex
+  constexpr int CONTRACTION_WITNESS_LIMIT = 500;
+
+  void writeVector( QDataStream &stream, const std::vector< int > &vector )
+  {
+    stream << static_cast< quint32 >( vector.size() );
+    for ( int value : vector )
+      stream << static_cast< qint32 >( value );
+  }
+
+  void writeVector( QDataStream &stream, const std::vector< double > &vector )
+  {
+    stream << static_cast< quint32 >( vector.size() );
+    for ( double value : vector )
+      stream << value;
+  }
+
+  bool readVector( QDataStream &stream, std::vector< int > &vector )
+  {
+    quint32 size = 0;
+    stream >> size;
+    // don't allocate more values than the file can contain
+    if ( stream.status() != QDataStream::Ok || size > stream.device()->bytesAvailable() / sizeof( qint32 ) )
+      return false;
+    vector.resize( size );
+    for ( quint32 i = 0; i < size && stream.status() == QDataStream::Ok; ++i )
+    {
+      qint32 value = 0;
+      stream >> value;
+      vector[i] = value;
+    }
+    return stream.status() == QDataStream::Ok;
+  }
+
+  bool readVector( QDataStream &stream, std::vector< double > &vector )
+  {
+    quint32 size = 0;
+    stream >> size;
+    if ( stream.status() != QDataStream::Ok || size > stream.device()->bytesAvailable() / sizeof( double ) )
+      return false;
+    vector.resize( size );
+    for ( quint32 i = 0; i < size && stream.status() == QDataStream::Ok; ++i )
+    {
+      stream >> vector[i];
+    }
+    return stream.status() == QDataStream::Ok;
+  }
+}
+
+///@endcond
+
+QgsContractionHierarchy::QgsContractionHierarchy() = default;
+
+QgsContractionHierarchy::~QgsContractionHierarchy() = default;
+
+bool QgsContractionHierarchy::build( const QgsGraph *graph, int criterionNum, QgsFeedback *feedback )
+{
+  mVertexCount = 0;
+  mShortcutCount = 0;
+  mRank.clear();
+  mForward.reset();
+  mBackward.reset();
+  mSearchStates.reset();
+
+  if ( !graph )
+    return false;
+
+  const int vertexCount = graph->vertexCount();
+  std::vector< std::vector< BuildArc > > outArcs( static_cast< std::size_t >( vertexCount ) );
+  std::vector< std::vector< BuildArc > > inArcs( static_cast< std::size_t >( vertexCount ) );
+
+  // adds an arc, or lowers the cost of an existing arc between the same vertices
+  auto addArc = [&outArcs, &inArcs]( int from, int to, double cost, int middle )
+  {
+    for ( BuildArc &arc : outArcs[ from ] )
+    {
+      if ( arc.vertex != to )
+        continue;
+
+      if ( cost < arc.cost )
+      {
+        arc.cost = cost;
+        arc.middle = middle;
+        for ( BuildArc &reverse : inArcs[ to ] )
+        {
+          if ( reverse.vertex == from )
+          {
+            reverse.cost = cost;
+            reverse.middle = middle;
+            break;
+          }
+        }
+      }
+      return;
+    }
+    outArcs[ from ].emplace_back( to, cost, middle );
+    inArcs[ to ].emplace_back( from, cost, middle );
+  };
+
+  for ( int i = 0; i < graph->edgeCount(); ++i )
+  {
+    const QgsGraphEdge &edge = graph->edge( i );
+    bool ok = false;
+    const double cost = edge.cost( criterionNum ).toDouble( &ok );
+    if ( !ok || std::isnan( cost ) || cost < 0 )
+      return false;
+
+    if ( edge.fromVertex() == edge.toVertex() )
+      continue;
+
+    addArc( edge.fromVertex(), edge.toVertex(), cost, -1 );
+  }
+
+  std::vector< bool > contracted( static_cast< std::size_t >( vertexCount ), false );
+  std::vector< int > contractedNeighbors( static_cast< std::size_t >( vertexCount ), 0 );
+  std::vector< int > level( static_cast< std::size_t >( vertexCount ), 0 );
+  std::vector< int > rank( static_cast< std::size_t >( vertexCount ), 0 );
+
+  // local Dijkstra search which looks for paths avoiding the vertex being contracted
+  std::vector< double > witnessCost( static_cast< std::size_t >( vertexCount ), std::numeric_limits< double >::infinity() );
+  std::vector< int > witnessTouched;
+  // vertices marked with the current search number are the targets of the search
+  std::vector< int > witnessTarget( static_cast< std::size_t >( vertexCount ), -1 );
+  int witnessSearchNumber = 0;
+  auto witnessSearch = [&]( int source, int excluded, double maxCost, int targetCount, int settleLimit )
+  {
+    for ( int vertex : witnessTouched )
+      witnessCost[ vertex ] = std::numeric_limits< double >::infinity();
+    witnessTouched.clear();
+
+    MinQueue queue;
+    witnessCost[ source ] = 0;
+    witnessTouched.push_back( source );
+    queue.push( QueueEntry( 0, source ) );
+    int settled = 0;
+    while ( !queue.empty() )
+    {
+      const QueueEntry entry = queue.top();
+      queue.pop();
+      if ( entry.first > witnessCost[ entry.second ] )
+        continue;
+      if ( entry.first > maxCost || ++settled > settleLimit )
+        break;
+      // stop once the costs of all targets are final
+      if ( witnessTarget[ entry.second ] == witnessSearchNumber && --targetCount == 0 )
+        break;
+
+      for ( const BuildArc &arc : outArcs[ entry.second ] )
+      {
+        if ( arc.vertex == excluded )
+          continue;
+
+        const double cost = entry.first + arc.cost;
+        if ( cost < witnessCost[ arc.vertex ] )
+        {
+          if ( std::isinf( witnessCost[ arc.vertex ] ) )
+            witnessTouched.push_back( arc.vertex );
+          witnessCost[ arc.vertex ] = cost;
+          queue.push( QueueEntry( cost, arc.vertex ) );
+        }
+      }
+    }
+  };
+
+  // returns the number of shortcuts needed to contract vertex, and adds them unless simulating
+  auto contractVertex = [&]( int vertex, bool simulate ) -> int
+  {
+    int shortcuts = 0;
+    const int settleLimit = simulate ? PRIORITY_WITNESS_LIMIT : CONTRACTION_WITNESS_LIMIT;
+    for ( std::size_t i = 0; i < inArcs[ vertex ].size(); ++i )
+    {
+      const BuildArc incoming = inArcs[ vertex ][ i ];
+      double maxCost = -1;
+      int targetCount = 0;
+      ++witnessSearchNumber;
+      for ( const BuildArc &outgoing : outArcs[ vertex ] )
+      {
+        if ( outgoing.vertex != incoming.vertex )
+        {
+          maxCost = std::max( maxCost, incoming.cost + outgoing.cost );
+          witnessTarget[ outgoing.vertex ] = witnessSearchNumber;
+          ++targetCount;
+        }
+      }
+      if ( maxCost < 0 )
+        continue;
+
+      witnessSearch( incoming.vertex, vertex, maxCost, targetCount, settleLimit );
+
+      for ( std::size_t j = 0; j < outArcs[ vertex ].size(); ++j )
+      {
+        const BuildArc outgoing = outArcs[ vertex ][ j ];
+        if ( outgoing.vertex == incoming.vertex )
+          continue;
+
+        const double viaCost = incoming.cost + outgoing.cost;
+        if ( witnessCost[ outgoing.vertex ] > viaCost )
+        {
+          ++shortcuts;
+          if ( !simulate )
+            addArc( incoming.vertex, outgoing.vertex, viaCost, vertex );
+        }
+      }
+    }
+    return shortcuts;
+  };
+
+  // edge difference, plus the number of already contracted neighbors and the depth of the hierarchy below
+  // the vertex, which spread the contraction evenly over the graph
+  auto priority = [&]( int vertex ) -> int
+  {
+    const int arcCount = static_cast< int >( inArcs[ vertex ].size() + outArcs[ vertex ].size() );
+    return 2 * ( contractVertex( vertex, true ) - arcCount ) + contractedNeighbors[ vertex ] + level[ vertex ];
+  };
+
+  typedef std::pair< int, int > PriorityEntry;
+  std::priority_queue< PriorityEntry, std::vector< PriorityEntry >, std::greater< PriorityEntry > > order;
+  for ( int vertex = 0; vertex < vertexCount; ++vertex )
+  {
+    if ( feedback && feedback->isCanceled() )
+      return false;
+    order.push( PriorityEntry( priority( vertex ), vertex ) );
+  }
+
+  auto removeArc = []( std::vector< BuildArc > &arcs, int neighbor )
+  {
+    arcs.erase( std::remove_if( arcs.begin(), arcs.end(), [neighbor]( const BuildArc & arc ) { return arc.vertex == neighbor; } ), arcs.end() );
+  };
+
+  int contractedCount = 0;
+  while ( !order.empty() )
+  {
+    const int vertex = order.top().second;
+    order.pop();
+    if ( contracted[ vertex ] )
+      continue;
+
+    // lazy update: priorities change as neighbors are contracted
+    const int currentPriority = priority( vertex );
+    if ( !order.empty() && currentPriority > order.top().first )
+    {
+      order.push( PriorityEntry( currentPriority, vertex ) );
+      continue;
+    }
+
+    contractVertex( vertex, false );
+    contracted[ vertex ] = true;
+    rank[ vertex ] = contractedCount++;
+
+    // the arcs of the contracted vertex are kept in its own lists only, so the lists of the
+    // remaining vertices only ever contain uncontracted vertices
+    for ( const BuildArc &arc : inArcs[ vertex ] )
+    {
+      contractedNeighbors[ arc.vertex ]++;
+      level[ arc.vertex ] = std::max( level[ arc.vertex ], level[ vertex ] + 1 );
+      removeArc( outArcs[ arc.vertex ], vertex );
+    }
+    for ( const BuildArc &arc : outArcs[ vertex ] )
+    {
+      contractedNeighbors[ arc.vertex ]++;
+      level[ arc.vertex ] = std::max( level[ arc.vertex ], level[ vertex ] + 1 );
+      removeArc( inArcs[ arc.vertex ], vertex );
+    }
+
+    if ( feedback && contractedCount % 1000 == 0 )
+    {
+      if ( feedback->isCanceled() )
+        return false;
+      feedback->setProgress( 100.0 * contractedCount / vertexCount );
+    }
+  }
+
+  // keep only the arcs towards more important vertices
+  auto buildUpwardGraph = [&rank, vertexCount]( const std::vector< std::vector< BuildArc > > &arcs )
+  {
+    std::unique_ptr< QgsGraphAdjacency > upward = qgis::make_unique< QgsGraphAdjacency >();
+    upward->offsets.reserve( static_cast< std::size_t >( vertexCount ) + 1 );
+    for ( int vertex = 0; vertex < vertexCount; ++vertex )
+    {
+      for ( const BuildArc &arc : arcs[ vertex ] )
+      {
+        if ( rank[ arc.vertex ] > rank[ vertex ] )
+          upward->addEdge( arc.vertex, arc.cost, arc.middle );
+      }
+      upward->endVertex();
+    }
+    return upward;
+  };
+  mForward = buildUpwardGraph( outArcs );
+  mBackward = buildUpwardGraph( inArcs );
+
+  mShortcutCount = static_cast< int >( std::count_if( mForward->values.begin(), mForward->values.end(), []( int middle ) { return middle >= 0; } )
+                                       + std::count_if( mBackward->values.begin(), mBackward->values.end(), []( int middle ) { return middle >= 0; } ) );
+  mRank = rank;
+  mVertexCount = vertexCount;
+  mSearchStates = qgis::make_unique< QgsSearchStatePool< SearchState > >( vertexCount );
+
+  if ( feedback )
+    feedback->setProgress( 100 );
+  return true;
+}
+
+bool QgsContractionHierarchy::isValid() const
+{
+  // an empty graph still has its (empty) upward graphs
+  return static_cast< bool >( mForward );
+}
+
+int QgsContractionHierarchy::vertexCount() const
+{
+  return mVertexCount;
+}
+
+int QgsContractionHierarchy::shortcutCount() const
+{
+  return mShortcutCount;
+}
+
+double QgsContractionHierarchy::shortestPathCost( int fromVertex, int toVertex ) const
+{
+  if ( fromVertex < 0 || fromVertex >= mVertexCount || toVertex < 0 || toVertex >= mVertexCount )
+    return std::numeric_limits< double >::infinity();
+
+  std::unique_ptr< SearchState > state = mSearchStates->acquire();
+  double cost = std::numeric_limits< double >::infinity();
+  search( *state, fromVertex, toVertex, cost );
+  state->reset();
+  mSearchStates->release( std::move( state ) );
+  return cost;
+}
+
+QVector<int> QgsContractionHierarchy::shortestPath( int fromVertex, int toVertex, double &cost ) const
+{
+  cost = std::numeric_limits< double >::infinity();
+  QVector< int > path;
+  if ( fromVertex < 0 || fromVertex >= mVertexCount || toVertex < 0 || toVertex >= mVertexCount )
+    return path;
+
+  std::unique_ptr< SearchState > state = mSearchStates->acquire();
+  const int meeting = search( *state, fromVertex, toVertex, cost );
+  if ( meeting >= 0 )
+  {
+    // vertices of the upward path from the start to the meeting vertex, then down to the end
+    std::vector< int > vertices;
+    for ( int vertex = meeting; vertex >= 0; vertex = state->forwardParent[ vertex ] )
+      vertices.push_back( vertex );
+    std::reverse( vertices.begin(), vertices.end() );
+    for ( int vertex = state->backwardParent[ meeting ]; vertex >= 0; vertex = state->backwardParent[ vertex ] )
+      vertices.push_back( vertex );
+
+    path.append( vertices.front() );
+    for ( std::size_t i = 1; i < vertices.size(); ++i )
+      unpackEdge( vertices[i - 1], vertices[i], path );
+  }
+  state->reset();
+  mSearchStates->release( std::move( state ) );
+  return path;
+}
+
+int QgsContractionHierarchy::search( SearchState &state, int fromVertex, int toVertex, double &cost ) const
+{
+  const double infinity = std::numeric_limits< double >::infinity();
+  cost = infinity;
+  if ( fromVertex == toVertex )
+  {
+    cost = 0;
+    return fromVertex;
+  }
+
+  MinQueue forwardQueue;
+  MinQueue backwardQueue;
+  state.forwardCost[ fromVertex ] = 0;
+  state.backwardCost[ toVertex ] = 0;
+  state.touched.push_back( fromVertex );
+  state.touched.push_back( toVertex );
+  forwardQueue.push( QueueEntry( 0, fromVertex ) );
+  backwardQueue.push( QueueEntry( 0, toVertex ) );
+
+  int meeting = -1;
+  while ( !forwardQueue.empty() || !backwardQueue.empty() )
+  {
+    const double forwardMin = forwardQueue.empty() ? infinity : forwardQueue.top().first;
+    const double backwardMin = backwardQueue.empty() ? infinity : backwardQueue.top().first;
+    // no remaining vertex in either direction can lead to a cheaper path
+    if ( std::min( forwardMin, backwardMin ) >= cost )
+      break;
+
+    const bool forward = forwardMin <= backwardMin;
+    MinQueue &queue = forward ? forwardQueue : backwardQueue;
+    const QgsGraphAdjacency &graph = forward ? *mForward : *mBackward;
+    std::vector< double > &costs = forward ? state.forwardCost : state.backwardCost;
+    std::vector< int > &parents = forward ? state.forwardParent : state.backwardParent;
+    const std::vector< double > &otherCosts = forward ? state.backwardCost : state.forwardCost;
+
+    const QueueEntry entry = queue.top();
+    queue.pop();
+    const int vertex = entry.second;
+    if ( entry.first > costs[ vertex ] )
+      continue;
+
+    if ( entry.first + otherCosts[ vertex ] < cost )
+    {
+      cost = entry.first + otherCosts[ vertex ];
+      meeting = vertex;
+    }
+
+    for ( int i = graph.offsets[ vertex ]; i < graph.offsets[ vertex + 1 ]; ++i )
+    {
+      const int target = graph.targets[ i ];
+      const double targetCost = entry.first + graph.costs[ i ];
+      if ( targetCost < costs[ target ] )
+      {
+        if ( std::isinf( state.forwardCost[ target ] ) && std::isinf( state.backwardCost[ target ] ) )
+          state.touched.push_back( target );
+        costs[ target ] = targetCost;
+        parents[ target ] = vertex;
+        queue.push( QueueEntry( targetCost, target ) );
+      }
+    }
+  }
+  return meeting;
+}
+
+void QgsContractionHierarchy::unpackEdge( int from, int to, QVector<int> &path ) const
+{
+  // the edge is stored with the less important of its two vertices
+  int middle = -1;
+  double cost = std::numeric_limits< double >::infinity();
+  if ( mRank[ to ] > mRank[ from ] )
+  {
+    const QgsGraphAdjacency &forward = *mForward;
+    for ( int i = forward.offsets[ from ]; i < forward.offsets[ from + 1 ]; ++i )
+    {
+      if ( forward.targets[ i ] == to && forward.costs[ i ] < cost )
+      {
+        cost = forward.costs[ i ];
+        middle = forward.values[ i ];
+      }
+    }
+  }
+  else
+  {
+    const QgsGraphAdjacency &backward = *mBackward;
+    for ( int i = backward.offsets[ to ]; i < backward.offsets[ to + 1 ]; ++i )
+    {
+      if ( backward.targets[ i ] == from && backward.costs[ i ] < cost )
+      {
+        cost = backward.costs[ i ];
+        middle = backward.values[ i ];
+      }
+    }
+  }
+
+  if ( middle < 0 )
+  {
+    path.append( to );
+  }
+  else
+  {
+    unpackEdge( from, middle, path );
+    unpackEdge( middle, to, path );
+  }
+}
+
+bool QgsContractionHierarchy::writeToFile( const QString &path ) const
+{
+  if ( !isValid() )
+    return false;
+
+  QFile file( path );
+  if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    return false;
+
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  stream << FILE_MAGIC << FILE_VERSION;
+  stream << static_cast< qint32 >( mVertexCount ) << static_cast< qint32 >( mShortcutCount );
+  writeVector( stream, mRank );
+  for ( const QgsGraphAdjacency *graph : { mForward.get(), mBackward.get() } )
+  {
+    writeVector( stream, graph->offsets );
+    writeVector( stream, graph->targets );
+    writeVector( stream, graph->costs );
+    writeVector( stream, graph->values );
+  }
+  return stream.status() == QDataStream::Ok;
+}
+
+bool QgsContractionHierarchy::readFromFile( const QString &path )
+{
+  QFile file( path );
+  if ( !file.open( QIODevice::ReadOnly ) )
+    return false;
+
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  quint32 magic = 0;
+  quint32 version = 0;
+  stream >> magic >> version;
+  if ( magic != FILE_MAGIC || version != FILE_VERSION )
+    return false;
+
+  qint32 vertexCount = 0;
+  qint32 shortcutCount = 0;
+  stream >> vertexCount >> shortcutCount;
+  if ( stream.status() != QDataStream::Ok || vertexCount < 0 || shortcutCount < 0 )
+    return false;
+
+  // the rank must be a permutation of the vertices
+  std::vector< int > rank;
+  if ( !readVector( stream, rank ) || rank.size() != static_cast< std::size_t >( vertexCount ) )
+    return false;
+  std::vector< bool > rankUsed( rank.size(), false );
+  for ( int vertexRank : rank )
+  {
+    if ( vertexRank < 0 || vertexRank >= vertexCount || rankUsed[ vertexRank ] )
+      return false;
+    rankUsed[ vertexRank ] = true;
+  }
+
+  std::unique_ptr< QgsGraphAdjacency > forward = qgis::make_unique< QgsGraphAdjacency >();
+  std::unique_ptr< QgsGraphAdjacency > backward = qgis::make_unique< QgsGraphAdjacency >();
+  int shortcuts = 0;
+  for ( QgsGraphAdjacency *graph : { forward.get(), backward.get() } )
+  {
+    if ( !readVector( stream, graph->offsets ) || !readVector( stream, graph->targets )
+         || !readVector( stream, graph->costs ) || !readVector( stream, graph->values ) )
+      return false;
+
+    if ( graph->offsets.size() != static_cast< std::size_t >( vertexCount ) + 1
+         || graph->costs.size() != graph->targets.size() || graph->values.size() != graph->targets.size() )
+      return false;
+
+    if ( graph->offsets.front() != 0 || graph->offsets.back() != static_cast< int >( graph->targets.size() ) )
+      return false;
+
+    for ( int vertex = 0; vertex < vertexCount; ++vertex )
+    {
+      if ( graph->offsets[ vertex + 1 ] < graph->offsets[ vertex ] )
+        return false;
+
+      // edges must lead to more important vertices and shortcuts must bridge a less important
+      // vertex, otherwise searches could run out of bounds and unpacking would never end
+      for ( int i = graph->offsets[ vertex ]; i < graph->offsets[ vertex + 1 ]; ++i )
+      {
+        const int target = graph->targets[ i ];
+        const int middle = graph->values[ i ];
+        if ( target < 0 || target >= vertexCount || rank[ target ] <= rank[ vertex ] )
+          return false;
+        if ( std::isnan( graph->costs[ i ] ) || graph->costs[ i ] < 0 )
+          return false;
+        if ( middle >= 0 )
+        {
+          if ( middle >= vertexCount || rank[ middle ] >= rank[ vertex ] )
+            return false;
+          ++shortcuts;
+        }
+        else if ( middle != -1 )
+        {
+          return false;
+        }
+      }
+    }
+  }
+  if ( shortcuts != shortcutCount )
+    return false;
+
+  mVertexCount = vertexCount;
+  mShortcutCount = shortcutCount;
+  mRank = std::move( rank );
+  mForward = std::move( forward );
+  mBackward = std::move( backward );
+  mSearchStates = qgis::make_unique< QgsSearchStatePool< SearchState > >( vertexCount );
+  return true;
+}
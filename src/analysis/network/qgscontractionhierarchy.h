@@ -0,0 +1,171 @@
+/***************************************************************************
+  qgscontractionhierarchy.h
+  --------------------------------------
+  Date                 : July 2020
+  Copyright            : (C) 2020 by the QGIS project
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSCONTRACTIONHIERARCHY_H
+#define QGSCONTRACTIONHIERARCHY_H
+
+#include <QVector>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "qgis_sip.h"
+#include "qgis_analysis.h"
+
+class QgsGraph;
+class QgsFeedback;
+#ifndef SIP_RUN
+struct QgsGraphAdjacency;
+template< typename State > class QgsSearchStatePool;
+#endif
+
+/**
+ * \ingroup analysis
+ * \class QgsContractionHierarchy
+ * \brief A contraction hierarchy of a QgsGraph, for fast point to point shortest path queries.
+ *
+ * Building the hierarchy converts the costs of one strategy of a QgsGraph to a compact
+ * representation with double costs, stored as compressed sparse rows. Vertices are then
+ * contracted one by one in order of importance, adding shortcut edges which preserve the
+ * shortest path costs between the remaining vertices.
+ *
+ * Queries run a bidirectional Dijkstra search which only follows edges towards more important
+ * vertices, so they settle a tiny fraction of the vertices settled by QgsGraphAnalyzer::dijkstra().
+ * Queries may be run concurrently from several threads.
+ *
+ * Building the hierarchy for a large network is expensive, so the result can be written to disk
+ * with writeToFile() and restored with readFromFile().
+ *
+ * Vertex indices are the indices of the vertices in the source QgsGraph.
+ *
+ * \since QGIS 3.16
+ */
+class ANALYSIS_EXPORT QgsContractionHierarchy
+{
+  public:
+
+    /**
+     * Constructor for an invalid QgsContractionHierarchy. Call build() or readFromFile()
+     * to make the hierarchy valid.
+     */
+    QgsContractionHierarchy();
+
+    ~QgsContractionHierarchy();
+
+    //! QgsContractionHierarchy cannot be copied
+    QgsContractionHierarchy( const QgsContractionHierarchy &other ) = delete;
+    //! QgsContractionHierarchy cannot be copied
+    QgsContractionHierarchy &operator=( const QgsContractionHierarchy &other ) = delete;
+
+    /**
+     * Builds the hierarchy for the costs calculated by the strategy with index \a criterionNum
+     * of the \a graph.
+     *
+     * An optional \a feedback object can be set for progress reports and cancellation support.
+     *
+     * A graph without vertices results in a valid, empty hierarchy.
+     *
+     * \returns TRUE if the hierarchy was built, FALSE if the build was canceled or the graph
+     * contains negative or invalid costs.
+     */
+    bool build( const QgsGraph *graph, int criterionNum, QgsFeedback *feedback = nullptr );
+
+    /**
+     * Returns TRUE if the hierarchy has been built or read from a file.
+     */
+    bool isValid() const;
+
+    /**
+     * Returns the number of vertices in the hierarchy.
+     */
+    int vertexCount() const;
+
+    /**
+     * Returns the number of shortcut edges added while contracting the vertices.
+     */
+    int shortcutCount() const;
+
+    /**
+     * Returns the cost of the shortest path from \a fromVertex to \a toVertex, or
+     * infinity if \a toVertex cannot be reached.
+     *
+     * \see shortestPath()
+     */
+    double shortestPathCost( int fromVertex, int toVertex ) const;
+
+    /**
+     * Returns the vertices along the shortest path from \a fromVertex to \a toVertex,
+     * including both end vertices, and sets \a cost to the cost of the path.
+     *
+     * An empty list is returned if \a toVertex cannot be reached.
+     *
+     * \see shortestPathCost()
+     */
+    QVector< int > shortestPath( int fromVertex, int toVertex, double &cost SIP_OUT ) const;
+
+    /**
+     * Writes the hierarchy to the file at \a path.
+     *
+     * \returns TRUE if the file was written
+     * \see readFromFile()
+     */
+    bool writeToFile( const QString &path ) const;
+
+    /**
+     * Reads a hierarchy previously written with writeToFile() from the file at \a path.
+     *
+     * The content of the file is checked before it is used, and the current hierarchy is left
+     * unchanged if the file is truncated, corrupt or inconsistent.
+     *
+     * \returns TRUE if the file was read
+     * \see writeToFile()
+     */
+    bool readFromFile( const QString &path );
+
+  private:
+
+#ifdef SIP_RUN
+    QgsContractionHierarchy( const QgsContractionHierarchy &other );
+#endif
+
+    struct SearchState;
+
+    /**
+     * Runs the bidirectional search and returns the vertex where the forward and backward
+     * searches meet on the shortest path, or -1 if there is no path.
+     */
+    int search( SearchState &state, int fromVertex, int toVertex, double &cost ) const;
+
+    //! Appends the original vertices of the edge from \a from to \a to, excluding \a from
+    void unpackEdge( int from, int to, QVector< int > &path ) const;
+
+    int mVertexCount = 0;
+    int mShortcutCount = 0;
+    //! Contraction order of each vertex
+    std::vector< int > mRank;
+
+    /**
+     * Edges to more important vertices, in their original direction. The value of each edge is the
+     * contracted vertex bridged by a shortcut edge, or -1 for an original edge. NULLPTR until the
+     * hierarchy is built or read.
+     */
+    std::unique_ptr< QgsGraphAdjacency > mForward;
+    //! Edges from more important vertices, in reverse direction, with the same values as the forward edges
+    std::unique_ptr< QgsGraphAdjacency > mBackward;
+
+    //! Pool of search states, reused between queries
+    std::unique_ptr< QgsSearchStatePool< SearchState > > mSearchStates;
+};
+
+#endif // QGSCONTRACTIONHIERARCHY_H
@@ -0,0 +1,135 @@
+/***************************************************************************
+  qgsgraphsearch_p.h
+  --------------------------------------
+  Date                 : July 2020
+  Copyright            : (C) 2020 by the QGIS project
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSGRAPHSEARCH_PRIVATE_H
+#define QGSGRAPHSEARCH_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <memory>
+#include <vector>
+
+/**
+ * Edges of each vertex of a graph, as compressed sparse rows, for searches which only
+ * read the graph.
+ *
+ * The edges of the vertices are added in order of vertex: the edges of a vertex are added
+ * with addEdge(), then endVertex() moves on to the next vertex.
+ */
+struct QgsGraphAdjacency
+{
+  //! Index of the first edge of each vertex, with a final entry for the end of the last vertex
+  std::vector< int > offsets { 0 };
+  //! Vertex at the other end of each edge
+  std::vector< int > targets;
+  //! Cost of each edge
+  std::vector< double > costs;
+  //! Value attached to each edge by the search using the graph, e.g. the index of the edge in a QgsGraph
+  std::vector< int > values;
+
+  //! Reserves memory for \a vertexCount vertices and \a edgeCount edges
+  void reserve( std::size_t vertexCount, std::size_t edgeCount )
+  {
+    offsets.reserve( vertexCount + 1 );
+    targets.reserve( edgeCount );
+    costs.reserve( edgeCount );
+    values.reserve( edgeCount );
+  }
+
+  //! Adds an edge to the current vertex
+  void addEdge( int target, double cost, int value )
+  {
+    targets.push_back( target );
+    costs.push_back( cost );
+    values.push_back( value );
+  }
+
+  //! Ends the edges of the current vertex
+  void endVertex()
+  {
+    offsets.push_back( static_cast< int >( targets.size() ) );
+  }
+
+  //! Returns the number of vertices
+  int vertexCount() const
+  {
+    return static_cast< int >( offsets.size() ) - 1;
+  }
+};
+
+/**
+ * Pool of search states, so that concurrent searches on the same graph each use their own state
+ * while reusing the memory of the states of earlier searches.
+ *
+ * \a State must be constructible from the number of vertices of the graph, and must be reset by
+ * the search before it is released.
+ */
+template< typename State >
+class QgsSearchStatePool
+{
+  public:
+
+    //! Constructor for QgsSearchStatePool, for searches on a graph with \a vertexCount vertices
+    explicit QgsSearchStatePool( int vertexCount )
+      : mVertexCount( vertexCount )
+    {}
+
+    //! Returns a state from the pool, or a new state if all states are in use
+    std::unique_ptr< State > acquire()
+    {
+      {
+        QMutexLocker locker( &mMutex );
+        if ( !mStates.empty() )
+        {
+          std::unique_ptr< State > state = std::move( mStates.back() );
+          mStates.pop_back();
+          return state;
+        }
+      }
+      return qgis::make_unique< State >( mVertexCount );
+    }
+
+    //! Returns a reset \a state to the pool
+    void release( std::unique_ptr< State > state )
+    {
+      QMutexLocker locker( &mMutex );
+      mStates.emplace_back( std::move( state ) );
+    }
+
+  private:
+
+    QMutex mMutex;
+    int mVertexCount = 0;
+    std::vector< std::unique_ptr< State > > mStates;
+};
+
+/// @endcond
+
+#endif // QGSGRAPHSEARCH_PRIVATE_H
@@ -0,0 +1,259 @@
+/***************************************************************************
+  qgsgraphsearchengine.cpp
+  --------------------------------------
+  Date                 : July 2020
+  Copyright            : (C) 2020 by the QGIS project
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include "qgsgraphsearchengine.h"
+#include "qgsgraphsearch_p.h"
+#include "qgsgraph.h"
+#include "qgsfeedback.h"
+#include "qgis.h"
+
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+///@cond PRIVATE
+
+//! State of a single search, reused between searches so that each search only touches the vertices it reaches
+struct QgsGraphSearchEngine::SearchState
+{
+  explicit SearchState( int vertexCount )
+    : cost( static_cast< std::size_t >( vertexCount ), std::numeric_limits< double >::infinity() )
+    , inboundEdge( static_cast< std::size_t >( vertexCount ), -1 )
+    , settled( static_cast< std::size_t >( vertexCount ), 0 )
+    , target( static_cast< std::size_t >( vertexCount ), 0 )
+  {}
+
+  //! Resets all vertices touched by the last search
+  void reset()
+  {
+    for ( int vertex : touched )
+    {
+      cost[ vertex ] = std::numeric_limits< double >::infinity();
+      inboundEdge[ vertex ] = -1;
+      settled[ vertex ] = 0;
+    }
+    touched.clear();
+    reached.clear();
+    queue.clear();
+  }
+
+  std::vector< double > cost;
+  std::vector< int > inboundEdge;
+  std::vector< char > settled;
+  std::vector< char > target;
+  //! Vertices with a finite cost
+  std::vector< int > touched;
+  //! Vertices settled within the maximum cost, in order of increasing cost
+  std::vector< int > reached;
+  //! Binary min heap of tentative costs
+  std::vector< std::pair< double, int > > queue;
+};
+
+///@endcond
+
+QgsGraphSearchEngine::QgsGraphSearchEngine( const QgsGraph *graph, int criterionNum )
+  : mGraph( graph )
+  , mVertexCount( graph ? graph->vertexCount() : 0 )
+  , mSearchStates( qgis::make_unique< QgsSearchStatePool< SearchState > >( mVertexCount ) )
+{
+  if ( !graph )
+    return;
+
+  std::unique_ptr< QgsGraphAdjacency > edges = qgis::make_unique< QgsGraphAdjacency >();
+  edges->reserve( static_cast< std::size_t >( mVertexCount ), static_cast< std::size_t >( graph->edgeCount() ) );
+  for ( int vertex = 0; vertex < mVertexCount; ++vertex )
+  {
+    const QgsGraphEdgeIds &outgoingEdges = graph->vertex( vertex ).outgoingEdges();
+    for ( int edgeId : outgoingEdges )
+    {
+      const QgsGraphEdge &edge = graph->edge( edgeId );
+      bool ok = false;
+      const double cost = edge.cost( criterionNum ).toDouble( &ok );
+      // Dijkstra searches are only correct for non negative costs
+      if ( !ok || std::isnan( cost ) || cost < 0 )
+        return;
+
+      edges->addEdge( edge.toVertex(), cost, edgeId );
+    }
+    edges->endVertex();
+  }
+  mEdges = std::move( edges );
+}
+
+QgsGraphSearchEngine::~QgsGraphSearchEngine() = default;
+
+bool QgsGraphSearchEngine::isValid() const
+{
+  return static_cast< bool >( mEdges );
+}
+
+void QgsGraphSearchEngine::dijkstra( int startVertexIdx, double maximumCost, QVector<int> *resultTree, QVector<double> *resultCost, QVector<int> *reachedVertices ) const
+{
+  if ( resultTree )
+  {
+    resultTree->clear();
+    resultTree->insert( resultTree->begin(), mVertexCount, -1 );
+  }
+  if ( resultCost )
+  {
+    resultCost->clear();
+    resultCost->insert( resultCost->begin(), mVertexCount, std::numeric_limits< double >::infinity() );
+  }
+  if ( reachedVertices )
+    reachedVertices->clear();
+
+  if ( !mEdges || startVertexIdx < 0 || startVertexIdx >= mVertexCount )
+    return;
+
+  std::unique_ptr< SearchState > state = mSearchStates->acquire();
+  search( *state, startVertexIdx, maximumCost < 0 ? std::numeric_limits< double >::infinity() : maximumCost, -1 );
+
+  for ( int vertex : state->touched )
+  {
+    if ( !state->settled[ vertex ] )
+      continue;
+
+    if ( resultTree )
+      ( *resultTree )[ vertex ] = state->inboundEdge[ vertex ];
+    if ( resultCost )
+      ( *resultCost )[ vertex ] = state->cost[ vertex ];
+  }
+  if ( reachedVertices )
+  {
+    reachedVertices->reserve( static_cast< int >( state->reached.size() ) );
+    for ( int vertex : state->reached )
+      reachedVertices->append( vertex );
+  }
+
+  state->reset();
+  mSearchStates->release( std::move( state ) );
+}
+
+QVector<double> QgsGraphSearchEngine::costs( int startVertexIdx, const QVector<int> &targetVertices, double maximumCost ) const
+{
+  QVector< double > result( targetVertices.size(), std::numeric_limits< double >::infinity() );
+  if ( !mEdges || startVertexIdx < 0 || startVertexIdx >= mVertexCount || targetVertices.isEmpty() )
+    return result;
+
+  if ( maximumCost < 0 )
+    maximumCost = std::numeric_limits< double >::infinity();
+
+  std::unique_ptr< SearchState > state = mSearchStates->acquire();
+  int targetCount = 0;
+  for ( int vertex : targetVertices )
+  {
+    if ( vertex >= 0 && vertex < mVertexCount && !state->target[ vertex ] )
+    {
+      state->target[ vertex ] = 1;
+      ++targetCount;
+    }
+  }
+
+  if ( targetCount > 0 )
+    search( *state, startVertexIdx, maximumCost, targetCount );
+
+  for ( int i = 0; i < targetVertices.size(); ++i )
+  {
+    const int vertex = targetVertices.at( i );
+    if ( vertex < 0 || vertex >= mVertexCount )
+      continue;
+
+    if ( state->settled[ vertex ] && state->cost[ vertex ] <= maximumCost )
+      result[ i ] = state->cost[ vertex ];
+    state->target[ vertex ] = 0;
+  }
+
+  state->reset();
+  mSearchStates->release( std::move( state ) );
+  return result;
+}
+
+QVector<QVector<double> > QgsGraphSearchEngine::costMatrix( const QVector<int> &originVertices, const QVector<int> &destinationVertices, double maximumCost, QgsFeedback *feedback ) const
+{
+  QVector< QVector< double > > result( originVertices.size() );
+  QVector< double > *rows = result.data();
+
+  std::vector< int > rowIndices( static_cast< std::size_t >( originVertices.size() ) );
+  std::iota( rowIndices.begin(), rowIndices.end(), 0 );
+
+  auto calculateRow = [this, rows, &originVertices, &destinationVertices, maximumCost, feedback]( int row )
+  {
+    if ( feedback && feedback->isCanceled() )
+      return;
+
+    rows[ row ] = costs( originVertices.at( row ), destinationVertices, maximumCost );
+  };
+  QtConcurrent::blockingMap( rowIndices, calculateRow );
+
+  return result;
+}
+
+void QgsGraphSearchEngine::search( SearchState &state, int startVertexIdx, double maximumCost, int targetCount ) const
+{
+  typedef std::pair< double, int > QueueEntry;
+  const std::greater< QueueEntry > compare;
+  const QgsGraphAdjacency &edges = *mEdges;
+
+  state.cost[ startVertexIdx ] = 0;
+  state.touched.push_back( startVertexIdx );
+  state.queue.push_back( QueueEntry( 0, startVertexIdx ) );
+
+  // when searching without targets, the vertices one edge beyond the maximum cost are settled
+  // too, so that their costs and inbound edges are exact
+  double frontierCost = -std::numeric_limits< double >::infinity();
+
+  while ( !state.queue.empty() )
+  {
+    std::pop_heap( state.queue.begin(), state.queue.end(), compare );
+    const QueueEntry entry = state.queue.back();
+    state.queue.pop_back();
+
+    const int vertex = entry.second;
+    if ( state.settled[ vertex ] || entry.first > state.cost[ vertex ] )
+      continue;
+
+    const bool withinMaximum = entry.first <= maximumCost;
+    if ( !withinMaximum && ( targetCount >= 0 || entry.first > frontierCost ) )
+      break;
+
+    state.settled[ vertex ] = 1;
+    if ( withinMaximum )
+      state.reached.push_back( vertex );
+
+    if ( targetCount > 0 && state.target[ vertex ] && --targetCount == 0 )
+      break;
+
+    for ( int i = edges.offsets[ vertex ]; i < edges.offsets[ vertex + 1 ]; ++i )
+    {
+      const int target = edges.targets[ i ];
+      const double cost = entry.first + edges.costs[ i ];
+      if ( cost < state.cost[ target ] )
+      {
+        if ( std::isinf( state.cost[ target ] ) )
+          state.touched.push_back( target );
+        state.cost[ target ] = cost;
+        state.inboundEdge[ target ] = edges.values[ i ];
+        state.queue.push_back( QueueEntry( cost, target ) );
+        std::push_heap( state.queue.begin(), state.queue.end(), compare );
+
+        if ( withinMaximum )
+          frontierCost = std::max( frontierCost, cost );
+      }
+    }
+  }
+}
@@ -0,0 +1,141 @@
+/***************************************************************************
+  qgsgraphsearchengine.h
+  --------------------------------------
+  Date                 : July 2020
+  Copyright            : (C) 2020 by the QGIS project
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSGRAPHSEARCHENGINE_H
+#define QGSGRAPHSEARCHENGINE_H
+
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "qgis_sip.h"
+#include "qgis_analysis.h"
+
+class QgsGraph;
+class QgsFeedback;
+#ifndef SIP_RUN
+struct QgsGraphAdjacency;
+template< typename State > class QgsSearchStatePool;
+#endif
+
+/**
+ * \ingroup analysis
+ * \class QgsGraphSearchEngine
+ * \brief Runs many Dijkstra searches on a single QgsGraph, optionally from several threads at once.
+ *
+ * The costs of one strategy of the graph are converted to doubles once, when the engine is
+ * constructed, and the state of each search is taken from a pool so that a search only touches
+ * the vertices it reaches. This makes bounded searches (e.g. for service areas) and cost
+ * matrices between many origins and destinations much cheaper than repeated calls to
+ * QgsGraphAnalyzer::dijkstra().
+ *
+ * All search methods are thread safe. The graph must outlive the engine and must not be modified
+ * while the engine is in use.
+ *
+ * \since QGIS 3.16
+ */
+class ANALYSIS_EXPORT QgsGraphSearchEngine
+{
+  public:
+
+    /**
+     * Constructor for QgsGraphSearchEngine, for searches on the costs calculated by the strategy
+     * with index \a criterionNum of the \a graph.
+     *
+     * If the \a graph is NULLPTR or any of its costs is negative or not a number, the engine is
+     * invalid and reports all vertices as unreachable.
+     *
+     * \see isValid()
+     */
+    QgsGraphSearchEngine( const QgsGraph *graph, int criterionNum );
+
+    ~QgsGraphSearchEngine();
+
+    //! QgsGraphSearchEngine cannot be copied
+    QgsGraphSearchEngine( const QgsGraphSearchEngine &other ) = delete;
+    //! QgsGraphSearchEngine cannot be copied
+    QgsGraphSearchEngine &operator=( const QgsGraphSearchEngine &other ) = delete;
+
+    /**
+     * Returns the graph searched by the engine.
+     */
+    const QgsGraph *graph() const { return mGraph; }
+
+    /**
+     * Returns TRUE if the engine can search the graph, i.e. a graph was set and all of its
+     * costs are valid, non negative numbers.
+     */
+    bool isValid() const;
+
+    /**
+     * Solves the shortest path problem from \a startVertexIdx, like QgsGraphAnalyzer::dijkstra(),
+     * but stops the search at \a maximumCost. A negative \a maximumCost does not limit the search.
+     *
+     * \a resultTree and \a resultCost are filled with one entry per graph vertex. Costs and
+     * inbound edges are exact for the vertices which can be reached within \a maximumCost,
+     * and for the vertices one edge beyond them. All other vertices are reported as unreachable,
+     * with an inbound edge of -1 and an infinite cost.
+     *
+     * If \a reachedVertices is set, it is filled with the vertices which can be reached within
+     * \a maximumCost, in order of increasing cost.
+     */
+    void dijkstra( int startVertexIdx, double maximumCost, QVector< int > *resultTree, QVector< double > *resultCost, QVector< int > *reachedVertices = nullptr ) const SIP_SKIP;
+
+    /**
+     * Returns the costs of the shortest paths from \a startVertexIdx to each of the \a targetVertices.
+     *
+     * The search stops as soon as all targets are reached, or at \a maximumCost unless it is negative.
+     * Targets which cannot be reached within \a maximumCost have an infinite cost.
+     */
+    QVector< double > costs( int startVertexIdx, const QVector< int > &targetVertices, double maximumCost = -1 ) const;
+
+    /**
+     * Returns a matrix of the costs of the shortest paths from each of the \a originVertices
+     * (rows) to each of the \a destinationVertices (columns).
+     *
+     * Rows are calculated in parallel on the global thread pool. Destinations which cannot be reached
+     * within \a maximumCost have an infinite cost. A negative \a maximumCost does not limit the searches.
+     *
+     * An optional \a feedback object can be set for cancellation support, in which case the rows
+     * which were not calculated are empty.
+     */
+    QVector< QVector< double > > costMatrix( const QVector< int > &originVertices, const QVector< int > &destinationVertices,
+        double maximumCost = -1, QgsFeedback *feedback = nullptr ) const;
+
+  private:
+
+#ifdef SIP_RUN
+    QgsGraphSearchEngine( const QgsGraphSearchEngine &other );
+#endif
+
+    struct SearchState;
+
+    /**
+     * Runs a search from \a startVertexIdx which settles vertices up to \a maximumCost. If \a targetCount
+     * is positive the search also stops once that many vertices flagged as targets in the \a state are
+     * settled, if it is negative the vertices one edge beyond \a maximumCost are settled too.
+     */
+    void search( SearchState &state, int startVertexIdx, double maximumCost, int targetCount ) const;
+
+    const QgsGraph *mGraph = nullptr;
+    int mVertexCount = 0;
+
+    //! Outgoing edges of each vertex, with the index of each edge in the graph, or NULLPTR if the engine is invalid
+    std::unique_ptr< QgsGraphAdjacency > mEdges;
+
+    //! Pool of search states, reused between searches
+    std::unique_ptr< QgsSearchStatePool< SearchState > > mSearchStates;
+};
+
+#endif // QGSGRAPHSEARCHENGINE_H
@@ -28,12 +28,21 @@
 #include "qgsgeometry.h"
 #include "qgsdistancearea.h"
 #include "qgswkbtypes.h"
+#include "qgscoordinatereferencesystem.h"
+#include "qgsvectorlayer.h"
 
+#include <QMutexLocker>
 #include <QString>
 #include <QtAlgorithms>
+#include <QtConcurrentMap>
 
 #include <spatialindex/SpatialIndex.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
 using namespace SpatialIndex;
 
 struct TiePointInfo
@@ -54,6 +63,229 @@ struct TiePointInfo
   QgsPointXY mLastPoint;
 };
 
+///@cond PRIVATE
+
+//! Limits the size of the segment grid for degenerate networks
+const double MAXIMUM_SEGMENT_GRID_CELLS_PER_AXIS = 16384;
+
+//! Segment of a network line, between two graph vertices
+struct NetworkSegment
+{
+  NetworkSegment( const QgsPointXY &start, const QgsPointXY &end, QgsFeatureId featureId )
+    : start( start )
+    , end( end )
+    , featureId( featureId )
+  {}
+
+  QgsPointXY start;
+  QgsPointXY end;
+  QgsFeatureId featureId = -1;
+};
+
+/**
+ * Uniform grid over the network segments, for finding the closest segment to a point.
+ *
+ * Segments are split in chunks no longer than a cell before being added to the cells overlapping
+ * their bounding box, so long segments only occupy the cells along them. Searches are read only
+ * and may run concurrently.
+ */
+class NetworkSegmentIndex
+{
+  public:
+
+    explicit NetworkSegmentIndex( const std::vector< NetworkSegment > &segments )
+      : mSegments( segments )
+    {
+      if ( segments.empty() )
+        return;
+
+      double xMax = std::numeric_limits< double >::lowest();
+      double yMax = std::numeric_limits< double >::lowest();
+      double totalLength = 0;
+      for ( const NetworkSegment &segment : segments )
+      {
+        mXMin = std::min( { mXMin, segment.start.x(), segment.end.x() } );
+        mYMin = std::min( { mYMin, segment.start.y(), segment.end.y() } );
+        xMax = std::max( { xMax, segment.start.x(), segment.end.x() } );
+        yMax = std::max( { yMax, segment.start.y(), segment.end.y() } );
+        totalLength += std::sqrt( segment.start.sqrDist( segment.end ) );
+      }
+
+      // about one segment per cell, but never cells shorter than the average segment
+      const double width = xMax - mXMin;
+      const double height = yMax - mYMin;
+      const double segmentCount = static_cast< double >( segments.size() );
+      mCellSize = std::max( std::sqrt( width * height / segmentCount ), totalLength / segmentCount );
+      if ( !( mCellSize > 0 ) )
+        mCellSize = std::max( { width, height, 1.0 } );
+      mColumns = static_cast< int >( std::min( width / mCellSize, MAXIMUM_SEGMENT_GRID_CELLS_PER_AXIS ) ) + 1;
+      mRows = static_cast< int >( std::min( height / mCellSize, MAXIMUM_SEGMENT_GRID_CELLS_PER_AXIS ) ) + 1;
+
+      // ( cell, segment ) pairs, in order of segment
+      std::vector< std::pair< int, int > > entries;
+      entries.reserve( segments.size() * 2 );
+      for ( std::size_t i = 0; i < segments.size(); ++i )
+      {
+        const NetworkSegment &segment = segments[i];
+        const double length = std::sqrt( segment.start.sqrDist( segment.end ) );
+        const int chunks = std::max( 1, static_cast< int >( std::ceil( std::min( length / mCellSize, static_cast< double >( mColumns + mRows ) ) ) ) );
+        for ( int chunk = 0; chunk < chunks; ++chunk )
+        {
+          const double t1 = static_cast< double >( chunk ) / chunks;
+          const double t2 = static_cast< double >( chunk + 1 ) / chunks;
+          const double x1 = segment.start.x() + ( segment.end.x() - segment.start.x() ) * t1;
+          const double y1 = segment.start.y() + ( segment.end.y() - segment.start.y() ) * t1;
+          const double x2 = segment.start.x() + ( segment.end.x() - segment.start.x() ) * t2;
+          const double y2 = segment.start.y() + ( segment.end.y() - segment.start.y() ) * t2;
+          for ( int row = cellRow( std::min( y1, y2 ) ); row <= cellRow( std::max( y1, y2 ) ); ++row )
+          {
+            for ( int column = cellColumn( std::min( x1, x2 ) ); column <= cellColumn( std::max( x1, x2 ) ); ++column )
+            {
+              entries.emplace_back( row * mColumns + column, static_cast< int >( i ) );
+            }
+          }
+        }
+      }
+
+      // counting sort by cell, keeping the segments of each cell in order and dropping duplicates
+      mCellOffsets.assign( static_cast< std::size_t >( mColumns ) * mRows + 1, 0 );
+      for ( const std::pair< int, int > &entry : entries )
+        mCellOffsets[ entry.first + 1 ]++;
+      std::partial_sum( mCellOffsets.begin(), mCellOffsets.end(), mCellOffsets.begin() );
+      std::vector< int > cellSegments( entries.size() );
+      std::vector< int > position( mCellOffsets.begin(), mCellOffsets.end() - 1 );
+      for ( const std::pair< int, int > &entry : entries )
+        cellSegments[ position[ entry.first ]++ ] = entry.second;
+
+      mCellSegments.reserve( cellSegments.size() );
+      std::vector< int > offsets( mCellOffsets.size(), 0 );
+      for ( std::size_t cell = 0; cell + 1 < mCellOffsets.size(); ++cell )
+      {
+        for ( int i = mCellOffsets[ cell ]; i < mCellOffsets[ cell + 1 ]; ++i )
+        {
+          if ( i == mCellOffsets[ cell ] || cellSegments[ i ] != cellSegments[ i - 1 ] )
+            mCellSegments.push_back( cellSegments[ i ] );
+        }
+        offsets[ cell + 1 ] = static_cast< int >( mCellSegments.size() );
+      }
+      mCellOffsets = std::move( offsets );
+    }
+
+    /**
+     * Returns the index of the segment closest to \a point, or -1 if there are no segments.
+     * Of several equally close segments the first one is returned.
+     *
+     * \a sqrDist is set to the squared distance to the segment, and \a snappedPoint to the closest
+     * point on the segment.
+     */
+    int closestSegment( const QgsPointXY &point, double &sqrDist, QgsPointXY &snappedPoint ) const
+    {
+      int closest = -1;
+      sqrDist = std::numeric_limits< double >::max();
+      if ( mSegments.empty() )
+        return closest;
+
+      auto testCell = [&]( int row, int column )
+      {
+        if ( row < 0 || row >= mRows || column < 0 || column >= mColumns )
+          return;
+
+        const int cell = row * mColumns + column;
+        for ( int i = mCellOffsets[ cell ]; i < mCellOffsets[ cell + 1 ]; ++i )
+        {
+          const int segmentIndex = mCellSegments[ i ];
+          const NetworkSegment &segment = mSegments[ static_cast< std::size_t >( segmentIndex ) ];
+          QgsPointXY segmentPoint;
+          double segmentDist = std::numeric_limits< double >::max();
+          if ( segment.start == segment.end )
+          {
+            segmentDist = point.sqrDist( segment.start );
+            segmentPoint = segment.start;
+          }
+          else
+          {
+            segmentDist = point.sqrDistToSegment( segment.start.x(), segment.start.y(), segment.end.x(), segment.end.y(), segmentPoint, 0 );
+          }
+
+          if ( segmentDist < sqrDist || ( segmentDist == sqrDist && segmentIndex < closest ) )
+          {
+            closest = segmentIndex;
+            sqrDist = segmentDist;
+            snappedPoint = segmentPoint;
+          }
+        }
+      };
+
+      const int centerRow = cellRow( point.y() );
+      const int centerColumn = cellColumn( point.x() );
+      const int maximumRing = std::max( mRows, mColumns );
+      for ( int ring = 0; ring <= maximumRing; ++ring )
+      {
+        if ( ring == 0 )
+        {
+          testCell( centerRow, centerColumn );
+        }
+        else
+        {
+          for ( int column = centerColumn - ring; column <= centerColumn + ring; ++column )
+          {
+            testCell( centerRow - ring, column );
+            testCell( centerRow + ring, column );
+          }
+          for ( int row = centerRow - ring + 1; row <= centerRow + ring - 1; ++row )
+          {
+            testCell( row, centerColumn - ring );
+            testCell( row, centerColumn + ring );
+          }
+        }
+
+        // cells of the next ring are at least ring cells away from the point
+        const double ringDistance = ring * mCellSize;
+        if ( closest >= 0 && sqrDist < ringDistance * ringDistance )
+          break;
+      }
+      return closest;
+    }
+
+  private:
+
+    int cellColumn( double x ) const
+    {
+      return static_cast< int >( std::max( 0.0, std::min( std::floor( ( x - mXMin ) / mCellSize ), static_cast< double >( mColumns - 1 ) ) ) );
+    }
+
+    int cellRow( double y ) const
+    {
+      return static_cast< int >( std::max( 0.0, std::min( std::floor( ( y - mYMin ) / mCellSize ), static_cast< double >( mRows - 1 ) ) ) );
+    }
+
+    const std::vector< NetworkSegment > &mSegments;
+    double mXMin = std::numeric_limits< double >::max();
+    double mYMin = std::numeric_limits< double >::max();
+    double mCellSize = 1;
+    int mColumns = 0;
+    int mRows = 0;
+    std::vector< int > mCellOffsets;
+    std::vector< int > mCellSegments;
+};
+
+///@endcond
+
+//! Network vertices and segments read from the source, which may be cached between calls to makeGraph()
+struct QgsVectorLayerDirector::NetworkTopology
+{
+  QgsCoordinateReferenceSystem destinationCrs;
+  double tolerance = 0;
+  long featureCount = -1;
+  //! Cache generation when the source was read
+  int generation = 0;
+
+  //! All vertices in graph, with vertices within builder's tolerance collapsed together
+  QVector< QgsPointXY > graphVertices;
+  //! All network segments, in order of iteration over the source
+  std::vector< NetworkSegment > segments;
+};
+
 QgsVectorLayerDirector::QgsVectorLayerDirector( QgsFeatureSource *source,
     int directionFieldId,
     const QString &directDirectionValue,
@@ -67,8 +299,19 @@ QgsVectorLayerDirector::QgsVectorLayerDirector( QgsFeatureSource *source,
   , mBothDirectionValue( bothDirectionValue )
   , mDefaultDirection( defaultDirection )
 {
+  // the features of layers change without changing their feature count when they are edited or reloaded
+  if ( QgsVectorLayer *layer = dynamic_cast< QgsVectorLayer * >( source ) )
+  {
+    connect( layer, &QgsVectorLayer::dataChanged, this, &QgsVectorLayerDirector::clearCache );
+    connect( layer, &QgsVectorLayer::layerModified, this, &QgsVectorLayerDirector::clearCache );
+    connect( layer, &QgsVectorLayer::afterRollBack, this, &QgsVectorLayerDirector::clearCache );
+    connect( layer, &QgsVectorLayer::subsetStringChanged, this, &QgsVectorLayerDirector::clearCache );
+    connect( layer, &QgsMapLayer::crsChanged, this, &QgsVectorLayerDirector::clearCache );
+  }
 }
 
+QgsVectorLayerDirector::~QgsVectorLayerDirector() = default;
+
 QString QgsVectorLayerDirector::name() const
 {
   return QStringLiteral( "Vector line" );
@@ -88,6 +331,28 @@ QgsAttributeList QgsVectorLayerDirector::requiredAttributes() const
   return qgis::setToList( attrs );
 }
 
+void QgsVectorLayerDirector::setCacheEnabled( bool enabled )
+{
+  QMutexLocker locker( &mCacheMutex );
+  mCacheEnabled = enabled;
+  if ( !enabled )
+    mCachedTopology.reset();
+}
+
+bool QgsVectorLayerDirector::isCacheEnabled() const
+{
+  QMutexLocker locker( &mCacheMutex );
+  return mCacheEnabled;
+}
+
+void QgsVectorLayerDirector::clearCache()
+{
+  QMutexLocker locker( &mCacheMutex );
+  mCachedTopology.reset();
+  // topologies read while the source changed are not cached
+  ++mCacheGeneration;
+}
+
 QgsVectorLayerDirector::Direction QgsVectorLayerDirector::directionForFeature( const QgsFeature &feature ) const
 {
   if ( mDirectionFieldId < 0 )
@@ -202,80 +467,125 @@ void QgsVectorLayerDirector::makeGraph( QgsGraphBuilderInterface *builder, const
     iRTree->insertData( 0, nullptr, SpatialIndex::Point( coords, 2 ), index );
   };
 
-  // first iteration - get all nodes from network, and snap additional points to network
-  QgsFeatureIterator fit = mSource->getFeatures( QgsFeatureRequest().setNoAttributes() );
-  QgsFeature feature;
-  while ( fit.nextFeature( feature ) )
-  {
-    if ( feedback && feedback->isCanceled() )
-      return;
+  const QgsCoordinateReferenceSystem destinationCrs = builder->coordinateTransformationEnabled() ? builder->destinationCrs() : QgsCoordinateReferenceSystem();
+  const long sourceFeatureCount = mSource->featureCount();
 
-    QgsMultiPolylineXY mpl;
-    if ( QgsWkbTypes::flatType( feature.geometry().wkbType() ) == QgsWkbTypes::MultiLineString )
-      mpl = feature.geometry().asMultiPolyline();
-    else if ( QgsWkbTypes::flatType( feature.geometry().wkbType() ) == QgsWkbTypes::LineString )
-      mpl.push_back( feature.geometry().asPolyline() );
+  // the cached topology is shared, so that concurrent calls can use it while it is replaced
+  std::shared_ptr< const NetworkTopology > topology;
+  bool cacheEnabled = false;
+  int cacheGeneration = 0;
+  {
+    QMutexLocker locker( &mCacheMutex );
+    cacheEnabled = mCacheEnabled;
+    cacheGeneration = mCacheGeneration;
+    if ( mCacheEnabled && mCachedTopology
+         && mCachedTopology->destinationCrs == destinationCrs
+         && qgsDoubleNear( mCachedTopology->tolerance, tolerance )
+         && mCachedTopology->featureCount == sourceFeatureCount )
+      topology = mCachedTopology;
+  }
 
-    for ( const QgsPolylineXY &line : qgis::as_const( mpl ) )
+  if ( topology )
+  {
+    // network was already read by a previous call, rebuild the vertex index from the cached vertices
+    graphVertices = topology->graphVertices;
+    for ( int i = 0; i < graphVertices.count(); ++i )
+      addPointToIndex( graphVertices.at( i ), i );
+    step = sourceFeatureCount;
+  }
+  else
+  {
+    std::shared_ptr< NetworkTopology > readTopology = std::make_shared< NetworkTopology >();
+    readTopology->destinationCrs = destinationCrs;
+    readTopology->tolerance = tolerance;
+    readTopology->featureCount = sourceFeatureCount;
+    readTopology->generation = cacheGeneration;
+
+    // first iteration - get all nodes and segments from network
+    QgsFeatureIterator fit = mSource->getFeatures( QgsFeatureRequest().setNoAttributes() );
+    QgsFeature feature;
+    while ( fit.nextFeature( feature ) )
     {
-      QgsPointXY pt1, pt2;
-      bool isFirstPoint = true;
-      for ( const QgsPointXY &point : line )
-      {
-        pt2 = ct.transform( point );
+      if ( feedback && feedback->isCanceled() )
+        return;
 
-        int pt2Idx = findPointWithinTolerance( pt2 ) ;
-        if ( pt2Idx == -1 )
-        {
-          // no vertex already exists within tolerance - add to points, and index
-          addPointToIndex( pt2, graphVertices.count() );
-          graphVertices.push_back( pt2 );
-        }
-        else
-        {
-          // vertex already exists within tolerance - use that
-          pt2 = graphVertices.at( pt2Idx );
-        }
+      QgsMultiPolylineXY mpl;
+      if ( QgsWkbTypes::flatType( feature.geometry().wkbType() ) == QgsWkbTypes::MultiLineString )
+        mpl = feature.geometry().asMultiPolyline();
+      else if ( QgsWkbTypes::flatType( feature.geometry().wkbType() ) == QgsWkbTypes::LineString )
+        mpl.push_back( feature.geometry().asPolyline() );
 
-        if ( !isFirstPoint )
+      for ( const QgsPolylineXY &line : qgis::as_const( mpl ) )
+      {
+        QgsPointXY pt1, pt2;
+        bool isFirstPoint = true;
+        for ( const QgsPointXY &point : line )
         {
-          // check if this line segment is a candidate for being closest to each additional point
-          int i = 0;
-          for ( const QgsPointXY &additionalPoint : additionalPoints )
-          {
+          pt2 = ct.transform( point );
 
-            QgsPointXY snappedPoint;
-            double thisSegmentClosestDist = std::numeric_limits<double>::max();
-            if ( pt1 == pt2 )
-            {
-              thisSegmentClosestDist = additionalPoint.sqrDist( pt1 );
-              snappedPoint = pt1;
-            }
-            else
-            {
-              thisSegmentClosestDist = additionalPoint.sqrDistToSegment( pt1.x(), pt1.y(),
-                                       pt2.x(), pt2.y(), snappedPoint, 0 );
-            }
+          int pt2Idx = findPointWithinTolerance( pt2 ) ;
+          if ( pt2Idx == -1 )
+          {
+            // no vertex already exists within tolerance - add to points, and index
+            addPointToIndex( pt2, graphVertices.count() );
+            graphVertices.push_back( pt2 );
+          }
+          else
+          {
+            // vertex already exists within tolerance - use that
+            pt2 = graphVertices.at( pt2Idx );
+          }
 
-            if ( thisSegmentClosestDist < additionalTiePoints[ i ].mLength )
-            {
-              // found a closer segment for this additional point
-              TiePointInfo info( i, feature.id(), pt1, pt2 );
-              info.mLength = thisSegmentClosestDist;
-              info.mTiedPoint = snappedPoint;
+          if ( !isFirstPoint )
+            readTopology->segments.emplace_back( pt1, pt2, feature.id() );
 
-              additionalTiePoints[ i ] = info;
-              snappedPoints[ i ] = info.mTiedPoint;
-            }
-            i++;
-          }
+          pt1 = pt2;
+          isFirstPoint = false;
         }
-        pt1 = pt2;
-        isFirstPoint = false;
       }
+      if ( feedback )
+        feedback->setProgress( 100.0 * static_cast< double >( ++step ) / featureCount );
+    }
+    readTopology->graphVertices = graphVertices;
+    topology = readTopology;
+
+    if ( cacheEnabled )
+    {
+      QMutexLocker locker( &mCacheMutex );
+      // don't cache a topology read while the source was changed
+      if ( mCacheEnabled && mCacheGeneration == topology->generation )
+        mCachedTopology = topology;
     }
-    if ( feedback )
-      feedback->setProgress( 100.0 * static_cast< double >( ++step ) / featureCount );
+  }
+
+  // snap additional points to the closest network segment, using a grid index over the segments
+  // instead of testing every segment against every point
+  if ( !additionalPoints.isEmpty() )
+  {
+    const NetworkSegmentIndex segmentIndex( topology->segments );
+    const std::vector< NetworkSegment > &segments = topology->segments;
+    TiePointInfo *tiePoints = additionalTiePoints.data();
+    QgsPointXY *snapped = snappedPoints.data();
+
+    std::vector< int > pointIndices( static_cast< std::size_t >( additionalPoints.size() ) );
+    std::iota( pointIndices.begin(), pointIndices.end(), 0 );
+    auto snapPoint = [&segmentIndex, &segments, &additionalPoints, tiePoints, snapped]( int i )
+    {
+      double sqrDist = std::numeric_limits< double >::max();
+      QgsPointXY snappedPoint;
+      const int segmentIdx = segmentIndex.closestSegment( additionalPoints.at( i ), sqrDist, snappedPoint );
+      if ( segmentIdx < 0 )
+        return;
+
+      const NetworkSegment &segment = segments[ static_cast< std::size_t >( segmentIdx ) ];
+      TiePointInfo info( i, segment.featureId, segment.start, segment.end );
+      info.mLength = sqrDist;
+      info.mTiedPoint = snappedPoint;
+
+      tiePoints[ i ] = info;
+      snapped[ i ] = info.mTiedPoint;
+    };
+    QtConcurrent::blockingMap( pointIndices, snapPoint );
   }
 
   // build a hash of feature ids to tie points which depend on this feature
@@ -324,7 +634,8 @@ void QgsVectorLayerDirector::makeGraph( QgsGraphBuilderInterface *builder, const
     }
   }
 
-  fit = mSource->getFeatures( QgsFeatureRequest().setSubsetOfAttributes( requiredAttributes() ) );
+  QgsFeatureIterator fit = mSource->getFeatures( QgsFeatureRequest().setSubsetOfAttributes( requiredAttributes() ) );
+  QgsFeature feature;
   while ( fit.nextFeature( feature ) )
   {
     if ( feedback && feedback->isCanceled() )
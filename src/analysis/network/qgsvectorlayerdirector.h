@@ -21,6 +21,9 @@
 #include "qgsgraphdirector.h"
 #include "qgis_analysis.h"
 
+#include <QMutex>
+#include <memory>
+
 class QgsGraphBuilderInterface;
 class QgsFeatureSource;
 
@@ -76,9 +79,51 @@ class ANALYSIS_EXPORT QgsVectorLayerDirector : public QgsGraphDirector
                     QVector< QgsPointXY> &snappedPoints SIP_OUT,
                     QgsFeedback *feedback = nullptr ) const override;
 
+    ~QgsVectorLayerDirector() override;
+
     QString name() const override;
 
+    /**
+     * Sets whether the network topology read by makeGraph() is cached and reused by later calls.
+     *
+     * Reading the network topology (all network vertices, merged within the builder's topology tolerance,
+     * and the network segments additional points are snapped to) is the most expensive part of building a
+     * graph. When caching is enabled, later calls to makeGraph() with a builder using the same destination
+     * CRS and topology tolerance skip this step, which makes it cheap to build graphs for many sets of
+     * additional points on the same network.
+     *
+     * If the source is a QgsVectorLayer, the cache is cleared whenever the layer data is changed, edited,
+     * reloaded or filtered. Other sources do not report changes, so the cache is only invalidated when
+     * their feature count changes and clearCache() must be called whenever their features are modified.
+     *
+     * Caching is disabled by default.
+     *
+     * \see isCacheEnabled()
+     * \see clearCache()
+     * \since QGIS 3.16
+     */
+    void setCacheEnabled( bool enabled );
+
+    /**
+     * Returns TRUE if the network topology read by makeGraph() is cached and reused by later calls.
+     *
+     * \see setCacheEnabled()
+     * \since QGIS 3.16
+     */
+    bool isCacheEnabled() const;
+
+    /**
+     * Clears the cached network topology.
+     *
+     * \see setCacheEnabled()
+     * \since QGIS 3.16
+     */
+    void clearCache();
+
   private:
+
+    struct NetworkTopology;
+
     QgsFeatureSource *mSource = nullptr;
     int mDirectionFieldId = -1;
     QString mDirectDirectionValue;
@@ -86,6 +131,13 @@ class ANALYSIS_EXPORT QgsVectorLayerDirector : public QgsGraphDirector
     QString mBothDirectionValue;
     Direction mDefaultDirection = DirectionBoth;
 
+    //! Guards the cache settings and the cached topology, which are updated by makeGraph()
+    mutable QMutex mCacheMutex;
+    bool mCacheEnabled = false;
+    //! Incremented each time the cache is cleared
+    int mCacheGeneration = 0;
+    mutable std::shared_ptr< const NetworkTopology > mCachedTopology;
+
     QgsAttributeList requiredAttributes() const;
     Direction directionForFeature( const QgsFeature &feature ) const;
 };
@@ -135,7 +135,8 @@ void QgsNetworkAnalysisAlgorithmBase::loadCommonParams( const QVariantMap &param
   mBuilder = qgis::make_unique< QgsGraphBuilder >( mNetwork->sourceCrs(), true, tolerance );
 }
 
-void QgsNetworkAnalysisAlgorithmBase::loadPoints( QgsFeatureSource *source, QVector< QgsPointXY > &points, QHash< int, QgsAttributes > &attributes, QgsProcessingContext &context, QgsProcessingFeedback *feedback )
+void QgsNetworkAnalysisAlgorithmBase::loadPoints( QgsFeatureSource *source, QVector< QgsPointXY > &points, QHash< int, QgsAttributes > &attributes, QgsProcessingContext &context, QgsProcessingFeedback *feedback,
+    QVector< QgsFeatureId > *featureIds )
 {
   feedback->pushInfo( QObject::tr( "Loading points…" ) );
 
@@ -163,6 +164,8 @@ void QgsNetworkAnalysisAlgorithmBase::loadPoints( QgsFeatureSource *source, QVec
     {
       points.push_back( QgsPointXY( *it ) );
       attributes.insert( pointId, feat.attributes() );
+      if ( featureIds )
+        featureIds->push_back( feat.id() );
       it++;
       pointId++;
     }
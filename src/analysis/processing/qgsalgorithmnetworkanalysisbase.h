@@ -57,8 +57,11 @@ class QgsNetworkAnalysisAlgorithmBase : public QgsProcessingAlgorithm
 
     /**
      * Loads point from the feature source for further processing.
+     *
+     * If \a featureIds is set, the id of the source feature of each point is appended to it.
      */
-    void loadPoints( QgsFeatureSource *source, QVector< QgsPointXY > &points, QHash< int, QgsAttributes > &attributes, QgsProcessingContext &context, QgsProcessingFeedback *feedback );
+    void loadPoints( QgsFeatureSource *source, QVector< QgsPointXY > &points, QHash< int, QgsAttributes > &attributes, QgsProcessingContext &context, QgsProcessingFeedback *feedback,
+                     QVector< QgsFeatureId > *featureIds = nullptr );
 
     std::unique_ptr< QgsFeatureSource > mNetwork;
     QgsVectorLayerDirector *mDirector = nullptr;
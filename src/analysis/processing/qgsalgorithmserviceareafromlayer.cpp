@@ -18,7 +18,12 @@
 #include "qgsalgorithmserviceareafromlayer.h"
 
 #include "qgsgeometryutils.h"
-#include "qgsgraphanalyzer.h"
+#include "qgsgraphsearchengine.h"
+
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <numeric>
 
 ///@cond PRIVATE
 
@@ -109,7 +114,7 @@ QVariantMap QgsServiceAreaFromLayerAlgorithm::processAlgorithm( const QVariantMa
   mDirector->makeGraph( mBuilder.get(), points, snappedPoints, feedback );
 
   feedback->pushInfo( QObject::tr( "Calculating service areas…" ) );
-  QgsGraph *graph = mBuilder->graph();
+  std::unique_ptr< QgsGraph > graph( mBuilder->graph() );
 
   QgsFields fields = startPoints->fields();
   fields.append( QgsField( QStringLiteral( "type" ), QVariant::String ) );
@@ -123,63 +128,50 @@ QVariantMap QgsServiceAreaFromLayerAlgorithm::processAlgorithm( const QVariantMa
   std::unique_ptr< QgsFeatureSink > linesSink( parameterAsSink( parameters, QStringLiteral( "OUTPUT_LINES" ), context, linesSinkId, fields,
       QgsWkbTypes::MultiLineString, mNetwork->sourceCrs() ) );
 
-  int idxStart;
-  QString origPoint;
-  QVector< int > tree;
-  QVector< double > costs;
-
-  int inboundEdgeIndex;
-  double startVertexCost, endVertexCost;
-  QgsPointXY startPoint, endPoint;
-  QgsGraphEdge edge;
+  // all searches share the graph, and stop at the travel cost
+  const QgsGraphSearchEngine engine( graph.get(), 0 );
+  if ( !engine.isValid() )
+    throw QgsProcessingException( QObject::tr( "The network contains negative or invalid costs." ) );
+  const bool createPoints = static_cast< bool >( pointsSink );
+  const bool createLines = static_cast< bool >( linesSink );
 
-  QgsFeature feat;
-  QgsAttributes attributes;
-
-  int step =  snappedPoints.size() > 0 ? 100.0 / snappedPoints.size() : 1;
-  for ( int i = 0; i < snappedPoints.size(); i++ )
+  struct ServiceArea
   {
-    if ( feedback->isCanceled() )
-    {
-      break;
-    }
+    QgsFeatureList points;
+    QgsFeatureList lines;
+  };
 
-    idxStart = graph->findVertex( snappedPoints.at( i ) );
-    origPoint = points.at( i ).toString();
+  auto calculateServiceArea = [&]( int i ) -> ServiceArea
+  {
+    ServiceArea result;
+    const int idxStart = graph->findVertex( snappedPoints.at( i ) );
+    const QString origPoint = points.at( i ).toString();
 
-    QgsGraphAnalyzer::dijkstra( graph, idxStart, 0, &tree, &costs );
+    QVector< int > tree;
+    QVector< double > costs;
+    QVector< int > reached;
+    engine.dijkstra( idxStart, travelCost, &tree, &costs, &reached );
+    // visit the vertices in index order, to keep the same order of parts between algorithm runs
+    std::sort( reached.begin(), reached.end() );
 
     QgsMultiPointXY areaPoints;
     QgsMultiPolylineXY lines;
     QSet< int > vertices;
+    QVector< int > beyondVertices;
 
-    for ( int j = 0; j < costs.size(); j++ )
+    for ( int j : qgis::as_const( reached ) )
     {
-      inboundEdgeIndex = tree.at( j );
-
-      if ( inboundEdgeIndex == -1 && j != idxStart )
-      {
-        // unreachable vertex
-        continue;
-      }
-
-      startVertexCost = costs.at( j );
-      if ( startVertexCost > travelCost )
-      {
-        // vertex is too expensive, discard
-        continue;
-      }
-
+      const double startVertexCost = costs.at( j );
       vertices.insert( j );
-      startPoint = graph->vertex( j ).point();
+      const QgsPointXY startPoint = graph->vertex( j ).point();
 
       // find all edges coming from this vertex
       const QList< int > outgoingEdges = graph->vertex( j ).outgoingEdges() ;
       for ( int edgeId : outgoingEdges )
       {
-        edge = graph->edge( edgeId );
-        endVertexCost = startVertexCost + edge.cost( 0 ).toDouble();
-        endPoint = graph->vertex( edge.toVertex() ).point();
+        const QgsGraphEdge &edge = graph->edge( edgeId );
+        const double endVertexCost = startVertexCost + edge.cost( 0 ).toDouble();
+        const QgsPointXY endPoint = graph->vertex( edge.toVertex() ).point();
         if ( endVertexCost <= travelCost )
         {
           // end vertex is cheap enough to include
@@ -194,81 +186,109 @@ QVariantMap QgsServiceAreaFromLayerAlgorithm::processAlgorithm( const QVariantMa
 
           areaPoints.push_back( interpolatedEndPoint );
           lines.push_back( QgsPolylineXY() << startPoint << interpolatedEndPoint );
+          beyondVertices.push_back( edge.toVertex() );
         }
       } // edges
-    } // costs
+    } // reached vertices
 
-    // convert to list and sort to maintain same order of points between algorithm runs
-    QList< int > verticesList = qgis::setToList( vertices );
-    areaPoints.reserve( verticesList.size() );
-    std::sort( verticesList.begin(), verticesList.end() );
-    for ( int v : verticesList )
+    if ( createPoints )
     {
-      areaPoints.push_back( graph->vertex( v ).point() );
-    }
+      // convert to list and sort to maintain same order of points between algorithm runs
+      QList< int > verticesList = qgis::setToList( vertices );
+      areaPoints.reserve( verticesList.size() );
+      std::sort( verticesList.begin(), verticesList.end() );
+      for ( int v : verticesList )
+      {
+        areaPoints.push_back( graph->vertex( v ).point() );
+      }
 
-    if ( pointsSink )
-    {
-      QgsGeometry geomPoints = QgsGeometry::fromMultiPointXY( areaPoints );
-      feat.setGeometry( geomPoints );
-      attributes = sourceAttributes.value( i + 1 );
+      QgsFeature feat;
+      feat.setGeometry( QgsGeometry::fromMultiPointXY( areaPoints ) );
+      QgsAttributes attributes = sourceAttributes.value( i + 1 );
       attributes << QStringLiteral( "within" ) << origPoint;
       feat.setAttributes( attributes );
-      pointsSink->addFeature( feat, QgsFeatureSink::FastInsert );
+      result.points << feat;
 
       if ( includeBounds )
       {
         QgsMultiPointXY upperBoundary, lowerBoundary;
-        QVector< int > nodes;
-        nodes.reserve( costs.size() );
 
-        int vertexId;
-        for ( int v = 0; v < costs.size(); v++ )
+        // only vertices one edge beyond the reached vertices can be boundary nodes
+        std::sort( beyondVertices.begin(), beyondVertices.end() );
+        beyondVertices.erase( std::unique( beyondVertices.begin(), beyondVertices.end() ), beyondVertices.end() );
+        for ( int v : qgis::as_const( beyondVertices ) )
         {
           if ( costs.at( v ) > travelCost && tree.at( v ) != -1 )
           {
-            vertexId = graph->edge( tree.at( v ) ).fromVertex();
-            if ( costs.at( vertexId ) <= travelCost )
+            const QgsGraphEdge &inboundEdge = graph->edge( tree.at( v ) );
+            if ( costs.at( inboundEdge.fromVertex() ) <= travelCost )
             {
-              nodes.push_back( v );
+              upperBoundary.push_back( graph->vertex( inboundEdge.toVertex() ).point() );
+              lowerBoundary.push_back( graph->vertex( inboundEdge.fromVertex() ).point() );
             }
           }
-        } // costs
-
-        for ( int n : qgis::as_const( nodes ) )
-        {
-          upperBoundary.push_back( graph->vertex( graph->edge( tree.at( n ) ).toVertex() ).point() );
-          lowerBoundary.push_back( graph->vertex( graph->edge( tree.at( n ) ).fromVertex() ).point() );
-        } // nodes
-
-        QgsGeometry geomUpper = QgsGeometry::fromMultiPointXY( upperBoundary );
-        QgsGeometry geomLower = QgsGeometry::fromMultiPointXY( lowerBoundary );
+        }
 
-        feat.setGeometry( geomUpper );
+        feat.setGeometry( QgsGeometry::fromMultiPointXY( upperBoundary ) );
         attributes = sourceAttributes.value( i + 1 );
         attributes << QStringLiteral( "upper" ) << origPoint;
         feat.setAttributes( attributes );
-        pointsSink->addFeature( feat, QgsFeatureSink::FastInsert );
+        result.points << feat;
 
-        feat.setGeometry( geomLower );
+        feat.setGeometry( QgsGeometry::fromMultiPointXY( lowerBoundary ) );
         attributes = sourceAttributes.value( i + 1 );
         attributes << QStringLiteral( "lower" ) << origPoint;
         feat.setAttributes( attributes );
-        pointsSink->addFeature( feat, QgsFeatureSink::FastInsert );
+        result.points << feat;
       } // includeBounds
     }
 
-    if ( linesSink )
+    if ( createLines )
     {
-      QgsGeometry geomLines = QgsGeometry::fromMultiPolylineXY( lines );
-      feat.setGeometry( geomLines );
-      attributes = sourceAttributes.value( i + 1 );
+      QgsFeature feat;
+      feat.setGeometry( QgsGeometry::fromMultiPolylineXY( lines ) );
+      QgsAttributes attributes = sourceAttributes.value( i + 1 );
       attributes << QStringLiteral( "lines" ) << origPoint;
       feat.setAttributes( attributes );
-      linesSink->addFeature( feat, QgsFeatureSink::FastInsert );
+      result.lines << feat;
+    }
+    return result;
+  };
+
+  // service areas of a batch of start points are calculated in parallel, then written in order
+  const int batchSize = std::max( 1, QThreadPool::globalInstance()->maxThreadCount() ) * 16;
+  const double step = snappedPoints.size() > 0 ? 100.0 / snappedPoints.size() : 1;
+  for ( int batchStart = 0; batchStart < snappedPoints.size(); batchStart += batchSize )
+  {
+    if ( feedback->isCanceled() )
+    {
+      break;
+    }
+
+    const int batchEnd = std::min( batchStart + batchSize, snappedPoints.size() );
+    std::vector< int > batch( static_cast< std::size_t >( batchEnd - batchStart ) );
+    std::iota( batch.begin(), batch.end(), batchStart );
+    std::vector< ServiceArea > serviceAreas( batch.size() );
+    QtConcurrent::blockingMap( batch, [&serviceAreas, &calculateServiceArea, batchStart]( int i )
+    {
+      serviceAreas[ static_cast< std::size_t >( i - batchStart ) ] = calculateServiceArea( i );
+    } );
+
+    for ( const ServiceArea &serviceArea : serviceAreas )
+    {
+      if ( pointsSink )
+      {
+        QgsFeatureList features = serviceArea.points;
+        pointsSink->addFeatures( features, QgsFeatureSink::FastInsert );
+      }
+      if ( linesSink )
+      {
+        QgsFeatureList features = serviceArea.lines;
+        linesSink->addFeatures( features, QgsFeatureSink::FastInsert );
+      }
     }
 
-    feedback->setProgress( i * step );
+    feedback->setProgress( batchEnd * step );
   } // snappedPoints
 
   QVariantMap outputs;
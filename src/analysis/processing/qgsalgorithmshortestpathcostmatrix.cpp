@@ -0,0 +1,160 @@
+/***************************************************************************
+                         qgsalgorithmshortestpathcostmatrix.cpp
+                         ---------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsalgorithmshortestpathcostmatrix.h"
+
+#include "qgsgraphsearchengine.h"
+
+///@cond PRIVATE
+
+//! Number of origins whose costs are calculated in parallel before being written to the sink
+constexpr int ORIGIN_BATCH_SIZE = 256;
+
+QString QgsShortestPathCostMatrixAlgorithm::name() const
+{
+  return QStringLiteral( "shortestpathcostmatrix" );
+}
+
+QString QgsShortestPathCostMatrixAlgorithm::displayName() const
+{
+  return QObject::tr( "Shortest path cost matrix (layer to layer)" );
+}
+
+QStringList QgsShortestPathCostMatrixAlgorithm::tags() const
+{
+  return QObject::tr( "network,path,shortest,fastest,origin,destination,od,matrix,cost" ).split( ',' );
+}
+
+QString QgsShortestPathCostMatrixAlgorithm::shortHelpString() const
+{
+  return QObject::tr( "This algorithm computes the cost of the optimal (shortest or fastest) route from each point "
+                      "of an origin point layer to each point of a destination point layer.\n\n"
+                      "The result is a table with the feature ids of the origin and destination and the cost "
+                      "of the route between them. If a maximum cost is set, pairs which cannot be reached "
+                      "within that cost are skipped, which makes the calculation much faster for large layers. "
+                      "Pairs which cannot be reached at all are always skipped." );
+}
+
+QgsShortestPathCostMatrixAlgorithm *QgsShortestPathCostMatrixAlgorithm::createInstance() const
+{
+  return new QgsShortestPathCostMatrixAlgorithm();
+}
+
+void QgsShortestPathCostMatrixAlgorithm::initAlgorithm( const QVariantMap & )
+{
+  addCommonParams();
+  addParameter( new QgsProcessingParameterFeatureSource( QStringLiteral( "START_POINTS" ), QObject::tr( "Vector layer with origin points" ), QList< int >() << QgsProcessing::TypeVectorPoint ) );
+  addParameter( new QgsProcessingParameterFeatureSource( QStringLiteral( "END_POINTS" ), QObject::tr( "Vector layer with destination points" ), QList< int >() << QgsProcessing::TypeVectorPoint ) );
+  addParameter( new QgsProcessingParameterNumber( QStringLiteral( "MAX_COST" ), QObject::tr( "Maximum travel cost (distance for 'Shortest', time for 'Fastest')" ),
+                QgsProcessingParameterNumber::Double, QVariant(), true, 0 ) );
+
+  addParameter( new QgsProcessingParameterFeatureSink( QStringLiteral( "OUTPUT" ), QObject::tr( "Cost matrix" ), QgsProcessing::TypeVector ) );
+}
+
+QVariantMap QgsShortestPathCostMatrixAlgorithm::processAlgorithm( const QVariantMap &parameters, QgsProcessingContext &context, QgsProcessingFeedback *feedback )
+{
+  loadCommonParams( parameters, context, feedback );
+
+  std::unique_ptr< QgsFeatureSource > startPoints( parameterAsSource( parameters, QStringLiteral( "START_POINTS" ), context ) );
+  if ( !startPoints )
+    throw QgsProcessingException( invalidSourceError( parameters, QStringLiteral( "START_POINTS" ) ) );
+
+  std::unique_ptr< QgsFeatureSource > endPoints( parameterAsSource( parameters, QStringLiteral( "END_POINTS" ), context ) );
+  if ( !endPoints )
+    throw QgsProcessingException( invalidSourceError( parameters, QStringLiteral( "END_POINTS" ) ) );
+
+  double maximumCost = -1;
+  if ( parameters.value( QStringLiteral( "MAX_COST" ) ).isValid() )
+    maximumCost = parameterAsDouble( parameters, QStringLiteral( "MAX_COST" ), context ) * mMultiplier;
+
+  QgsFields fields;
+  fields.append( QgsField( QStringLiteral( "origin_id" ), QVariant::LongLong ) );
+  fields.append( QgsField( QStringLiteral( "destination_id" ), QVariant::LongLong ) );
+  fields.append( QgsField( QStringLiteral( "cost" ), QVariant::Double ) );
+
+  QString dest;
+  std::unique_ptr< QgsFeatureSink > sink( parameterAsSink( parameters, QStringLiteral( "OUTPUT" ), context, dest, fields, QgsWkbTypes::NoGeometry, QgsCoordinateReferenceSystem() ) );
+  if ( !sink )
+    throw QgsProcessingException( invalidSinkError( parameters, QStringLiteral( "OUTPUT" ) ) );
+
+  QVector< QgsPointXY > points;
+  QHash< int, QgsAttributes > sourceAttributes;
+  QVector< QgsFeatureId > originIds;
+  loadPoints( startPoints.get(), points, sourceAttributes, context, feedback, &originIds );
+  const int originCount = points.size();
+  QVector< QgsFeatureId > destinationIds;
+  loadPoints( endPoints.get(), points, sourceAttributes, context, feedback, &destinationIds );
+
+  feedback->pushInfo( QObject::tr( "Building graph…" ) );
+  QVector< QgsPointXY > snappedPoints;
+  mDirector->makeGraph( mBuilder.get(), points, snappedPoints, feedback );
+  std::unique_ptr< QgsGraph > graph( mBuilder->graph() );
+
+  QVector< int > originVertices;
+  originVertices.reserve( originCount );
+  QVector< int > destinationVertices;
+  destinationVertices.reserve( snappedPoints.size() - originCount );
+  for ( int i = 0; i < snappedPoints.size(); ++i )
+  {
+    const int vertex = graph->findVertex( snappedPoints.at( i ) );
+    if ( i < originCount )
+      originVertices << vertex;
+    else
+      destinationVertices << vertex;
+  }
+
+  feedback->pushInfo( QObject::tr( "Calculating cost matrix…" ) );
+  const QgsGraphSearchEngine engine( graph.get(), 0 );
+  if ( !engine.isValid() )
+    throw QgsProcessingException( QObject::tr( "The network contains negative or invalid costs." ) );
+
+  QgsFeature feat;
+  feat.setFields( fields );
+  const double step = originCount > 0 ? 100.0 / originCount : 1;
+  for ( int batchStart = 0; batchStart < originCount; batchStart += ORIGIN_BATCH_SIZE )
+  {
+    if ( feedback->isCanceled() )
+      break;
+
+    // rows of a batch are calculated in parallel, then written in order
+    const QVector< int > batchOrigins = originVertices.mid( batchStart, ORIGIN_BATCH_SIZE );
+    const QVector< QVector< double > > costs = engine.costMatrix( batchOrigins, destinationVertices, maximumCost, feedback );
+    if ( feedback->isCanceled() )
+      break;
+
+    for ( int row = 0; row < costs.size(); ++row )
+    {
+      const QVector< double > &rowCosts = costs.at( row );
+      for ( int column = 0; column < rowCosts.size(); ++column )
+      {
+        const double cost = rowCosts.at( column );
+        if ( std::isinf( cost ) )
+          continue;
+
+        feat.setAttributes( QgsAttributes() << originIds.at( batchStart + row ) << destinationIds.at( column ) << cost / mMultiplier );
+        sink->addFeature( feat, QgsFeatureSink::FastInsert );
+      }
+    }
+
+    feedback->setProgress( ( batchStart + batchOrigins.size() ) * step );
+  }
+
+  QVariantMap outputs;
+  outputs.insert( QStringLiteral( "OUTPUT" ), dest );
+  return outputs;
+}
+
+///@endcond
@@ -0,0 +1,52 @@
+/***************************************************************************
+                         qgsalgorithmshortestpathcostmatrix.h
+                         ---------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSALGORITHMSHORTESTPATHCOSTMATRIX_H
+#define QGSALGORITHMSHORTESTPATHCOSTMATRIX_H
+
+#define SIP_NO_FILE
+
+#include "qgis_sip.h"
+#include "qgsalgorithmnetworkanalysisbase.h"
+
+///@cond PRIVATE
+
+/**
+ * Native shortest path cost matrix (layer to layer) algorithm.
+ */
+class QgsShortestPathCostMatrixAlgorithm : public QgsNetworkAnalysisAlgorithmBase
+{
+
+  public:
+
+    QgsShortestPathCostMatrixAlgorithm() = default;
+    void initAlgorithm( const QVariantMap &configuration = QVariantMap() ) override;
+    QString name() const override;
+    QString displayName() const override;
+    QStringList tags() const override;
+    QString shortHelpString() const override;
+    QgsShortestPathCostMatrixAlgorithm *createInstance() const override SIP_FACTORY;
+
+  protected:
+
+    QVariantMap processAlgorithm( const QVariantMap &parameters,
+                                  QgsProcessingContext &context, QgsProcessingFeedback *feedback ) override;
+
+};
+
+///@endcond PRIVATE
+
+#endif // QGSALGORITHMSHORTESTPATHCOSTMATRIX_H
@@ -96,6 +96,11 @@ void QgsZonalStatisticsAlgorithm::initAlgorithm( const QVariantMap & )
   addParameter( new QgsProcessingParameterEnum( QStringLiteral( "STATISTICS" ), QObject::tr( "Statistics to calculate" ),
                 statChoices, true, QVariantList() << 0 << 1 << 2 ) );
 
+  std::unique_ptr< QgsProcessingParameterEnum > methodParam = qgis::make_unique< QgsProcessingParameterEnum >( QStringLiteral( "RASTERIZATION_METHOD" ), QObject::tr( "Zone rasterization method" ),
+      QStringList() << QObject::tr( "Test cell centers for each zone" ) << QObject::tr( "Scanline rasterization (faster for many zones)" ), false, 0 );
+  methodParam->setFlags( methodParam->flags() | QgsProcessingParameterDefinition::FlagAdvanced );
+  addParameter( methodParam.release() );
+
   addOutput( new QgsProcessingOutputVectorLayer( QStringLiteral( "INPUT_VECTOR" ), QObject::tr( "Zonal statistics" ), QgsProcessing::TypeVectorPolygon ) );
 }
 
@@ -124,6 +129,9 @@ bool QgsZonalStatisticsAlgorithm::prepareAlgorithm( const QVariantMap &parameter
     mStats |= STATS.at( s );
   }
 
+  mRasterizationMethod = parameterAsEnum( parameters, QStringLiteral( "RASTERIZATION_METHOD" ), context ) == 1
+                         ? QgsZonalStatistics::ScanlineRasterization : QgsZonalStatistics::CellCenterTest;
+
   return true;
 }
 
@@ -142,6 +150,7 @@ QVariantMap QgsZonalStatisticsAlgorithm::processAlgorithm( const QVariantMap &pa
                          mBand,
                          QgsZonalStatistics::Statistics( mStats )
                        );
+  zs.setRasterizationMethod( mRasterizationMethod );
 
   zs.calculateStatistics( feedback );
 
@@ -56,6 +56,7 @@ class QgsZonalStatisticsAlgorithm : public QgsProcessingAlgorithm
     int mBand;
     QString mPrefix;
     QgsZonalStatistics::Statistics mStats = QgsZonalStatistics::All;
+    QgsZonalStatistics::RasterizationMethod mRasterizationMethod = QgsZonalStatistics::CellCenterTest;
     QgsCoordinateReferenceSystem mCrs;
     double mPixelSizeX;
     double mPixelSizeY;
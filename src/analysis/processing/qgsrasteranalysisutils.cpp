@@ -20,6 +20,8 @@
 #include "qgsrasteriterator.h"
 #include "qgsgeos.h"
 #include "qgsprocessingparameters.h"
+#include "qgscurvepolygon.h"
+#include "qgslinestring.h"
 #include <map>
 #include <unordered_map>
 #include <unordered_set>
@@ -165,6 +167,145 @@ void QgsRasterAnalysisUtils::statisticsFromPreciseIntersection( QgsRasterInterfa
   }
 }
 
+QgsRasterAnalysisUtils::ScanlineRasterizer::ScanlineRasterizer( const QgsGeometry &poly )
+  : mGeometry( poly )
+{
+  if ( mGeometry.isNull() )
+    return;
+
+  if ( mGeometry.constGet()->hasCurvedSegments() )
+    mGeometry = QgsGeometry( mGeometry.constGet()->segmentize() );
+  const QgsAbstractGeometry *geom = mGeometry.constGet();
+
+  auto addRing = [this]( const QgsCurve * ring )
+  {
+    const QgsLineString *line = qgsgeometry_cast< const QgsLineString * >( ring );
+    if ( !line || line->numPoints() < 2 )
+      return;
+
+    const double *x = line->xData();
+    const double *y = line->yData();
+    const int nPoints = line->numPoints();
+    for ( int i = 1; i < nPoints; ++i )
+    {
+      Edge edge;
+      if ( y[i - 1] <= y[i] )
+      {
+        edge.yMin = y[i - 1];
+        edge.yMax = y[i];
+        edge.xAtYMin = x[i - 1];
+      }
+      else
+      {
+        edge.yMin = y[i];
+        edge.yMax = y[i - 1];
+        edge.xAtYMin = x[i];
+      }
+      edge.dxdy = edge.yMax > edge.yMin ? ( x[i] - x[i - 1] ) / ( y[i] - y[i - 1] ) : 0;
+      mEdges.emplace_back( edge );
+    }
+  };
+
+  for ( auto partIt = geom->const_parts_begin(); partIt != geom->const_parts_end(); ++partIt )
+  {
+    const QgsCurvePolygon *polygon = qgsgeometry_cast< const QgsCurvePolygon * >( *partIt );
+    if ( !polygon )
+      continue;
+
+    addRing( polygon->exteriorRing() );
+    for ( int i = 0; i < polygon->numInteriorRings(); ++i )
+      addRing( polygon->interiorRing( i ) );
+  }
+
+  std::sort( mEdges.begin(), mEdges.end(), []( const Edge & a, const Edge & b ) { return a.yMax > b.yMax; } );
+}
+
+void QgsRasterAnalysisUtils::ScanlineRasterizer::rasterize( double gridLeft, double gridTop, double cellSizeX, double cellSizeY, int rowStart, int rowEnd, int colStart, int colEnd, const std::function<void( int, int, int )> &addSpan ) const
+{
+  if ( mEdges.empty() || rowStart >= rowEnd || colStart >= colEnd )
+    return;
+
+  // only created if a row passes exactly through a vertex
+  std::unique_ptr< QgsGeometryEngine > polyEngine;
+
+  std::vector< const Edge * > active;
+  std::vector< double > crossings;
+  auto nextEdge = mEdges.cbegin();
+
+  for ( int row = rowStart; row < rowEnd; ++row )
+  {
+    const double cellCenterY = gridTop - ( row + 0.5 ) * cellSizeY;
+
+    // edges are sorted by descending yMax, so we can sweep down the rows adding edges as the scanline reaches them
+    while ( nextEdge != mEdges.cend() && nextEdge->yMax >= cellCenterY )
+    {
+      active.emplace_back( &( *nextEdge ) );
+      ++nextEdge;
+    }
+    active.erase( std::remove_if( active.begin(), active.end(), [cellCenterY]( const Edge * edge ) { return edge->yMin > cellCenterY; } ), active.end() );
+    if ( active.empty() )
+    {
+      if ( nextEdge == mEdges.cend() )
+        break;
+      continue;
+    }
+
+    crossings.clear();
+    bool throughVertex = false;
+    for ( const Edge *edge : active )
+    {
+      if ( edge->yMin == cellCenterY || edge->yMax == cellCenterY )
+      {
+        throughVertex = true;
+        break;
+      }
+      crossings.emplace_back( edge->xAtYMin + ( cellCenterY - edge->yMin ) * edge->dxdy );
+    }
+
+    if ( throughVertex )
+    {
+      // crossings are ambiguous when the scanline touches a vertex, so fall back to testing each cell center
+      if ( !polyEngine )
+      {
+        polyEngine.reset( QgsGeometry::createGeometryEngine( mGeometry.constGet() ) );
+        if ( !polyEngine )
+          return;
+        polyEngine->prepareGeometry();
+      }
+      int spanStart = -1;
+      for ( int col = colStart; col < colEnd; ++col )
+      {
+        QgsPoint cellCenter( gridLeft + ( col + 0.5 ) * cellSizeX, cellCenterY );
+        if ( polyEngine->contains( &cellCenter ) )
+        {
+          if ( spanStart < 0 )
+            spanStart = col;
+        }
+        else if ( spanStart >= 0 )
+        {
+          addSpan( row, spanStart, col - 1 );
+          spanStart = -1;
+        }
+      }
+      if ( spanStart >= 0 )
+        addSpan( row, spanStart, colEnd - 1 );
+      continue;
+    }
+
+    std::sort( crossings.begin(), crossings.end() );
+    for ( std::size_t i = 0; i + 1 < crossings.size(); i += 2 )
+    {
+      // cells with centers strictly between the two crossings are inside the polygon
+      const double firstCol = ( crossings[i] - gridLeft ) / cellSizeX - 0.5;
+      const double lastCol = ( crossings[i + 1] - gridLeft ) / cellSizeX - 0.5;
+      const int spanStart = std::max( static_cast< int >( std::floor( firstCol ) ) + 1, colStart );
+      const int spanEnd = std::min( static_cast< int >( std::ceil( lastCol ) ) - 1, colEnd - 1 );
+      if ( spanStart <= spanEnd )
+        addSpan( row, spanStart, spanEnd );
+    }
+  }
+}
+
 bool QgsRasterAnalysisUtils::validPixel( double value )
 {
   return !std::isnan( value );
@@ -18,6 +18,7 @@
 
 #include "qgis_analysis.h"
 #include "qgis.h"
+#include "qgsgeometry.h"
 
 #include <functional>
 #include <memory>
@@ -28,7 +29,6 @@
 ///@cond PRIVATE
 
 class QgsRasterInterface;
-class QgsGeometry;
 class QgsRectangle;
 class QgsProcessingParameterDefinition;
 class QgsRasterProjector;
@@ -54,6 +54,63 @@ namespace QgsRasterAnalysisUtils
   void statisticsFromPreciseIntersection( QgsRasterInterface *rasterInterface, int rasterBand, const QgsGeometry &poly, int nCellsX, int nCellsY,
                                           double cellSizeX, double cellSizeY, const QgsRectangle &rasterBBox, const std::function<void( double, double )> &addValue, bool skipNodata = true );
 
+  /**
+   * Rasterizes a polygon over a raster grid using a scanline algorithm.
+   *
+   * A cell is considered to be inside the polygon when its center is inside the polygon, matching
+   * the behavior of statisticsFromMiddlePointTest() but without a point in polygon test per cell. Rows
+   * where the cell centers pass exactly through a polygon vertex are resolved with exact point in polygon
+   * tests, so that cells centered on the polygon boundary are treated identically.
+   *
+   * The rasterizer is immutable after construction and can safely be used from multiple threads at once.
+   */
+  class ScanlineRasterizer
+  {
+    public:
+
+      /**
+       * Constructor for ScanlineRasterizer, for the specified (multi)polygon geometry.
+       */
+      explicit ScanlineRasterizer( const QgsGeometry &poly );
+
+      /**
+       * Returns the polygon geometry being rasterized.
+       */
+      const QgsGeometry &geometry() const { return mGeometry; }
+
+      /**
+       * Returns TRUE if the polygon has no edges to rasterize.
+       */
+      bool isEmpty() const { return mEdges.empty(); }
+
+      /**
+       * Calls \a addSpan for each run of cells inside the polygon, for rows \a rowStart (inclusive) to
+       * \a rowEnd (exclusive) and columns \a colStart (inclusive) to \a colEnd (exclusive) of the
+       * grid with top left corner at \a gridLeft, \a gridTop.
+       *
+       * The arguments passed to \a addSpan are the row, the first column and the last column (inclusive) of
+       * the span.
+       */
+      void rasterize( double gridLeft, double gridTop, double cellSizeX, double cellSizeY,
+                      int rowStart, int rowEnd, int colStart, int colEnd,
+                      const std::function<void( int, int, int )> &addSpan ) const;
+
+    private:
+
+      struct Edge
+      {
+        double yMin;
+        double yMax;
+        double xAtYMin;
+        double dxdy;
+      };
+
+      QgsGeometry mGeometry;
+
+      //! Polygon edges, sorted by descending yMax
+      std::vector< Edge > mEdges;
+  };
+
   //! Tests whether a pixel's value should be included in the result
   bool validPixel( double value );
 
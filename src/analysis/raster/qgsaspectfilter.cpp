@@ -17,6 +17,8 @@
 
 #include "qgsaspectfilter.h"
 #include <cmath>
+#include <typeinfo>
+#include <vector>
 
 QgsAspectFilter::QgsAspectFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
@@ -44,3 +46,34 @@ float QgsAspectFilter::processNineCellWindow(
   }
 }
 
+void QgsAspectFilter::processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width )
+{
+  if ( typeid( *this ) != typeid( QgsAspectFilter ) )
+  {
+    QgsNineCellFilter::processNineCellRow( scanLine1, scanLine2, scanLine3, resultLine, width );
+    return;
+  }
+
+  std::vector< float > derX( width );
+  std::vector< float > derY( width );
+  calcFirstDerivatives( scanLine1, scanLine2, scanLine3, width, derX.data(), derY.data() );
+
+  for ( int i = 0; i < width; ++i )
+  {
+    if ( derX[i] == mOutputNodataValue ||
+         derY[i] == mOutputNodataValue ||
+         ( derX[i] == 0.0 && derY[i] == 0.0 ) )
+    {
+      resultLine[i] = mOutputNodataValue;
+    }
+    else
+    {
+      resultLine[i] = 180.0 + std::atan2( derX[i], derY[i] ) * 180.0 / M_PI;
+    }
+  }
+}
+
+bool QgsAspectFilter::supportsParallelRows() const
+{
+  return typeid( *this ) == typeid( QgsAspectFilter );
+}
@@ -23,6 +23,43 @@ QgsDerivativeFilter::QgsDerivativeFilter( const QString &inputFile, const QStrin
 
 }
 
+void QgsDerivativeFilter::calcFirstDerivatives( float *scanLine1, float *scanLine2, float *scanLine3, int width, float *derX, float *derY )
+{
+  // first pass: the basic formula for every cell, without branches
+  const double cellSizeX = mCellSizeX;
+  const double cellSizeY = mCellSizeY;
+  const double zFactor = mZFactor;
+  for ( int i = 0; i < width; ++i )
+  {
+    double sumX = ( scanLine1[i + 2] - scanLine1[i] );
+    sumX += 2 * ( scanLine2[i + 2] - scanLine2[i] );
+    sumX += ( scanLine3[i + 2] - scanLine3[i] );
+    derX[i] = sumX / ( 8 * cellSizeX ) * zFactor;
+
+    double sumY = ( scanLine1[i] - scanLine3[i] );
+    sumY += 2 * ( scanLine1[i + 1] - scanLine3[i + 1] );
+    sumY += ( scanLine1[i + 2] - scanLine3[i + 2] );
+    derY[i] = sumY / ( 8 * cellSizeY ) * zFactor;
+  }
+
+  // second pass: windows with a nodata neighbor need the weighted formulas
+  const float nodata = mInputNodataValue;
+  for ( int i = 0; i < width; ++i )
+  {
+    if ( scanLine1[i] == nodata || scanLine1[i + 1] == nodata || scanLine1[i + 2] == nodata
+         || scanLine2[i] == nodata || scanLine2[i + 2] == nodata
+         || scanLine3[i] == nodata || scanLine3[i + 1] == nodata || scanLine3[i + 2] == nodata )
+    {
+      derX[i] = calcFirstDerX( &scanLine1[i], &scanLine1[i + 1], &scanLine1[i + 2],
+                               &scanLine2[i], &scanLine2[i + 1], &scanLine2[i + 2],
+                               &scanLine3[i], &scanLine3[i + 1], &scanLine3[i + 2] );
+      derY[i] = calcFirstDerY( &scanLine1[i], &scanLine1[i + 1], &scanLine1[i + 2],
+                               &scanLine2[i], &scanLine2[i + 1], &scanLine2[i + 2],
+                               &scanLine3[i], &scanLine3[i + 1], &scanLine3[i + 2] );
+    }
+  }
+}
+
 float QgsDerivativeFilter::calcFirstDerX( float *x11, float *x21, float *x31, float *x12, float *x22, float *x32, float *x13, float *x23, float *x33 )
 {
   //the basic formula would be simple, but we need to test for nodata values...
@@ -39,6 +39,18 @@ class ANALYSIS_EXPORT QgsDerivativeFilter : public QgsNineCellFilter
     float calcFirstDerX( float *x11, float *x21, float *x31, float *x12, float *x22, float *x32, float *x13, float *x23, float *x33 );
     //! Calculates the first order derivative in y-direction according to Horn (1981)
     float calcFirstDerY( float *x11, float *x21, float *x31, float *x12, float *x22, float *x32, float *x13, float *x23, float *x33 );
+
+    /**
+     * Calculates the first order derivatives in x- and y-direction for a complete row of \a width cells,
+     * storing the results in \a derX and \a derY.
+     *
+     * The scanlines follow the layout described in processNineCellRow(). Results are identical to
+     * calling calcFirstDerX() and calcFirstDerY() for every cell, but windows without nodata values are
+     * calculated in a single loop which the compiler can vectorize.
+     *
+     * \since QGIS 3.16
+     */
+    void calcFirstDerivatives( float *scanLine1, float *scanLine2, float *scanLine3, int width, float *derX, float *derY ) SIP_SKIP;
 };
 
 #endif // QGSDERIVATIVEFILTER_H
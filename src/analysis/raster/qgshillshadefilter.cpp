@@ -17,6 +17,8 @@
 
 #include "qgshillshadefilter.h"
 #include <cmath>
+#include <typeinfo>
+#include <vector>
 
 QgsHillshadeFilter::QgsHillshadeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat, double lightAzimuth,
                                         double lightAngle )
@@ -37,6 +39,34 @@ float QgsHillshadeFilter::processNineCellWindow( float *x11, float *x21, float *
   float derX = calcFirstDerX( x11, x21, x31, x12, x22, x32, x13, x23, x33 );
   float derY = calcFirstDerY( x11, x21, x31, x12, x22, x32, x13, x23, x33 );
 
+  return shade( derX, derY );
+}
+
+void QgsHillshadeFilter::processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width )
+{
+  if ( typeid( *this ) != typeid( QgsHillshadeFilter ) )
+  {
+    QgsNineCellFilter::processNineCellRow( scanLine1, scanLine2, scanLine3, resultLine, width );
+    return;
+  }
+
+  std::vector< float > derX( width );
+  std::vector< float > derY( width );
+  calcFirstDerivatives( scanLine1, scanLine2, scanLine3, width, derX.data(), derY.data() );
+
+  for ( int i = 0; i < width; ++i )
+  {
+    resultLine[i] = shade( derX[i], derY[i] );
+  }
+}
+
+bool QgsHillshadeFilter::supportsParallelRows() const
+{
+  return typeid( *this ) == typeid( QgsHillshadeFilter );
+}
+
+float QgsHillshadeFilter::shade( float derX, float derY ) const
+{
   if ( derX == mOutputNodataValue || derY == mOutputNodataValue )
   {
     return mOutputNodataValue;
@@ -34,6 +34,8 @@ class ANALYSIS_EXPORT QgsHillshadeFilter: public QgsDerivativeFilter
     float processNineCellWindow( float *x11, float *x21, float *x31,
                                  float *x12, float *x22, float *x32,
                                  float *x13, float *x23, float *x33 ) override;
+    void processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width ) override SIP_SKIP;
+    bool supportsParallelRows() const override SIP_SKIP;
 
     float lightAzimuth() const { return mLightAzimuth; }
     void setLightAzimuth( float azimuth );
@@ -50,6 +52,9 @@ class ANALYSIS_EXPORT QgsHillshadeFilter: public QgsDerivativeFilter
     }
 #endif
 
+    //! Calculates the shading value from the first order derivatives of a cell
+    float shade( float derX, float derY ) const;
+
     float mLightAzimuth;
     float mLightAngle;
     // Precalculate for speed:
@@ -17,9 +17,18 @@
 #include "qgsfeaturesource.h"
 #include "qgsfeatureiterator.h"
 #include "qgsgeometry.h"
+#include "qgsfeedback.h"
+
+#include <QTemporaryFile>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 #define NO_DATA -9999
 
+
 QgsKernelDensityEstimation::QgsKernelDensityEstimation( const QgsKernelDensityEstimation::Parameters &parameters, const QString &outputFile, const QString &outputFormat )
   : mSource( parameters.source )
   , mOutputFile( outputFile )
@@ -66,6 +75,287 @@ QgsKernelDensityEstimation::Result QgsKernelDensityEstimation::run()
   return finalise();
 }
 
+QgsKernelDensityEstimation::Result QgsKernelDensityEstimation::runTiled( QgsFeedback *feedback, int tileSize, int maximumPointsInMemory )
+{
+  Result result = prepare();
+  if ( result != Success )
+    return result;
+
+  tileSize = std::max( tileSize, 1 );
+  maximumPointsInMemory = std::max( maximumPointsInMemory, 1 );
+  const int rows = GDALGetRasterBandYSize( mRasterBandH );
+  const int columns = GDALGetRasterBandXSize( mRasterBandH );
+  const int bandCount = ( rows + tileSize - 1 ) / tileSize;
+  const int tileCount = ( columns + tileSize - 1 ) / tileSize;
+
+  // a point, with the position of its kernel block calculated as in addFeature()
+  struct KernelPoint
+  {
+    double x;
+    double y;
+    double radius;
+    double weight;
+    int buffer;
+    int xPosition;
+    int yPosition;
+    int yPositionIO;
+  };
+
+  // a run of points of a band which was spilled to the temporary file
+  struct SpilledChunk
+  {
+    qint64 offset;
+    int count;
+  };
+
+  std::vector< std::vector< KernelPoint > > bandPoints( static_cast< std::size_t >( bandCount ) );
+  std::vector< std::vector< SpilledChunk > > spilledChunks( static_cast< std::size_t >( bandCount ) );
+  // number of points held in bandPoints, over all bands
+  std::size_t heldPoints = 0;
+  QTemporaryFile spillFile;
+
+  auto spillBand = [&spillFile, &bandPoints, &spilledChunks, &heldPoints]( int band ) -> bool
+  {
+    std::vector< KernelPoint > &points = bandPoints[ band ];
+    if ( !spillFile.isOpen() && !spillFile.open() )
+      return false;
+
+    const qint64 size = static_cast< qint64 >( points.size() * sizeof( KernelPoint ) );
+    SpilledChunk chunk;
+    chunk.offset = spillFile.size();
+    chunk.count = static_cast< int >( points.size() );
+    if ( !spillFile.seek( chunk.offset ) || spillFile.write( reinterpret_cast< const char * >( points.data() ), size ) != size )
+      return false;
+
+    spilledChunks[ band ].push_back( chunk );
+    heldPoints -= points.size();
+    std::vector< KernelPoint >().swap( points );
+    return true;
+  };
+
+  // spills the bands holding most points, until at most half of the budget is held
+  auto spillLargestBands = [&]() -> bool
+  {
+    std::vector< int > bands( static_cast< std::size_t >( bandCount ) );
+    std::iota( bands.begin(), bands.end(), 0 );
+    std::sort( bands.begin(), bands.end(), [&bandPoints]( int a, int b ) { return bandPoints[ a ].size() > bandPoints[ b ].size(); } );
+    for ( int band : bands )
+    {
+      if ( heldPoints <= static_cast< std::size_t >( maximumPointsInMemory ) / 2 || bandPoints[ band ].empty() )
+        break;
+      if ( !spillBand( band ) )
+        return false;
+    }
+    return true;
+  };
+
+  QgsAttributeList requiredAttributes;
+  if ( mRadiusField >= 0 )
+    requiredAttributes << mRadiusField;
+  if ( mWeightField >= 0 )
+    requiredAttributes << mWeightField;
+
+  // first pass - bin all points into the bands of tiles their kernels overlap
+  const long featureCount = mSource->featureCount();
+  long current = 0;
+  QgsFeatureIterator fit = mSource->getFeatures( QgsFeatureRequest().setSubsetOfAttributes( requiredAttributes ) );
+  QgsFeature feature;
+  while ( fit.nextFeature( feature ) )
+  {
+    if ( feedback && feedback->isCanceled() )
+    {
+      finalise();
+      return Canceled;
+    }
+    if ( feedback && featureCount > 0 )
+      feedback->setProgress( 50.0 * static_cast< double >( current++ ) / featureCount );
+
+    const QgsGeometry featureGeometry = feature.geometry();
+    if ( featureGeometry.isNull() )
+      continue;
+
+    QgsMultiPointXY multiPoints;
+    if ( !featureGeometry.isMultipart() )
+      multiPoints << featureGeometry.asPoint();
+    else
+      multiPoints = featureGeometry.asMultiPoint();
+
+    KernelPoint point;
+    point.radius = mRadius;
+    point.buffer = mBufferSize;
+    if ( mRadiusField >= 0 )
+    {
+      point.radius = feature.attribute( mRadiusField ).toDouble();
+      point.buffer = radiusSizeInPixels( point.radius );
+    }
+    point.weight = mWeightField >= 0 ? feature.attribute( mWeightField ).toDouble() : 1.0;
+    const int blockSize = 2 * point.buffer + 1;
+
+    for ( const QgsPointXY &p : qgis::as_const( multiPoints ) )
+    {
+      // avoiding any empty points or out of extent points
+      if ( !mBounds.contains( p ) )
+        continue;
+
+      point.x = p.x();
+      point.y = p.y();
+      point.xPosition = static_cast< int >( ( ( p.x() - mBounds.xMinimum() ) / mPixelSize ) - point.buffer );
+      point.yPosition = static_cast< int >( ( ( p.y() - mBounds.yMinimum() ) / mPixelSize ) - point.buffer );
+      point.yPositionIO = static_cast< int >( ( ( mBounds.yMaximum() - p.y() ) / mPixelSize ) - point.buffer );
+
+      // like addFeature(), skip points whose kernel block does not fit in the raster
+      if ( blockSize <= 0 || point.xPosition < 0 || point.yPositionIO < 0
+           || point.xPosition + blockSize > columns || point.yPositionIO + blockSize > rows )
+      {
+        if ( feedback )
+          feedback->reportError( QObject::tr( "Error adding feature with ID %1 to heatmap" ).arg( feature.id() ) );
+        continue;
+      }
+
+      const int firstRow = point.yPositionIO;
+      const int lastRow = point.yPositionIO + blockSize - 1;
+      for ( int band = firstRow / tileSize; band <= lastRow / tileSize; ++band )
+      {
+        bandPoints[ band ].push_back( point );
+        ++heldPoints;
+      }
+      if ( heldPoints >= static_cast< std::size_t >( maximumPointsInMemory ) && !spillLargestBands() )
+      {
+        finalise();
+        return FileCreationError;
+      }
+    }
+  }
+
+  // second pass - accumulate the points of each band into its tiles, in chunks of at most the points
+  // spilled at once or held in memory, with the tiles accumulated in parallel. The band is then written.
+  std::vector< int > tileIndices( static_cast< std::size_t >( tileCount ) );
+  std::iota( tileIndices.begin(), tileIndices.end(), 0 );
+  std::vector< std::vector< float > > tiles( static_cast< std::size_t >( tileCount ) );
+  std::vector< std::vector< int > > tilePoints( static_cast< std::size_t >( tileCount ) );
+  std::vector< KernelPoint > chunkPoints;
+  for ( int band = 0; band < bandCount; ++band )
+  {
+    if ( feedback && feedback->isCanceled() )
+    {
+      finalise();
+      return Canceled;
+    }
+    if ( feedback )
+      feedback->setProgress( 50.0 + 50.0 * static_cast< double >( band ) / bandCount );
+
+    const int bandRow = band * tileSize;
+    const int bandRows = std::min( tileSize, rows - bandRow );
+    for ( int tile = 0; tile < tileCount; ++tile )
+    {
+      const int tileColumns = std::min( tileSize, columns - tile * tileSize );
+      tiles[ tile ].assign( static_cast< std::size_t >( tileColumns ) * bandRows, NO_DATA );
+    }
+
+    auto accumulateTile = [&]( int tile )
+    {
+      const int tileColumn = tile * tileSize;
+      const int tileColumns = std::min( tileSize, columns - tileColumn );
+      std::vector< float > &data = tiles[ tile ];
+
+      // squared offsets of the pixel centroids from the point, along each axis
+      std::vector< double > dx2;
+      std::vector< double > dy2;
+      for ( int index : tilePoints[ tile ] )
+      {
+        const KernelPoint &point = chunkPoints[ index ];
+        const int blockSize = 2 * point.buffer + 1;
+        const int firstColumn = std::max( point.xPosition, tileColumn );
+        const int lastColumn = std::min( point.xPosition + blockSize - 1, tileColumn + tileColumns - 1 );
+        const int firstRow = std::max( point.yPositionIO, bandRow );
+        const int lastRow = std::min( point.yPositionIO + blockSize - 1, bandRow + bandRows - 1 );
+        if ( firstColumn > lastColumn || firstRow > lastRow )
+          continue;
+
+        dx2.resize( static_cast< std::size_t >( lastColumn - firstColumn + 1 ) );
+        for ( int column = firstColumn; column <= lastColumn; ++column )
+        {
+          const double pixelCentroidX = ( column + 0.5 ) * mPixelSize + mBounds.xMinimum();
+          dx2[ column - firstColumn ] = std::pow( pixelCentroidX - point.x, 2.0 );
+        }
+        dy2.resize( static_cast< std::size_t >( lastRow - firstRow + 1 ) );
+        for ( int row = firstRow; row <= lastRow; ++row )
+        {
+          const double pixelCentroidY = ( point.yPosition + ( row - point.yPositionIO ) + 0.5 ) * mPixelSize + mBounds.yMinimum();
+          dy2[ row - firstRow ] = std::pow( pixelCentroidY - point.y, 2.0 );
+        }
+
+        for ( int row = firstRow; row <= lastRow; ++row )
+        {
+          float *line = data.data() + static_cast< std::size_t >( row - bandRow ) * tileColumns;
+          const double rowOffset = dy2[ row - firstRow ];
+          for ( int column = firstColumn; column <= lastColumn; ++column )
+          {
+            const double distance = std::sqrt( dx2[ column - firstColumn ] + rowOffset );
+
+            // is pixel outside search bandwidth of feature?
+            if ( distance > point.radius )
+              continue;
+
+            const int pos = column - tileColumn;
+            if ( line[ pos ] == NO_DATA )
+              line[ pos ] = 0;
+            line[ pos ] += point.weight * calculateKernelValue( distance, point.radius, mShape, mOutputValues );
+          }
+        }
+      }
+    };
+
+    auto accumulateChunk = [&]()
+    {
+      for ( std::vector< int > &indices : tilePoints )
+        indices.clear();
+      for ( int i = 0; i < static_cast< int >( chunkPoints.size() ); ++i )
+      {
+        const KernelPoint &point = chunkPoints[ i ];
+        const int firstColumn = point.xPosition;
+        const int lastColumn = point.xPosition + 2 * point.buffer;
+        for ( int tile = firstColumn / tileSize; tile <= lastColumn / tileSize; ++tile )
+          tilePoints[ tile ].push_back( i );
+      }
+      QtConcurrent::blockingMap( tileIndices, accumulateTile );
+    };
+
+    // the spilled points come first, so that points are accumulated in the order of the source
+    for ( const SpilledChunk &chunk : spilledChunks[ band ] )
+    {
+      const qint64 size = static_cast< qint64 >( chunk.count * sizeof( KernelPoint ) );
+      chunkPoints.resize( static_cast< std::size_t >( chunk.count ) );
+      if ( !spillFile.seek( chunk.offset ) || spillFile.read( reinterpret_cast< char * >( chunkPoints.data() ), size ) != size )
+      {
+        finalise();
+        return RasterIoError;
+      }
+      accumulateChunk();
+    }
+    chunkPoints.swap( bandPoints[ band ] );
+    std::vector< KernelPoint >().swap( bandPoints[ band ] );
+    accumulateChunk();
+    std::vector< KernelPoint >().swap( chunkPoints );
+
+    for ( int tile = 0; tile < tileCount; ++tile )
+    {
+      const int tileColumns = std::min( tileSize, columns - tile * tileSize );
+      if ( GDALRasterIO( mRasterBandH, GF_Write, tile * tileSize, bandRow, tileColumns, bandRows,
+                         tiles[ tile ].data(), tileColumns, bandRows, GDT_Float32, 0, 0 ) != CE_None )
+      {
+        result = RasterIoError;
+      }
+    }
+  }
+
+  if ( feedback )
+    feedback->setProgress( 100 );
+
+  const Result finaliseResult = finalise();
+  return result != Success ? result : finaliseResult;
+}
+
 QgsKernelDensityEstimation::Result QgsKernelDensityEstimation::prepare()
 {
   GDALAllRegister();
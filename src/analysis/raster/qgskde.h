@@ -28,6 +28,7 @@
 
 class QgsFeatureSource;
 class QgsFeature;
+class QgsFeedback;
 
 
 /**
@@ -65,6 +66,7 @@ class ANALYSIS_EXPORT QgsKernelDensityEstimation
       InvalidParameters, //!< Input parameters were not valid
       FileCreationError, //!< Error creating output file
       RasterIoError, //!< Error writing to raster
+      Canceled, //!< Operation was canceled (since QGIS 3.16)
     };
 
     //! KDE parameters
@@ -112,6 +114,28 @@ class ANALYSIS_EXPORT QgsKernelDensityEstimation
      */
     Result run();
 
+    /**
+     * Runs the KDE calculation across the whole layer at once, like run(), but calculates the output
+     * raster in tiles of \a tileSize by \a tileSize pixels.
+     *
+     * Points are first binned into horizontal bands of tiles, including the points whose kernel
+     * reaches into a band from a neighboring band. Once more than \a maximumPointsInMemory points are
+     * binned over all bands, the points of the fullest bands are spilled to a temporary file. Each band is
+     * then calculated from its spilled chunks of points and the points still in memory, one chunk at a
+     * time with the tiles accumulated in parallel, and written to the output file before the next band
+     * is started.
+     *
+     * Memory use is therefore bounded by about twice \a maximumPointsInMemory points plus one band of
+     * tiles, whatever the number of points, which makes this method suitable for very large point sources.
+     *
+     * The output is identical to the output of run().
+     *
+     * An optional \a feedback object can be set for progress reports and cancellation support.
+     *
+     * \since QGIS 3.16
+     */
+    Result runTiled( QgsFeedback *feedback = nullptr, int tileSize = 256, int maximumPointsInMemory = 65536 );
+
     /**
      * Prepares the output file for writing and setups up the surface calculation. This must be called
      * before adding features via addFeature().
@@ -30,7 +30,15 @@
 #include <QFile>
 #include <QDebug>
 #include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 #include <iterator>
+#include <vector>
+
+//! Maximum number of rows in each strip processed by the CPU calculation
+constexpr int MAXIMUM_STRIP_HEIGHT = 256;
+//! Approximate number of cells in each strip processed by the CPU calculation
+constexpr int STRIP_CELLS = 1 << 21;
 
 
 
@@ -84,6 +92,17 @@ int QgsNineCellFilter::processRaster( QgsFeedback *feedback )
 #endif
 }
 
+void QgsNineCellFilter::processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width )
+{
+  for ( int xIndex = 0; xIndex < width; ++xIndex )
+  {
+    // cells(x, y) x11, x21, x31, x12, x22, x32, x13, x23, x33
+    resultLine[ xIndex ] = processNineCellWindow( &scanLine1[ xIndex ], &scanLine1[ xIndex + 1 ], &scanLine1[ xIndex + 2 ],
+                           &scanLine2[ xIndex ], &scanLine2[ xIndex + 1 ], &scanLine2[ xIndex + 2 ],
+                           &scanLine3[ xIndex ], &scanLine3[ xIndex + 1 ], &scanLine3[ xIndex + 2 ] );
+  }
+}
+
 gdal::dataset_unique_ptr QgsNineCellFilter::openInputFile( int &nCellsX, int &nCellsY )
 {
   gdal::dataset_unique_ptr inputDataset( GDALOpen( mInputFile.toUtf8().constData(), GA_ReadOnly ) );
@@ -401,16 +420,35 @@ int QgsNineCellFilter::processRasterCPU( QgsFeedback *feedback )
     return 6;
   }
 
-  //keep only three scanlines in memory at a time, make room for initial and final nodata
-  std::size_t bufferSize( sizeof( float ) * ( xSize + 2 ) );
-  float *scanLine1 = ( float * ) CPLMalloc( bufferSize );
-  float *scanLine2 = ( float * ) CPLMalloc( bufferSize );
-  float *scanLine3 = ( float * ) CPLMalloc( bufferSize );
+  // The raster is processed in horizontal strips. Each strip is read with a single call into a buffer
+  // holding its rows plus the rows directly above and below it, with an initial and final nodata
+  // column, so the three scanlines of every output row are adjacent in memory. Batches of strips
+  // are calculated, in parallel if the filter supports it, and then written in order.
+  const std::size_t lineSize = static_cast< std::size_t >( xSize ) + 2;
+  const int stripHeight = std::max( 1, std::min( MAXIMUM_STRIP_HEIGHT, STRIP_CELLS / xSize ) );
+  const int stripCount = ( ySize + stripHeight - 1 ) / stripHeight;
+  const bool parallel = supportsParallelRows();
+  const int batchSize = parallel ? std::max( 1, QThreadPool::globalInstance()->maxThreadCount() ) : 1;
+
+  struct Strip
+  {
+    int firstRow = 0;
+    int rows = 0;
+    std::vector< float > scanLines;
+    std::vector< float > result;
+  };
 
-  float *resultLine = ( float * ) CPLMalloc( sizeof( float ) * xSize );
+  auto processStrip = [this, lineSize, xSize]( Strip & strip )
+  {
+    for ( int row = 0; row < strip.rows; ++row )
+    {
+      float *scanLine1 = strip.scanLines.data() + row * lineSize;
+      processNineCellRow( scanLine1, scanLine1 + lineSize, scanLine1 + 2 * lineSize,
+                          strip.result.data() + static_cast< std::size_t >( row ) * xSize, xSize );
+    }
+  };
 
-  //values outside the layer extent (if the 3x3 window is on the border) are sent to the processing method as (input) nodata values
-  for ( int yIndex = 0; yIndex < ySize; ++yIndex )
+  for ( int batchStart = 0; batchStart < stripCount; batchStart += batchSize )
   {
     if ( feedback && feedback->isCanceled() )
     {
@@ -419,74 +457,50 @@ int QgsNineCellFilter::processRasterCPU( QgsFeedback *feedback )
 
     if ( feedback )
     {
-      feedback->setProgress( 100.0 * static_cast< double >( yIndex ) / ySize );
+      feedback->setProgress( 100.0 * static_cast< double >( batchStart ) / stripCount );
     }
 
-    if ( yIndex == 0 )
+    std::vector< Strip > strips( static_cast< std::size_t >( std::min( batchSize, stripCount - batchStart ) ) );
+    for ( std::size_t i = 0; i < strips.size(); ++i )
     {
-      //fill scanline 1 with (input) nodata for the values above the first row and feed scanline2 with the first row
-      for ( int a = 0; a < xSize + 2 ; ++a )
-      {
-        scanLine1[a] = mInputNodataValue;
-      }
-      // Read scanline2
-      if ( GDALRasterIO( rasterBand, GF_Read, 0, 0, xSize, 1, &scanLine2[1], xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
+      Strip &strip = strips[i];
+      strip.firstRow = ( batchStart + static_cast< int >( i ) ) * stripHeight;
+      strip.rows = std::min( stripHeight, ySize - strip.firstRow );
+
+      //values outside the layer extent (if the 3x3 window is on the border) are sent to the processing method as (input) nodata values
+      strip.scanLines.assign( lineSize * ( strip.rows + 2 ), static_cast< float >( mInputNodataValue ) );
+      strip.result.resize( static_cast< std::size_t >( xSize ) * strip.rows );
+
+      const int readStart = std::max( 0, strip.firstRow - 1 );
+      const int readEnd = std::min( ySize, strip.firstRow + strip.rows + 1 );
+      float *readBuffer = strip.scanLines.data() + ( readStart - strip.firstRow + 1 ) * lineSize + 1;
+      if ( GDALRasterIO( rasterBand, GF_Read, 0, readStart, xSize, readEnd - readStart, readBuffer, xSize, readEnd - readStart,
+                         GDT_Float32, 0, static_cast< int >( lineSize * sizeof( float ) ) ) != CE_None )
       {
         QgsDebugMsg( QStringLiteral( "Raster IO Error" ) );
       }
     }
-    else
-    {
-      //normally fetch only scanLine3 and release scanline 1 if we move forward one row
-      CPLFree( scanLine1 );
-      scanLine1 = scanLine2;
-      scanLine2 = scanLine3;
-      scanLine3 = ( float * ) CPLMalloc( bufferSize );
-    }
 
-    // Read scanline 3
-    if ( yIndex == ySize - 1 ) //fill the row below the bottom with nodata values
+    if ( parallel )
     {
-      for ( int a = 0; a < xSize + 2; ++a )
-      {
-        scanLine3[a] = mInputNodataValue;
-      }
+      QtConcurrent::blockingMap( strips, processStrip );
     }
     else
     {
-      if ( GDALRasterIO( rasterBand, GF_Read, 0, yIndex + 1, xSize, 1, &scanLine3[1], xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
-      {
-        QgsDebugMsg( QStringLiteral( "Raster IO Error" ) );
-      }
+      // the filter may not be thread safe (e.g. Python subclasses), so stay in the calling thread
+      for ( Strip &strip : strips )
+        processStrip( strip );
     }
-    // Set first and last extra columns to nodata
-    scanLine1[0] = scanLine1[xSize + 1] = mInputNodataValue;
-    scanLine2[0] = scanLine2[xSize + 1] = mInputNodataValue;
-    scanLine3[0] = scanLine3[xSize + 1] = mInputNodataValue;
-
 
-
-    // j is the x axis index, skip 0 and last cell that have been filled with nodata
-    for ( int xIndex = 0; xIndex < xSize ; ++xIndex )
+    for ( Strip &strip : strips )
     {
-      // cells(x, y) x11, x21, x31, x12, x22, x32, x13, x23, x33
-      resultLine[ xIndex ] = processNineCellWindow( &scanLine1[ xIndex ], &scanLine1[ xIndex + 1 ], &scanLine1[ xIndex + 2 ],
-                             &scanLine2[ xIndex ], &scanLine2[ xIndex + 1 ], &scanLine2[ xIndex + 2 ],
-                             &scanLine3[ xIndex ], &scanLine3[ xIndex + 1 ], &scanLine3[ xIndex + 2 ] );
-
-    }
-
-    if ( GDALRasterIO( outputRasterBand, GF_Write, 0, yIndex, xSize, 1, resultLine, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
-    {
-      QgsDebugMsg( QStringLiteral( "Raster IO Error" ) );
+      if ( GDALRasterIO( outputRasterBand, GF_Write, 0, strip.firstRow, xSize, strip.rows, strip.result.data(), xSize, strip.rows, GDT_Float32, 0, 0 ) != CE_None )
+      {
+        QgsDebugMsg( QStringLiteral( "Raster IO Error" ) );
+      }
     }
   }
 
-  CPLFree( resultLine );
-  CPLFree( scanLine1 );
-  CPLFree( scanLine2 );
-  CPLFree( scanLine3 );
-
   if ( feedback && feedback->isCanceled() )
   {
     //delete the dataset without closing (because it is faster)
@@ -21,6 +21,7 @@
 #include <QString>
 #include "gdal.h"
 #include "qgis_analysis.h"
+#include "qgis_sip.h"
 #include "qgsogrutils.h"
 
 class QgsFeedback;
@@ -79,6 +80,40 @@ class ANALYSIS_EXPORT QgsNineCellFilter
     virtual float processNineCellWindow( float *x11, float *x21, float *x31,
                                          float *x12, float *x22, float *x32,
                                          float *x13, float *x23, float *x33 ) = 0;
+#ifndef SIP_RUN
+    /**
+     * Calculates the output values for a complete row of \a width cells.
+     *
+     * \a scanLine1, \a scanLine2 and \a scanLine3 are the input rows above, at and below the
+     * output row. Each scanline contains \a width + 2 values, with the first and last values
+     * set to the input nodata value. The results are written to \a resultLine.
+     *
+     * The default implementation calls processNineCellWindow() for every cell. Subclasses can
+     * override this method to process the row in a single loop, avoiding a virtual call per cell
+     * and allowing the compiler to vectorize the calculation.
+     *
+     * The built-in filters only use their row implementation for instances of exactly their own
+     * class. Instances of classes derived from them fall back to the default implementation, so that
+     * an overridden processNineCellWindow() is still called for every cell.
+     *
+     * \note Rows are processed from several threads at once if supportsParallelRows() returns TRUE.
+     * \note Not available in Python bindings
+     * \since QGIS 3.16
+     */
+    virtual void processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width );
+
+    /**
+     * Returns TRUE if processNineCellRow() can be called for several rows at once from worker threads.
+     *
+     * The default implementation returns FALSE, and all rows are calculated one after another in the
+     * thread calling processRaster(). Subclasses whose processNineCellRow() implementation neither
+     * modifies the filter nor calls code which is not thread safe can return TRUE.
+     *
+     * \note Not available in Python bindings
+     * \since QGIS 3.16
+     */
+    virtual bool supportsParallelRows() const { return false; }
+#endif
 
   private:
     //default constructor forbidden. We need input file, output file and format obligatory
@@ -193,7 +193,7 @@ bool QgsRasterCalcNode::calculate( QMap<QString, QgsRasterBlock * > &rasterData,
     size_t nEntries = static_cast<size_t>( result.nColumns() * result.nRows() );
     double *data = new double[ nEntries ];
     std::fill( data, data + nEntries, mNumber );
-    result.setData( result.nColumns(), 1, data, result.nodataValue() );
+    result.setData( result.nColumns(), result.nRows(), data, result.nodataValue() );
 
     return true;
   }
@@ -27,6 +27,9 @@
 #include "qgsproject.h"
 
 #include <QFile>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 
 #include <cpl_string.h>
 #include <gdalwarper.h>
@@ -36,6 +39,9 @@
 #include "qgsgdalutils.h"
 #endif
 
+//! Width and height of the tiles evaluated in parallel by the CPU calculation
+constexpr int TILE_SIZE = 512;
+
 QgsRasterCalculator::QgsRasterCalculator( const QString &formulaString, const QString &outputFile, const QString &outputFormat, const QgsRectangle &outputExtent, int nOutputColumns, int nOutputRows, const QVector<QgsRasterCalculatorEntry> &rasterEntries, const QgsCoordinateTransformContext &transformContext )
   : mFormulaString( formulaString )
   , mOutputFile( outputFile )
@@ -160,98 +166,15 @@ QgsRasterCalculator::Result QgsRasterCalculator::processCalculation( QgsFeedback
   GDALSetRasterNoDataValue( outputRasterBand, outputNodataValue );
 
 
-  // Take the fast route (process one line at a time) if we can
+  // Take the fast route (process one tile at a time, in parallel) if we can
   if ( ! requiresMatrix )
   {
-    // Map of raster names -> blocks
-    std::map<QString, std::unique_ptr<QgsRasterBlock>> inputBlocks;
-    std::map<QString, QgsRasterCalculatorEntry> uniqueRasterEntries;
-    const QList<const QgsRasterCalcNode *> rasterRefNodes = calcNode->findNodes( QgsRasterCalcNode::Type::tRasterRef );
-    for ( const QgsRasterCalcNode *r : rasterRefNodes )
-    {
-      QString layerRef( r->toString().remove( 0, 1 ) );
-      layerRef.chop( 1 );
-      if ( ! inputBlocks.count( layerRef ) )
-      {
-        for ( const QgsRasterCalculatorEntry &ref : qgis::as_const( mRasterEntries ) )
-        {
-          if ( ref.ref == layerRef )
-          {
-            uniqueRasterEntries[layerRef] = ref;
-            inputBlocks[layerRef ] = qgis::make_unique<QgsRasterBlock>();
-          }
-        }
-      }
-    }
-
-    //read / write line by line
-    QMap<QString, QgsRasterBlock * > _rasterData;
-    // Cast to float
-    std::vector<float> castedResult( static_cast<size_t>( mNumOutputColumns ), 0 );
-    auto rowHeight = mOutputRectangle.height() / mNumOutputRows;
-    for ( size_t row = 0; row < static_cast<size_t>( mNumOutputRows ); ++row )
-    {
-      if ( feedback )
-      {
-        feedback->setProgress( 100.0 * static_cast< double >( row ) / mNumOutputRows );
-      }
-
-      if ( feedback && feedback->isCanceled() )
-      {
-        break;
-      }
-
-      // Calculates the rect for a single row read
-      QgsRectangle rect( mOutputRectangle );
-      rect.setYMaximum( rect.yMaximum() - rowHeight * row );
-      rect.setYMinimum( rect.yMaximum() - rowHeight );
-
-      // Read rows into input blocks
-      for ( auto &layerRef : inputBlocks )
-      {
-        QgsRasterCalculatorEntry ref = uniqueRasterEntries[layerRef.first];
-        if ( ref.raster->crs() != mOutputCrs )
-        {
-          QgsRasterProjector proj;
-          proj.setCrs( ref.raster->crs(), mOutputCrs, mTransformContext );
-          proj.setInput( ref.raster->dataProvider() );
-          proj.setPrecision( QgsRasterProjector::Exact );
-          layerRef.second.reset( proj.block( ref.bandNumber, rect, mNumOutputColumns, 1 ) );
-        }
-        else
-        {
-          layerRef.second.reset( ref.raster->dataProvider()->block( ref.bandNumber, rect, mNumOutputColumns, 1 ) );
-        }
-      }
-
-      // 1 row X mNumOutputColumns matrix
-      QgsRasterMatrix resultMatrix( mNumOutputColumns, 1, nullptr, outputNodataValue );
-
-      _rasterData.clear();
-      for ( const auto &layerRef : inputBlocks )
-      {
-        _rasterData.insert( layerRef.first, layerRef.second.get() );
-      }
-
-      if ( calcNode->calculate( _rasterData, resultMatrix, 0 ) )
-      {
-        std::copy( resultMatrix.data(), resultMatrix.data() + mNumOutputColumns, castedResult.begin() );
-        if ( GDALRasterIO( outputRasterBand, GF_Write, 0, row, mNumOutputColumns, 1, castedResult.data(), mNumOutputColumns, 1, GDT_Float32, 0, 0 ) != CE_None )
-        {
-          QgsDebugMsg( QStringLiteral( "RasterIO error!" ) );
-        }
-      }
-      else
-      {
-        //delete the dataset without closing (because it is faster)
-        gdal::fast_delete_and_close( outputDataset, outputDriver, mOutputFile );
-        return CalculationError;
-      }
-    }
-
-    if ( feedback )
+    const Result result = processCalculationTiled( *calcNode, outputRasterBand, outputNodataValue, feedback );
+    if ( result == CalculationError )
     {
-      feedback->setProgress( 100.0 );
+      //delete the dataset without closing (because it is faster)
+      gdal::fast_delete_and_close( outputDataset, outputDriver, mOutputFile );
+      return CalculationError;
     }
   }
   else  // Original code (memory inefficient route)
@@ -357,6 +280,185 @@ QgsRasterCalculator::Result QgsRasterCalculator::processCalculation( QgsFeedback
   return Success;
 }
 
+QgsRasterCalculator::Result QgsRasterCalculator::processCalculationTiled( const QgsRasterCalcNode &calcNode, GDALRasterBandH outputRasterBand, float outputNodataValue, QgsFeedback *feedback )
+{
+  // Collect the raster entries referenced by the expression
+  std::map<QString, QgsRasterCalculatorEntry> uniqueRasterEntries;
+  const QList<const QgsRasterCalcNode *> rasterRefNodes = calcNode.findNodes( QgsRasterCalcNode::Type::tRasterRef );
+  for ( const QgsRasterCalcNode *r : rasterRefNodes )
+  {
+    QString layerRef( r->toString().remove( 0, 1 ) );
+    layerRef.chop( 1 );
+    if ( ! uniqueRasterEntries.count( layerRef ) )
+    {
+      for ( const QgsRasterCalculatorEntry &ref : qgis::as_const( mRasterEntries ) )
+      {
+        if ( ref.ref == layerRef )
+        {
+          uniqueRasterEntries[layerRef] = ref;
+        }
+      }
+    }
+  }
+
+  // Raster providers are not thread safe, so each worker reads through its own set of cloned
+  // providers (and projectors, when the input needs reprojection). Sets are pooled and reused.
+  struct TileInputs
+  {
+    std::map<QString, std::unique_ptr<QgsRasterInterface>> providers;
+    std::map<QString, std::unique_ptr<QgsRasterProjector>> projectors;
+  };
+  QMutex inputsMutex;
+  std::vector< std::unique_ptr< TileInputs > > inputsPool;
+  auto createInputs = [&]()
+  {
+    std::unique_ptr< TileInputs > inputs = qgis::make_unique< TileInputs >();
+    for ( const auto &entry : uniqueRasterEntries )
+    {
+      std::unique_ptr< QgsRasterInterface > provider( entry.second.raster->dataProvider()->clone() );
+      if ( !provider )
+        continue;
+      if ( entry.second.raster->crs() != mOutputCrs )
+      {
+        std::unique_ptr< QgsRasterProjector > proj = qgis::make_unique< QgsRasterProjector >();
+        proj->setCrs( entry.second.raster->crs(), mOutputCrs, mTransformContext );
+        proj->setInput( provider.get() );
+        proj->setPrecision( QgsRasterProjector::Exact );
+        inputs->projectors[entry.first] = std::move( proj );
+      }
+      inputs->providers[entry.first] = std::move( provider );
+    }
+    return inputs;
+  };
+
+  struct Tile
+  {
+    int left = 0;
+    int top = 0;
+    int columns = 0;
+    int rows = 0;
+    bool ok = true;
+    std::vector<float> result;
+  };
+
+  const double cellSizeX = mOutputRectangle.width() / mNumOutputColumns;
+  const double cellSizeY = mOutputRectangle.height() / mNumOutputRows;
+  auto processTile = [&]( Tile & tile )
+  {
+    if ( feedback && feedback->isCanceled() )
+      return;
+
+    std::unique_ptr< TileInputs > inputs;
+    {
+      QMutexLocker locker( &inputsMutex );
+      if ( !inputsPool.empty() )
+      {
+        inputs = std::move( inputsPool.back() );
+        inputsPool.pop_back();
+      }
+      else
+      {
+        // cloning reads the shared providers of the layers, which is not thread safe either
+        inputs = createInputs();
+      }
+    }
+
+    const QgsRectangle rect( mOutputRectangle.xMinimum() + tile.left * cellSizeX,
+                             mOutputRectangle.yMaximum() - ( tile.top + tile.rows ) * cellSizeY,
+                             mOutputRectangle.xMinimum() + ( tile.left + tile.columns ) * cellSizeX,
+                             mOutputRectangle.yMaximum() - tile.top * cellSizeY );
+
+    // Read tiles into input blocks
+    std::vector< std::unique_ptr< QgsRasterBlock > > blocks;
+    QMap<QString, QgsRasterBlock * > rasterData;
+    for ( const auto &entry : uniqueRasterEntries )
+    {
+      if ( !inputs->providers.count( entry.first ) )
+        continue;
+
+      QgsRasterInterface *input = inputs->projectors.count( entry.first ) ? static_cast< QgsRasterInterface * >( inputs->projectors[entry.first].get() )
+                                  : inputs->providers[entry.first].get();
+      blocks.emplace_back( input->block( entry.second.bandNumber, rect, tile.columns, tile.rows ) );
+      rasterData.insert( entry.first, blocks.back().get() );
+    }
+
+    QgsRasterMatrix resultMatrix( tile.columns, tile.rows, nullptr, outputNodataValue );
+    tile.ok = calcNode.calculate( rasterData, resultMatrix );
+    if ( tile.ok )
+    {
+      // Cast to float
+      const std::size_t nEntries = static_cast< std::size_t >( tile.columns ) * static_cast< std::size_t >( tile.rows );
+      if ( resultMatrix.isNumber() )
+        tile.result.assign( nEntries, static_cast< float >( resultMatrix.number() ) );
+      else
+        tile.result.assign( resultMatrix.data(), resultMatrix.data() + nEntries );
+    }
+
+    QMutexLocker locker( &inputsMutex );
+    inputsPool.emplace_back( std::move( inputs ) );
+  };
+
+  const int tileWidth = std::min( mNumOutputColumns, TILE_SIZE );
+  const int tileHeight = std::min( mNumOutputRows, TILE_SIZE );
+  const int tileColumns = static_cast< int >( std::ceil( static_cast< double >( mNumOutputColumns ) / tileWidth ) );
+  const int tileRows = static_cast< int >( std::ceil( static_cast< double >( mNumOutputRows ) / tileHeight ) );
+  const int tileCount = tileColumns * tileRows;
+
+  // Only a limited number of tiles is held in memory at once: a batch is evaluated in parallel,
+  // then written in order before the next batch is started
+  const int batchSize = std::max( 1, QThreadPool::globalInstance()->maxThreadCount() * 2 );
+  for ( int batchStart = 0; batchStart < tileCount; batchStart += batchSize )
+  {
+    if ( feedback )
+    {
+      feedback->setProgress( 100.0 * static_cast< double >( batchStart ) / tileCount );
+    }
+
+    if ( feedback && feedback->isCanceled() )
+    {
+      break;
+    }
+
+    std::vector< Tile > tiles( static_cast< std::size_t >( std::min( batchSize, tileCount - batchStart ) ) );
+    for ( std::size_t i = 0; i < tiles.size(); ++i )
+    {
+      const int tileIndex = batchStart + static_cast< int >( i );
+      Tile &tile = tiles[i];
+      tile.left = ( tileIndex % tileColumns ) * tileWidth;
+      tile.top = ( tileIndex / tileColumns ) * tileHeight;
+      tile.columns = std::min( tileWidth, mNumOutputColumns - tile.left );
+      tile.rows = std::min( tileHeight, mNumOutputRows - tile.top );
+    }
+
+    QtConcurrent::blockingMap( tiles, processTile );
+
+    for ( Tile &tile : tiles )
+    {
+      if ( feedback && feedback->isCanceled() )
+      {
+        break;
+      }
+
+      if ( !tile.ok )
+      {
+        return CalculationError;
+      }
+
+      if ( GDALRasterIO( outputRasterBand, GF_Write, tile.left, tile.top, tile.columns, tile.rows, tile.result.data(), tile.columns, tile.rows, GDT_Float32, 0, 0 ) != CE_None )
+      {
+        QgsDebugMsg( QStringLiteral( "RasterIO error!" ) );
+      }
+    }
+  }
+
+  if ( feedback )
+  {
+    feedback->setProgress( 100.0 );
+  }
+
+  return Success;
+}
+
 #ifdef HAVE_OPENCL
 QgsRasterCalculator::Result QgsRasterCalculator::processCalculationGPU( std::unique_ptr< QgsRasterCalcNode > calcNode, QgsFeedback *feedback )
 {
@@ -196,6 +196,12 @@ class ANALYSIS_EXPORT QgsRasterCalculator
     */
     void outputGeoTransform( double *transform ) const;
 
+    /**
+     * Executes the calculation in 2D tiles, evaluating batches of tiles in parallel and writing
+     * the results to \a outputRasterBand in tile order.
+     */
+    Result processCalculationTiled( const QgsRasterCalcNode &calcNode, GDALRasterBandH outputRasterBand, float outputNodataValue, QgsFeedback *feedback );
+
     //! Execute calculations on GPU
     Result processCalculationGPU( std::unique_ptr< QgsRasterCalcNode > calcNode, QgsFeedback *feedback = nullptr );
 
@@ -20,6 +20,109 @@
 #include <cmath>
 #include <algorithm>
 
+///@cond PRIVATE
+
+// The operator switch is resolved once per matrix rather than once per cell, so that each
+// operator gets its own tight loop over contiguous data which the compiler can vectorize.
+namespace
+{
+  struct ArrayArgument
+  {
+    explicit ArrayArgument( const double *data ) : mData( data ) {}
+    double operator[]( std::size_t i ) const { return mData[i]; }
+    const double *mData = nullptr;
+  };
+
+  struct ScalarArgument
+  {
+    explicit ScalarArgument( double value ) : mValue( value ) {}
+    double operator[]( std::size_t ) const { return mValue; }
+    double mValue = 0;
+  };
+
+  bool isValidPower( double base, double power )
+  {
+    return !( ( base == 0 && power < 0 ) || ( base < 0 && ( power - std::floor( power ) ) > 0 ) );
+  }
+
+  template <typename Operation>
+  void applyOneArgumentOp( double *data, std::size_t nEntries, double nodata, Operation operation )
+  {
+    for ( std::size_t i = 0; i < nEntries; ++i )
+    {
+      const double value = data[i];
+      data[i] = value == nodata ? nodata : operation( value );
+    }
+  }
+
+  template <typename Left, typename Right, typename Operation>
+  void applyTwoArgumentOp( double *result, Left left, Right right, std::size_t nEntries, double leftNodata, double rightNodata, double nodata, Operation operation )
+  {
+    //operations with nodata values always generate nodata
+    for ( std::size_t i = 0; i < nEntries; ++i )
+    {
+      const double value1 = left[i];
+      const double value2 = right[i];
+      result[i] = ( value1 == leftNodata || value2 == rightNodata ) ? nodata : operation( value1, value2 );
+    }
+  }
+
+  template <typename Left, typename Right>
+  void dispatchTwoArgumentOp( QgsRasterMatrix::TwoArgOperator op, double *result, Left left, Right right, std::size_t nEntries, double leftNodata, double rightNodata, double nodata )
+  {
+    switch ( op )
+    {
+      case QgsRasterMatrix::opPLUS:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a + b; } );
+        break;
+      case QgsRasterMatrix::opMINUS:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a - b; } );
+        break;
+      case QgsRasterMatrix::opMUL:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a * b; } );
+        break;
+      case QgsRasterMatrix::opDIV:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, [nodata]( double a, double b ) { return b == 0 ? nodata : a / b; } );
+        break;
+      case QgsRasterMatrix::opPOW:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, [nodata]( double a, double b ) { return isValidPower( a, b ) ? std::pow( a, b ) : nodata; } );
+        break;
+      case QgsRasterMatrix::opEQ:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a == b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opNE:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a == b ? 0.0 : 1.0; } );
+        break;
+      case QgsRasterMatrix::opGT:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a > b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opLT:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a < b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opGE:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a >= b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opLE:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a <= b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opAND:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a && b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opOR:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return a || b ? 1.0 : 0.0; } );
+        break;
+      case QgsRasterMatrix::opMAX:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return std::max( a, b ); } );
+        break;
+      case QgsRasterMatrix::opMIN:
+        applyTwoArgumentOp( result, left, right, nEntries, leftNodata, rightNodata, nodata, []( double a, double b ) { return std::min( a, b ); } );
+        break;
+    }
+  }
+}
+
+///@endcond
+
 QgsRasterMatrix::QgsRasterMatrix( int nCols, int nRows, double *data, double nodataValue )
   : mColumns( nCols )
   , mRows( nRows )
@@ -208,171 +311,67 @@ bool QgsRasterMatrix::oneArgumentOperation( OneArgOperator op )
     return false;
   }
 
-  int nEntries = mColumns * mRows;
-  double value;
-  for ( int i = 0; i < nEntries; ++i )
-  {
-    value = mData[i];
-    if ( value != mNodataValue )
-    {
-      switch ( op )
-      {
-        case opSQRT:
-          if ( value < 0 ) //no complex numbers
-          {
-            mData[i] = mNodataValue;
-          }
-          else
-          {
-            mData[i] = std::sqrt( value );
-          }
-          break;
-        case opSIN:
-          mData[i] = std::sin( value );
-          break;
-        case opCOS:
-          mData[i] = std::cos( value );
-          break;
-        case opTAN:
-          mData[i] = std::tan( value );
-          break;
-        case opASIN:
-          mData[i] = std::asin( value );
-          break;
-        case opACOS:
-          mData[i] = std::acos( value );
-          break;
-        case opATAN:
-          mData[i] = std::atan( value );
-          break;
-        case opSIGN:
-          mData[i] = -value;
-          break;
-        case opLOG:
-          if ( value <= 0 )
-          {
-            mData[i] = mNodataValue;
-          }
-          else
-          {
-            mData[i] = ::log( value );
-          }
-          break;
-        case opLOG10:
-          if ( value <= 0 )
-          {
-            mData[i] = mNodataValue;
-          }
-          else
-          {
-            mData[i] = ::log10( value );
-          }
-          break;
-        case opABS:
-          mData[i] = ::fabs( value );
-          break;
-      }
-    }
-  }
-  return true;
-}
-
-double QgsRasterMatrix::calculateTwoArgumentOp( TwoArgOperator op, double arg1, double arg2 ) const
-{
+  const std::size_t nEntries = static_cast< std::size_t >( mColumns ) * static_cast< std::size_t >( mRows );
+  const double nodata = mNodataValue;
   switch ( op )
   {
-    case opPLUS:
-      return arg1 + arg2;
-    case opMINUS:
-      return arg1 - arg2;
-    case opMUL:
-      return arg1 * arg2;
-    case opDIV:
-      if ( arg2 == 0 )
-      {
-        return mNodataValue;
-      }
-      else
-      {
-        return arg1 / arg2;
-      }
-    case opPOW:
-      if ( !testPowerValidity( arg1, arg2 ) )
-      {
-        return mNodataValue;
-      }
-      else
-      {
-        return std::pow( arg1, arg2 );
-      }
-    case opEQ:
-      return ( arg1 == arg2 ? 1.0 : 0.0 );
-    case opNE:
-      return ( arg1 == arg2 ? 0.0 : 1.0 );
-    case opGT:
-      return ( arg1 > arg2 ? 1.0 : 0.0 );
-    case opLT:
-      return ( arg1 < arg2 ? 1.0 : 0.0 );
-    case opGE:
-      return ( arg1 >= arg2 ? 1.0 : 0.0 );
-    case opLE:
-      return ( arg1 <= arg2 ? 1.0 : 0.0 );
-    case opAND:
-      return ( arg1 && arg2 ? 1.0 : 0.0 );
-    case opOR:
-      return ( arg1 || arg2 ? 1.0 : 0.0 );
-    case opMAX:
-      return std::max( arg1, arg2 );
-    case opMIN:
-      return std::min( arg1, arg2 );
+    case opSQRT:
+      applyOneArgumentOp( mData, nEntries, nodata, [nodata]( double value ) { return value < 0 ? nodata : std::sqrt( value ); } ); //no complex numbers
+      break;
+    case opSIN:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return std::sin( value ); } );
+      break;
+    case opCOS:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return std::cos( value ); } );
+      break;
+    case opTAN:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return std::tan( value ); } );
+      break;
+    case opASIN:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return std::asin( value ); } );
+      break;
+    case opACOS:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return std::acos( value ); } );
+      break;
+    case opATAN:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return std::atan( value ); } );
+      break;
+    case opSIGN:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return -value; } );
+      break;
+    case opLOG:
+      applyOneArgumentOp( mData, nEntries, nodata, [nodata]( double value ) { return value <= 0 ? nodata : ::log( value ); } );
+      break;
+    case opLOG10:
+      applyOneArgumentOp( mData, nEntries, nodata, [nodata]( double value ) { return value <= 0 ? nodata : ::log10( value ); } );
+      break;
+    case opABS:
+      applyOneArgumentOp( mData, nEntries, nodata, []( double value ) { return ::fabs( value ); } );
+      break;
   }
-  return mNodataValue;
+  return true;
 }
 
 bool QgsRasterMatrix::twoArgumentOperation( TwoArgOperator op, const QgsRasterMatrix &other )
 {
   if ( isNumber() && other.isNumber() ) //operation on two 1x1 matrices
   {
-    //operations with nodata values always generate nodata
-    if ( mData[0] == mNodataValue || other.number() == other.nodataValue() )
-    {
-      mData[0] = mNodataValue;
-    }
-    else
-    {
-      mData[0] = calculateTwoArgumentOp( op, mData[0], other.number() );
-    }
+    dispatchTwoArgumentOp( op, mData, ScalarArgument( mData[0] ), ScalarArgument( other.number() ), 1, mNodataValue, other.mNodataValue, mNodataValue );
     return true;
   }
 
   //two matrices
   if ( !isNumber() && !other.isNumber() )
   {
-    double *matrix = other.mData;
-    int nEntries = mColumns * mRows;
-    double value1, value2;
-
-    for ( int i = 0; i < nEntries; ++i )
-    {
-      value1 = mData[i];
-      value2 = matrix[i];
-      if ( value1 == mNodataValue || value2 == other.mNodataValue )
-      {
-        mData[i] = mNodataValue;
-      }
-      else
-      {
-        mData[i] = calculateTwoArgumentOp( op, value1, value2 );
-      }
-    }
+    const std::size_t nEntries = static_cast< std::size_t >( mColumns ) * static_cast< std::size_t >( mRows );
+    dispatchTwoArgumentOp( op, mData, ArrayArgument( mData ), ArrayArgument( other.mData ), nEntries, mNodataValue, other.mNodataValue, mNodataValue );
     return true;
   }
 
   //this matrix is a single number and the other one a real matrix
   if ( isNumber() )
   {
-    double *matrix = other.mData;
-    int nEntries = other.nColumns() * other.nRows();
+    const std::size_t nEntries = static_cast< std::size_t >( other.nColumns() ) * static_cast< std::size_t >( other.nRows() );
     double value = mData[0];
     delete[] mData;
     mData = new double[nEntries];
@@ -382,53 +381,24 @@ bool QgsRasterMatrix::twoArgumentOperation( TwoArgOperator op, const QgsRasterMa
 
     if ( value == mNodataValue )
     {
-      for ( int i = 0; i < nEntries; ++i )
-      {
-        mData[i] = mNodataValue;
-      }
+      std::fill( mData, mData + nEntries, mNodataValue );
       return true;
     }
 
-    for ( int i = 0; i < nEntries; ++i )
-    {
-      if ( matrix[i] == other.mNodataValue )
-      {
-        mData[i] = mNodataValue;
-        continue;
-      }
-
-      mData[i] = calculateTwoArgumentOp( op, value, matrix[i] );
-    }
+    dispatchTwoArgumentOp( op, mData, ScalarArgument( value ), ArrayArgument( other.mData ), nEntries, mNodataValue, other.mNodataValue, mNodataValue );
     return true;
   }
   else //this matrix is a real matrix and the other a number
   {
-    double value = other.number();
-    int nEntries = mColumns * mRows;
+    const std::size_t nEntries = static_cast< std::size_t >( mColumns ) * static_cast< std::size_t >( mRows );
 
     if ( other.number() == other.mNodataValue )
     {
-      for ( int i = 0; i < nEntries; ++i )
-      {
-        mData[i] = mNodataValue;
-      }
+      std::fill( mData, mData + nEntries, mNodataValue );
       return true;
     }
 
-    for ( int i = 0; i < nEntries; ++i )
-    {
-      if ( mData[i] == mNodataValue )
-      {
-        continue;
-      }
-
-      mData[i] = calculateTwoArgumentOp( op, mData[i], value );
-    }
+    dispatchTwoArgumentOp( op, mData, ArrayArgument( mData ), ScalarArgument( other.number() ), nEntries, mNodataValue, other.mNodataValue, mNodataValue );
     return true;
   }
 }
-
-bool QgsRasterMatrix::testPowerValidity( double base, double power ) const
-{
-  return !( ( base == 0 && power < 0 ) || ( base < 0 && ( power - std::floor( power ) ) > 0 ) );
-}
@@ -152,11 +152,9 @@ class ANALYSIS_EXPORT QgsRasterMatrix
 
     //! +,-,*,/,^,<,>,<=,>=,=,!=, and, or
     bool twoArgumentOperation( TwoArgOperator op, const QgsRasterMatrix &other );
-    double calculateTwoArgumentOp( TwoArgOperator op, double arg1, double arg2 ) const;
 
     /*sqrt, std::sin, std::cos, tan, asin, acos, atan*/
     bool oneArgumentOperation( OneArgOperator op );
-    bool testPowerValidity( double base, double power ) const;
 };
 
 #endif // QGSRASTERMATRIX_H
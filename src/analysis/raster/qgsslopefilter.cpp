@@ -17,6 +17,8 @@
 
 #include "qgsslopefilter.h"
 #include <cmath>
+#include <typeinfo>
+#include <vector>
 
 QgsSlopeFilter::QgsSlopeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
@@ -40,3 +42,32 @@ float QgsSlopeFilter::processNineCellWindow(
   return std::atan( std::sqrt( derX * derX + derY * derY ) ) * 180.0 / M_PI;
 }
 
+void QgsSlopeFilter::processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width )
+{
+  if ( typeid( *this ) != typeid( QgsSlopeFilter ) )
+  {
+    QgsNineCellFilter::processNineCellRow( scanLine1, scanLine2, scanLine3, resultLine, width );
+    return;
+  }
+
+  std::vector< float > derX( width );
+  std::vector< float > derY( width );
+  calcFirstDerivatives( scanLine1, scanLine2, scanLine3, width, derX.data(), derY.data() );
+
+  for ( int i = 0; i < width; ++i )
+  {
+    if ( derX[i] == mOutputNodataValue || derY[i] == mOutputNodataValue )
+    {
+      resultLine[i] = mOutputNodataValue;
+    }
+    else
+    {
+      resultLine[i] = std::atan( std::sqrt( derX[i] * derX[i] + derY[i] * derY[i] ) ) * 180.0 / M_PI;
+    }
+  }
+}
+
+bool QgsSlopeFilter::supportsParallelRows() const
+{
+  return typeid( *this ) == typeid( QgsSlopeFilter );
+}
@@ -33,6 +33,8 @@ class ANALYSIS_EXPORT QgsSlopeFilter: public QgsDerivativeFilter
     float processNineCellWindow( float *x11, float *x21, float *x31,
                                  float *x12, float *x22, float *x32,
                                  float *x13, float *x23, float *x33 ) override;
+    void processNineCellRow( float *scanLine1, float *scanLine2, float *scanLine3, float *resultLine, int width ) override SIP_SKIP;
+    bool supportsParallelRows() const override SIP_SKIP;
 
 
 #ifdef HAVE_OPENCL
@@ -27,8 +27,13 @@
 #include "qgsrasterlayer.h"
 #include "qgslogger.h"
 #include "qgsproject.h"
+#include "qgsrasterblock.h"
+#include "qgsrasteriterator.h"
 
 #include <QFile>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 
 QgsZonalStatistics::QgsZonalStatistics( QgsVectorLayer *polygonLayer, QgsRasterLayer *rasterLayer, const QString &attributePrefix, int rasterBand, QgsZonalStatistics::Statistics stats )
   : QgsZonalStatistics( polygonLayer,
@@ -224,84 +229,45 @@ int QgsZonalStatistics::calculateStatistics( QgsFeedback *feedback )
   int featureCounter = 0;
 
   QgsChangedAttributesMap changeMap;
-  while ( fi.nextFeature( f ) )
-  {
-    if ( feedback && feedback->isCanceled() )
-    {
-      break;
-    }
-
-    if ( feedback )
-    {
-      feedback->setProgress( 100.0 * static_cast< double >( featureCounter ) / featureCount );
-    }
-
-    if ( !f.hasGeometry() )
-    {
-      ++featureCounter;
-      continue;
-    }
-    QgsGeometry featureGeometry = f.geometry();
-
-    QgsRectangle featureRect = featureGeometry.boundingBox().intersect( rasterBBox );
-    if ( featureRect.isEmpty() )
-    {
-      ++featureCounter;
-      continue;
-    }
-
-    int nCellsX, nCellsY;
-    QgsRectangle rasterBlockExtent;
-    QgsRasterAnalysisUtils::cellInfoForBBox( rasterBBox, featureRect, mCellSizeX, mCellSizeY, nCellsX, nCellsY, nCellsXProvider, nCellsYProvider, rasterBlockExtent );
-
-    featureStats.reset();
-    QgsRasterAnalysisUtils::statisticsFromMiddlePointTest( mRasterInterface, mRasterBand, featureGeometry, nCellsX, nCellsY, mCellSizeX, mCellSizeY,
-    rasterBlockExtent, [ &featureStats ]( double value ) { featureStats.addValue( value ); } );
-
-    if ( featureStats.count <= 1 )
-    {
-      //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
-      featureStats.reset();
-      QgsRasterAnalysisUtils::statisticsFromPreciseIntersection( mRasterInterface, mRasterBand, featureGeometry, nCellsX, nCellsY, mCellSizeX, mCellSizeY,
-      rasterBlockExtent, [ &featureStats ]( double value, double weight ) { featureStats.addValue( value, weight ); } );
-    }
 
-    //write the statistics value to the vector data provider
+  //write the statistics value to the vector data provider
+  auto addChangedAttributes = [&]( QgsFeatureId fid, FeatureStats & stats )
+  {
     QgsAttributeMap changeAttributeMap;
     if ( mStatistics & QgsZonalStatistics::Count )
-      changeAttributeMap.insert( countIndex, QVariant( featureStats.count ) );
+      changeAttributeMap.insert( countIndex, QVariant( stats.count ) );
     if ( mStatistics & QgsZonalStatistics::Sum )
-      changeAttributeMap.insert( sumIndex, QVariant( featureStats.sum ) );
-    if ( featureStats.count > 0 )
+      changeAttributeMap.insert( sumIndex, QVariant( stats.sum ) );
+    if ( stats.count > 0 )
     {
-      double mean = featureStats.sum / featureStats.count;
+      double mean = stats.sum / stats.count;
       if ( mStatistics & QgsZonalStatistics::Mean )
         changeAttributeMap.insert( meanIndex, QVariant( mean ) );
       if ( mStatistics & QgsZonalStatistics::Median )
       {
-        std::sort( featureStats.values.begin(), featureStats.values.end() );
-        int size = featureStats.values.count();
+        std::sort( stats.values.begin(), stats.values.end() );
+        int size = stats.values.count();
         bool even = ( size % 2 ) < 1;
         double medianValue;
         if ( even )
         {
-          medianValue = ( featureStats.values.at( size / 2 - 1 ) + featureStats.values.at( size / 2 ) ) / 2;
+          medianValue = ( stats.values.at( size / 2 - 1 ) + stats.values.at( size / 2 ) ) / 2;
         }
         else //odd
         {
-          medianValue = featureStats.values.at( ( size + 1 ) / 2 - 1 );
+          medianValue = stats.values.at( ( size + 1 ) / 2 - 1 );
         }
         changeAttributeMap.insert( medianIndex, QVariant( medianValue ) );
       }
       if ( mStatistics & QgsZonalStatistics::StDev || mStatistics & QgsZonalStatistics::Variance )
       {
         double sumSquared = 0;
-        for ( int i = 0; i < featureStats.values.count(); ++i )
+        for ( int i = 0; i < stats.values.count(); ++i )
         {
-          double diff = featureStats.values.at( i ) - mean;
+          double diff = stats.values.at( i ) - mean;
           sumSquared += diff * diff;
         }
-        double variance = sumSquared / featureStats.values.count();
+        double variance = sumSquared / stats.values.count();
         if ( mStatistics & QgsZonalStatistics::StDev )
         {
           double stdev = std::pow( variance, 0.5 );
@@ -311,32 +277,95 @@ int QgsZonalStatistics::calculateStatistics( QgsFeedback *feedback )
           changeAttributeMap.insert( varianceIndex, QVariant( variance ) );
       }
       if ( mStatistics & QgsZonalStatistics::Min )
-        changeAttributeMap.insert( minIndex, QVariant( featureStats.min ) );
+        changeAttributeMap.insert( minIndex, QVariant( stats.min ) );
       if ( mStatistics & QgsZonalStatistics::Max )
-        changeAttributeMap.insert( maxIndex, QVariant( featureStats.max ) );
+        changeAttributeMap.insert( maxIndex, QVariant( stats.max ) );
       if ( mStatistics & QgsZonalStatistics::Range )
-        changeAttributeMap.insert( rangeIndex, QVariant( featureStats.max - featureStats.min ) );
+        changeAttributeMap.insert( rangeIndex, QVariant( stats.max - stats.min ) );
       if ( mStatistics & QgsZonalStatistics::Minority || mStatistics & QgsZonalStatistics::Majority )
       {
-        QList<int> vals = featureStats.valueCount.values();
+        QList<int> vals = stats.valueCount.values();
         std::sort( vals.begin(), vals.end() );
         if ( mStatistics & QgsZonalStatistics::Minority )
         {
-          double minorityKey = featureStats.valueCount.key( vals.first() );
+          double minorityKey = stats.valueCount.key( vals.first() );
           changeAttributeMap.insert( minorityIndex, QVariant( minorityKey ) );
         }
         if ( mStatistics & QgsZonalStatistics::Majority )
         {
-          double majKey = featureStats.valueCount.key( vals.last() );
+          double majKey = stats.valueCount.key( vals.last() );
           changeAttributeMap.insert( majorityIndex, QVariant( majKey ) );
         }
       }
       if ( mStatistics & QgsZonalStatistics::Variety )
-        changeAttributeMap.insert( varietyIndex, QVariant( featureStats.valueCount.count() ) );
+        changeAttributeMap.insert( varietyIndex, QVariant( stats.valueCount.count() ) );
+    }
+
+    changeMap.insert( fid, changeAttributeMap );
+  };
+
+  if ( mRasterizationMethod == ScanlineRasterization )
+  {
+    std::vector< std::pair< QgsFeatureId, FeatureStats > > results;
+    if ( !calculateScanlineStatistics( fi, featureStats, results, feedback ) )
+    {
+      // zones are accumulated tile by tile, so when canceled the statistics of every zone may be
+      // incomplete: don't write any of them
+      mPolygonLayer->updateFields();
+      return 9;
+    }
+    for ( auto &result : results )
+    {
+      addChangedAttributes( result.first, result.second );
     }
+  }
+  else
+  {
+    while ( fi.nextFeature( f ) )
+    {
+      if ( feedback && feedback->isCanceled() )
+      {
+        break;
+      }
+
+      if ( feedback )
+      {
+        feedback->setProgress( 100.0 * static_cast< double >( featureCounter ) / featureCount );
+      }
+
+      if ( !f.hasGeometry() )
+      {
+        ++featureCounter;
+        continue;
+      }
+      QgsGeometry featureGeometry = f.geometry();
 
-    changeMap.insert( f.id(), changeAttributeMap );
-    ++featureCounter;
+      QgsRectangle featureRect = featureGeometry.boundingBox().intersect( rasterBBox );
+      if ( featureRect.isEmpty() )
+      {
+        ++featureCounter;
+        continue;
+      }
+
+      int nCellsX, nCellsY;
+      QgsRectangle rasterBlockExtent;
+      QgsRasterAnalysisUtils::cellInfoForBBox( rasterBBox, featureRect, mCellSizeX, mCellSizeY, nCellsX, nCellsY, nCellsXProvider, nCellsYProvider, rasterBlockExtent );
+
+      featureStats.reset();
+      QgsRasterAnalysisUtils::statisticsFromMiddlePointTest( mRasterInterface, mRasterBand, featureGeometry, nCellsX, nCellsY, mCellSizeX, mCellSizeY,
+      rasterBlockExtent, [ &featureStats ]( double value ) { featureStats.addValue( value ); } );
+
+      if ( featureStats.count <= 1 )
+      {
+        //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
+        featureStats.reset();
+        QgsRasterAnalysisUtils::statisticsFromPreciseIntersection( mRasterInterface, mRasterBand, featureGeometry, nCellsX, nCellsY, mCellSizeX, mCellSizeY,
+        rasterBlockExtent, [ &featureStats ]( double value, double weight ) { featureStats.addValue( value, weight ); } );
+      }
+
+      addChangedAttributes( f.id(), featureStats );
+      ++featureCounter;
+    }
   }
 
   vectorProvider->changeAttributeValues( changeMap );
@@ -356,6 +385,193 @@ int QgsZonalStatistics::calculateStatistics( QgsFeedback *feedback )
   return 0;
 }
 
+bool QgsZonalStatistics::calculateScanlineStatistics( QgsFeatureIterator &zones, const FeatureStats &prototype,
+    std::vector< std::pair< QgsFeatureId, FeatureStats > > &results, QgsFeedback *feedback )
+{
+  const QgsRectangle rasterBBox = mRasterInterface->extent();
+  const int rasterWidth = mRasterInterface->xSize();
+  const int rasterHeight = mRasterInterface->ySize();
+
+  const int tileWidth = QgsRasterIterator::DEFAULT_MAXIMUM_TILE_WIDTH;
+  const int tileHeight = QgsRasterIterator::DEFAULT_MAXIMUM_TILE_HEIGHT;
+  const int tileColumns = static_cast< int >( std::ceil( static_cast< double >( rasterWidth ) / tileWidth ) );
+  const int tileRows = static_cast< int >( std::ceil( static_cast< double >( rasterHeight ) / tileHeight ) );
+  const int tileCount = tileColumns * tileRows;
+
+  struct Zone
+  {
+    explicit Zone( const QgsGeometry &geometry )
+      : rasterizer( geometry )
+    {}
+
+    QgsRasterAnalysisUtils::ScanlineRasterizer rasterizer;
+    QgsRectangle blockExtent;
+    int firstColumn = 0;
+    int firstRow = 0;
+    int nCellsX = 0;
+    int nCellsY = 0;
+  };
+
+  // first pass: prepare all zones and bin them into the raster tiles they cover
+  std::vector< Zone > preparedZones;
+  std::vector< std::vector< std::size_t > > tileZones( static_cast< std::size_t >( tileCount ) );
+  QgsFeature f;
+  while ( zones.nextFeature( f ) )
+  {
+    if ( feedback && feedback->isCanceled() )
+      return false;
+
+    if ( !f.hasGeometry() )
+      continue;
+
+    const QgsGeometry featureGeometry = f.geometry();
+    const QgsRectangle featureRect = featureGeometry.boundingBox().intersect( rasterBBox );
+    if ( featureRect.isEmpty() )
+      continue;
+
+    Zone zone( featureGeometry );
+    QgsRasterAnalysisUtils::cellInfoForBBox( rasterBBox, featureRect, mCellSizeX, mCellSizeY, zone.nCellsX, zone.nCellsY, rasterWidth, rasterHeight, zone.blockExtent );
+    zone.firstColumn = static_cast< int >( std::round( ( zone.blockExtent.xMinimum() - rasterBBox.xMinimum() ) / mCellSizeX ) );
+    zone.firstRow = static_cast< int >( std::round( ( rasterBBox.yMaximum() - zone.blockExtent.yMaximum() ) / mCellSizeY ) );
+
+    const std::size_t zoneIndex = preparedZones.size();
+    if ( zone.nCellsX > 0 && zone.nCellsY > 0 && !zone.rasterizer.isEmpty() )
+    {
+      const int lastTileColumn = std::min( ( zone.firstColumn + zone.nCellsX - 1 ) / tileWidth, tileColumns - 1 );
+      const int lastTileRow = std::min( ( zone.firstRow + zone.nCellsY - 1 ) / tileHeight, tileRows - 1 );
+      for ( int tileRow = zone.firstRow / tileHeight; tileRow <= lastTileRow; ++tileRow )
+      {
+        for ( int tileColumn = zone.firstColumn / tileWidth; tileColumn <= lastTileColumn; ++tileColumn )
+        {
+          tileZones[ static_cast< std::size_t >( tileRow * tileColumns + tileColumn ) ].emplace_back( zoneIndex );
+        }
+      }
+    }
+    preparedZones.emplace_back( std::move( zone ) );
+    results.emplace_back( f.id(), prototype );
+  }
+
+  // raster data providers are not thread safe, so each worker reads through its own clone when possible
+  QMutex poolMutex;
+  QMutex sharedInterfaceMutex;
+  std::vector< std::unique_ptr< QgsRasterInterface > > interfacePool;
+  const bool canCloneInterface = static_cast< bool >( dynamic_cast< QgsRasterDataProvider * >( mRasterInterface ) );
+
+  struct TileJob
+  {
+    int tile = 0;
+    std::vector< std::pair< std::size_t, FeatureStats > > stats;
+  };
+
+  auto processTile = [&]( TileJob & job )
+  {
+    const std::vector< std::size_t > &zoneIndices = tileZones[ static_cast< std::size_t >( job.tile ) ];
+    if ( zoneIndices.empty() || ( feedback && feedback->isCanceled() ) )
+      return;
+
+    const int rowStart = ( job.tile / tileColumns ) * tileHeight;
+    const int rowEnd = std::min( rowStart + tileHeight, rasterHeight );
+    const int colStart = ( job.tile % tileColumns ) * tileWidth;
+    const int colEnd = std::min( colStart + tileWidth, rasterWidth );
+    const QgsRectangle tileExtent( rasterBBox.xMinimum() + colStart * mCellSizeX,
+                                   rasterBBox.yMaximum() - rowEnd * mCellSizeY,
+                                   rasterBBox.xMinimum() + colEnd * mCellSizeX,
+                                   rasterBBox.yMaximum() - rowStart * mCellSizeY );
+
+    std::unique_ptr< QgsRasterBlock > block;
+    if ( canCloneInterface )
+    {
+      std::unique_ptr< QgsRasterInterface > interface;
+      {
+        QMutexLocker locker( &poolMutex );
+        if ( !interfacePool.empty() )
+        {
+          interface = std::move( interfacePool.back() );
+          interfacePool.pop_back();
+        }
+        else
+        {
+          interface.reset( mRasterInterface->clone() );
+        }
+      }
+      if ( !interface )
+        return;
+
+      block.reset( interface->block( mRasterBand, tileExtent, colEnd - colStart, rowEnd - rowStart ) );
+
+      QMutexLocker locker( &poolMutex );
+      interfacePool.emplace_back( std::move( interface ) );
+    }
+    else
+    {
+      QMutexLocker locker( &sharedInterfaceMutex );
+      block.reset( mRasterInterface->block( mRasterBand, tileExtent, colEnd - colStart, rowEnd - rowStart ) );
+    }
+    if ( !block || !block->isValid() )
+      return;
+
+    bool isNoData = false;
+    for ( std::size_t zoneIndex : zoneIndices )
+    {
+      const Zone &zone = preparedZones[ zoneIndex ];
+      FeatureStats stats = prototype;
+      zone.rasterizer.rasterize( rasterBBox.xMinimum(), rasterBBox.yMaximum(), mCellSizeX, mCellSizeY,
+                                 std::max( rowStart, zone.firstRow ), std::min( rowEnd, zone.firstRow + zone.nCellsY ),
+                                 std::max( colStart, zone.firstColumn ), std::min( colEnd, zone.firstColumn + zone.nCellsX ),
+                                 [&]( int row, int firstColumn, int lastColumn )
+      {
+        for ( int col = firstColumn; col <= lastColumn; ++col )
+        {
+          const double pixelValue = block->valueAndNoData( row - rowStart, col - colStart, isNoData );
+          if ( QgsRasterAnalysisUtils::validPixel( pixelValue ) && !isNoData )
+            stats.addValue( pixelValue );
+        }
+      } );
+      if ( stats.count > 0 )
+        job.stats.emplace_back( zoneIndex, std::move( stats ) );
+    }
+  };
+
+  // second pass: read the raster once in tile order, processing batches of tiles in parallel. Tile results
+  // are merged in tile order so that the calculation is deterministic regardless of the thread count.
+  const int batchSize = std::max( 1, QThreadPool::globalInstance()->maxThreadCount() * 2 );
+  for ( int batchStart = 0; batchStart < tileCount; batchStart += batchSize )
+  {
+    if ( feedback && feedback->isCanceled() )
+      return false;
+
+    std::vector< TileJob > jobs( static_cast< std::size_t >( std::min( batchSize, tileCount - batchStart ) ) );
+    for ( std::size_t i = 0; i < jobs.size(); ++i )
+      jobs[i].tile = batchStart + static_cast< int >( i );
+
+    QtConcurrent::blockingMap( jobs, processTile );
+
+    for ( TileJob &job : jobs )
+    {
+      for ( auto &zoneStats : job.stats )
+        results[ zoneStats.first ].second.merge( zoneStats.second );
+    }
+
+    if ( feedback )
+      feedback->setProgress( 100.0 * static_cast< double >( batchStart + jobs.size() ) / tileCount );
+  }
+
+  for ( std::size_t i = 0; i < preparedZones.size(); ++i )
+  {
+    FeatureStats &featureStats = results[i].second;
+    if ( featureStats.count <= 1 )
+    {
+      //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
+      const Zone &zone = preparedZones[i];
+      featureStats.reset();
+      QgsRasterAnalysisUtils::statisticsFromPreciseIntersection( mRasterInterface, mRasterBand, zone.rasterizer.geometry(), zone.nCellsX, zone.nCellsY, mCellSizeX, mCellSizeY,
+      zone.blockExtent, [ &featureStats ]( double value, double weight ) { featureStats.addValue( value, weight ); } );
+    }
+  }
+
+  return true;
+}
+
 QString QgsZonalStatistics::getUniqueFieldName( const QString &fieldName, const QList<QgsField> &newFields )
 {
   QgsVectorDataProvider *dp = mPolygonLayer->dataProvider();
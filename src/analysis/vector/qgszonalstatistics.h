@@ -23,10 +23,12 @@
 
 #include <limits>
 #include <cfloat>
+#include <vector>
 
 #include "qgis_analysis.h"
 #include "qgsfeedback.h"
 #include "qgscoordinatereferencesystem.h"
+#include "qgsfeatureid.h"
 
 class QgsGeometry;
 class QgsVectorLayer;
@@ -35,6 +37,7 @@ class QgsRasterInterface;
 class QgsRasterDataProvider;
 class QgsRectangle;
 class QgsField;
+class QgsFeatureIterator;
 
 /**
  * \ingroup analysis
@@ -63,6 +66,16 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     };
     Q_DECLARE_FLAGS( Statistics, Statistic )
 
+    /**
+     * Methods for determining which raster cells belong to a zone.
+     * \since QGIS 3.16
+     */
+    enum RasterizationMethod
+    {
+      CellCenterTest, //!< Reads the raster window under each zone and tests every cell center against the zone geometry (default)
+      ScanlineRasterization, //!< Rasterizes the zones with a scanline algorithm and reads the raster once in tile order, processing tiles in parallel
+    };
+
     /**
      * Convenience constructor for QgsZonalStatistics, using an input raster layer.
      *
@@ -112,6 +125,26 @@ class ANALYSIS_EXPORT QgsZonalStatistics
                         int rasterBand = 1,
                         QgsZonalStatistics::Statistics stats = QgsZonalStatistics::Statistics( QgsZonalStatistics::Count | QgsZonalStatistics::Sum | QgsZonalStatistics::Mean ) );
 
+    /**
+     * Returns the method used to determine which raster cells belong to each zone.
+     * \see setRasterizationMethod()
+     * \since QGIS 3.16
+     */
+    RasterizationMethod rasterizationMethod() const { return mRasterizationMethod; }
+
+    /**
+     * Sets the \a method used to determine which raster cells belong to each zone.
+     *
+     * Both methods consider a cell to be part of a zone when its center lies inside the zone, and
+     * fall back to a precise pixel-polygon intersection for zones smaller than a raster cell, so they
+     * give the same results. The ScanlineRasterization method is much faster when calculating statistics
+     * for a large number of zones, at the cost of holding the zone geometries in memory.
+     *
+     * \see rasterizationMethod()
+     * \since QGIS 3.16
+     */
+    void setRasterizationMethod( RasterizationMethod method ) { mRasterizationMethod = method; }
+
     /**
      * Starts the calculation
      * \returns 0 in case of success
@@ -173,6 +206,23 @@ class ANALYSIS_EXPORT QgsZonalStatistics
           if ( mStoreValues )
             values.append( value );
         }
+
+        //! Merges the values collected by \a other into these statistics
+        void merge( const FeatureStats &other )
+        {
+          sum += other.sum;
+          count += other.count;
+          min = std::min( min, other.min );
+          max = std::max( max, other.max );
+          if ( mStoreValueCounts )
+          {
+            for ( auto it = other.valueCount.constBegin(); it != other.valueCount.constEnd(); ++it )
+              valueCount.insert( it.key(), valueCount.value( it.key(), 0 ) + it.value() );
+          }
+          if ( mStoreValues )
+            values.append( other.values );
+        }
+
         double sum = 0.0;
         double count = 0.0;
         double max = std::numeric_limits<double>::lowest();
@@ -187,6 +237,14 @@ class ANALYSIS_EXPORT QgsZonalStatistics
 
     QString getUniqueFieldName( const QString &fieldName, const QList<QgsField> &newFields );
 
+    /**
+     * Collects statistics for all features from \a zones using scanline rasterization, reading the raster
+     * in tile order and processing tiles in parallel. Results are appended to \a results in feature order.
+     * \returns FALSE if the calculation was canceled
+     */
+    bool calculateScanlineStatistics( QgsFeatureIterator &zones, const FeatureStats &prototype,
+                                      std::vector< std::pair< QgsFeatureId, FeatureStats > > &results, QgsFeedback *feedback );
+
     QgsRasterInterface *mRasterInterface = nullptr;
     QgsCoordinateReferenceSystem mRasterCrs;
 
@@ -198,6 +256,7 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     QgsVectorLayer *mPolygonLayer = nullptr;
     QString mAttributePrefix;
     Statistics mStatistics = QgsZonalStatistics::All;
+    RasterizationMethod mRasterizationMethod = CellCenterTest;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( QgsZonalStatistics::Statistics )
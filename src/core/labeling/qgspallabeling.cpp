@@ -69,6 +69,7 @@
 #include "callouts/qgscalloutsregistry.h"
 #include "qgsvectortilelayer.h"
 #include "qgsvectortilebasiclabeling.h"
+#include "textrenderer/qgstextmetricscache_p.h"
 #include <QMessageBox>
 
 using namespace pal;
@@ -1514,13 +1515,20 @@ void QgsPalLayerSettings::calculateLabelSize( const QFontMetricsF *fm, const QSt
     wrapchr = QStringLiteral( "\n" ); // default to new line delimiter
   }
 
+  // the label font metrics of internal calls are not bound to a device, so their text widths can be shared across renders
+  const QString fontKey = f == mCurFeat ? mCurFontKey : QString();
+  auto textWidth = [fm, &fontKey]( const QString & string ) -> double
+  {
+    return fontKey.isEmpty() ? fm->width( string ) : QgsTextMetricsCache::instance()->horizontalAdvance( fontKey, *fm, string );
+  };
+
   //consider the space needed for the direction symbol
   if ( addDirSymb && placement == QgsPalLayerSettings::Line
        && ( !leftDirSymb.isEmpty() || !rightDirSymb.isEmpty() ) )
   {
     QString dirSym = leftDirSymb;
 
-    if ( fm->width( rightDirSymb ) > fm->width( dirSym ) )
+    if ( textWidth( rightDirSymb ) > textWidth( dirSym ) )
       dirSym = rightDirSymb;
 
     switch ( placeDirSymb )
@@ -1561,7 +1569,7 @@ void QgsPalLayerSettings::calculateLabelSize( const QFontMetricsF *fm, const QSt
 
       for ( const auto &line : multiLineSplit )
       {
-        w = std::max( w, fm->width( line ) );
+        w = std::max( w, textWidth( line ) );
       }
       break;
     }
@@ -1586,7 +1594,7 @@ void QgsPalLayerSettings::calculateLabelSize( const QFontMetricsF *fm, const QSt
       double widthHorizontal = 0.0;
       for ( const auto &line : multiLineSplit )
       {
-        widthHorizontal = std::max( w, fm->width( line ) );
+        widthHorizontal = std::max( w, textWidth( line ) );
       }
 
       double widthVertical = 0.0;
@@ -1912,7 +1920,9 @@ void QgsPalLayerSettings::registerFeature( const QgsFeature &f, QgsRenderContext
     doc = QgsTextDocument::fromHtml( QStringList() << labelText );
 
   // also applies the line split to doc!
+  mCurFontKey = QgsTextMetricsCache::fontKey( labelFont );
   calculateLabelSize( labelFontMetrics.get(), labelText, labelX, labelY, mCurFeat, &context, &rotatedLabelX, &rotatedLabelY, format().allowHtmlFormatting() ? &doc : nullptr );
+  mCurFontKey.clear();
 
   // maximum angle between curved label characters (hardcoded defaults used in QGIS <2.0)
   //
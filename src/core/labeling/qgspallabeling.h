@@ -1197,6 +1197,9 @@ class CORE_EXPORT QgsPalLayerSettings
 
     bool mRenderStarted = false;
 
+    //! Font key of the label font metrics passed to calculateLabelSize() by registerFeature()
+    QString mCurFontKey;
+
     static void initPropertyDefinitions();
 };
 
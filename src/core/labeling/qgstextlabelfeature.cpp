@@ -22,6 +22,7 @@
 #include "qgstextcharacterformat.h"
 #include "qgstextfragment.h"
 #include "qgstextblock.h"
+#include "textrenderer/qgstextmetricscache_p.h"
 
 QgsTextLabelFeature::QgsTextLabelFeature( QgsFeatureId id, geos::unique_ptr geometry, QSizeF size )
   : QgsLabelFeature( id, std::move( geometry ), size )
@@ -78,11 +79,7 @@ void QgsTextLabelFeature::calculateInfo( bool curvedLabeling, QFontMetricsF *fm,
   double mapScale = xform->mapUnitsPerPixel();
   double labelHeight = mapScale * fm->height();
 
-  // mLetterSpacing/mWordSpacing = 0.0 is default for non-curved labels
-  // (non-curved spacings handled by Qt in QgsPalLayerSettings/QgsPalLabeling)
-  qreal charWidth;
-  qreal wordSpaceFix;
-
+  QVector< double > characterWidths;
   if ( document && curvedLabeling )
   {
     for ( const QgsTextBlock &block : qgis::as_const( *document ) )
@@ -97,43 +94,71 @@ void QgsTextLabelFeature::calculateInfo( bool curvedLabeling, QFontMetricsF *fm,
         }
       }
     }
+    characterWidths = calculateCharacterWidths( mClusters, curvedLabeling, fm, letterSpacing, wordSpacing );
   }
   else
   {
-    //split string by valid grapheme boundaries - required for certain scripts (see #6883)
-    mClusters = QgsPalLabeling::splitToGraphemes( mLabelText );
+    // the metrics are made from the defined font without a device, so the widths can be shared by all renders
+    QgsTextMetricsCache *cache = QgsTextMetricsCache::instance();
+    const QString fontKey = QgsTextMetricsCache::fontKey( mDefinedFont );
+    QgsTextMetricsCache::CharacterWidths cached;
+    if ( !cache->characterWidths( fontKey, curvedLabeling, mLabelText, cached ) )
+    {
+      const int generation = cache->generation();
+      //split string by valid grapheme boundaries - required for certain scripts (see #6883)
+      cached.graphemes = QgsPalLabeling::splitToGraphemes( mLabelText );
+      cached.widths = calculateCharacterWidths( cached.graphemes, curvedLabeling, fm, letterSpacing, wordSpacing );
+      cache->insertCharacterWidths( fontKey, curvedLabeling, mLabelText, cached, generation );
+    }
+    mClusters = cached.graphemes;
+    characterWidths = cached.widths;
   }
 
   mInfo = new pal::LabelInfo( mClusters.count(), labelHeight, maxinangle, maxoutangle );
   for ( int i = 0; i < mClusters.count(); i++ )
+  {
+    mInfo->char_info[i].width = mapScale * characterWidths.at( i );
+  }
+}
+
+QVector< double > QgsTextLabelFeature::calculateCharacterWidths( const QStringList &clusters, bool curvedLabeling, const QFontMetricsF *fm, qreal letterSpacing, qreal wordSpacing )
+{
+  // mLetterSpacing/mWordSpacing = 0.0 is default for non-curved labels
+  // (non-curved spacings handled by Qt in QgsPalLayerSettings/QgsPalLabeling)
+  qreal charWidth;
+  qreal wordSpaceFix;
+
+  QVector< double > widths;
+  widths.reserve( clusters.count() );
+  for ( int i = 0; i < clusters.count(); i++ )
   {
     // reconstruct how Qt creates word spacing, then adjust per individual stored character
     // this will allow PAL to create each candidate width = character width + correct spacing
-    charWidth = fm->width( mClusters[i] );
+    charWidth = fm->width( clusters[i] );
     if ( curvedLabeling )
     {
       wordSpaceFix = qreal( 0.0 );
-      if ( mClusters[i] == QLatin1String( " " ) )
+      if ( clusters[i] == QLatin1String( " " ) )
       {
         // word spacing only gets added once at end of consecutive run of spaces, see QTextEngine::shapeText()
         int nxt = i + 1;
-        wordSpaceFix = ( nxt < mClusters.count() && mClusters[nxt] != QLatin1String( " " ) ) ? wordSpacing : qreal( 0.0 );
+        wordSpaceFix = ( nxt < clusters.count() && clusters[nxt] != QLatin1String( " " ) ) ? wordSpacing : qreal( 0.0 );
       }
       // this workaround only works for clusters with a single character. Not sure how it should be handled
       // with multi-character clusters.
-      if ( mClusters[i].length() == 1 &&
-           !qgsDoubleNear( fm->width( QString( mClusters[i].at( 0 ) ) ), fm->width( mClusters[i].at( 0 ) ) + letterSpacing ) )
+      if ( clusters[i].length() == 1 &&
+           !qgsDoubleNear( fm->width( QString( clusters[i].at( 0 ) ) ), fm->width( clusters[i].at( 0 ) ) + letterSpacing ) )
       {
         // word spacing applied when it shouldn't be
         wordSpaceFix -= wordSpacing;
       }
 
-      charWidth = fm->width( QString( mClusters[i] ) ) + wordSpaceFix;
+      charWidth = fm->width( QString( clusters[i] ) ) + wordSpaceFix;
     }
 
-    double labelWidth = mapScale * charWidth;
-    mInfo->char_info[i].width = labelWidth;
+    widths << charWidth;
   }
+  return widths;
 }
 
 QgsTextDocument QgsTextLabelFeature::document() const
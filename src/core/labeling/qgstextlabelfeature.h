@@ -20,6 +20,8 @@
 #include "qgslabelfeature.h"
 #include "qgstextdocument.h"
 
+#include <QVector>
+
 class QgsTextCharacterFormat;
 
 /**
@@ -93,6 +95,14 @@ class QgsTextLabelFeature : public QgsLabelFeature
     void setDocument( const QgsTextDocument &document );
 
   protected:
+
+    /**
+     * Calculates the width in pixels of each of the \a clusters of a label, measured with \a fm.
+     *
+     * \since QGIS 3.16
+     */
+    static QVector< double > calculateCharacterWidths( const QStringList &clusters, bool curvedLabeling, const QFontMetricsF *fm, qreal letterSpacing, qreal wordSpacing );
+
     //! List of graphemes (used for curved labels)
     QStringList mClusters;
 
@@ -488,11 +488,18 @@ QList<LabelPosition *> Pal::solveProblem( Problem *prob, bool displayAll, QList<
   if ( !prob )
     return QList<LabelPosition *>();
 
-  prob->reduce();
-
   try
   {
-    prob->chain_search();
+    // large problems are split into independent parts, which are solved concurrently
+    if ( !prob->solveInParts() )
+    {
+      // don't start over with the whole problem if splitting it was canceled
+      if ( isCanceled() )
+        return QList<LabelPosition *>();
+
+      prob->reduce();
+      prob->chain_search();
+    }
   }
   catch ( InternalException::Empty & )
   {
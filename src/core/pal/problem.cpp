@@ -37,13 +37,62 @@
 #include "util.h"
 #include "priorityqueue.h"
 #include "internalexception.h"
+#include <atomic>
 #include <cfloat>
 #include <limits> //for std::numeric_limits<int>::max()
+#include <numeric>
 
 #include "qgslabelingengine.h"
 
+#include <QtConcurrentMap>
+
 using namespace pal;
 
+//! Minimum number of candidates in each part of a problem solved by Problem::solveInParts()
+static const int PART_MINIMUM_CANDIDATES = 4096;
+
+///@cond PRIVATE
+
+/**
+ * Disjoint sets of problem features, with the lowest feature id of each set as its root.
+ */
+class FeatureComponents
+{
+  public:
+
+    explicit FeatureComponents( std::size_t featureCount )
+      : mParents( featureCount )
+    {
+      std::iota( mParents.begin(), mParents.end(), 0 );
+    }
+
+    int find( int feature )
+    {
+      while ( mParents[feature] != feature )
+      {
+        mParents[feature] = mParents[mParents[feature]];
+        feature = mParents[feature];
+      }
+      return feature;
+    }
+
+    void unite( int feature1, int feature2 )
+    {
+      feature1 = find( feature1 );
+      feature2 = find( feature2 );
+      if ( feature1 < feature2 )
+        mParents[feature2] = feature1;
+      else if ( feature2 < feature1 )
+        mParents[feature1] = feature2;
+    }
+
+  private:
+
+    std::vector< int > mParents;
+};
+
+///@endcond
+
 inline void delete_chain( Chain *chain )
 {
   if ( chain )
@@ -55,7 +104,8 @@ inline void delete_chain( Chain *chain )
 }
 
 Problem::Problem( const QgsRectangle &extent )
-  : mAllCandidatesIndex( extent )
+  : mExtent( extent )
+  , mAllCandidatesIndex( extent )
   , mActiveCandidatesIndex( extent )
 {
 
@@ -654,6 +704,164 @@ void Problem::chain_search()
   delete[] ok;
 }
 
+bool Problem::solveInParts()
+{
+  if ( mTotalCandidates < 2 * PART_MINIMUM_CANDIDATES )
+    return false;
+
+  // features with conflicting candidates must be solved together, all others are independent
+  FeatureComponents components( mFeatureCount );
+
+  double amin[2];
+  double amax[2];
+  for ( std::size_t i = 0; i < mFeatureCount; i++ )
+  {
+    if ( pal->isCanceled() )
+      return false;
+
+    for ( int j = 0; j < mFeatNbLp[i]; j++ )
+    {
+      const LabelPosition *lp = mLabelPositions[ mFeatStartId[i] + j ].get();
+      lp->getBoundingBox( amin, amax );
+      mAllCandidatesIndex.intersects( QgsRectangle( amin[0], amin[1], amax[0], amax[1] ), [lp, &components]( const LabelPosition * lp2 ) -> bool
+      {
+        // conflicts are symmetric, so each pair of features only needs to be tested once
+        const int feature1 = lp->getProblemFeatureId();
+        const int feature2 = lp2->getProblemFeatureId();
+        if ( feature2 > feature1 && components.find( feature1 ) != components.find( feature2 ) && lp->isInConflict( lp2 ) )
+        {
+          components.unite( feature1, feature2 );
+        }
+        return true;
+      } );
+    }
+  }
+
+  // group components into parts of at least PART_MINIMUM_CANDIDATES candidates, in feature order
+  std::vector< int > componentCandidates( mFeatureCount, 0 );
+  for ( std::size_t i = 0; i < mFeatureCount; i++ )
+    componentCandidates[ components.find( static_cast< int >( i ) ) ] += mFeatNbLp[i];
+
+  std::vector< int > componentParts( mFeatureCount, -1 );
+  std::vector< std::vector< int > > partFeatures( 1 );
+  int partCandidates = 0;
+  for ( std::size_t i = 0; i < mFeatureCount; i++ )
+  {
+    const int component = components.find( static_cast< int >( i ) );
+    if ( componentParts[component] < 0 )
+    {
+      if ( partCandidates >= PART_MINIMUM_CANDIDATES )
+      {
+        partFeatures.emplace_back();
+        partCandidates = 0;
+      }
+      componentParts[component] = static_cast< int >( partFeatures.size() ) - 1;
+      partCandidates += componentCandidates[component];
+    }
+    partFeatures[ componentParts[component] ].emplace_back( static_cast< int >( i ) );
+  }
+
+  if ( partFeatures.size() < 2 )
+    return false;
+
+  // move the candidates of each part into a problem of its own, renumbering them
+  std::vector< std::unique_ptr< Problem > > parts;
+  parts.reserve( partFeatures.size() );
+  for ( const std::vector< int > &features : partFeatures )
+  {
+    std::unique_ptr< Problem > part = qgis::make_unique< Problem >( mExtent );
+    part->pal = pal;
+    part->mDisplayAll = mDisplayAll;
+    std::copy( mMapExtentBounds, mMapExtentBounds + 4, part->mMapExtentBounds );
+    part->mFeatureCount = features.size();
+    part->mFeatStartId.resize( features.size() );
+    part->mFeatNbLp.resize( features.size() );
+    part->mInactiveCost.resize( features.size() );
+
+    int overlaps = 0;
+    int idlp = 0;
+    for ( std::size_t k = 0; k < features.size(); k++ )
+    {
+      const int feature = features[k];
+      part->mFeatStartId[k] = idlp;
+      part->mFeatNbLp[k] = mFeatNbLp[feature];
+      part->mInactiveCost[k] = mInactiveCost[feature];
+
+      for ( int j = 0; j < mFeatNbLp[feature]; j++ )
+      {
+        std::unique_ptr< LabelPosition > &position = mLabelPositions[ mFeatStartId[feature] + j ];
+        position->setProblemIds( static_cast< int >( k ), idlp++ );
+        position->insertIntoIndex( part->mAllCandidatesIndex );
+        overlaps += position->getNumOverlaps();
+        part->mLabelPositions.emplace_back( std::move( position ) );
+      }
+    }
+    part->mTotalCandidates = idlp;
+    part->mAllNblp = idlp;
+    part->mNbOverlap = overlaps / 2;
+    parts.emplace_back( std::move( part ) );
+  }
+
+  std::atomic< bool > emptyPart( false );
+  QtConcurrent::blockingMap( parts, [&emptyPart]( std::unique_ptr< Problem > &part )
+  {
+    part->reduce();
+    try
+    {
+      part->chain_search();
+    }
+    catch ( InternalException::Empty & )
+    {
+      // reported once all candidates are back in this problem
+      part->mSol.activeLabelIds.assign( part->mFeatureCount, -1 );
+      emptyPart = true;
+    }
+  } );
+
+  // move the candidates back, restoring their ids, and merge the solutions
+  mSol.init( mFeatureCount );
+  mTotalCandidates = 0;
+  mNbOverlap = 0;
+  for ( std::size_t p = 0; p < parts.size(); p++ )
+  {
+    Problem *part = parts[p].get();
+    const std::vector< int > &features = partFeatures[p];
+    for ( std::size_t k = 0; k < features.size(); k++ )
+    {
+      const int feature = features[k];
+      const int startId = mFeatStartId[feature];
+      const int partStartId = part->mFeatStartId[k];
+      for ( int j = 0; j < mFeatNbLp[feature]; j++ )
+      {
+        std::unique_ptr< LabelPosition > &position = part->mLabelPositions[ partStartId + j ];
+        position->setProblemIds( feature, startId + j );
+        // candidates removed by the part's reduce()
+        if ( j >= part->mFeatNbLp[k] )
+          position->removeFromIndex( mAllCandidatesIndex );
+        mLabelPositions[ startId + j ] = std::move( position );
+      }
+      mFeatNbLp[feature] = part->mFeatNbLp[k];
+
+      const int labelId = part->mSol.activeLabelIds[k];
+      if ( labelId >= 0 && !emptyPart )
+      {
+        mSol.activeLabelIds[feature] = startId + labelId - partStartId;
+        mLabelPositions[ mSol.activeLabelIds[feature] ]->insertIntoIndex( mActiveCandidatesIndex );
+      }
+    }
+    mTotalCandidates += part->mTotalCandidates;
+    mNbOverlap += part->mNbOverlap;
+    mSol.totalCost += part->mSol.totalCost;
+  }
+
+  // a failed chain_search() leaves the whole problem without a solution, whether the
+  // problem was split or not
+  if ( emptyPart )
+    throw InternalException::Empty();
+
+  return true;
+}
+
 QList<LabelPosition *> Problem::getSolution( bool returnInactive, QList<LabelPosition *> *unlabeled )
 {
   QList<LabelPosition *> finalLabelPlacements;
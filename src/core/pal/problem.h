@@ -136,6 +136,23 @@ namespace pal
 
       void init_sol_falp();
 
+      /**
+       * Splits the problem into parts which have no conflicting candidates between each other,
+       * then reduces and solves these parts concurrently.
+       *
+       * Features are assigned to parts in their problem order, so the solution does not depend
+       * on the number of threads used. Returns FALSE if the problem is too small or too dense to
+       * be split, in which case it is left untouched and should be solved with reduce() and
+       * chain_search() instead, or if labeling was canceled while splitting it.
+       *
+       * \throws InternalException::Empty if chain_search() throws it for any part, so that callers
+       * handle it as a failure of the whole problem. The candidates are then back in this problem,
+       * with no active label.
+       *
+       * \since QGIS 3.16
+       */
+      bool solveInParts();
+
       /**
        * Returns a reference to the list of label positions which correspond to
        * features with no candidates.
@@ -154,6 +171,11 @@ namespace pal
 
     private:
 
+      /**
+       * Bounds of the incoming coordinates
+       */
+      QgsRectangle mExtent;
+
       /**
        * Total number of layers containing labels
        */
@@ -40,7 +40,81 @@ void QgsAbstractContentCacheBase::onRemoteContentFetched( const QString &, bool
 
 }
 
+///@cond PRIVATE
 
+//
+// QgsContentCacheImageShards
+//
 
+QgsContentCacheImageShards::QgsContentCacheImageShards( long maximumSize )
+  : mMaximumShardSize( maximumSize / SHARD_COUNT )
+{
+}
 
+int QgsContentCacheImageShards::generation() const
+{
+  return mGeneration.load();
+}
+
+bool QgsContentCacheImageShards::image( const QString &key, int expiryTimeout, QImage &image, bool *isMissing ) const
+{
+  if ( expiryTimeout <= 0 )
+    return false;
+
+  const Shard &keyShard = shard( key );
+  QReadLocker locker( &keyShard.lock );
+  auto it = keyShard.entries.constFind( key );
+  if ( it == keyShard.entries.constEnd() || it->age.hasExpired( expiryTimeout ) )
+    return false;
+
+  image = it->image;
+  if ( isMissing )
+    *isMissing = it->isMissing;
+  return true;
+}
+
+void QgsContentCacheImageShards::insert( const QString &key, const QImage &image, bool isMissing, int generation )
+{
+  const long imageSize = static_cast< long >( image.bytesPerLine() ) * image.height();
+  if ( imageSize > mMaximumShardSize )
+    return;
+
+  Shard &keyShard = shard( key );
+  QWriteLocker locker( &keyShard.lock );
+  // checked while holding the shard lock, so that a concurrent clear() either removes this image or rejects it
+  if ( generation != mGeneration.load() )
+    return;
+
+  auto it = keyShard.entries.find( key );
+  if ( it != keyShard.entries.end() )
+  {
+    keyShard.size -= static_cast< long >( it->image.bytesPerLine() ) * it->image.height();
+    keyShard.entries.erase( it );
+  }
+
+  if ( keyShard.size + imageSize > mMaximumShardSize )
+  {
+    // rendered images are cheap to look up again from the owning cache, so simply start over
+    keyShard.entries.clear();
+    keyShard.size = 0;
+  }
+
+  Entry &entry = keyShard.entries[ key ];
+  entry.image = image;
+  entry.isMissing = isMissing;
+  entry.age.start();
+  keyShard.size += imageSize;
+}
+
+void QgsContentCacheImageShards::clear()
+{
+  mGeneration.fetchAndAddOrdered( 1 );
+  for ( Shard &imageShard : mShards )
+  {
+    QWriteLocker locker( &imageShard.lock );
+    imageShard.entries.clear();
+    imageShard.size = 0;
+  }
+}
 
+///@endcond
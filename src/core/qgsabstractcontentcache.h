@@ -27,6 +27,10 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QImage>
 #include <QCache>
 #include <QSet>
 #include <QDateTime>
@@ -172,6 +176,80 @@ class CORE_EXPORT QgsAbstractContentCacheBase: public QObject
 
 #ifndef SIP_RUN
 
+///@cond PRIVATE
+
+/**
+ * \class QgsContentCacheImageShards
+ * \ingroup core
+ * Lookup of the images already rendered by a content cache.
+ *
+ * The images are split over SHARD_COUNT shards, each one guarded by its own read-write lock, so
+ * that threads looking up images which are already rendered neither block each other nor wait for
+ * the cache mutex while another thread renders new content.
+ *
+ * Images are only returned for an expiry timeout after they were inserted, so that changes to
+ * the underlying files are still detected by the owning cache. Each call to clear() starts a
+ * new generation, and images rendered for an older generation are not inserted.
+ *
+ * All methods are thread safe.
+ *
+ * \note Not available in Python bindings.
+ * \since QGIS 3.16
+ */
+class CORE_EXPORT QgsContentCacheImageShards
+{
+  public:
+
+    //! Number of shards
+    static const int SHARD_COUNT = 16;
+
+    /**
+     * Constructor for QgsContentCacheImageShards, holding up to \a maximumSize bytes of images.
+     */
+    explicit QgsContentCacheImageShards( long maximumSize );
+
+    //! Returns the current generation, which must be passed to insert()
+    int generation() const;
+
+    /**
+     * Looks up the image with a matching \a key, and if it was inserted less than \a expiryTimeout
+     * milliseconds ago copies it to \a image and sets \a isMissing to the matching flag.
+     * Returns TRUE if the image was found.
+     */
+    bool image( const QString &key, int expiryTimeout, QImage &image, bool *isMissing = nullptr ) const;
+
+    //! Inserts a rendered image, unless the shards were cleared since \a generation was retrieved
+    void insert( const QString &key, const QImage &image, bool isMissing, int generation );
+
+    //! Removes all images and starts a new generation
+    void clear();
+
+  private:
+
+    struct Entry
+    {
+      QImage image;
+      bool isMissing = false;
+      QElapsedTimer age;
+    };
+
+    struct Shard
+    {
+      mutable QReadWriteLock lock;
+      QHash< QString, Entry > entries;
+      long size = 0;
+    };
+
+    Shard &shard( const QString &key ) { return mShards[ qHash( key ) % SHARD_COUNT ]; }
+    const Shard &shard( const QString &key ) const { return mShards[ qHash( key ) % SHARD_COUNT ]; }
+
+    Shard mShards[ SHARD_COUNT ];
+    QAtomicInt mGeneration;
+    long mMaximumShardSize = 0;
+};
+
+///@endcond
+
 /**
  * \class QgsAbstractContentCache
  * \ingroup core
@@ -209,6 +287,7 @@ class CORE_EXPORT QgsAbstractContentCache : public QgsAbstractContentCacheBase
       : QgsAbstractContentCacheBase( parent )
       , mMutex( QMutex::Recursive )
       , mMaxCacheSize( maxCacheSize )
+      , mRenderedImages( maxCacheSize )
       , mFileModifiedCheckTimeout( fileModifiedCheckTimeout )
       , mTypeString( typeString.isEmpty() ? QObject::tr( "Content" ) : typeString )
     {
@@ -434,6 +513,9 @@ class CORE_EXPORT QgsAbstractContentCache : public QgsAbstractContentCacheBase
       QMutexLocker locker( &mMutex );
       mPendingRemoteUrls.remove( url );
 
+      // images may have been rendered from the placeholder content
+      mRenderedImages.clear();
+
       T *nextEntry = mLeastRecentEntry;
       while ( T *entry = nextEntry )
       {
@@ -553,6 +635,43 @@ class CORE_EXPORT QgsAbstractContentCache : public QgsAbstractContentCacheBase
     //! Maximum cache size
     long mMaxCacheSize = 20000000;
 
+    /**
+     * Returns the generation of the rendered images, which must be retrieved before the content
+     * of an image is read and passed to insertRenderedImage().
+     *
+     * \since QGIS 3.16
+     */
+    int renderedImageGeneration() const
+    {
+      return mRenderedImages.generation();
+    }
+
+    /**
+     * Looks up an image rendered with the matching \a key, without locking the cache mutex.
+     *
+     * Images are only returned as long as the files they were rendered from would not be checked
+     * for changes. Returns TRUE if the image was found.
+     *
+     * \since QGIS 3.16
+     */
+    bool renderedImage( const QString &key, QImage &image, bool *isMissing = nullptr ) const
+    {
+      return mRenderedImages.image( key, mFileModifiedCheckTimeout, image, isMissing );
+    }
+
+    /**
+     * Inserts an \a image rendered by the cache, so that it is returned by renderedImage().
+     *
+     * The image is not inserted if the cache content was invalidated since \a generation
+     * was retrieved.
+     *
+     * \since QGIS 3.16
+     */
+    void insertRenderedImage( const QString &key, const QImage &image, bool isMissing, int generation )
+    {
+      mRenderedImages.insert( key, image, isMissing, generation );
+    }
+
   private:
 
     /**
@@ -640,6 +759,9 @@ class CORE_EXPORT QgsAbstractContentCache : public QgsAbstractContentCacheBase
     //! Entry pointers accessible by file name
     QMultiHash< QString, T * > mEntryLookup;
 
+    //! Images already rendered by the cache, which may be looked up without locking the cache mutex
+    QgsContentCacheImageShards mRenderedImages;
+
     //! Minimum time (in ms) between consecutive file modified time checks
     int mFileModifiedCheckTimeout = 30000;
 
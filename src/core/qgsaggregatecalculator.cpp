@@ -21,6 +21,9 @@
 #include "qgsfeatureiterator.h"
 #include "qgsgeometry.h"
 #include "qgsvectorlayer.h"
+#include "qgsvectorlayercache.h"
+
+#include <QThread>
 
 
 
@@ -106,7 +109,7 @@ QVariant QgsAggregateCalculator::calculate( QgsAggregateCalculator::Aggregate ag
     QgsFeatureRequest testRequest( request );
     testRequest.setLimit( 1 );
     QgsFeature f;
-    QgsFeatureIterator fit = mLayer->getFeatures( testRequest );
+    QgsFeatureIterator fit = getFeatures( testRequest );
     if ( !fit.nextFeature( f ) )
     {
       //no matching features
@@ -123,10 +126,20 @@ QVariant QgsAggregateCalculator::calculate( QgsAggregateCalculator::Aggregate ag
   else
     resultType = mLayer->fields().at( attrNum ).type();
 
-  QgsFeatureIterator fit = mLayer->getFeatures( request );
+  QgsFeatureIterator fit = getFeatures( request );
   return calculate( aggregate, fit, resultType, attrNum, expression.get(), mDelimiter, context, ok );
 }
 
+QgsFeatureIterator QgsAggregateCalculator::getFeatures( const QgsFeatureRequest &request ) const
+{
+  // the shared cache of the layer can only be read from its own thread, e.g. not while rendering
+  QgsVectorLayerCache *cache = QgsVectorLayerCache::sharedCache( mLayer );
+  if ( cache && cache->hasFullCache() && QThread::currentThread() == cache->thread() )
+    return cache->getFeatures( request );
+
+  return mLayer->getFeatures( request );
+}
+
 QgsAggregateCalculator::Aggregate QgsAggregateCalculator::stringToAggregate( const QString &string, bool *ok )
 {
   QString normalized = string.trimmed().toLower();
@@ -236,6 +236,9 @@ class CORE_EXPORT QgsAggregateCalculator
                                         QgsExpressionContext *context, const QString &delimiter, bool unique = false );
 
     QVariant defaultValue( Aggregate aggregate ) const;
+
+    //! Returns the features of the layer for a \a request, read from the shared cache of the layer when it holds all features
+    QgsFeatureIterator getFeatures( const QgsFeatureRequest &request ) const;
 };
 
 #endif //QGSAGGREGATECALCULATOR_H
@@ -0,0 +1,276 @@
+/***************************************************************************
+                         qgsfeatureidranges.cpp
+                         ----------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsfeatureidranges.h"
+#include "qgis.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <limits>
+
+QgsFeatureIdRanges::QgsFeatureIdRanges( const QgsFeatureIds &ids )
+{
+  QVector< QgsFeatureId > sortedIds;
+  sortedIds.reserve( ids.size() );
+  for ( QgsFeatureId id : ids )
+    sortedIds << id;
+  build( sortedIds );
+}
+
+QgsFeatureIdRanges::QgsFeatureIdRanges( QVector< QgsFeatureId > ids )
+{
+  build( ids );
+}
+
+long long QgsFeatureIdRanges::count() const
+{
+  long long count = 0;
+  for ( const Range &range : mRanges )
+    count += range.last - range.first + 1;
+  return count;
+}
+
+bool QgsFeatureIdRanges::contains( QgsFeatureId id ) const
+{
+  const int index = upperBound( id ) - 1;
+  return index >= 0 && mRanges.at( index ).last >= id;
+}
+
+QgsFeatureIds QgsFeatureIdRanges::toFeatureIds() const
+{
+  QgsFeatureIds ids;
+  ids.reserve( static_cast< int >( std::min( count(), static_cast< long long >( std::numeric_limits< int >::max() ) ) ) );
+  for ( const Range &range : mRanges )
+  {
+    for ( QgsFeatureId id = range.first; ; ++id )
+    {
+      ids.insert( id );
+      if ( id == range.last )
+        break;
+    }
+  }
+  return ids;
+}
+
+void QgsFeatureIdRanges::insert( QgsFeatureId id )
+{
+  const int next = upperBound( id );
+  const int previous = next - 1;
+  if ( previous >= 0 && mRanges.at( previous ).last >= id )
+    return;
+
+  // id is lower than the first id of the next range and greater than the last id of the previous one
+  const bool joinsPrevious = previous >= 0 && mRanges.at( previous ).last + 1 == id;
+  const bool joinsNext = next < mRanges.size() && mRanges.at( next ).first - 1 == id;
+  if ( joinsPrevious && joinsNext )
+  {
+    mRanges[previous].last = mRanges.at( next ).last;
+    mRanges.remove( next );
+  }
+  else if ( joinsPrevious )
+  {
+    mRanges[previous].last = id;
+  }
+  else if ( joinsNext )
+  {
+    mRanges[next].first = id;
+  }
+  else
+  {
+    mRanges.insert( next, Range{ id, id } );
+  }
+}
+
+void QgsFeatureIdRanges::remove( QgsFeatureId id )
+{
+  const int index = upperBound( id ) - 1;
+  if ( index < 0 || mRanges.at( index ).last < id )
+    return;
+
+  Range &range = mRanges[index];
+  if ( range.first == range.last )
+  {
+    mRanges.remove( index );
+  }
+  else if ( range.first == id )
+  {
+    range.first = id + 1;
+  }
+  else if ( range.last == id )
+  {
+    range.last = id - 1;
+  }
+  else
+  {
+    const Range after{ id + 1, range.last };
+    range.last = id - 1;
+    mRanges.insert( index + 1, after );
+  }
+}
+
+QgsFeatureIdRanges &QgsFeatureIdRanges::unite( const QgsFeatureIdRanges &other )
+{
+  if ( other.isEmpty() )
+    return *this;
+
+  QVector< Range > result;
+  result.reserve( mRanges.size() + other.mRanges.size() );
+  int i = 0;
+  int j = 0;
+  while ( i < mRanges.size() || j < other.mRanges.size() )
+  {
+    if ( j == other.mRanges.size() || ( i < mRanges.size() && mRanges.at( i ).first <= other.mRanges.at( j ).first ) )
+      appendRange( result, mRanges.at( i++ ) );
+    else
+      appendRange( result, other.mRanges.at( j++ ) );
+  }
+  mRanges = result;
+  return *this;
+}
+
+QgsFeatureIdRanges &QgsFeatureIdRanges::intersect( const QgsFeatureIdRanges &other )
+{
+  QVector< Range > result;
+  int i = 0;
+  int j = 0;
+  while ( i < mRanges.size() && j < other.mRanges.size() )
+  {
+    const Range &a = mRanges.at( i );
+    const Range &b = other.mRanges.at( j );
+    const QgsFeatureId first = std::max( a.first, b.first );
+    const QgsFeatureId last = std::min( a.last, b.last );
+    if ( first <= last )
+      appendRange( result, Range{ first, last } );
+
+    if ( a.last < b.last )
+      ++i;
+    else
+      ++j;
+  }
+  mRanges = result;
+  return *this;
+}
+
+QgsFeatureIdRanges &QgsFeatureIdRanges::subtract( const QgsFeatureIdRanges &other )
+{
+  if ( isEmpty() || other.isEmpty() )
+    return *this;
+
+  QVector< Range > result;
+  result.reserve( mRanges.size() );
+  int j = 0;
+  for ( const Range &range : qgis::as_const( mRanges ) )
+  {
+    // skip the removed ranges before this one, they may still overlap the next range
+    while ( j < other.mRanges.size() && other.mRanges.at( j ).last < range.first )
+      ++j;
+
+    QgsFeatureId first = range.first;
+    bool removed = false;
+    for ( int k = j; k < other.mRanges.size() && other.mRanges.at( k ).first <= range.last; ++k )
+    {
+      const Range &removedRange = other.mRanges.at( k );
+      if ( removedRange.first > first )
+        appendRange( result, Range{ first, removedRange.first - 1 } );
+      if ( removedRange.last >= range.last )
+      {
+        removed = true;
+        break;
+      }
+      first = removedRange.last + 1;
+    }
+    if ( !removed )
+      appendRange( result, Range{ first, range.last } );
+  }
+  mRanges = result;
+  return *this;
+}
+
+QString QgsFeatureIdRanges::sqlWhereClause( const QString &column, int minimumRangeLength ) const
+{
+  QStringList terms;
+  QStringList values;
+  for ( const Range &range : mRanges )
+  {
+    if ( range.last - range.first + 1 >= minimumRangeLength )
+    {
+      terms << QStringLiteral( "%1 BETWEEN %2 AND %3" ).arg( column ).arg( range.first ).arg( range.last );
+      continue;
+    }
+
+    for ( QgsFeatureId id = range.first; ; ++id )
+    {
+      values << QString::number( id );
+      if ( id == range.last )
+        break;
+    }
+  }
+
+  if ( !values.isEmpty() )
+    terms.prepend( QStringLiteral( "%1 IN (%2)" ).arg( column, values.join( ',' ) ) );
+
+  if ( terms.size() > 1 )
+    return '(' + terms.join( QStringLiteral( " OR " ) ) + ')';
+  return terms.value( 0 );
+}
+
+void QgsFeatureIdRanges::build( QVector< QgsFeatureId > &ids )
+{
+  std::sort( ids.begin(), ids.end() );
+  for ( QgsFeatureId id : qgis::as_const( ids ) )
+    append( id );
+}
+
+void QgsFeatureIdRanges::appendRange( QVector< Range > &ranges, const Range &range )
+{
+  if ( !ranges.isEmpty() )
+  {
+    Range &last = ranges.last();
+    // overlapping or adjacent ranges are merged, without overflowing at the largest id
+    if ( range.first <= last.last || last.last + 1 == range.first )
+    {
+      last.last = std::max( last.last, range.last );
+      return;
+    }
+  }
+  ranges.append( range );
+}
+
+int QgsFeatureIdRanges::upperBound( QgsFeatureId id ) const
+{
+  const auto it = std::upper_bound( mRanges.constBegin(), mRanges.constEnd(), id, []( QgsFeatureId value, const Range & range )
+  {
+    return value < range.first;
+  } );
+  return static_cast< int >( it - mRanges.constBegin() );
+}
+
+void QgsFeatureIdRanges::append( QgsFeatureId id )
+{
+  if ( !mRanges.isEmpty() )
+  {
+    Range &last = mRanges.last();
+    if ( id <= last.last )
+      return;
+    if ( id == last.last + 1 )
+    {
+      last.last = id;
+      return;
+    }
+  }
+  mRanges.append( Range{ id, id } );
+}
@@ -0,0 +1,131 @@
+/***************************************************************************
+                         qgsfeatureidranges.h
+                         --------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSFEATUREIDRANGES_H
+#define QGSFEATUREIDRANGES_H
+
+#include "qgis_core.h"
+#include "qgsfeatureid.h"
+
+#include <QString>
+#include <QVector>
+
+#define SIP_NO_FILE
+
+/**
+ * \ingroup core
+ * \class QgsFeatureIdRanges
+ *
+ * A set of feature ids stored as sorted ranges of consecutive ids.
+ *
+ * Feature ids are mostly allocated sequentially, so large sets of ids such as selections of
+ * whole areas of a layer collapse to a few ranges. The selection of QgsVectorLayer and the
+ * deleted features of QgsVectorLayerEditBuffer are stored this way, and converted to
+ * QgsFeatureIds with toFeatureIds() where the API uses them. Providers use sqlWhereClause() to
+ * match the ranges with BETWEEN instead of listing every id.
+ *
+ * \note Not available in Python bindings.
+ * \since QGIS 3.16
+ */
+class CORE_EXPORT QgsFeatureIdRanges
+{
+  public:
+
+    //! Range of consecutive feature ids, including \a first and \a last
+    struct Range
+    {
+      QgsFeatureId first;
+      QgsFeatureId last;
+
+      bool operator==( const Range &other ) const { return first == other.first && last == other.last; }
+      bool operator!=( const Range &other ) const { return !( *this == other ); }
+    };
+
+    //! Constructor for an empty QgsFeatureIdRanges
+    QgsFeatureIdRanges() = default;
+
+    //! Constructor for QgsFeatureIdRanges containing the feature \a ids
+    explicit QgsFeatureIdRanges( const QgsFeatureIds &ids );
+
+    /**
+     * Constructor for QgsFeatureIdRanges containing the feature \a ids, which may be unsorted
+     * and contain duplicates.
+     */
+    explicit QgsFeatureIdRanges( QVector< QgsFeatureId > ids );
+
+    //! Returns the sorted, non overlapping and non adjacent ranges
+    const QVector< Range > &ranges() const { return mRanges; }
+
+    //! Returns TRUE if the set contains no feature id
+    bool isEmpty() const { return mRanges.isEmpty(); }
+
+    //! Returns the number of feature ids in the set
+    long long count() const;
+
+    //! Returns TRUE if the set contains the feature \a id
+    bool contains( QgsFeatureId id ) const;
+
+    //! Returns the feature ids of the set
+    QgsFeatureIds toFeatureIds() const;
+
+    //! Adds the feature \a id to the set
+    void insert( QgsFeatureId id );
+
+    //! Removes the feature \a id from the set
+    void remove( QgsFeatureId id );
+
+    //! Removes all feature ids from the set
+    void clear() { mRanges.clear(); }
+
+    //! Adds the feature ids of \a other to the set
+    QgsFeatureIdRanges &unite( const QgsFeatureIdRanges &other );
+
+    //! Removes the feature ids which are not contained in \a other from the set
+    QgsFeatureIdRanges &intersect( const QgsFeatureIdRanges &other );
+
+    //! Removes the feature ids of \a other from the set
+    QgsFeatureIdRanges &subtract( const QgsFeatureIdRanges &other );
+
+    /**
+     * Returns an SQL expression matching the values of the quoted \a column contained in the set,
+     * or an empty string if the set is empty.
+     *
+     * Ranges of at least \a minimumRangeLength ids are matched with BETWEEN, other ids are listed
+     * in a single IN clause.
+     */
+    QString sqlWhereClause( const QString &column, int minimumRangeLength = 3 ) const;
+
+    bool operator==( const QgsFeatureIdRanges &other ) const { return mRanges == other.mRanges; }
+    bool operator!=( const QgsFeatureIdRanges &other ) const { return mRanges != other.mRanges; }
+
+  private:
+
+    //! Sorts \a ids and builds the ranges from them
+    void build( QVector< QgsFeatureId > &ids );
+
+    //! Appends the feature \a id, which must not be lower than the ids already added
+    void append( QgsFeatureId id );
+
+    //! Appends a \a range to \a ranges, whose ranges must not start after it
+    static void appendRange( QVector< Range > &ranges, const Range &range );
+
+    //! Returns the index of the first range starting after \a id
+    int upperBound( QgsFeatureId id ) const;
+
+    QVector< Range > mRanges;
+};
+
+#endif // QGSFEATUREIDRANGES_H
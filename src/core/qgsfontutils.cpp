@@ -19,6 +19,7 @@
 #include "qgslogger.h"
 #include "qgssettings.h"
 #include "qgis.h"
+#include "qgstextmetricscache_p.h"
 
 #include <QApplication>
 #include <QFile>
@@ -281,6 +282,10 @@ bool QgsFontUtils::loadStandardTestFonts( const QStringList &loadstyles )
     }
   }
 
+  // newly available fonts may change how already measured text is shaped
+  if ( fontsLoaded )
+    QgsTextMetricsCache::instance()->clear();
+
   return fontsLoaded;
 }
 
@@ -110,46 +110,63 @@ QImage QgsImageCache::pathAsImage( const QString &f, const QSize size, const boo
   if ( file.isEmpty() )
     return QImage();
 
-  QMutexLocker locker( &mMutex );
-
   fitsInCache = true;
 
-  QgsImageCacheEntry *currentEntry = findExistingEntry( new QgsImageCacheEntry( file, size, keepAspectRatio, opacity ) );
+  const QString key = file + '\n' + QString::number( size.width() ) + 'x' + QString::number( size.height() )
+                      + '\n' + QString::number( keepAspectRatio ) + '\n' + QString::number( opacity, 'g', 17 );
+  const int generation = renderedImageGeneration();
 
   QImage result;
+  bool cachedIsMissing = false;
+  if ( renderedImage( key, result, &cachedIsMissing ) )
+  {
+    if ( isMissing )
+      *isMissing = cachedIsMissing;
+    return result;
+  }
 
-  //if current entry image is null: create the image
-  // checks to see if image will fit into cache
-  //update stats for memory usage
-  if ( currentEntry->image.isNull() )
   {
-    long cachedDataSize = 0;
-    bool isBroken = false;
-    result = renderImage( file, size, keepAspectRatio, opacity, isBroken, blocking );
-    cachedDataSize += result.width() * result.height() * 32;
-    if ( cachedDataSize > mMaxCacheSize / 2 )
-    {
-      fitsInCache = false;
-      currentEntry->image = QImage();
-    }
-    else
+    QMutexLocker locker( &mMutex );
+    QgsImageCacheEntry *currentEntry = findExistingEntry( new QgsImageCacheEntry( file, size, keepAspectRatio, opacity ) );
+    if ( !currentEntry->image.isNull() )
     {
-      mTotalSize += ( result.width() * result.height() * 32 );
-      currentEntry->image = result;
+      result = currentEntry->image;
+      if ( isMissing )
+        *isMissing = currentEntry->isMissingImage;
+      insertRenderedImage( key, result, currentEntry->isMissingImage, generation );
+      return result;
     }
+  }
 
-    if ( isMissing )
-      *isMissing = isBroken;
-    currentEntry->isMissingImage = isBroken;
+  // the image is rendered without holding the cache lock, so that other threads can use the cache meanwhile
+  bool isBroken = false;
+  result = renderImage( file, size, keepAspectRatio, opacity, isBroken, blocking );
+  if ( isMissing )
+    *isMissing = isBroken;
 
-    trimToMaximumSize();
+  // checks to see if image will fit into cache
+  const long cachedDataSize = result.width() * result.height() * 32;
+  if ( cachedDataSize > mMaxCacheSize / 2 )
+  {
+    fitsInCache = false;
+    return result;
   }
-  else
+
+  QMutexLocker locker( &mMutex );
+  // don't store images rendered from content which was replaced meanwhile, e.g. when a remote image was fetched
+  if ( renderedImageGeneration() != generation )
+    return result;
+
+  //update stats for memory usage
+  QgsImageCacheEntry *currentEntry = findExistingEntry( new QgsImageCacheEntry( file, size, keepAspectRatio, opacity ) );
+  if ( currentEntry->image.isNull() )
   {
-    result = currentEntry->image;
-    if ( isMissing )
-      *isMissing = currentEntry->isMissingImage;
+    mTotalSize += ( result.width() * result.height() * 32 );
+    currentEntry->image = result;
+    currentEntry->isMissingImage = isBroken;
+    trimToMaximumSize();
   }
+  insertRenderedImage( key, result, isBroken, generation );
 
   return result;
 }
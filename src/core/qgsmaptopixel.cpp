@@ -24,6 +24,68 @@
 #include "qgslogger.h"
 #include "qgspointxy.h"
 
+#include <cmath>
+
+// Compile the batch transforms for several instruction sets, the variant matching the CPU
+// is selected by the dynamic loader. Other compilers and platforms get a single variant.
+#if defined( __GNUC__ ) && !defined( __clang__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __linux__ )
+#define MAPTOPIXEL_TARGET_CLONES __attribute__(( target_clones( "avx2", "sse4.1", "default" ) ))
+#else
+#define MAPTOPIXEL_TARGET_CLONES
+#endif
+
+///@cond PRIVATE
+
+//! Affine part of a QTransform, as applied by QTransform::map()
+struct AffineCoefficients
+{
+  double m11;
+  double m12;
+  double m21;
+  double m22;
+  double dx;
+  double dy;
+};
+
+/*
+ * Both kernels read and write whole arrays without branches, so that the compiler can vectorize
+ * them. x - x is 0 for finite values only, and collecting that test with an integer reduction
+ * keeps the loops vectorizable without relaxing floating point semantics.
+ */
+MAPTOPIXEL_TARGET_CLONES
+static bool affineToPoints( const AffineCoefficients &c, const double *x, const double *y, int count, double *points )
+{
+  int finite = 1;
+  for ( int i = 0; i < count; ++i )
+  {
+    const double px = c.m11 * x[i] + c.m21 * y[i] + c.dx;
+    const double py = c.m12 * x[i] + c.m22 * y[i] + c.dy;
+    points[2 * i] = px;
+    points[2 * i + 1] = py;
+    finite &= ( px - px == 0 ) & ( py - py == 0 );
+  }
+  return finite;
+}
+
+MAPTOPIXEL_TARGET_CLONES
+static bool affineInPlace( const AffineCoefficients &c, double *points, int count )
+{
+  int finite = 1;
+  for ( int i = 0; i < count; ++i )
+  {
+    const double x = points[2 * i];
+    const double y = points[2 * i + 1];
+    const double px = c.m11 * x + c.m21 * y + c.dx;
+    const double py = c.m12 * x + c.m22 * y + c.dy;
+    points[2 * i] = px;
+    points[2 * i + 1] = py;
+    finite &= ( px - px == 0 ) & ( py - py == 0 );
+  }
+  return finite;
+}
+
+///@endcond
+
 
 QgsMapToPixel::QgsMapToPixel( double mapUnitsPerPixel,
                               double xc,
@@ -249,6 +311,45 @@ void QgsMapToPixel::transformInPlace( float &x, float &y ) const
   y = my;
 }
 
+bool QgsMapToPixel::transformToPoints( const double *x, const double *y, int count, QPointF *points ) const
+{
+  // QPointF is a plain pair of qreal coordinates
+  static_assert( sizeof( QPointF ) == 2 * sizeof( double ), "QPointF must hold two doubles" );
+
+  if ( mMatrix.type() <= QTransform::TxShear )
+  {
+    const AffineCoefficients coefficients { mMatrix.m11(), mMatrix.m12(), mMatrix.m21(), mMatrix.m22(), mMatrix.dx(), mMatrix.dy() };
+    return affineToPoints( coefficients, x, y, count, reinterpret_cast< double * >( points ) );
+  }
+
+  bool finite = true;
+  for ( int i = 0; i < count; ++i )
+  {
+    qreal mx, my;
+    mMatrix.map( x[i], y[i], &mx, &my );
+    points[i] = QPointF( mx, my );
+    finite = finite && std::isfinite( mx ) && std::isfinite( my );
+  }
+  return finite;
+}
+
+bool QgsMapToPixel::transformInPlace( QPointF *points, int count ) const
+{
+  if ( mMatrix.type() <= QTransform::TxShear )
+  {
+    const AffineCoefficients coefficients { mMatrix.m11(), mMatrix.m12(), mMatrix.m21(), mMatrix.m22(), mMatrix.dx(), mMatrix.dy() };
+    return affineInPlace( coefficients, reinterpret_cast< double * >( points ), count );
+  }
+
+  bool finite = true;
+  for ( int i = 0; i < count; ++i )
+  {
+    transformInPlace( points[i].rx(), points[i].ry() );
+    finite = finite && std::isfinite( points[i].x() ) && std::isfinite( points[i].y() );
+  }
+  return finite;
+}
+
 QTransform QgsMapToPixel::transform() const
 {
   // NOTE: operations are done in the reverse order in which
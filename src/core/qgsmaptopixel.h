@@ -116,6 +116,31 @@ class CORE_EXPORT QgsMapToPixel
       for ( int i = 0; i < x.size(); ++i )
         transformInPlace( x[i], y[i] );
     }
+
+    /**
+     * Transforms \a count points from map coordinates, read from the \a x and \a y arrays,
+     * to device coordinates and stores them in \a points, which must hold \a count points.
+     *
+     * This is much faster than transforming the points one by one, and the source arrays
+     * are left untouched.
+     *
+     * Returns FALSE if any of the transformed points is not finite.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.16
+     */
+    bool transformToPoints( const double *x, const double *y, int count, QPointF *points ) const;
+
+    /**
+     * Transforms \a count points starting at \a points from map coordinates to device
+     * coordinates in place.
+     *
+     * Returns FALSE if any of the transformed points is not finite.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.16
+     */
+    bool transformInPlace( QPointF *points, int count ) const;
 #endif
 
     //! Transform device coordinates to map (world) coordinates
@@ -77,6 +77,8 @@
 #include "qgsvectorlayerfeatureiterator.h"
 #include "qgsvectorlayerjoinbuffer.h"
 #include "qgsvectorlayerlabeling.h"
+#include "qgsvectorlayergeneralizationpyramid_p.h"
+#include "qgsvectorlayerrendercache_p.h"
 #include "qgsvectorlayerrenderer.h"
 #include "qgsvectorlayerundocommand.h"
 #include "qgsvectorlayerfeaturecounter.h"
@@ -202,6 +204,40 @@ QgsVectorLayer::QgsVectorLayer( const QString &vectorLayerPath,
 
   connect( this, &QgsVectorLayer::subsetStringChanged, this, &QgsMapLayer::configChanged );
 
+  connect( this, &QgsVectorLayer::dataChanged, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsVectorLayer::layerModified, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsVectorLayer::afterCommitChanges, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsVectorLayer::afterRollBack, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsVectorLayer::updatedFields, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsVectorLayer::subsetStringChanged, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsMapLayer::crsChanged, this, &QgsVectorLayer::clearRenderCache );
+  connect( this, &QgsMapLayer::dataSourceChanged, this, &QgsVectorLayer::clearRenderCache );
+  // generalized geometries of the previous data are kept in a still valid sidecar file only
+  connect( this, &QgsVectorLayer::dataChanged, this, [ = ]
+  {
+    if ( mGeneralizationPyramid )
+      mGeneralizationPyramid->clear();
+  } );
+  connect( this, &QgsVectorLayer::afterCommitChanges, this, [ = ]
+  {
+    if ( mGeneralizationPyramid )
+      mGeneralizationPyramid->clear();
+  } );
+  // features outside of the previous subset are missing from the pyramid, which is kept in a separate sidecar file
+  connect( this, &QgsVectorLayer::subsetStringChanged, this, [ = ]
+  {
+    if ( mGeneralizationPyramid )
+      resetGeneralizationPyramid();
+  } );
+
+  // deferred repaints are requested by auto refresh, which expects fresh data. Other repaints
+  // follow style or selection changes, which do not change the features
+  connect( this, &QgsMapLayer::repaintRequested, this, [ = ]( bool deferredUpdate )
+  {
+    if ( deferredUpdate )
+      clearRenderCache();
+  } );
+
   // Default simplify drawing settings
   QgsSettings settings;
   mSimplifyMethod.setSimplifyHints( settings.flagValue( QStringLiteral( "qgis/simplifyDrawingHints" ), mSimplifyMethod.simplifyHints(), QgsSettings::NoSection ) );
@@ -299,6 +335,7 @@ QgsVectorLayer *QgsVectorLayer::clone() const
   layer->setLabelsEnabled( labelsEnabled() );
 
   layer->setSimplifyMethod( simplifyMethod() );
+  layer->setRenderCacheEnabled( isRenderCacheEnabled() );
 
   if ( diagramRenderer() )
   {
@@ -410,6 +447,7 @@ void QgsVectorLayer::drawVertexMarker( double x, double y, QPainter &p, QgsVecto
 void QgsVectorLayer::select( QgsFeatureId fid )
 {
   mSelectedFeatureIds.insert( fid );
+  invalidateSelectedFeatureIdSet();
   mPreviousSelectedFeatureIds.clear();
 
   emit selectionChanged( QgsFeatureIds() << fid, QgsFeatureIds(), false );
@@ -417,7 +455,8 @@ void QgsVectorLayer::select( QgsFeatureId fid )
 
 void QgsVectorLayer::select( const QgsFeatureIds &featureIds )
 {
-  mSelectedFeatureIds.unite( featureIds );
+  mSelectedFeatureIds.unite( QgsFeatureIdRanges( featureIds ) );
+  invalidateSelectedFeatureIdSet();
   mPreviousSelectedFeatureIds.clear();
 
   emit selectionChanged( featureIds, QgsFeatureIds(), false );
@@ -426,6 +465,7 @@ void QgsVectorLayer::select( const QgsFeatureIds &featureIds )
 void QgsVectorLayer::deselect( const QgsFeatureId fid )
 {
   mSelectedFeatureIds.remove( fid );
+  invalidateSelectedFeatureIdSet();
   mPreviousSelectedFeatureIds.clear();
 
   emit selectionChanged( QgsFeatureIds(), QgsFeatureIds() << fid, false );
@@ -433,7 +473,8 @@ void QgsVectorLayer::deselect( const QgsFeatureId fid )
 
 void QgsVectorLayer::deselect( const QgsFeatureIds &featureIds )
 {
-  mSelectedFeatureIds.subtract( featureIds );
+  mSelectedFeatureIds.subtract( QgsFeatureIdRanges( featureIds ) );
+  invalidateSelectedFeatureIdSet();
   mPreviousSelectedFeatureIds.clear();
 
   emit selectionChanged( QgsFeatureIds(), featureIds, false );
@@ -523,32 +564,39 @@ void QgsVectorLayer::selectByExpression( const QString &expression, QgsVectorLay
 
 void QgsVectorLayer::selectByIds( const QgsFeatureIds &ids, QgsVectorLayer::SelectBehavior behavior )
 {
-  QgsFeatureIds newSelection;
+  const QgsFeatureIdRanges idRanges( ids );
+  QgsFeatureIdRanges newSelection = mSelectedFeatureIds;
 
   switch ( behavior )
   {
     case SetSelection:
-      newSelection = ids;
+      newSelection = idRanges;
       break;
 
     case AddToSelection:
-      newSelection = mSelectedFeatureIds + ids;
+      newSelection.unite( idRanges );
       break;
 
     case RemoveFromSelection:
-      newSelection = mSelectedFeatureIds - ids;
+      newSelection.subtract( idRanges );
       break;
 
     case IntersectSelection:
-      newSelection = mSelectedFeatureIds.intersect( ids );
+      newSelection.intersect( idRanges );
       break;
   }
 
-  QgsFeatureIds deselectedFeatures = mSelectedFeatureIds - newSelection;
+  QgsFeatureIdRanges deselectedFeatures = mSelectedFeatureIds;
+  deselectedFeatures.subtract( newSelection );
   mSelectedFeatureIds = newSelection;
   mPreviousSelectedFeatureIds.clear();
 
-  emit selectionChanged( newSelection, deselectedFeatures, true );
+  // the signal carries the whole selection, keep that set for selectedFeatureIds()
+  const QgsFeatureIds selected = behavior == SetSelection ? ids : mSelectedFeatureIds.toFeatureIds();
+  mSelectedFeatureIdSet = selected;
+  mSelectedFeatureIdSetValid = true;
+
+  emit selectionChanged( selected, deselectedFeatures.toFeatureIds(), true );
 }
 
 void QgsVectorLayer::modifySelection( const QgsFeatureIds &selectIds, const QgsFeatureIds &deselectIds )
@@ -559,8 +607,9 @@ void QgsVectorLayer::modifySelection( const QgsFeatureIds &selectIds, const QgsF
     QgsDebugMsgLevel( QStringLiteral( "Trying to select and deselect the same item at the same time. Unsure what to do. Selecting dubious items." ), 3 );
   }
 
-  mSelectedFeatureIds -= deselectIds;
-  mSelectedFeatureIds += selectIds;
+  mSelectedFeatureIds.subtract( QgsFeatureIdRanges( deselectIds ) );
+  mSelectedFeatureIds.unite( QgsFeatureIdRanges( selectIds ) );
+  invalidateSelectedFeatureIdSet();
   mPreviousSelectedFeatureIds.clear();
 
   emit selectionChanged( selectIds, deselectIds - intersectingIds, false );
@@ -568,9 +617,9 @@ void QgsVectorLayer::modifySelection( const QgsFeatureIds &selectIds, const QgsF
 
 void QgsVectorLayer::invertSelection()
 {
-  QgsFeatureIds ids = allFeatureIds();
+  QgsFeatureIdRanges ids( allFeatureIds() );
   ids.subtract( mSelectedFeatureIds );
-  selectByIds( ids );
+  selectByIds( ids.toFeatureIds() );
 }
 
 void QgsVectorLayer::selectAll()
@@ -612,17 +661,17 @@ void QgsVectorLayer::removeSelection()
   if ( mSelectedFeatureIds.isEmpty() )
     return;
 
-  const QgsFeatureIds previous = mSelectedFeatureIds;
+  const QgsFeatureIdRanges previous = mSelectedFeatureIds;
   selectByIds( QgsFeatureIds() );
   mPreviousSelectedFeatureIds = previous;
 }
 
 void QgsVectorLayer::reselect()
 {
-  if ( mPreviousSelectedFeatureIds.isEmpty() || !mSelectedFeatureIds.empty() )
+  if ( mPreviousSelectedFeatureIds.isEmpty() || !mSelectedFeatureIds.isEmpty() )
     return;
 
-  selectByIds( mPreviousSelectedFeatureIds );
+  selectByIds( mPreviousSelectedFeatureIds.toFeatureIds() );
 }
 
 QgsVectorDataProvider *QgsVectorLayer::dataProvider()
@@ -681,7 +730,7 @@ QgsRectangle QgsVectorLayer::boundingBoxOfSelected() const
   if ( mDataProvider->capabilities() & QgsVectorDataProvider::SelectAtId )
   {
     QgsFeatureIterator fit = getFeatures( QgsFeatureRequest()
-                                          .setFilterFids( mSelectedFeatureIds )
+                                          .setFilterFids( selectedFeatureIds() )
                                           .setNoAttributes() );
 
     while ( fit.nextFeature( fet ) )
@@ -986,6 +1035,48 @@ bool QgsVectorLayer::simplifyDrawingCanbeApplied( const QgsRenderContext &render
   return false;
 }
 
+void QgsVectorLayer::setRenderCacheEnabled( bool enabled )
+{
+  if ( enabled == isRenderCacheEnabled() )
+    return;
+
+  if ( enabled )
+    mRenderCache = std::make_shared< QgsVectorLayerRenderCache >();
+  else
+    mRenderCache.reset();
+}
+
+bool QgsVectorLayer::isRenderCacheEnabled() const
+{
+  return static_cast< bool >( mRenderCache );
+}
+
+void QgsVectorLayer::clearRenderCache()
+{
+  if ( mRenderCache )
+    mRenderCache->clear();
+}
+
+bool QgsVectorLayer::buildGeneralizedGeometries( QgsFeedback *feedback )
+{
+  if ( !mDataProvider || !mGeneralizationPyramid || !isSpatial() || geometryType() == QgsWkbTypes::PointGeometry )
+    return false;
+
+  std::unique_ptr< QgsAbstractFeatureSource > source( mDataProvider->featureSource() );
+  return mGeneralizationPyramid->build( source.get(), mDataProvider->extent(), mDataProvider->featureCount(), feedback );
+}
+
+bool QgsVectorLayer::hasGeneralizedGeometries() const
+{
+  return mGeneralizationPyramid && mGeneralizationPyramid->isAvailable();
+}
+
+void QgsVectorLayer::removeGeneralizedGeometries()
+{
+  if ( mGeneralizationPyramid )
+    mGeneralizationPyramid->remove();
+}
+
 QgsConditionalLayerStyles *QgsVectorLayer::conditionalStyles() const
 {
   return mConditionalStyles;
@@ -1172,13 +1263,17 @@ bool QgsVectorLayer::deleteSelectedFeatures( int *deletedCount, QgsVectorLayer::
   }
 
   int deleted = 0;
-  int count = mSelectedFeatureIds.size();
+  int count = selectedFeatureCount();
   // Make a copy since deleteFeature modifies mSelectedFeatureIds
-  QgsFeatureIds selectedFeatures( mSelectedFeatureIds );
-  const auto constSelectedFeatures = selectedFeatures;
-  for ( QgsFeatureId fid : constSelectedFeatures )
+  const QgsFeatureIdRanges selectedFeatures( mSelectedFeatureIds );
+  for ( const QgsFeatureIdRanges::Range &range : selectedFeatures.ranges() )
   {
-    deleted += deleteFeature( fid, context );  // removes from selection
+    for ( QgsFeatureId fid = range.first; ; ++fid )
+    {
+      deleted += deleteFeature( fid, context );  // removes from selection
+      if ( fid == range.last )
+        break;
+    }
   }
 
   triggerRepaint();
@@ -1220,7 +1315,7 @@ QgsGeometry::OperationResult QgsVectorLayer::addRing( const QgsPointSequence &ri
   //first try with selected features
   if ( !mSelectedFeatureIds.isEmpty() )
   {
-    result = utils.addRing( ring, mSelectedFeatureIds, featureId );
+    result = utils.addRing( ring, selectedFeatureIds(), featureId );
   }
 
   if ( result != QgsGeometry::OperationResult::Success )
@@ -1257,7 +1352,7 @@ QgsGeometry::OperationResult QgsVectorLayer::addRing( QgsCurve *ring, QgsFeature
   //first try with selected features
   if ( !mSelectedFeatureIds.isEmpty() )
   {
-    result = utils.addRing( static_cast< QgsCurve * >( ring->clone() ), mSelectedFeatureIds, featureId );
+    result = utils.addRing( static_cast< QgsCurve * >( ring->clone() ), selectedFeatureIds(), featureId );
   }
 
   if ( result != QgsGeometry::OperationResult::Success )
@@ -1293,19 +1388,19 @@ QgsGeometry::OperationResult QgsVectorLayer::addPart( const QgsPointSequence &po
 
   //number of selected features must be 1
 
-  if ( mSelectedFeatureIds.empty() )
+  if ( mSelectedFeatureIds.isEmpty() )
   {
     QgsDebugMsgLevel( QStringLiteral( "Number of selected features <1" ), 3 );
     return QgsGeometry::OperationResult::SelectionIsEmpty;
   }
-  else if ( mSelectedFeatureIds.size() > 1 )
+  else if ( mSelectedFeatureIds.count() > 1 )
   {
     QgsDebugMsgLevel( QStringLiteral( "Number of selected features >1" ), 3 );
     return QgsGeometry::OperationResult::SelectionIsGreaterThanOne;
   }
 
   QgsVectorLayerEditUtils utils( this );
-  QgsGeometry::OperationResult result = utils.addPart( points, *mSelectedFeatureIds.constBegin() );
+  QgsGeometry::OperationResult result = utils.addPart( points, mSelectedFeatureIds.ranges().constFirst().first );
 
   if ( result == QgsGeometry::OperationResult::Success )
     updateExtents();
@@ -1319,19 +1414,19 @@ QgsGeometry::OperationResult QgsVectorLayer::addPart( QgsCurve *ring )
 
   //number of selected features must be 1
 
-  if ( mSelectedFeatureIds.empty() )
+  if ( mSelectedFeatureIds.isEmpty() )
   {
     QgsDebugMsgLevel( QStringLiteral( "Number of selected features <1" ), 3 );
     return QgsGeometry::OperationResult::SelectionIsEmpty;
   }
-  else if ( mSelectedFeatureIds.size() > 1 )
+  else if ( mSelectedFeatureIds.count() > 1 )
   {
     QgsDebugMsgLevel( QStringLiteral( "Number of selected features >1" ), 3 );
     return QgsGeometry::OperationResult::SelectionIsGreaterThanOne;
   }
 
   QgsVectorLayerEditUtils utils( this );
-  QgsGeometry::OperationResult result = utils.addPart( ring, *mSelectedFeatureIds.constBegin() );
+  QgsGeometry::OperationResult result = utils.addPart( ring, mSelectedFeatureIds.ranges().constFirst().first );
 
   if ( result == QgsGeometry::OperationResult::Success )
     updateExtents();
@@ -1607,6 +1702,8 @@ bool QgsVectorLayer::readXml( const QDomNode &layer_node, QgsReadWriteContext &c
   // QGIS Server WMS Dimensions
   mServerProperties->readXml( layer_node );
 
+  setRenderCacheEnabled( layer_node.firstChildElement( QStringLiteral( "renderCache" ) ).attribute( QStringLiteral( "enabled" ) ) == QLatin1String( "1" ) );
+
   return isValid();               // should be true if read successfully
 
 } // void QgsVectorLayer::readXml
@@ -1708,6 +1805,7 @@ bool QgsVectorLayer::setDataProvider( QString const &provider, const QgsDataProv
 {
   mProviderKey = provider;
   delete mDataProvider;
+  mGeneralizationPyramid.reset();
 
   // For Postgres provider primary key unicity is tested at construction time,
   // so it has to be set before initializing the provider,
@@ -1818,9 +1916,19 @@ bool QgsVectorLayer::setDataProvider( QString const &provider, const QgsDataProv
   connect( mDataProvider, &QgsVectorDataProvider::dataChanged, this, &QgsVectorLayer::emitDataChanged );
   connect( mDataProvider, &QgsVectorDataProvider::dataChanged, this, &QgsVectorLayer::removeSelection );
 
+  resetGeneralizationPyramid();
+
   return true;
 } // QgsVectorLayer:: setDataProvider
 
+void QgsVectorLayer::resetGeneralizationPyramid()
+{
+  const QString subset = mDataProvider ? mDataProvider->subsetString() : QString();
+  QString sourcePath;
+  const QString sidecarPath = QgsVectorLayerGeneralizationPyramid::sidecarPath( mProviderKey, mDataSource, subset, sourcePath );
+  mGeneralizationPyramid = std::make_shared< QgsVectorLayerGeneralizationPyramid >( sourcePath, sidecarPath, subset );
+}
+
 
 
 
@@ -1908,6 +2016,13 @@ bool QgsVectorLayer::writeXml( QDomNode &layer_node,
   // save QGIS Server WMS Dimension definitions
   mServerProperties->writeXml( layer_node, document );
 
+  if ( isRenderCacheEnabled() )
+  {
+    QDomElement renderCacheElement = document.createElement( QStringLiteral( "renderCache" ) );
+    renderCacheElement.setAttribute( QStringLiteral( "enabled" ), QStringLiteral( "1" ) );
+    layer_node.appendChild( renderCacheElement );
+  }
+
   // renderer specific settings
   QString errorMsg;
   return writeSymbology( layer_node, document, errorMsg, context );
@@ -3307,6 +3422,7 @@ bool QgsVectorLayer::deleteFeature( QgsFeatureId fid, QgsVectorLayer::DeleteCont
   if ( res )
   {
     mSelectedFeatureIds.remove( fid ); // remove it from selection
+    invalidateSelectedFeatureIdSet();
     updateExtents();
   }
 
@@ -3322,7 +3438,8 @@ bool QgsVectorLayer::deleteFeatures( const QgsFeatureIds &fids, QgsVectorLayer::
 
   if ( res )
   {
-    mSelectedFeatureIds.subtract( fids ); // remove it from selection
+    mSelectedFeatureIds.subtract( QgsFeatureIdRanges( fids ) ); // remove it from selection
+    invalidateSelectedFeatureIdSet();
     updateExtents();
   }
 
@@ -3356,7 +3473,7 @@ long QgsVectorLayer::featureCount() const
   if ( ! mDataProvider )
     return -1;
   return mDataProvider->featureCount() +
-         ( mEditBuffer ? mEditBuffer->mAddedFeatures.size() - mEditBuffer->mDeletedFeatureIds.size() : 0 );
+         ( mEditBuffer ? mEditBuffer->mAddedFeatures.size() - mEditBuffer->mDeletedFeatureIds.count() : 0 );
 }
 
 QgsFeatureSource::FeatureAvailability QgsVectorLayer::hasFeatures() const
@@ -3484,26 +3601,38 @@ bool QgsVectorLayer::rollBack( bool deleteBuffer )
 
 int QgsVectorLayer::selectedFeatureCount() const
 {
-  return mSelectedFeatureIds.size();
+  return static_cast< int >( mSelectedFeatureIds.count() );
 }
 
 const QgsFeatureIds &QgsVectorLayer::selectedFeatureIds() const
 {
-  return mSelectedFeatureIds;
+  if ( !mSelectedFeatureIdSetValid )
+  {
+    mSelectedFeatureIdSet = mSelectedFeatureIds.toFeatureIds();
+    mSelectedFeatureIdSetValid = true;
+  }
+  return mSelectedFeatureIdSet;
+}
+
+void QgsVectorLayer::invalidateSelectedFeatureIdSet()
+{
+  mSelectedFeatureIdSet.clear();
+  mSelectedFeatureIdSetValid = false;
 }
 
 QgsFeatureList QgsVectorLayer::selectedFeatures() const
 {
   QgsFeatureList features;
-  features.reserve( mSelectedFeatureIds.count() );
+  const int count = selectedFeatureCount();
+  features.reserve( count );
   QgsFeature f;
 
-  if ( mSelectedFeatureIds.count() <= 8 )
+  if ( count <= 8 )
   {
     // for small amount of selected features, fetch them directly
     // because request with FilterFids would go iterate over the whole layer
-    const auto constMSelectedFeatureIds = mSelectedFeatureIds;
-    for ( QgsFeatureId fid : constMSelectedFeatureIds )
+    const QgsFeatureIds ids = mSelectedFeatureIds.toFeatureIds();
+    for ( QgsFeatureId fid : ids )
     {
       getFeatures( QgsFeatureRequest( fid ) ).nextFeature( f );
       features << f;
@@ -3531,9 +3660,9 @@ QgsFeatureIterator QgsVectorLayer::getSelectedFeatures( QgsFeatureRequest reques
     request.setFlags( QgsFeatureRequest::NoGeometry );
 
   if ( mSelectedFeatureIds.count() == 1 )
-    request.setFilterFid( *mSelectedFeatureIds.constBegin() );
+    request.setFilterFid( mSelectedFeatureIds.ranges().constFirst().first );
   else
-    request.setFilterFids( mSelectedFeatureIds );
+    request.setFilterFids( selectedFeatureIds() );
 
   return getFeatures( request );
 }
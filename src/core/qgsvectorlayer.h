@@ -30,6 +30,7 @@
 #include "qgis.h"
 #include "qgsmaplayer.h"
 #include "qgsfeature.h"
+#include "qgsfeatureidranges.h"
 #include "qgsfeaturerequest.h"
 #include "qgsfeaturesource.h"
 #include "qgsfields.h"
@@ -80,6 +81,8 @@ class QgsAuxiliaryLayer;
 class QgsGeometryOptions;
 class QgsStyleEntityVisitorInterface;
 class QgsVectorLayerTemporalProperties;
+class QgsVectorLayerRenderCache;
+class QgsVectorLayerGeneralizationPyramid;
 
 typedef QList<int> QgsAttributeList;
 typedef QSet<int> QgsAttributeIds;
@@ -841,6 +844,18 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
      */
     Q_INVOKABLE const QgsFeatureIds &selectedFeatureIds() const;
 
+    /**
+     * Returns the selected features IDs in this layer, stored as ranges of consecutive ids.
+     *
+     * Unlike selectedFeatureIds() this does not build a set containing each selected id, which
+     * makes it cheaper for large selections.
+     *
+     * \note Not available in Python bindings.
+     * \see selectedFeatureIds()
+     * \since QGIS 3.16
+     */
+    const QgsFeatureIdRanges &selectedFeatureIdRanges() const SIP_SKIP { return mSelectedFeatureIds; }
+
     //! Returns the bounding box of the selected features. If there is no selection, QgsRectangle(0,0,0,0) is returned
     Q_INVOKABLE QgsRectangle boundingBoxOfSelected() const;
 
@@ -2240,6 +2255,87 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
      */
     bool simplifyDrawingCanbeApplied( const QgsRenderContext &renderContext, QgsVectorSimplifyMethod::SimplifyHint simplifyHint ) const;
 
+    /**
+     * Sets whether the features fetched to render the layer are cached.
+     *
+     * When enabled, renders keep the features within the rendered extent in memory, with all their
+     * attributes and with their geometries already simplified for the map resolution. A later render
+     * of the same area at the same scale, e.g. after the style or the selection changed or for another
+     * frame of a temporal animation, draws them without requesting them from the data provider again.
+     *
+     * The cache is cleared whenever the data, fields, subset string or CRS of the layer change, and when
+     * the layer is refreshed. Layers in edit mode, layers with expression or joined fields and renders filtered
+     * by a feature filter provider are not cached. Renders fetching features which need more than about 128 MB
+     * are not cached either, and the least recently used extents are evicted to keep the cache within that size.
+     *
+     * The render cache is disabled by default.
+     *
+     * \see isRenderCacheEnabled()
+     * \see clearRenderCache()
+     * \since QGIS 3.16
+     */
+    void setRenderCacheEnabled( bool enabled );
+
+    /**
+     * Returns TRUE if the features fetched to render the layer are cached.
+     *
+     * \see setRenderCacheEnabled()
+     * \since QGIS 3.16
+     */
+    bool isRenderCacheEnabled() const;
+
+    /**
+     * Removes all features from the render cache of the layer.
+     *
+     * This is done automatically when the data, fields, subset string or CRS of the layer change.
+     *
+     * \see setRenderCacheEnabled()
+     * \since QGIS 3.16
+     */
+    void clearRenderCache();
+
+    /**
+     * Builds a pyramid of generalized geometries for the layer.
+     *
+     * The geometries of all features are simplified for a series of fixed tolerances, from the tolerance
+     * suiting a view of the whole layer to finer ones. Renders at scales where a level is precise enough
+     * then use its geometries instead of fetching the full resolution geometries from the data provider,
+     * which makes drawing large polygon and line layers at overview scales much faster.
+     *
+     * When the layer is read from a local file, the pyramid is also written to a sidecar file next to it
+     * and automatically used when the layer is loaded again, until the file changes. Otherwise the pyramid
+     * is only kept in memory. The pyramid is discarded whenever the data or the subset string of the layer
+     * changes, and each subset string has its own sidecar file. Features missing from the pyramid, e.g.
+     * added to the provider after it was built, are drawn with their provider geometries.
+     *
+     * This method reads all features of the layer and blocks until the pyramid is built. The optional
+     * \a feedback reports the progress and allows the build to be canceled.
+     *
+     * Returns TRUE if a pyramid was built. No pyramid is built for point layers, or when no level
+     * reduces the number of vertices significantly.
+     *
+     * \see hasGeneralizedGeometries()
+     * \see removeGeneralizedGeometries()
+     * \since QGIS 3.16
+     */
+    bool buildGeneralizedGeometries( QgsFeedback *feedback = nullptr );
+
+    /**
+     * Returns TRUE if a pyramid of generalized geometries is available for the layer.
+     *
+     * \see buildGeneralizedGeometries()
+     * \since QGIS 3.16
+     */
+    bool hasGeneralizedGeometries() const;
+
+    /**
+     * Discards the pyramid of generalized geometries of the layer, and deletes its sidecar file.
+     *
+     * \see buildGeneralizedGeometries()
+     * \since QGIS 3.16
+     */
+    void removeGeneralizedGeometries();
+
     /**
      * Returns the conditional styles that are set for this layer. Style information is
      * used to render conditional formatting in the attribute table.
@@ -2763,6 +2859,9 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
      */
     bool setDataProvider( QString const &provider, const QgsDataProvider::ProviderOptions &options );
 
+    //! Creates an empty pyramid of generalized geometries for the current data source and subset string
+    void resetGeneralizationPyramid();
+
     //! Read labeling from SLD
     void readSldLabeling( const QDomNode &node );
 
@@ -2774,6 +2873,9 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
 
     bool deleteFeatureCascade( QgsFeatureId fid, DeleteContext *context = nullptr );
 
+    //! Discards the set returned by selectedFeatureIds(), which is rebuilt from the ranges when next required
+    void invalidateSelectedFeatureIdSet();
+
 #ifdef SIP_RUN
     QgsVectorLayer( const QgsVectorLayer &rhs );
 #endif
@@ -2805,12 +2907,19 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
         subsequently gets deleted (i.e. by its addition to mDeletedFeatureIds),
         it always needs to be removed from mSelectedFeatureIds as well.
      */
-    QgsFeatureIds mSelectedFeatureIds;
+    QgsFeatureIdRanges mSelectedFeatureIds;
+
+    /**
+     * Selected feature IDs returned by selectedFeatureIds(), only built when requested
+     * since it holds each id separately. Changes of the selection discard it.
+     */
+    mutable QgsFeatureIds mSelectedFeatureIdSet;
+    mutable bool mSelectedFeatureIdSetValid = true;
 
     /**
      * Stores the previous set of selected features, to allow for "reselect" operations.
      */
-    QgsFeatureIds mPreviousSelectedFeatureIds;
+    QgsFeatureIdRanges mPreviousSelectedFeatureIds;
 
     //! Field map to commit
     QgsFields mFields;
@@ -2932,6 +3041,14 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
 
     friend class QgsVectorLayerFeatureSource;
 
+    //! Cache of the features fetched by the layer renderers. NULLPTR if the render cache is disabled
+    std::shared_ptr< QgsVectorLayerRenderCache > mRenderCache;
+
+    //! Generalized geometries, shared with the feature sources. NULLPTR if the layer has no valid data provider
+    std::shared_ptr< QgsVectorLayerGeneralizationPyramid > mGeneralizationPyramid;
+
+    friend class QgsVectorLayerRenderer;
+
     //! To avoid firing multiple time dataChanged signal on circular layer circular dependencies
     bool mDataChangedFired = false;
 
@@ -17,16 +17,50 @@
 
 #include "qgsvectorlayercache.h"
 #include "qgscacheindex.h"
+#include "qgscacheindexfeatureid.h"
 #include "qgscachedfeatureiterator.h"
+#include "qgsvectorlayercachestorage_p.h"
 #include "qgsvectorlayerjoininfo.h"
 #include "qgsvectorlayerjoinbuffer.h"
 #include "qgsvectorlayer.h"
+#include "qgsgeometry.h"
+#include "qgssettings.h"
+
+#include <QThread>
+
+#include <algorithm>
+#include <limits>
+
+//! Object name of the cache shared by the consumers of a layer, which is a child of the layer
+static const char *SHARED_CACHE_NAME = "qgis_shared_feature_cache";
+
+QgsVectorLayerCache::QgsCachedFeature::QgsCachedFeature( const QgsFeature &feat, QgsVectorLayerCache *vlCache )
+  : mCache( vlCache )
+  , mId( feat.id() )
+  , mRow( vlCache->mStorage->addFeature( feat ) )
+{
+}
+
+QgsVectorLayerCache::QgsCachedFeature::~QgsCachedFeature()
+{
+  // That's the reason we need this wrapper:
+  // Inform the cache that this feature has been removed
+  mCache->featureRemoved( mId );
+  mCache->mStorage->removeFeature( mRow );
+}
+
+QgsFeature QgsVectorLayerCache::QgsCachedFeature::feature() const
+{
+  return mCache->mStorage->feature( mRow );
+}
 
 QgsVectorLayerCache::QgsVectorLayerCache( QgsVectorLayer *layer, int cacheSize, QObject *parent )
   : QObject( parent )
   , mLayer( layer )
+  , mStorage( qgis::make_unique< QgsVectorLayerCacheStorage >() )
 {
   mCache.setMaxCost( cacheSize );
+  mStorage->reset( mLayer->fields() );
 
   connect( mLayer, &QgsVectorLayer::featureDeleted, this, &QgsVectorLayerCache::featureDeleted );
   connect( mLayer, &QgsVectorLayer::featureAdded, this, &QgsVectorLayerCache::onFeatureAdded );
@@ -48,6 +82,32 @@ QgsVectorLayerCache::~QgsVectorLayerCache()
 {
   qDeleteAll( mCacheIndices );
   mCacheIndices.clear();
+  mCache.clear();
+}
+
+QgsVectorLayerCache *QgsVectorLayerCache::sharedCache( const QgsVectorLayer *layer )
+{
+  if ( !layer )
+    return nullptr;
+
+  return layer->findChild< QgsVectorLayerCache * >( QLatin1String( SHARED_CACHE_NAME ), Qt::FindDirectChildrenOnly );
+}
+
+QgsVectorLayerCache *QgsVectorLayerCache::createSharedCache( QgsVectorLayer *layer )
+{
+  if ( !layer || QThread::currentThread() != layer->thread() )
+    return nullptr;
+
+  if ( QgsVectorLayerCache *cache = sharedCache( layer ) )
+    return cache;
+
+  // the memory budget limits the cache, rather than a number of features
+  QgsVectorLayerCache *cache = new QgsVectorLayerCache( layer, std::numeric_limits< int >::max(), layer );
+  cache->setObjectName( QLatin1String( SHARED_CACHE_NAME ) );
+  const qint64 megabytes = QgsSettings().value( QStringLiteral( "qgis/sharedFeatureCacheMemory" ), 256 ).toLongLong();
+  cache->setMaximumMemoryUsage( megabytes * 1024 * 1024 );
+  cache->addCacheIndex( new QgsCacheIndexFeatureId( cache ) );
+  return cache;
 }
 
 void QgsVectorLayerCache::setCacheSize( int cacheSize )
@@ -60,6 +120,12 @@ int QgsVectorLayerCache::cacheSize()
   return mCache.maxCost();
 }
 
+void QgsVectorLayerCache::setMaximumMemoryUsage( qint64 bytes )
+{
+  mMaximumMemoryUsage = std::max< qint64 >( 0, bytes );
+  trimToMemoryUsage();
+}
+
 void QgsVectorLayerCache::setCacheGeometry( bool cacheGeometry )
 {
   bool shouldCacheGeometry = cacheGeometry && mLayer->isSpatial();
@@ -108,6 +174,10 @@ void QgsVectorLayerCache::setFullCache( bool fullCache )
     {
       ++i;
 
+      // the features do not fit within the memory budget
+      if ( !mFullCache )
+        break;
+
       if ( t.elapsed() > 1000 )
       {
         bool cancel = false;
@@ -142,6 +212,11 @@ void QgsVectorLayerCache::setCacheAddedAttributes( bool cacheAddedAttributes )
   }
 }
 
+qint64 QgsVectorLayerCache::memoryUsage() const
+{
+  return mStorage->memoryUsage() + static_cast< qint64 >( mCache.size() ) * sizeof( QgsCachedFeature );
+}
+
 bool QgsVectorLayerCache::featureAtId( QgsFeatureId featureId, QgsFeature &feature, bool skipCache )
 {
   bool featureFound = false;
@@ -155,7 +230,7 @@ bool QgsVectorLayerCache::featureAtId( QgsFeatureId featureId, QgsFeature &featu
 
   if ( cachedFeature )
   {
-    feature = QgsFeature( *cachedFeature->feature() );
+    feature = cachedFeature->feature();
     featureFound = true;
   }
   else if ( mLayer->getFeatures( QgsFeatureRequest()
@@ -181,6 +256,11 @@ QgsVectorLayer *QgsVectorLayerCache::layer()
   return mLayer;
 }
 
+QgsAbstractFeatureSource *QgsVectorLayerCache::createFeatureSource() const
+{
+  return new QgsVectorLayerCacheFeatureSource( *mStorage, mLayer ? mLayer->crs() : QgsCoordinateReferenceSystem() );
+}
+
 QgsCoordinateReferenceSystem QgsVectorLayerCache::sourceCrs() const
 {
   return mLayer->crs();
@@ -233,7 +313,8 @@ void QgsVectorLayerCache::onAttributeValueChanged( QgsFeatureId fid, int field,
 
   if ( cachedFeat )
   {
-    cachedFeat->mFeature->setAttribute( field, value );
+    mStorage->setAttribute( cachedFeat->mRow, field, value );
+    trimToMemoryUsage();
   }
 
   emit attributeValueChanged( fid, field, value );
@@ -302,6 +383,11 @@ void QgsVectorLayerCache::attributeDeleted( int field )
     else if ( attr > field )
       mCachedAttributes << attr - 1;
   }
+
+  // the attributes of the cached features are stored in columns of the former fields. The cache
+  // is usually invalidated already, as the fields of the layer were updated
+  if ( mCache.size() > 0 )
+    invalidate();
 }
 
 void QgsVectorLayerCache::geometryChanged( QgsFeatureId fid, const QgsGeometry &geom )
@@ -310,7 +396,8 @@ void QgsVectorLayerCache::geometryChanged( QgsFeatureId fid, const QgsGeometry &
 
   if ( cachedFeat )
   {
-    cachedFeat->mFeature->setGeometry( geom );
+    mStorage->setGeometry( cachedFeat->mRow, geom );
+    trimToMemoryUsage();
   }
 }
 
@@ -323,6 +410,7 @@ void QgsVectorLayerCache::layerDeleted()
 void QgsVectorLayerCache::invalidate()
 {
   mCache.clear();
+  mStorage->reset( mLayer ? mLayer->fields() : QgsFields() );
   mFullCache = false;
   emit invalidated();
 }
@@ -464,3 +552,30 @@ void QgsVectorLayerCache::connectJoinedLayers() const
       connect( vl, &QgsVectorLayer::attributeValueChanged, this, &QgsVectorLayerCache::onJoinAttributeValueChanged );
   }
 }
+
+void QgsVectorLayerCache::cacheFeature( QgsFeature &feat )
+{
+  QgsCachedFeature *cachedFeature = new QgsCachedFeature( feat, this );
+  mCache.insert( feat.id(), cachedFeature );
+  trimToMemoryUsage();
+}
+
+void QgsVectorLayerCache::trimToMemoryUsage()
+{
+  if ( mMaximumMemoryUsage <= 0 || memoryUsage() <= mMaximumMemoryUsage )
+    return;
+
+  // QCache only removes features in least recently used order when its maximum cost decreases,
+  // every feature has a cost of 1. The most recently used feature is always kept.
+  const int maxCost = mCache.maxCost();
+  bool removed = false;
+  while ( memoryUsage() > mMaximumMemoryUsage && mCache.size() > 1 )
+  {
+    mCache.setMaxCost( mCache.totalCost() - 1 );
+    removed = true;
+  }
+  mCache.setMaxCost( maxCost );
+
+  if ( removed )
+    mFullCache = false;
+}
@@ -26,11 +26,13 @@
 #include "qgsfeatureiterator.h"
 
 #include <QCache>
+#include <memory>
 
 class QgsVectorLayer;
 class QgsFeature;
 class QgsCachedFeatureIterator;
 class QgsAbstractCacheIndex;
+class QgsVectorLayerCacheStorage;
 
 /**
  * \ingroup core
@@ -60,28 +62,21 @@ class CORE_EXPORT QgsVectorLayerCache : public QObject
         /**
          * Will create a new cached feature.
          *
-         * \param feat     The feature to cache. A copy will be made.
+         * \param feat     The feature to cache. It is stored in the columns of the cache.
          * \param vlCache  The cache to inform when the feature has been removed from the cache.
          */
-        QgsCachedFeature( const QgsFeature &feat, QgsVectorLayerCache *vlCache )
-          : mCache( vlCache )
-        {
-          mFeature = new QgsFeature( feat );
-        }
-
-        ~QgsCachedFeature()
-        {
-          // That's the reason we need this wrapper:
-          // Inform the cache that this feature has been removed
-          mCache->featureRemoved( mFeature->id() );
-          delete mFeature;
-        }
-
-        inline const QgsFeature *feature() { return mFeature; }
+        QgsCachedFeature( const QgsFeature &feat, QgsVectorLayerCache *vlCache );
+
+        ~QgsCachedFeature();
+
+        //! Returns a copy of the cached feature
+        QgsFeature feature() const;
 
       private:
-        QgsFeature *mFeature = nullptr;
         QgsVectorLayerCache *mCache = nullptr;
+        QgsFeatureId mId;
+        //! Row of the feature in the storage of the cache
+        int mRow = -1;
 
         friend class QgsVectorLayerCache;
         Q_DISABLE_COPY( QgsCachedFeature )
@@ -91,6 +86,30 @@ class CORE_EXPORT QgsVectorLayerCache : public QObject
     QgsVectorLayerCache( QgsVectorLayer *layer, int cacheSize, QObject *parent SIP_TRANSFERTHIS = nullptr );
     ~QgsVectorLayerCache() override;
 
+    /**
+     * Returns the cache shared by the consumers of the features of a \a layer, or NULLPTR if
+     * it was not created with createSharedCache().
+     *
+     * \see createSharedCache()
+     * \since QGIS 3.16
+     */
+    static QgsVectorLayerCache *sharedCache( const QgsVectorLayer *layer );
+
+    /**
+     * Returns the cache shared by the consumers of the features of a \a layer, creating it if required.
+     *
+     * The shared cache is owned by the layer. It caches all attributes and the geometries of the
+     * features, within the memory budget set by the "qgis/sharedFeatureCacheMemory" setting, in MiB.
+     * The attribute table uses it, and once it holds all features of the layer, aggregates, identify
+     * results and the layer renderer read their features from it instead of the data provider.
+     *
+     * Returns NULLPTR if called from another thread than the thread of the \a layer.
+     *
+     * \see sharedCache()
+     * \since QGIS 3.16
+     */
+    static QgsVectorLayerCache *createSharedCache( QgsVectorLayer *layer );
+
     /**
      * Sets the maximum number of features to keep in the cache. Some features will be removed from
      * the cache if the number is smaller than the previous size of the cache.
@@ -108,6 +127,40 @@ class CORE_EXPORT QgsVectorLayerCache : public QObject
      */
     int cacheSize();
 
+    /**
+     * Sets the maximum amount of memory, in bytes, used by the cached features.
+     *
+     * Once the estimated memory usage of the cached features exceeds \a bytes, least recently
+     * used features are removed from the cache, in addition to the limit set by setCacheSize().
+     * A full cache which no longer fits within the budget is not considered full anymore.
+     * A value of 0 (the default) disables the memory budget.
+     *
+     * \see maximumMemoryUsage()
+     * \see memoryUsage()
+     * \since QGIS 3.16
+     */
+    void setMaximumMemoryUsage( qint64 bytes );
+
+    /**
+     * Returns the maximum amount of memory, in bytes, used by the cached features, or 0 if
+     * the memory usage is not limited.
+     *
+     * \see setMaximumMemoryUsage()
+     * \since QGIS 3.16
+     */
+    qint64 maximumMemoryUsage() const { return mMaximumMemoryUsage; }
+
+    /**
+     * Returns the estimated amount of memory, in bytes, used by the cached features.
+     *
+     * Attributes are stored per field, text values repeated across features are stored
+     * once per field and only count once.
+     *
+     * \see setMaximumMemoryUsage()
+     * \since QGIS 3.16
+     */
+    qint64 memoryUsage() const;
+
     /**
      * Enable or disable the caching of geometries
      *
@@ -233,6 +286,15 @@ class CORE_EXPORT QgsVectorLayerCache : public QObject
      */
     QgsFeatureIds cachedFeatureIds() const { return qgis::listToSet( mCache.keys() ); }
 
+    /**
+     * Returns a new feature source reading a copy of the cached features, which can be used
+     * from any thread. The copy shares the storage of the features until the cache changes,
+     * so creating it is cheap.
+     *
+     * \since QGIS 3.16
+     */
+    QgsAbstractFeatureSource *createFeatureSource() const SIP_FACTORY;
+
     /**
      * Gets the feature at the given feature id. Considers the changed, added, deleted and permanent features
      * \param featureId The id of the feature to query
@@ -389,13 +451,18 @@ class CORE_EXPORT QgsVectorLayerCache : public QObject
 
     void connectJoinedLayers() const;
 
-    inline void cacheFeature( QgsFeature &feat )
-    {
-      QgsCachedFeature *cachedFeature = new QgsCachedFeature( feat, this );
-      mCache.insert( feat.id(), cachedFeature );
-    }
+    void cacheFeature( QgsFeature &feat );
+
+    //! Removes least recently used features until the memory budget is respected
+    void trimToMemoryUsage();
 
     QgsVectorLayer *mLayer = nullptr;
+
+    qint64 mMaximumMemoryUsage = 0;
+
+    //! Attributes and geometries of the cached features, declared before mCache which removes its features on destruction
+    std::unique_ptr< QgsVectorLayerCacheStorage > mStorage;
+
     QCache< QgsFeatureId, QgsCachedFeature > mCache;
 
     bool mCacheGeometry = true;
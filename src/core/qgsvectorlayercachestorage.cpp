@@ -0,0 +1,512 @@
+/***************************************************************************
+                         qgsvectorlayercachestorage.cpp
+                         ------------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsvectorlayercachestorage_p.h"
+#include "qgsexception.h"
+
+#include <algorithm>
+
+/// @cond PRIVATE
+
+//! Estimated memory used by a dictionary string, in the string vector and as hash key, in bytes
+static qint64 stringSize( const QString &string )
+{
+  return 2 * static_cast< qint64 >( sizeof( QString ) ) + 2 * sizeof( int ) + 2 * sizeof( void * )
+         + static_cast< qint64 >( string.size() ) * sizeof( QChar );
+}
+
+//! Estimated memory used by the data of a value stored as QVariant, in addition to the QVariant itself, in bytes
+static qint64 variantDataSize( const QVariant &value )
+{
+  switch ( value.type() )
+  {
+    case QVariant::String:
+      return sizeof( QString ) + static_cast< qint64 >( value.toString().size() ) * sizeof( QChar );
+    case QVariant::ByteArray:
+      return value.toByteArray().size();
+    default:
+      return 0;
+  }
+}
+
+//! Estimated memory used by a value of another type than its column, in bytes
+static qint64 otherValueSize( const QVariant &value )
+{
+  return sizeof( QVariant ) + sizeof( int ) + 2 * sizeof( void * ) + variantDataSize( value );
+}
+
+static qint64 geometrySize( const QgsGeometry &geometry )
+{
+  if ( geometry.isNull() )
+    return 0;
+
+  const QgsAbstractGeometry *g = geometry.constGet();
+  const int dimensions = 2 + ( g->is3D() ? 1 : 0 ) + ( g->isMeasure() ? 1 : 0 );
+  return static_cast< qint64 >( g->nCoordinates() ) * dimensions * sizeof( double );
+}
+
+QVariant QgsVectorLayerCacheColumn::value( int row ) const
+{
+  if ( row >= mKinds.size() )
+    return QVariant();
+
+  switch ( static_cast< ValueKind >( mKinds.at( row ) ) )
+  {
+    case Invalid:
+      return QVariant();
+
+    case Null:
+      return QVariant( static_cast< QVariant::Type >( mType ) );
+
+    case Other:
+      return mOtherValues.value( row );
+
+    case Stored:
+      break;
+  }
+
+  switch ( mStorage )
+  {
+    case Integers:
+    {
+      const qint64 integer = mIntegers.at( row );
+      switch ( mType )
+      {
+        case QVariant::Int:
+          return QVariant( static_cast< int >( integer ) );
+        case QVariant::UInt:
+          return QVariant( static_cast< uint >( integer ) );
+        case QVariant::ULongLong:
+          return QVariant( static_cast< qulonglong >( integer ) );
+        case QVariant::Bool:
+          return QVariant( integer != 0 );
+        default:
+          return QVariant( static_cast< qlonglong >( integer ) );
+      }
+    }
+
+    case Doubles:
+      return QVariant( mDoubles.at( row ) );
+
+    case Strings:
+      return QVariant( mStrings.at( mStringCodes.at( row ) ) );
+
+    case Variants:
+      return mVariants.at( row );
+
+    case Undefined:
+      break;
+  }
+  return QVariant();
+}
+
+void QgsVectorLayerCacheColumn::setValue( int row, const QVariant &value )
+{
+  if ( row >= mKinds.size() )
+    resize( row + 1 );
+
+  if ( !value.isValid() )
+  {
+    mKinds[row] = Invalid;
+    return;
+  }
+
+  if ( mStorage == Undefined )
+  {
+    mType = value.userType();
+    switch ( mType )
+    {
+      case QVariant::Int:
+      case QVariant::UInt:
+      case QVariant::LongLong:
+      case QVariant::ULongLong:
+      case QVariant::Bool:
+        mStorage = Integers;
+        break;
+      case QVariant::Double:
+        mStorage = Doubles;
+        break;
+      case QVariant::String:
+        mStorage = Strings;
+        break;
+      default:
+        mStorage = Variants;
+        break;
+    }
+    resize( mKinds.size() );
+  }
+
+  if ( value.userType() != mType )
+  {
+    mKinds[row] = Other;
+    mOtherValues.insert( row, value );
+    mExtraSize += otherValueSize( value );
+    return;
+  }
+
+  // values of other types keep their own null state
+  if ( mStorage != Variants && value.isNull() )
+  {
+    mKinds[row] = Null;
+    return;
+  }
+
+  mKinds[row] = Stored;
+  switch ( mStorage )
+  {
+    case Integers:
+      switch ( mType )
+      {
+        case QVariant::ULongLong:
+          mIntegers[row] = static_cast< qint64 >( value.toULongLong() );
+          break;
+        case QVariant::Bool:
+          mIntegers[row] = value.toBool() ? 1 : 0;
+          break;
+        default:
+          mIntegers[row] = value.toLongLong();
+          break;
+      }
+      break;
+
+    case Doubles:
+      mDoubles[row] = value.toDouble();
+      break;
+
+    case Strings:
+      mStringCodes[row] = stringCode( value.toString() );
+      break;
+
+    case Variants:
+      mVariants[row] = value;
+      mExtraSize += variantDataSize( value );
+      break;
+
+    case Undefined:
+      break;
+  }
+}
+
+void QgsVectorLayerCacheColumn::clearValue( int row )
+{
+  if ( row >= mKinds.size() )
+    return;
+
+  switch ( static_cast< ValueKind >( mKinds.at( row ) ) )
+  {
+    case Invalid:
+    case Null:
+      break;
+
+    case Other:
+      mExtraSize -= otherValueSize( mOtherValues.take( row ) );
+      break;
+
+    case Stored:
+      if ( mStorage == Strings )
+      {
+        releaseString( mStringCodes.at( row ) );
+      }
+      else if ( mStorage == Variants )
+      {
+        mExtraSize -= variantDataSize( mVariants.at( row ) );
+        mVariants[row] = QVariant();
+      }
+      break;
+  }
+  mKinds[row] = Invalid;
+}
+
+int QgsVectorLayerCacheColumn::rowSize() const
+{
+  switch ( mStorage )
+  {
+    case Integers:
+      return sizeof( quint8 ) + sizeof( qint64 );
+    case Doubles:
+      return sizeof( quint8 ) + sizeof( double );
+    case Strings:
+      return sizeof( quint8 ) + sizeof( int );
+    case Variants:
+      return sizeof( quint8 ) + sizeof( QVariant );
+    case Undefined:
+      break;
+  }
+  return sizeof( quint8 );
+}
+
+void QgsVectorLayerCacheColumn::resize( int rows )
+{
+  mKinds.resize( rows );
+  switch ( mStorage )
+  {
+    case Integers:
+      mIntegers.resize( rows );
+      break;
+    case Doubles:
+      mDoubles.resize( rows );
+      break;
+    case Strings:
+      mStringCodes.resize( rows );
+      break;
+    case Variants:
+      mVariants.resize( rows );
+      break;
+    case Undefined:
+      break;
+  }
+}
+
+int QgsVectorLayerCacheColumn::stringCode( const QString &string )
+{
+  const auto it = mStringCodesByValue.constFind( string );
+  if ( it != mStringCodesByValue.constEnd() )
+  {
+    ++mStringUses[ it.value() ];
+    return it.value();
+  }
+
+  int code;
+  if ( !mFreeStringCodes.isEmpty() )
+  {
+    code = mFreeStringCodes.takeLast();
+    mStrings[code] = string;
+    mStringUses[code] = 1;
+  }
+  else
+  {
+    code = mStrings.size();
+    mStrings.append( string );
+    mStringUses.append( 1 );
+  }
+  mStringCodesByValue.insert( string, code );
+  mExtraSize += stringSize( string );
+  return code;
+}
+
+void QgsVectorLayerCacheColumn::releaseString( int code )
+{
+  if ( --mStringUses[code] > 0 )
+    return;
+
+  mExtraSize -= stringSize( mStrings.at( code ) );
+  mStringCodesByValue.remove( mStrings.at( code ) );
+  mStrings[code] = QString();
+  mFreeStringCodes.append( code );
+}
+
+
+void QgsVectorLayerCacheStorage::reset( const QgsFields &fields )
+{
+  *this = QgsVectorLayerCacheStorage();
+  mFields = fields;
+}
+
+int QgsVectorLayerCacheStorage::addFeature( const QgsFeature &feature )
+{
+  int row;
+  if ( !mFreeRows.isEmpty() )
+  {
+    row = mFreeRows.takeLast();
+    mIds[row] = feature.id();
+    mGeometries[row] = feature.geometry();
+  }
+  else
+  {
+    row = mIds.size();
+    mIds.append( feature.id() );
+    mAttributeCounts.append( -1 );
+    mGeometries.append( feature.geometry() );
+  }
+  mGeometrySize += geometrySize( mGeometries.at( row ) );
+
+  const QgsAttributes attributes = feature.attributes();
+  if ( attributes.size() > mColumns.size() )
+    mColumns.resize( attributes.size() );
+  for ( int i = 0; i < attributes.size(); ++i )
+    mColumns[i].setValue( row, attributes.at( i ) );
+
+  mAttributeCounts[row] = attributes.size();
+  ++mFeatureCount;
+  return row;
+}
+
+void QgsVectorLayerCacheStorage::removeFeature( int row )
+{
+  if ( !isUsed( row ) )
+    return;
+
+  for ( int i = 0; i < mAttributeCounts.at( row ); ++i )
+    mColumns[i].clearValue( row );
+
+  mGeometrySize -= geometrySize( mGeometries.at( row ) );
+  mGeometries[row] = QgsGeometry();
+  mAttributeCounts[row] = -1;
+  mFreeRows.append( row );
+  --mFeatureCount;
+}
+
+QgsFeature QgsVectorLayerCacheStorage::feature( int row ) const
+{
+  QgsFeature feature( mFields, mIds.at( row ) );
+
+  const int count = mAttributeCounts.at( row );
+  QgsAttributes attributes( std::max( count, 0 ) );
+  for ( int i = 0; i < count; ++i )
+    attributes[i] = mColumns.at( i ).value( row );
+  feature.setAttributes( attributes );
+
+  feature.setGeometry( mGeometries.at( row ) );
+  feature.setValid( true );
+  return feature;
+}
+
+QVariant QgsVectorLayerCacheStorage::attribute( int row, int field ) const
+{
+  if ( field < 0 || field >= mAttributeCounts.at( row ) )
+    return QVariant();
+
+  return mColumns.at( field ).value( row );
+}
+
+void QgsVectorLayerCacheStorage::setAttribute( int row, int field, const QVariant &value )
+{
+  if ( field < 0 || field >= mAttributeCounts.at( row ) )
+    return;
+
+  mColumns[field].clearValue( row );
+  mColumns[field].setValue( row, value );
+}
+
+void QgsVectorLayerCacheStorage::setGeometry( int row, const QgsGeometry &geometry )
+{
+  mGeometrySize -= geometrySize( mGeometries.at( row ) );
+  mGeometries[row] = geometry;
+  mGeometrySize += geometrySize( geometry );
+}
+
+qint64 QgsVectorLayerCacheStorage::memoryUsage() const
+{
+  qint64 rowSize = sizeof( QgsFeatureId ) + sizeof( int ) + sizeof( QgsGeometry );
+  qint64 extraSize = mGeometrySize;
+  for ( const QgsVectorLayerCacheColumn &column : mColumns )
+  {
+    rowSize += column.rowSize();
+    extraSize += column.extraSize();
+  }
+  return mFeatureCount * rowSize + extraSize;
+}
+
+int QgsVectorLayerCacheStorage::dictionarySize( int field ) const
+{
+  return field >= 0 && field < mColumns.size() ? mColumns.at( field ).dictionarySize() : 0;
+}
+
+
+QgsVectorLayerCacheFeatureSource::QgsVectorLayerCacheFeatureSource( const QgsVectorLayerCacheStorage &storage, const QgsCoordinateReferenceSystem &crs )
+  : mStorage( storage )
+  , mCrs( crs )
+{
+}
+
+QgsFeatureIterator QgsVectorLayerCacheFeatureSource::getFeatures( const QgsFeatureRequest &request )
+{
+  return QgsFeatureIterator( new QgsVectorLayerCacheFeatureIterator( this, false, request ) );
+}
+
+
+QgsVectorLayerCacheFeatureIterator::QgsVectorLayerCacheFeatureIterator( QgsVectorLayerCacheFeatureSource *source, bool ownSource, const QgsFeatureRequest &request )
+  : QgsAbstractFeatureIteratorFromSource< QgsVectorLayerCacheFeatureSource >( source, ownSource, request )
+{
+  if ( mRequest.destinationCrs().isValid() && mRequest.destinationCrs() != mSource->mCrs )
+  {
+    mTransform = QgsCoordinateTransform( mSource->mCrs, mRequest.destinationCrs(), mRequest.transformContext() );
+  }
+  try
+  {
+    mFilterRect = filterRectToSourceCrs( mTransform );
+  }
+  catch ( QgsCsException & )
+  {
+    // can't reproject mFilterRect
+    close();
+    return;
+  }
+}
+
+QgsVectorLayerCacheFeatureIterator::~QgsVectorLayerCacheFeatureIterator()
+{
+  close();
+}
+
+bool QgsVectorLayerCacheFeatureIterator::fetchFeature( QgsFeature &feature )
+{
+  feature.setValid( false );
+
+  if ( mClosed )
+    return false;
+
+  const QgsVectorLayerCacheStorage &storage = mSource->mStorage;
+  while ( mRow < storage.rowCount() )
+  {
+    const int row = mRow++;
+    if ( !storage.isUsed( row ) )
+      continue;
+
+    // test the cheap criteria before building the feature
+    const QgsFeatureId id = storage.id( row );
+    if ( ( mRequest.filterType() == QgsFeatureRequest::FilterFid && id != mRequest.filterFid() )
+         || ( mRequest.filterType() == QgsFeatureRequest::FilterFids && !mRequest.filterFids().contains( id ) ) )
+      continue;
+
+    if ( !mFilterRect.isNull() )
+    {
+      const QgsGeometry &geometry = storage.geometry( row );
+      if ( geometry.isNull() || !geometry.boundingBoxIntersects( mFilterRect ) )
+        continue;
+      if ( mRequest.flags() & QgsFeatureRequest::ExactIntersect && !geometry.intersects( mFilterRect ) )
+        continue;
+    }
+
+    feature = storage.feature( row );
+    geometryToDestinationCrs( feature, mTransform );
+    return true;
+  }
+
+  close();
+  return false;
+}
+
+bool QgsVectorLayerCacheFeatureIterator::rewind()
+{
+  if ( mClosed )
+    return false;
+
+  mRow = 0;
+  return true;
+}
+
+bool QgsVectorLayerCacheFeatureIterator::close()
+{
+  if ( mClosed )
+    return false;
+
+  iteratorClosed();
+  mClosed = true;
+  return true;
+}
+
+/// @endcond
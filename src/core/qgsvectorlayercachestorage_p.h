@@ -0,0 +1,234 @@
+/***************************************************************************
+                         qgsvectorlayercachestorage_p.h
+                         ------------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSVECTORLAYERCACHESTORAGE_PRIVATE_H
+#define QGSVECTORLAYERCACHESTORAGE_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+#include "qgscoordinatereferencesystem.h"
+#include "qgscoordinatetransform.h"
+#include "qgsfeature.h"
+#include "qgsfeatureiterator.h"
+#include "qgsfields.h"
+#include "qgsgeometry.h"
+
+#include <QHash>
+#include <QVariant>
+#include <QVector>
+
+/**
+ * Attribute values of one field for all rows of a QgsVectorLayerCacheStorage.
+ *
+ * The column takes the type of the first valid value stored in it. Integer and boolean values are
+ * then stored as 64 bit integers, doubles as doubles and strings as codes into a dictionary of the
+ * distinct strings of the column, which counts the rows using each string. Values of other types
+ * are stored as QVariant, and so are values whose type differs from the type of the column.
+ */
+class CORE_EXPORT QgsVectorLayerCacheColumn
+{
+  public:
+
+    //! Returns the value of a \a row
+    QVariant value( int row ) const;
+
+    /**
+     * Sets the \a value of a \a row which has no value yet, or whose value was removed
+     * with clearValue(). The column grows to contain \a row if required.
+     */
+    void setValue( int row, const QVariant &value );
+
+    //! Removes the value of a \a row, releasing its string from the dictionary
+    void clearValue( int row );
+
+    //! Returns the estimated memory used by the value of each row, in bytes
+    int rowSize() const;
+
+    //! Returns the estimated memory used by the dictionary and by values stored as QVariant, in bytes
+    qint64 extraSize() const { return mExtraSize; }
+
+    //! Returns the number of distinct strings of the column
+    int dictionarySize() const { return mStringCodesByValue.size(); }
+
+  private:
+
+    enum Storage
+    {
+      Undefined, //!< No valid value was stored yet
+      Integers,
+      Doubles,
+      Strings,
+      Variants,
+    };
+
+    enum ValueKind
+    {
+      Invalid, //!< Invalid QVariant, e.g. an attribute which was not fetched
+      Stored, //!< Value stored in the typed vector of the column
+      Null, //!< Null value of the column type
+      Other, //!< Value of another type, stored in mOtherValues
+    };
+
+    void resize( int rows );
+    int stringCode( const QString &string );
+    void releaseString( int code );
+
+    Storage mStorage = Undefined;
+    int mType = QVariant::Invalid;
+
+    QVector< quint8 > mKinds;
+    QVector< qint64 > mIntegers;
+    QVector< double > mDoubles;
+    QVector< int > mStringCodes;
+    QVector< QVariant > mVariants;
+    QHash< int, QVariant > mOtherValues;
+
+    //! Distinct strings, indexed by code
+    QVector< QString > mStrings;
+    //! Number of rows using each string code
+    QVector< int > mStringUses;
+    QHash< QString, int > mStringCodesByValue;
+    QVector< int > mFreeStringCodes;
+
+    qint64 mExtraSize = 0;
+};
+
+/**
+ * Column oriented storage of the features cached by a QgsVectorLayerCache.
+ *
+ * Each feature occupies a row, rows of removed features are reused by the features added later.
+ * The storage is implicitly shared: a copy is cheap to create and is not affected by later
+ * changes of the original, so that it can be read from another thread.
+ */
+class CORE_EXPORT QgsVectorLayerCacheStorage
+{
+  public:
+
+    //! Removes all features and sets the \a fields of the features added afterwards
+    void reset( const QgsFields &fields );
+
+    //! Adds a \a feature and returns its row
+    int addFeature( const QgsFeature &feature );
+
+    //! Removes the feature of a \a row
+    void removeFeature( int row );
+
+    //! Returns the feature of a \a row
+    QgsFeature feature( int row ) const;
+
+    //! Returns the number of rows, including the unused rows of removed features
+    int rowCount() const { return mIds.size(); }
+
+    //! Returns TRUE if a feature is stored in \a row
+    bool isUsed( int row ) const { return mAttributeCounts.at( row ) >= 0; }
+
+    //! Returns the feature id of a \a row
+    QgsFeatureId id( int row ) const { return mIds.at( row ); }
+
+    //! Returns the geometry of a \a row
+    const QgsGeometry &geometry( int row ) const { return mGeometries.at( row ); }
+
+    //! Returns the value of attribute \a field of a \a row
+    QVariant attribute( int row, int field ) const;
+
+    //! Sets the \a value of attribute \a field of a \a row. Fields beyond the attributes of the feature are ignored
+    void setAttribute( int row, int field, const QVariant &value );
+
+    //! Sets the \a geometry of a \a row
+    void setGeometry( int row, const QgsGeometry &geometry );
+
+    //! Returns the estimated memory used by the stored features, in bytes
+    qint64 memoryUsage() const;
+
+    //! Returns the number of distinct strings stored for attribute \a field
+    int dictionarySize( int field ) const;
+
+  private:
+
+    QgsFields mFields;
+    QVector< QgsFeatureId > mIds;
+    //! Number of attributes of the feature of each row, or -1 for unused rows
+    QVector< int > mAttributeCounts;
+    QVector< QgsGeometry > mGeometries;
+    QVector< QgsVectorLayerCacheColumn > mColumns;
+    QVector< int > mFreeRows;
+    int mFeatureCount = 0;
+    qint64 mGeometrySize = 0;
+};
+
+/**
+ * Feature source reading a copy of the features cached by a QgsVectorLayerCache, which can be
+ * used from any thread.
+ */
+class CORE_EXPORT QgsVectorLayerCacheFeatureSource : public QgsAbstractFeatureSource
+{
+  public:
+
+    //! Constructor for QgsVectorLayerCacheFeatureSource, reading the features of \a storage with the \a crs of the layer
+    QgsVectorLayerCacheFeatureSource( const QgsVectorLayerCacheStorage &storage, const QgsCoordinateReferenceSystem &crs );
+
+    QgsFeatureIterator getFeatures( const QgsFeatureRequest &request = QgsFeatureRequest() ) override;
+
+  private:
+
+    QgsVectorLayerCacheStorage mStorage;
+    QgsCoordinateReferenceSystem mCrs;
+
+    friend class QgsVectorLayerCacheFeatureIterator;
+};
+
+/**
+ * Iterates over the features of a QgsVectorLayerCacheFeatureSource.
+ *
+ * Only the filter rectangle, feature id filters and destination CRS are handled here, filter
+ * expressions, ordering and limits are applied by QgsAbstractFeatureIterator.
+ */
+class CORE_EXPORT QgsVectorLayerCacheFeatureIterator : public QgsAbstractFeatureIteratorFromSource< QgsVectorLayerCacheFeatureSource >
+{
+  public:
+
+    //! Constructor for QgsVectorLayerCacheFeatureIterator
+    QgsVectorLayerCacheFeatureIterator( QgsVectorLayerCacheFeatureSource *source, bool ownSource, const QgsFeatureRequest &request );
+    ~QgsVectorLayerCacheFeatureIterator() override;
+
+    bool rewind() override;
+    bool close() override;
+
+  protected:
+    bool fetchFeature( QgsFeature &feature ) override;
+
+  private:
+
+    QgsRectangle mFilterRect;
+    QgsCoordinateTransform mTransform;
+    int mRow = 0;
+};
+
+/// @endcond
+
+#endif // QGSVECTORLAYERCACHESTORAGE_PRIVATE_H
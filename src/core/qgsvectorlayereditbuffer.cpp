@@ -577,27 +577,27 @@ bool QgsVectorLayerEditBuffer::commitChanges( QStringList &commitErrors )
     //
     if ( success && !mDeletedFeatureIds.isEmpty() )
     {
-      if ( ( cap & QgsVectorDataProvider::DeleteFeatures ) && provider->deleteFeatures( mDeletedFeatureIds ) )
+      const QgsFeatureIds deletedIds = mDeletedFeatureIds.toFeatureIds();
+      if ( ( cap & QgsVectorDataProvider::DeleteFeatures ) && provider->deleteFeatures( deletedIds ) )
       {
-        commitErrors << tr( "SUCCESS: %n feature(s) deleted.", "deleted features count", mDeletedFeatureIds.size() );
+        commitErrors << tr( "SUCCESS: %n feature(s) deleted.", "deleted features count", deletedIds.size() );
         // TODO[MD]: we should not need this here
-        for ( QgsFeatureId id : qgis::as_const( mDeletedFeatureIds ) )
+        for ( QgsFeatureId id : deletedIds )
         {
           mChangedAttributeValues.remove( id );
           mChangedGeometries.remove( id );
         }
 
-        emit committedFeaturesRemoved( L->id(), mDeletedFeatureIds );
+        emit committedFeaturesRemoved( L->id(), deletedIds );
 
         mDeletedFeatureIds.clear();
       }
       else
       {
-        commitErrors << tr( "ERROR: %n feature(s) not deleted.", "not deleted features count", mDeletedFeatureIds.size() );
+        commitErrors << tr( "ERROR: %n feature(s) not deleted.", "not deleted features count", deletedIds.size() );
 #if 0
         QString list = "ERROR: pending deletes:";
-        const auto constMDeletedFeatureIds = mDeletedFeatureIds;
-        for ( QgsFeatureId id : constMDeletedFeatureIds )
+        for ( QgsFeatureId id : deletedIds )
         {
           list.append( ' ' + FID_TO_STRING( id ) );
         }
@@ -20,6 +20,7 @@
 #include <QSet>
 
 #include "qgsfeature.h"
+#include "qgsfeatureidranges.h"
 #include "qgsfields.h"
 #include "qgsgeometry.h"
 
@@ -174,7 +175,15 @@ class CORE_EXPORT QgsVectorLayerEditBuffer : public QObject
      * Returns a list of deleted feature IDs which are not committed.
      * \see isFeatureDeleted()
     */
-    QgsFeatureIds deletedFeatureIds() const { return mDeletedFeatureIds; }
+    QgsFeatureIds deletedFeatureIds() const { return mDeletedFeatureIds.toFeatureIds(); }
+
+    /**
+     * Returns the deleted feature IDs which are not committed, stored as ranges of consecutive ids.
+     * \note Not available in Python bindings.
+     * \see deletedFeatureIds()
+     * \since QGIS 3.16
+     */
+    const QgsFeatureIdRanges &deletedFeatureIdRanges() const SIP_SKIP { return mDeletedFeatureIds; }
 
     /**
      * Returns TRUE if the specified feature ID has been deleted but not committed.
@@ -284,7 +293,7 @@ class CORE_EXPORT QgsVectorLayerEditBuffer : public QObject
         again before the change is committed - in that case the added feature would be removed
         from mAddedFeatures only and *not* entered here.
      */
-    QgsFeatureIds mDeletedFeatureIds;
+    QgsFeatureIdRanges mDeletedFeatureIds;
 
     //! New features which are not committed.
     QgsFeatureMap mAddedFeatures;
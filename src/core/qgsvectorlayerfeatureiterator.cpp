@@ -21,6 +21,7 @@
 #include "qgsvectorlayereditbuffer.h"
 #include "qgsvectorlayer.h"
 #include "qgsvectorlayerjoinbuffer.h"
+#include "qgsvectorlayergeneralizationpyramid_p.h"
 #include "qgsexpressioncontext.h"
 #include "qgsdistancearea.h"
 #include "qgsproject.h"
@@ -28,6 +29,9 @@
 #include "qgsexception.h"
 #include "qgsexpressioncontextutils.h"
 
+//! Maximum number of features with changed geometries whose attributes are fetched with a single provider request
+static const int CHANGED_GEOMETRY_BATCH_SIZE = 1000;
+
 QgsVectorLayerFeatureSource::QgsVectorLayerFeatureSource( const QgsVectorLayer *layer )
 {
   QMutexLocker locker( &layer->mFeatureSourceConstructorMutex );
@@ -43,6 +47,7 @@ QgsVectorLayerFeatureSource::QgsVectorLayerFeatureSource( const QgsVectorLayer *
 
   mExpressionFieldBuffer = new QgsExpressionFieldBuffer( *layer->mExpressionFieldBuffer );
   mCrs = layer->crs();
+  mGeneralizationPyramid = layer->mGeneralizationPyramid;
 
   mHasEditBuffer = layer->editBuffer();
   if ( mHasEditBuffer )
@@ -73,7 +78,7 @@ QgsVectorLayerFeatureSource::QgsVectorLayerFeatureSource( const QgsVectorLayer *
 #endif
       mAddedFeatures = QgsFeatureMap( layer->editBuffer()->addedFeatures() );
       mChangedGeometries = QgsGeometryMap( layer->editBuffer()->changedGeometries() );
-      mDeletedFeatureIds = QgsFeatureIds( layer->editBuffer()->deletedFeatureIds() );
+      mDeletedFeatureIds = layer->editBuffer()->deletedFeatureIdRanges();
       mChangedAttributeValues = QgsChangedAttributesMap( layer->editBuffer()->changedAttributeValues() );
       mAddedAttributes = QList<QgsField>( layer->editBuffer()->addedAttributes() );
       mDeletedAttributeIds = QgsAttributeList( layer->editBuffer()->deletedAttributeIds() );
@@ -250,6 +255,24 @@ QgsVectorLayerFeatureIterator::QgsVectorLayerFeatureIterator( QgsVectorLayerFeat
     }
   }
 
+  // geometries simplified for rendering can be taken from the generalization pyramid of the layer,
+  // without transferring the full resolution geometries from the provider
+  if ( mSource->mGeneralizationPyramid && !mSource->mHasEditBuffer
+       && mRequest.simplifyMethod().methodType() == QgsSimplifyMethod::OptimizeForRendering
+       && !( mRequest.flags() & QgsFeatureRequest::NoGeometry )
+       && !( mRequest.flags() & QgsFeatureRequest::ExactIntersect )
+       && mRequest.invalidGeometryCheck() == QgsFeatureRequest::GeometryNoCheck
+       && mRequest.filterType() != QgsFeatureRequest::FilterFid
+       && !( mRequest.filterType() == QgsFeatureRequest::FilterExpression && mRequest.filterExpression()->needsGeometry() ) )
+  {
+    if ( QgsVectorLayerGeneralizationPyramid::LevelPtr level = mSource->mGeneralizationPyramid->level( mRequest.simplifyMethod().tolerance() ) )
+    {
+      mGeneralizedGeometries = std::shared_ptr< const QHash< QgsFeatureId, QgsGeometry > >( level, &level->geometries );
+      mProviderRequest.setFlags( mProviderRequest.flags() | QgsFeatureRequest::NoGeometry );
+      mProviderRequest.setSimplifyMethod( QgsSimplifyMethod() );
+    }
+  }
+
   if ( mSource->mHasEditBuffer )
   {
     mChangedFeaturesRequest = mProviderRequest;
@@ -266,7 +289,7 @@ QgsVectorLayerFeatureIterator::QgsVectorLayerFeatureIterator( QgsVectorLayerFeat
       int providerLimit = mProviderRequest.limit();
 
       // features may be deleted in buffer, so increase limit sent to provider
-      providerLimit += mSource->mDeletedFeatureIds.size();
+      providerLimit += static_cast< int >( mSource->mDeletedFeatureIds.count() );
 
       if ( mProviderRequest.filterType() == QgsFeatureRequest::FilterExpression )
       {
@@ -441,12 +464,15 @@ bool QgsVectorLayerFeatureIterator::fetchFeature( QgsFeature &f )
 
   while ( mProviderIterator.nextFeature( f ) )
   {
-    if ( mFetchConsidered.contains( f.id() ) )
+    if ( isFetchConsidered( f.id() ) )
       continue;
 
     // TODO[MD]: just one resize of attributes
     f.setFields( mSource->mFields );
 
+    if ( mGeneralizedGeometries )
+      setGeneralizedGeometry( f );
+
     // update attributes
     if ( mSource->mHasEditBuffer )
       updateChangedAttributes( f );
@@ -531,7 +557,7 @@ bool QgsVectorLayerFeatureIterator::fetchNextAddedFeature( QgsFeature &f )
   {
     QgsFeatureId fid = mFetchAddedFeaturesIt->id();
 
-    if ( mFetchConsidered.contains( fid ) )
+    if ( isFetchConsidered( fid ) )
       // must have changed geometry outside rectangle
       continue;
 
@@ -576,15 +602,23 @@ bool QgsVectorLayerFeatureIterator::fetchNextChangedGeomFeature( QgsFeature &f )
   {
     QgsFeatureId fid = mFetchChangedGeomIt.key();
 
-    if ( mFetchConsidered.contains( fid ) )
+    if ( isFetchConsidered( fid ) )
       // skip deleted features
       continue;
 
-    mFetchConsidered << fid;
-
-    if ( !mFilterRect.isNull() && !mFetchChangedGeomIt->intersects( mFilterRect ) )
+    // the changed geometries up to the last one of the prefetched batch were already checked
+    const bool checked = !mChangedGeometryBatch.isEmpty() && fid <= mChangedGeometryBatchLast;
+    if ( checked ? !mChangedGeometryBatch.contains( fid ) : ( !mFilterRect.isNull() && !mFetchChangedGeomIt->intersects( mFilterRect ) ) )
+    {
       // skip changed geometries not in rectangle and don't check again
+      mFetchConsidered << fid;
       continue;
+    }
+
+    if ( !checked && changedGeometryNeedsAttributes() )
+      prefetchChangedGeometryAttributes();
+
+    mFetchConsidered << fid;
 
     useChangedAttributeFeature( fid, *mFetchChangedGeomIt, f );
 
@@ -612,7 +646,7 @@ bool QgsVectorLayerFeatureIterator::fetchNextChangedAttributeFeature( QgsFeature
 {
   while ( mChangedFeaturesIterator.nextFeature( f ) )
   {
-    if ( mFetchConsidered.contains( f.id() ) )
+    if ( isFetchConsidered( f.id() ) )
       // skip deleted features and those already handled by the geometry
       continue;
 
@@ -647,7 +681,13 @@ void QgsVectorLayerFeatureIterator::useChangedAttributeFeature( QgsFeatureId fid
   }
 
   bool subsetAttrs = ( mRequest.flags() & QgsFeatureRequest::SubsetOfAttributes );
-  if ( !subsetAttrs || !mRequest.subsetOfAttributes().isEmpty() )
+  if ( mChangedGeometryBatch.contains( fid ) )
+  {
+    auto it = mChangedGeometryAttributes.constFind( fid );
+    if ( it != mChangedGeometryAttributes.constEnd() )
+      f.setAttributes( *it );
+  }
+  else if ( !subsetAttrs || !mRequest.subsetOfAttributes().isEmpty() )
   {
     // retrieve attributes from provider
     QgsFeature tmp;
@@ -672,9 +712,56 @@ void QgsVectorLayerFeatureIterator::useChangedAttributeFeature( QgsFeatureId fid
 
 
 
+bool QgsVectorLayerFeatureIterator::changedGeometryNeedsAttributes() const
+{
+  return !( mRequest.flags() & QgsFeatureRequest::SubsetOfAttributes ) || !mRequest.subsetOfAttributes().isEmpty();
+}
+
+bool QgsVectorLayerFeatureIterator::isFetchConsidered( QgsFeatureId fid ) const
+{
+  return mSource->mDeletedFeatureIds.contains( fid ) || mFetchConsidered.contains( fid );
+}
+
+void QgsVectorLayerFeatureIterator::prefetchChangedGeometryAttributes()
+{
+  mChangedGeometryBatch.clear();
+  mChangedGeometryAttributes.clear();
+
+  // the current changed geometry is known to match
+  mChangedGeometryBatch.insert( mFetchChangedGeomIt.key() );
+  mChangedGeometryBatchLast = mFetchChangedGeomIt.key();
+  for ( auto it = mFetchChangedGeomIt + 1; it != mSource->mChangedGeometries.constEnd() && mChangedGeometryBatch.size() < CHANGED_GEOMETRY_BATCH_SIZE; ++it )
+  {
+    mChangedGeometryBatchLast = it.key();
+    if ( isFetchConsidered( it.key() ) )
+      continue;
+    if ( !mFilterRect.isNull() && !it->intersects( mFilterRect ) )
+      continue;
+    mChangedGeometryBatch.insert( it.key() );
+  }
+
+  QgsFeatureRequest request;
+  request.setFilterFids( mChangedGeometryBatch ).setFlags( QgsFeatureRequest::NoGeometry );
+  if ( mRequest.flags() & QgsFeatureRequest::SubsetOfAttributes )
+  {
+    request.setSubsetOfAttributes( mProviderRequest.subsetOfAttributes() );
+  }
+  QgsFeatureIterator fi = mSource->mProviderFeatureSource->getFeatures( request );
+  fi.setInterruptionChecker( mInterruptionChecker );
+  QgsFeature tmp;
+  while ( fi.nextFeature( tmp ) )
+  {
+    if ( mHasVirtualAttributes || mSource->mHasEditBuffer )
+      updateChangedAttributes( tmp );
+    mChangedGeometryAttributes.insert( tmp.id(), tmp.attributes() );
+  }
+}
+
 void QgsVectorLayerFeatureIterator::rewindEditBuffer()
 {
-  mFetchConsidered = mSource->mDeletedFeatureIds;
+  mFetchConsidered.clear();
+  mChangedGeometryBatch.clear();
+  mChangedGeometryAttributes.clear();
 
   mFetchAddedFeaturesIt = mSource->mAddedFeatures.constEnd();
   mFetchChangedGeomIt = mSource->mChangedGeometries.constBegin();
@@ -868,6 +955,26 @@ bool QgsVectorLayerFeatureIterator::postProcessFeature( QgsFeature &feature )
   return result;
 }
 
+void QgsVectorLayerFeatureIterator::setGeneralizedGeometry( QgsFeature &f )
+{
+  auto it = mGeneralizedGeometries->constFind( f.id() );
+  if ( it != mGeneralizedGeometries->constEnd() )
+  {
+    f.setGeometry( *it );
+    return;
+  }
+
+  // features added to the provider after the level was built are missing from it
+  QgsFeatureRequest request( f.id() );
+  request.setSubsetOfAttributes( QgsAttributeList() );
+  request.setSimplifyMethod( mRequest.simplifyMethod() );
+  QgsFeature providerFeature;
+  if ( mSource->mProviderFeatureSource->getFeatures( request ).nextFeature( providerFeature ) )
+    f.setGeometry( providerFeature.geometry() );
+  else
+    f.clearGeometry();
+}
+
 bool QgsVectorLayerFeatureIterator::checkGeometryValidity( const QgsFeature &feature )
 {
   if ( !feature.hasGeometry() )
@@ -1134,20 +1241,22 @@ bool QgsVectorLayerFeatureIterator::nextFeatureFid( QgsFeature &f )
     return false;
 
   // has changed geometry?
-  if ( !( mRequest.flags() & QgsFeatureRequest::NoGeometry ) && mSource->mChangedGeometries.contains( featureId ) )
+  if ( !( mRequest.flags() & QgsFeatureRequest::NoGeometry ) )
   {
-    useChangedAttributeFeature( featureId, mSource->mChangedGeometries[featureId], f );
-    return true;
+    auto changedGeometryIt = mSource->mChangedGeometries.constFind( featureId );
+    if ( changedGeometryIt != mSource->mChangedGeometries.constEnd() )
+    {
+      useChangedAttributeFeature( featureId, *changedGeometryIt, f );
+      return true;
+    }
   }
 
   // added features
-  for ( QgsFeatureMap::ConstIterator iter = mSource->mAddedFeatures.constBegin(); iter != mSource->mAddedFeatures.constEnd(); ++iter )
+  auto addedFeatureIt = mSource->mAddedFeatures.constFind( featureId );
+  if ( addedFeatureIt != mSource->mAddedFeatures.constEnd() )
   {
-    if ( iter->id() == featureId )
-    {
-      useAddedFeature( *iter, f );
-      return true;
-    }
+    useAddedFeature( *addedFeatureIt, f );
+    return true;
   }
 
   // regular features
@@ -1170,6 +1279,11 @@ bool QgsVectorLayerFeatureIterator::nextFeatureFid( QgsFeature &f )
 
 void QgsVectorLayerFeatureIterator::updateChangedAttributes( QgsFeature &f )
 {
+  auto changedIt = mSource->mChangedAttributeValues.constFind( f.id() );
+  // most features are not edited, leave their attributes shared with the provider feature
+  if ( changedIt == mSource->mChangedAttributeValues.constEnd() && mSource->mDeletedAttributeIds.isEmpty() && mSource->mAddedAttributes.isEmpty() )
+    return;
+
   QgsAttributes attrs = f.attributes();
 
   // remove all attributes that will disappear - from higher indices to lower
@@ -1182,9 +1296,9 @@ void QgsVectorLayerFeatureIterator::updateChangedAttributes( QgsFeature &f )
   attrs.resize( attrs.count() + mSource->mAddedAttributes.count() );
 
   // update changed attributes
-  if ( mSource->mChangedAttributeValues.contains( f.id() ) )
+  if ( changedIt != mSource->mChangedAttributeValues.constEnd() )
   {
-    const QgsAttributeMap &map = mSource->mChangedAttributeValues[f.id()];
+    const QgsAttributeMap &map = *changedIt;
     for ( QgsAttributeMap::const_iterator it = map.begin(); it != map.end(); ++it )
       attrs[it.key()] = it.value();
   }
@@ -1193,8 +1307,9 @@ void QgsVectorLayerFeatureIterator::updateChangedAttributes( QgsFeature &f )
 
 void QgsVectorLayerFeatureIterator::updateFeatureGeometry( QgsFeature &f )
 {
-  if ( mSource->mChangedGeometries.contains( f.id() ) )
-    f.setGeometry( mSource->mChangedGeometries[f.id()] );
+  auto it = mSource->mChangedGeometries.constFind( f.id() );
+  if ( it != mSource->mChangedGeometries.constEnd() )
+    f.setGeometry( *it );
 }
 
 void QgsVectorLayerFeatureIterator::createExpressionContext()
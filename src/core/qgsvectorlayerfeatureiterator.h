@@ -17,6 +17,7 @@
 
 #include "qgis_core.h"
 #include "qgis_sip.h"
+#include "qgsfeatureidranges.h"
 #include "qgsfeatureiterator.h"
 #include "qgsfields.h"
 #include "qgscoordinatereferencesystem.h"
@@ -35,6 +36,7 @@ class QgsVectorLayerEditBuffer;
 class QgsVectorLayerJoinBuffer;
 class QgsVectorLayerJoinInfo;
 class QgsExpressionContext;
+class QgsVectorLayerGeneralizationPyramid;
 
 class QgsVectorLayerFeatureIterator;
 
@@ -106,12 +108,14 @@ class CORE_EXPORT QgsVectorLayerFeatureSource : public QgsAbstractFeatureSource
     // for explanation
     QgsFeatureMap mAddedFeatures;
     QgsGeometryMap mChangedGeometries;
-    QgsFeatureIds mDeletedFeatureIds;
+    QgsFeatureIdRanges mDeletedFeatureIds;
     QList<QgsField> mAddedAttributes;
     QgsChangedAttributesMap mChangedAttributeValues;
     QgsAttributeList mDeletedAttributeIds;
 
     QgsCoordinateReferenceSystem mCrs;
+
+    std::shared_ptr< QgsVectorLayerGeneralizationPyramid > mGeneralizationPyramid;
 };
 
 /**
@@ -285,12 +289,39 @@ class CORE_EXPORT QgsVectorLayerFeatureIterator : public QgsAbstractFeatureItera
      */
     bool postProcessFeature( QgsFeature &feature );
 
+    /**
+     * Fetches the provider attributes of the changed geometries matching the request, starting with
+     * the current one, with a single provider request.
+     */
+    void prefetchChangedGeometryAttributes();
+
+    //! Returns TRUE if the attributes of features with changed geometries must be read from the provider
+    bool changedGeometryNeedsAttributes() const;
+
+    //! Returns TRUE if the feature \a fid was deleted or was already returned from the edit buffer
+    bool isFetchConsidered( QgsFeatureId fid ) const;
+
+    //! Changed geometries matching the request whose attributes were prefetched
+    QgsFeatureIds mChangedGeometryBatch;
+    //! Last changed geometry checked by prefetchChangedGeometryAttributes()
+    QgsFeatureId mChangedGeometryBatchLast = 0;
+    QHash< QgsFeatureId, QgsAttributes > mChangedGeometryAttributes;
+
     /**
      * Checks a feature's geometry for validity, if requested in feature request.
      */
     bool checkGeometryValidity( const QgsFeature &feature );
 
     bool mDelegatedOrderByToProvider = false;
+
+    /**
+     * Sets the geometry of \a f from the generalization level, or from the provider if the level
+     * does not contain the feature.
+     */
+    void setGeneralizedGeometry( QgsFeature &f );
+
+    //! Geometries replacing the provider geometries, when a generalization level suits the requested simplification
+    std::shared_ptr< const QHash< QgsFeatureId, QgsGeometry > > mGeneralizedGeometries;
 };
 
 
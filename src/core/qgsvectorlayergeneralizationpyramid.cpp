@@ -0,0 +1,326 @@
+/***************************************************************************
+                         qgsvectorlayergeneralizationpyramid.cpp
+                         ---------------------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsvectorlayergeneralizationpyramid_p.h"
+#include "qgsfeatureiterator.h"
+#include "qgsfeedback.h"
+#include "qgsgeometrysimplifier.h"
+#include "qgsproviderregistry.h"
+#include "qgssimplifymethod.h"
+#include "qgslogger.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+
+/// @cond PRIVATE
+
+//! Identifies sidecar files, "QGGP"
+static const quint32 SIDECAR_MAGIC = 0x51474750;
+static const quint32 SIDECAR_VERSION = 2;
+
+//! Size of the smallest geometry record of a sidecar file, a feature id and an empty WKB
+static const qint64 MINIMUM_RECORD_SIZE = sizeof( qint64 ) + sizeof( quint32 );
+
+//! Levels keeping more than this fraction of the full resolution vertices are not worth storing
+static const double MAXIMUM_VERTEX_RATIO = 0.5;
+
+QgsVectorLayerGeneralizationPyramid::QgsVectorLayerGeneralizationPyramid( const QString &sourcePath, const QString &sidecarPath, const QString &subsetString )
+  : mSourcePath( sourcePath )
+  , mSidecarPath( sidecarPath )
+  , mSubsetString( subsetString )
+{
+}
+
+QString QgsVectorLayerGeneralizationPyramid::sidecarPath( const QString &providerKey, const QString &uri, const QString &subsetString, QString &sourcePath )
+{
+  const QVariantMap parts = QgsProviderRegistry::instance()->decodeUri( providerKey, uri );
+  sourcePath = parts.value( QStringLiteral( "path" ) ).toString();
+  if ( sourcePath.isEmpty() || !QFileInfo( sourcePath ).isFile() )
+  {
+    sourcePath.clear();
+    return QString();
+  }
+
+  // datasets with several layers get one sidecar per layer
+  QString layer = parts.value( QStringLiteral( "layerName" ) ).toString();
+  if ( layer.isEmpty() && parts.contains( QStringLiteral( "layerId" ) ) && !parts.value( QStringLiteral( "layerId" ) ).isNull() )
+    layer = parts.value( QStringLiteral( "layerId" ) ).toString();
+
+  QString path = layer.isEmpty() ? sourcePath : sourcePath + '.' + layer;
+
+  // and filtered layers one per subset string, which is also checked when reading the sidecar
+  if ( !subsetString.isEmpty() )
+    path += '.' + QString::fromLatin1( QCryptographicHash::hash( subsetString.toUtf8(), QCryptographicHash::Sha1 ).toHex().left( 16 ) );
+
+  return path + QStringLiteral( ".qggp" );
+}
+
+QVector< double > QgsVectorLayerGeneralizationPyramid::levelTolerances( const QgsRectangle &extent )
+{
+  QVector< double > tolerances;
+  const double size = std::max( extent.width(), extent.height() );
+  if ( extent.isNull() || !std::isfinite( size ) || size <= 0 )
+    return tolerances;
+
+  // the coarsest level suits a view of the whole layer on about 512 pixels, each finer level halves the tolerance
+  for ( int i = LEVEL_COUNT - 1; i >= 0; --i )
+    tolerances << std::ldexp( size, -9 - i );
+  return tolerances;
+}
+
+bool QgsVectorLayerGeneralizationPyramid::build( QgsAbstractFeatureSource *source, const QgsRectangle &extent, long featureCount, QgsFeedback *feedback )
+{
+  const QVector< double > tolerances = levelTolerances( extent );
+  if ( !source || tolerances.isEmpty() )
+    return false;
+
+  QVector< std::unique_ptr< QgsAbstractGeometrySimplifier > > simplifiers;
+  QVector< std::shared_ptr< Level > > levels;
+  for ( double tolerance : tolerances )
+  {
+    QgsSimplifyMethod method;
+    method.setMethodType( QgsSimplifyMethod::OptimizeForRendering );
+    method.setTolerance( tolerance );
+    simplifiers.append( std::unique_ptr< QgsAbstractGeometrySimplifier >( QgsSimplifyMethod::createGeometrySimplifier( method ) ) );
+
+    std::shared_ptr< Level > level = std::make_shared< Level >();
+    level->tolerance = tolerance;
+    levels.append( level );
+  }
+
+  QVector< qint64 > vertexCounts( tolerances.size(), 0 );
+  qint64 fullVertexCount = 0;
+
+  QgsFeatureIterator it = source->getFeatures( QgsFeatureRequest().setSubsetOfAttributes( QgsAttributeList() ) );
+  QgsFeature feature;
+  long processed = 0;
+  while ( it.nextFeature( feature ) )
+  {
+    if ( feedback )
+    {
+      if ( feedback->isCanceled() )
+        return false;
+      if ( featureCount > 0 )
+        feedback->setProgress( 100.0 * processed / featureCount );
+    }
+    ++processed;
+
+    const QgsGeometry geometry = feature.geometry();
+    if ( geometry.isNull() )
+      continue;
+
+    fullVertexCount += geometry.constGet()->nCoordinates();
+    for ( int i = 0; i < levels.size(); ++i )
+    {
+      const QgsGeometry simplified = simplifiers.at( i )->simplify( geometry );
+      vertexCounts[i] += simplified.isNull() ? 0 : simplified.constGet()->nCoordinates();
+      levels[i]->geometries.insert( feature.id(), simplified );
+    }
+  }
+
+  QVector< LevelPtr > keptLevels;
+  for ( int i = 0; i < levels.size(); ++i )
+  {
+    if ( vertexCounts.at( i ) <= fullVertexCount * MAXIMUM_VERTEX_RATIO )
+      keptLevels.append( levels.at( i ) );
+  }
+  if ( keptLevels.isEmpty() )
+    return false;
+
+  {
+    QMutexLocker locker( &mMutex );
+    mLevels = keptLevels;
+    mLoaded = true;
+  }
+
+  if ( !mSidecarPath.isEmpty() && !writeSidecar() )
+    QgsDebugMsg( QStringLiteral( "Could not write generalized geometries to %1" ).arg( mSidecarPath ) );
+
+  if ( feedback )
+    feedback->setProgress( 100 );
+  return true;
+}
+
+QgsVectorLayerGeneralizationPyramid::LevelPtr QgsVectorLayerGeneralizationPyramid::level( double tolerance )
+{
+  QMutexLocker locker( &mMutex );
+  if ( !ensureLoaded() )
+    return nullptr;
+
+  LevelPtr result;
+  for ( const LevelPtr &level : qgis::as_const( mLevels ) )
+  {
+    if ( level->tolerance > tolerance )
+      break;
+    result = level;
+  }
+  return result;
+}
+
+bool QgsVectorLayerGeneralizationPyramid::isAvailable()
+{
+  QMutexLocker locker( &mMutex );
+  if ( mLoaded )
+    return !mLevels.isEmpty();
+  return readSidecar( true );
+}
+
+void QgsVectorLayerGeneralizationPyramid::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mLevels.clear();
+  mLoaded = false;
+}
+
+void QgsVectorLayerGeneralizationPyramid::remove()
+{
+  QMutexLocker locker( &mMutex );
+  mLevels.clear();
+  // nothing is left to load
+  mLoaded = true;
+  if ( !mSidecarPath.isEmpty() && QFile::exists( mSidecarPath ) )
+    QFile::remove( mSidecarPath );
+}
+
+bool QgsVectorLayerGeneralizationPyramid::ensureLoaded()
+{
+  if ( !mLoaded )
+  {
+    // read once, a missing or outdated sidecar is not checked again until the pyramid is cleared
+    mLoaded = true;
+    if ( !readSidecar( false ) )
+      mLevels.clear();
+  }
+  return !mLevels.isEmpty();
+}
+
+bool QgsVectorLayerGeneralizationPyramid::readSidecar( bool headerOnly )
+{
+  if ( mSidecarPath.isEmpty() )
+    return false;
+
+  QFile file( mSidecarPath );
+  if ( !file.open( QIODevice::ReadOnly ) )
+    return false;
+
+  QDataStream stream( &file );
+  quint32 magic = 0;
+  quint32 version = 0;
+  qint64 sourceSize = 0;
+  qint64 sourceModified = 0;
+  QString subsetString;
+  stream >> magic >> version;
+  if ( stream.status() != QDataStream::Ok || magic != SIDECAR_MAGIC || version != SIDECAR_VERSION )
+    return false;
+
+  stream >> sourceSize >> sourceModified >> subsetString;
+  const QFileInfo sourceInfo( mSourcePath );
+  if ( stream.status() != QDataStream::Ok || sourceSize != sourceInfo.size() || sourceModified != sourceInfo.lastModified().toMSecsSinceEpoch()
+       || subsetString != mSubsetString )
+    return false;
+
+  if ( headerOnly )
+    return true;
+
+  // counts and sizes are checked against the file size, so that a corrupted sidecar can not trigger huge allocations
+  qint32 levelCount = 0;
+  stream >> levelCount;
+  if ( stream.status() != QDataStream::Ok || levelCount < 0 || levelCount > LEVEL_COUNT )
+    return false;
+
+  QVector< LevelPtr > levels;
+  double previousTolerance = 0;
+  for ( int i = 0; i < levelCount; ++i )
+  {
+    std::shared_ptr< Level > level = std::make_shared< Level >();
+    qint32 geometryCount = 0;
+    stream >> level->tolerance >> geometryCount;
+    if ( stream.status() != QDataStream::Ok || !std::isfinite( level->tolerance ) || level->tolerance <= previousTolerance
+         || geometryCount < 0 || geometryCount > ( file.size() - file.pos() ) / MINIMUM_RECORD_SIZE )
+      return false;
+    previousTolerance = level->tolerance;
+
+    level->geometries.reserve( geometryCount );
+    for ( int j = 0; j < geometryCount; ++j )
+    {
+      qint64 id = 0;
+      quint32 wkbSize = 0;
+      stream >> id >> wkbSize;
+      if ( stream.status() != QDataStream::Ok )
+        return false;
+
+      QgsGeometry geometry;
+      // null geometries are stored as null byte arrays
+      if ( wkbSize != 0xffffffff && wkbSize > 0 )
+      {
+        if ( static_cast< qint64 >( wkbSize ) > file.size() - file.pos() )
+          return false;
+
+        QByteArray wkb( static_cast< int >( wkbSize ), Qt::Uninitialized );
+        if ( stream.readRawData( wkb.data(), static_cast< int >( wkbSize ) ) != static_cast< int >( wkbSize ) )
+          return false;
+
+        geometry.fromWkb( wkb );
+        if ( geometry.isNull() )
+          return false;
+      }
+      level->geometries.insert( id, geometry );
+    }
+    levels.append( level );
+  }
+
+  mLevels = levels;
+  return true;
+}
+
+bool QgsVectorLayerGeneralizationPyramid::writeSidecar() const
+{
+  const QFileInfo sourceInfo( mSourcePath );
+  QVector< LevelPtr > levels;
+  {
+    QMutexLocker locker( &mMutex );
+    levels = mLevels;
+  }
+
+  // written atomically, so that a concurrently opened layer never reads a partially written file
+  QSaveFile file( mSidecarPath );
+  if ( !file.open( QIODevice::WriteOnly ) )
+    return false;
+
+  QDataStream stream( &file );
+  stream << SIDECAR_MAGIC << SIDECAR_VERSION
+         << static_cast< qint64 >( sourceInfo.size() ) << static_cast< qint64 >( sourceInfo.lastModified().toMSecsSinceEpoch() )
+         << mSubsetString
+         << static_cast< qint32 >( levels.size() );
+  for ( const LevelPtr &level : qgis::as_const( levels ) )
+  {
+    stream << level->tolerance << static_cast< qint32 >( level->geometries.size() );
+    for ( auto it = level->geometries.constBegin(); it != level->geometries.constEnd(); ++it )
+      stream << static_cast< qint64 >( it.key() ) << ( it.value().isNull() ? QByteArray() : it.value().asWkb() );
+  }
+
+  return stream.status() == QDataStream::Ok && file.commit();
+}
+
+/// @endcond
@@ -0,0 +1,144 @@
+/***************************************************************************
+                         qgsvectorlayergeneralizationpyramid_p.h
+                         ---------------------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSVECTORLAYERGENERALIZATIONPYRAMID_PRIVATE_H
+#define QGSVECTORLAYERGENERALIZATIONPYRAMID_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+#include "qgsfeatureid.h"
+#include "qgsgeometry.h"
+#include "qgsrectangle.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+class QgsAbstractFeatureSource;
+class QgsFeedback;
+
+/**
+ * Pyramid of generalized geometries of a vector layer.
+ *
+ * Each level holds the geometries of all features of the layer, simplified for rendering with a
+ * fixed tolerance (see levelTolerances()). Feature iterators requesting simplified geometries use
+ * the coarsest level whose tolerance does not exceed the requested one, and do not fetch geometries
+ * from the provider.
+ *
+ * Levels are built by build(). When the layer is read from a local file the pyramid is also written to
+ * a sidecar file next to it, which is read the first time a level is needed. The sidecar records the
+ * size and modification time of the source file and the subset string of the layer, and is ignored once
+ * the source file changed or when read for another subset string.
+ *
+ * A level may lack features which were added after it was built, so feature iterators have to fall back
+ * to provider geometries for feature ids missing from a level.
+ *
+ * All methods are thread safe.
+ */
+class CORE_EXPORT QgsVectorLayerGeneralizationPyramid
+{
+  public:
+
+    //! Number of levels considered by build()
+    static const int LEVEL_COUNT = 8;
+
+    //! Generalized geometries of all features for one tolerance
+    struct Level
+    {
+      //! Tolerance of the simplification, in layer units
+      double tolerance = 0;
+      QHash< QgsFeatureId, QgsGeometry > geometries;
+    };
+
+    typedef std::shared_ptr< const Level > LevelPtr;
+
+    /**
+     * Constructor for QgsVectorLayerGeneralizationPyramid.
+     *
+     * \a sourcePath is the local file the layer is read from, and \a sidecarPath the file the
+     * pyramid is persisted to. Both are empty if the pyramid is only kept in memory. \a subsetString
+     * is the subset string of the layer the pyramid is built for.
+     */
+    QgsVectorLayerGeneralizationPyramid( const QString &sourcePath = QString(), const QString &sidecarPath = QString(), const QString &subsetString = QString() );
+
+    /**
+     * Returns the sidecar path used for the layer with the data provider \a providerKey, \a uri and
+     * \a subsetString, and sets \a sourcePath to the file the layer is read from. Returns an empty string
+     * if the layer is not read from a local file.
+     */
+    static QString sidecarPath( const QString &providerKey, const QString &uri, const QString &subsetString, QString &sourcePath );
+
+    //! Returns the tolerances of the levels considered for a layer covering \a extent, finest first
+    static QVector< double > levelTolerances( const QgsRectangle &extent );
+
+    /**
+     * Builds the levels from the features of \a source, covering \a extent, and writes the sidecar file.
+     *
+     * Levels which do not reduce the number of vertices significantly compared to the full resolution
+     * geometries are skipped. Returns FALSE if the build was canceled or no level was worth keeping.
+     */
+    bool build( QgsAbstractFeatureSource *source, const QgsRectangle &extent, long featureCount, QgsFeedback *feedback = nullptr );
+
+    /**
+     * Returns the coarsest level whose tolerance does not exceed \a tolerance, or NULLPTR if there is none.
+     */
+    LevelPtr level( double tolerance );
+
+    //! Returns TRUE if levels were built or can be read from a valid sidecar file
+    bool isAvailable();
+
+    /**
+     * Forgets all levels. A still valid sidecar file is read again when a level is needed.
+     */
+    void clear();
+
+    //! Forgets all levels and deletes the sidecar file
+    void remove();
+
+  private:
+
+    bool ensureLoaded();
+    bool readSidecar( bool headerOnly );
+    bool writeSidecar() const;
+
+    QString mSourcePath;
+    QString mSidecarPath;
+    QString mSubsetString;
+
+    mutable QMutex mMutex;
+    //! Levels, finest first
+    QVector< LevelPtr > mLevels;
+    bool mLoaded = false;
+};
+
+/// @endcond
+
+#endif // QGSVECTORLAYERGENERALIZATIONPYRAMID_PRIVATE_H
@@ -0,0 +1,180 @@
+/***************************************************************************
+                         qgsvectorlayerrendercache.cpp
+                         -----------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsvectorlayerrendercache_p.h"
+#include "qgsgeometry.h"
+
+#include <QMutexLocker>
+
+/// @cond PRIVATE
+
+bool QgsVectorLayerRenderCache::Key::covers( const Key &request ) const
+{
+  if ( simplifyMethod.methodType() != request.simplifyMethod.methodType()
+       || simplifyMethod.tolerance() != request.simplifyMethod.tolerance()
+       || simplifyMethod.threshold() != request.simplifyMethod.threshold()
+       || simplifyMethod.forceLocalOptimization() != request.simplifyMethod.forceLocalOptimization() )
+    return false;
+
+  // a null extent requests all features
+  if ( extent.isNull() )
+    return true;
+  return !request.extent.isNull() && extent.contains( request.extent );
+}
+
+qint64 QgsVectorLayerRenderCache::estimatedMemoryUsage( const QgsFeature &feature )
+{
+  qint64 size = sizeof( QgsFeature );
+  if ( feature.hasGeometry() )
+  {
+    const QgsAbstractGeometry *geometry = feature.geometry().constGet();
+    const int dimensions = 2 + ( geometry->is3D() ? 1 : 0 ) + ( geometry->isMeasure() ? 1 : 0 );
+    size += sizeof( QgsGeometry ) + static_cast< qint64 >( geometry->nCoordinates() ) * dimensions * sizeof( double );
+  }
+
+  const QgsAttributes attributes = feature.attributes();
+  for ( const QVariant &value : attributes )
+  {
+    size += sizeof( QVariant );
+    switch ( value.type() )
+    {
+      case QVariant::String:
+        size += sizeof( QString ) + value.toString().size() * sizeof( QChar );
+        break;
+      case QVariant::ByteArray:
+        size += value.toByteArray().size();
+        break;
+      default:
+        break;
+    }
+  }
+  return size;
+}
+
+int QgsVectorLayerRenderCache::generation() const
+{
+  QMutexLocker locker( &mMutex );
+  return mGeneration;
+}
+
+QgsVectorLayerRenderCache::Features QgsVectorLayerRenderCache::features( const Key &key )
+{
+  QMutexLocker locker( &mMutex );
+  for ( int i = 0; i < mEntries.size(); ++i )
+  {
+    if ( mEntries.at( i ).key.covers( key ) )
+    {
+      mEntries.move( i, 0 );
+      return mEntries.at( 0 ).features;
+    }
+  }
+  return nullptr;
+}
+
+void QgsVectorLayerRenderCache::insert( const Key &key, const Features &features, qint64 bytes, int generation )
+{
+  if ( !features || bytes > MAXIMUM_MEMORY_USAGE )
+    return;
+
+  QMutexLocker locker( &mMutex );
+  if ( generation != mGeneration )
+    return;
+
+  // entries covered by the new one are redundant
+  for ( int i = mEntries.size() - 1; i >= 0; --i )
+  {
+    if ( key.covers( mEntries.at( i ).key ) )
+    {
+      mMemoryUsage -= mEntries.at( i ).bytes;
+      mEntries.removeAt( i );
+    }
+  }
+
+  while ( !mEntries.isEmpty() && mMemoryUsage + bytes > MAXIMUM_MEMORY_USAGE )
+  {
+    mMemoryUsage -= mEntries.constLast().bytes;
+    mEntries.removeLast();
+  }
+
+  mEntries.prepend( Entry{ key, features, bytes } );
+  mMemoryUsage += bytes;
+}
+
+void QgsVectorLayerRenderCache::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mEntries.clear();
+  mMemoryUsage = 0;
+  ++mGeneration;
+}
+
+
+QgsVectorLayerRenderCacheIterator::QgsVectorLayerRenderCacheIterator( const QgsVectorLayerRenderCache::Features &features, const QgsFeatureIterator &remaining, const QgsFeatureRequest &request )
+  : QgsAbstractFeatureIterator( request )
+  , mFeatures( features )
+  , mRemaining( remaining )
+{
+}
+
+bool QgsVectorLayerRenderCacheIterator::fetchFeature( QgsFeature &feature )
+{
+  feature.setValid( false );
+
+  if ( mClosed )
+    return false;
+
+  const QgsRectangle filterRect = mRequest.filterRect();
+  while ( mIndex < mFeatures->size() )
+  {
+    const QgsFeature &cached = mFeatures->at( mIndex++ );
+    if ( !filterRect.isNull() && ( !cached.hasGeometry() || !cached.geometry().boundingBoxIntersects( filterRect ) ) )
+      continue;
+
+    feature = cached;
+    feature.setValid( true );
+    return true;
+  }
+
+  if ( mRemaining.nextFeature( feature ) )
+    return true;
+
+  close();
+  return false;
+}
+
+bool QgsVectorLayerRenderCacheIterator::rewind()
+{
+  // the features of the remaining iterator are not kept, so it can not be rewound
+  if ( mRemaining.isValid() )
+    return false;
+
+  mIndex = 0;
+  return true;
+}
+
+bool QgsVectorLayerRenderCacheIterator::close()
+{
+  mClosed = true;
+  mRemaining.close();
+  return true;
+}
+
+void QgsVectorLayerRenderCacheIterator::setInterruptionChecker( QgsFeedback *interruptionChecker )
+{
+  mRemaining.setInterruptionChecker( interruptionChecker );
+}
+
+/// @endcond
@@ -0,0 +1,150 @@
+/***************************************************************************
+                         qgsvectorlayerrendercache_p.h
+                         -----------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSVECTORLAYERRENDERCACHE_PRIVATE_H
+#define QGSVECTORLAYERRENDERCACHE_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+#include "qgsfeature.h"
+#include "qgsfeatureiterator.h"
+#include "qgsrectangle.h"
+#include "qgssimplifymethod.h"
+
+#include <QList>
+#include <QMutex>
+#include <QVector>
+
+#include <memory>
+
+/**
+ * Cache of the features fetched to render a vector layer, shared by the renderers of the layer.
+ *
+ * Each entry holds all attributes of the features within a request extent, with their geometries
+ * already simplified by the provider for the map resolution. A later render whose extent lies within
+ * a cached extent and which uses the same simplification re-renders from memory, applying its own
+ * filter expressions and ordering to the cached features.
+ *
+ * Entries are evicted in least recently used order once the estimated memory used by the cached
+ * features exceeds MAXIMUM_MEMORY_USAGE. Each call to clear() starts a new generation, and features
+ * fetched for an older generation are not inserted.
+ *
+ * All methods are thread safe.
+ */
+class CORE_EXPORT QgsVectorLayerRenderCache
+{
+  public:
+
+    //! Maximum estimated memory used by the cached features, in bytes. Renders fetching more features are not cached
+    static const qint64 MAXIMUM_MEMORY_USAGE = 128 * 1024 * 1024;
+
+    //! Features of an entry, shared with the iterators reading them
+    typedef std::shared_ptr< const QVector< QgsFeature > > Features;
+
+    //! Identifies the features fetched by a render
+    struct Key
+    {
+      //! Request extent, in layer CRS
+      QgsRectangle extent;
+      //! Simplification applied by the provider
+      QgsSimplifyMethod simplifyMethod;
+
+      //! Returns TRUE if the features of this key can be used for the \a request key
+      bool covers( const Key &request ) const;
+    };
+
+    //! Returns the estimated memory used by a cached \a feature, in bytes
+    static qint64 estimatedMemoryUsage( const QgsFeature &feature );
+
+    //! Returns the current generation, which must be passed to insert()
+    int generation() const;
+
+    /**
+     * Returns the features of an entry covering \a key, or NULLPTR if none is cached.
+     */
+    Features features( const Key &key );
+
+    /**
+     * Inserts fetched \a features, with an estimated memory usage of \a bytes, unless the cache
+     * was cleared since \a generation was retrieved.
+     */
+    void insert( const Key &key, const Features &features, qint64 bytes, int generation );
+
+    //! Removes all features and starts a new generation
+    void clear();
+
+  private:
+
+    struct Entry
+    {
+      Key key;
+      Features features;
+      qint64 bytes;
+    };
+
+    mutable QMutex mMutex;
+    //! Entries, most recently used first
+    QList< Entry > mEntries;
+    qint64 mMemoryUsage = 0;
+    int mGeneration = 0;
+};
+
+/**
+ * Iterates over features of a QgsVectorLayerRenderCache entry, followed by the features of
+ * an optional provider iterator.
+ *
+ * Only the filter rectangle of the request is handled here, filter expressions and ordering
+ * are applied by QgsAbstractFeatureIterator.
+ */
+class CORE_EXPORT QgsVectorLayerRenderCacheIterator : public QgsAbstractFeatureIterator
+{
+  public:
+
+    /**
+     * Constructor for QgsVectorLayerRenderCacheIterator, iterating over \a features and then
+     * over the \a remaining iterator, if it is valid.
+     */
+    QgsVectorLayerRenderCacheIterator( const QgsVectorLayerRenderCache::Features &features, const QgsFeatureIterator &remaining, const QgsFeatureRequest &request );
+
+    bool rewind() override;
+    bool close() override;
+    void setInterruptionChecker( QgsFeedback *interruptionChecker ) override;
+
+  protected:
+    bool fetchFeature( QgsFeature &feature ) override;
+
+  private:
+
+    QgsVectorLayerRenderCache::Features mFeatures;
+    QgsFeatureIterator mRemaining;
+    int mIndex = 0;
+};
+
+/// @endcond
+
+#endif // QGSVECTORLAYERRENDERCACHE_PRIVATE_H
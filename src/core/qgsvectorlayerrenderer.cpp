@@ -27,6 +27,7 @@
 #include "qgssymbollayerutils.h"
 #include "qgssymbol.h"
 #include "qgsvectorlayer.h"
+#include "qgsvectorlayercache.h"
 #include "qgsvectorlayerdiagramprovider.h"
 #include "qgsvectorlayerfeatureiterator.h"
 #include "qgsvectorlayerlabeling.h"
@@ -40,8 +41,10 @@
 #include "qgsrenderedfeaturehandlerinterface.h"
 #include "qgsvectorlayertemporalproperties.h"
 #include "qgsmapclippingutils.h"
+#include "qgsvectorlayerrendercache_p.h"
 
 #include <QPicture>
+#include <QThread>
 
 
 QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRenderContext &context )
@@ -54,7 +57,7 @@ QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRender
   mSource = new QgsVectorLayerFeatureSource( layer );
 
   mRenderer = layer->renderer() ? layer->renderer()->clone() : nullptr;
-  mSelectedFeatureIds = layer->selectedFeatureIds();
+  mSelectedFeatureIds = layer->selectedFeatureIdRanges();
 
   mDrawVertexMarkers = nullptr != layer->editBuffer();
 
@@ -62,6 +65,34 @@ QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRender
 
   mFeatureBlendMode = layer->featureBlendMode();
 
+  bool hasVolatileFields = false;
+  for ( int i = 0; i < mFields.count(); ++i )
+  {
+    const QgsFields::FieldOrigin origin = mFields.fieldOrigin( i );
+    if ( origin == QgsFields::OriginExpression || origin == QgsFields::OriginJoin )
+    {
+      hasVolatileFields = true;
+      break;
+    }
+  }
+
+  // a shared cache holding all features of the layer follows its edits, and is copied here to be read
+  // by the render thread. Values of expression and joined fields are not stable enough to be cached
+  QgsVectorLayerCache *sharedCache = QgsVectorLayerCache::sharedCache( layer );
+  if ( sharedCache && sharedCache->hasFullCache() && sharedCache->cacheGeometry() && !hasVolatileFields
+       && QThread::currentThread() == sharedCache->thread() )
+  {
+    mCachedSource.reset( sharedCache->createFeatureSource() );
+  }
+
+  // features of layers in edit mode are not stable enough to be cached, changes to joined layers are not
+  // notified to this layer. Feature filter providers may filter differently for each render
+  if ( layer->mRenderCache && !mCachedSource && !mDrawVertexMarkers && !context.featureFilterProvider() && !hasVolatileFields )
+  {
+    mRenderCache = layer->mRenderCache;
+    mRenderCacheGeneration = mRenderCache->generation();
+  }
+
   if ( context.isTemporal() )
   {
     QgsVectorLayerTemporalContext temporalContext;
@@ -286,6 +317,9 @@ bool QgsVectorLayerRenderer::render()
 
       QgsVectorSimplifyMethod vectorMethod = mSimplifyMethod;
       vectorMethod.setTolerance( map2pixelTol );
+      // geometries of the shared cache are not simplified by the provider
+      if ( mCachedSource )
+        vectorMethod.setForceLocalOptimization( true );
       context.setVectorSimplifyMethod( vectorMethod );
     }
     else
@@ -302,7 +336,13 @@ bool QgsVectorLayerRenderer::render()
     context.setVectorSimplifyMethod( vectorMethod );
   }
 
-  QgsFeatureIterator fit = mSource->getFeatures( featureRequest );
+  QgsFeatureIterator fit;
+  if ( mCachedSource )
+    fit = mCachedSource->getFeatures( featureRequest );
+  else if ( mRenderCache )
+    fit = cachedFeatures( featureRequest );
+  else
+    fit = mSource->getFeatures( featureRequest );
   // Attach an interruption checker so that iterators that have potentially
   // slow fetchFeature() implementations, such as in the WFS provider, can
   // check it, instead of relying on just the mContext.renderingStopped() check
@@ -329,6 +369,50 @@ bool QgsVectorLayerRenderer::render()
 }
 
 
+QgsFeatureIterator QgsVectorLayerRenderer::cachedFeatures( const QgsFeatureRequest &request )
+{
+  QgsVectorLayerRenderCache::Key key;
+  key.extent = request.filterRect();
+  key.simplifyMethod = request.simplifyMethod();
+
+  QgsVectorLayerRenderCache::Features features = mRenderCache->features( key );
+  QgsFeatureIterator remaining;
+  if ( !features )
+  {
+    // fetch all attributes without filters or ordering, so that the same features serve later renders
+    // with another style, selection or temporal range
+    QgsFeatureIterator fit = mSource->getFeatures( QgsFeatureRequest()
+                             .setFilterRect( key.extent )
+                             .setSimplifyMethod( key.simplifyMethod ) );
+    fit.setInterruptionChecker( mInterruptionChecker.get() );
+    if ( !fit.isValid() )
+      return fit;
+
+    std::shared_ptr< QVector< QgsFeature > > fetched = std::make_shared< QVector< QgsFeature > >();
+    qint64 bytes = 0;
+    QgsFeature feature;
+    while ( bytes <= QgsVectorLayerRenderCache::MAXIMUM_MEMORY_USAGE && fit.nextFeature( feature ) )
+    {
+      bytes += QgsVectorLayerRenderCache::estimatedMemoryUsage( feature );
+      fetched->append( feature );
+    }
+
+    if ( bytes <= QgsVectorLayerRenderCache::MAXIMUM_MEMORY_USAGE )
+    {
+      if ( !renderContext()->renderingStopped() )
+        mRenderCache->insert( key, fetched, bytes, mRenderCacheGeneration );
+    }
+    else
+    {
+      // too many features to be cached, render the rest straight from the source
+      remaining = fit;
+    }
+    features = fetched;
+  }
+
+  return QgsFeatureIterator( new QgsVectorLayerRenderCacheIterator( features, remaining, request ) );
+}
+
 void QgsVectorLayerRenderer::drawRenderer( QgsFeatureIterator &fit )
 {
   QgsExpressionContextScope *symbolScope = QgsExpressionContextUtils::updateSymbolScope( nullptr, new QgsExpressionContextScope() );
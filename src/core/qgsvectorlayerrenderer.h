@@ -41,11 +41,13 @@ typedef QList<int> QgsAttributeList;
 #include "qgsvectorsimplifymethod.h"
 #include "qgsfeedback.h"
 #include "qgsfeatureid.h"
+#include "qgsfeatureidranges.h"
 
 #include "qgsmaplayerrenderer.h"
 
 class QgsVectorLayerLabelProvider;
 class QgsVectorLayerDiagramProvider;
+class QgsVectorLayerRenderCache;
 
 /**
  * \ingroup core
@@ -111,6 +113,12 @@ class QgsVectorLayerRenderer : public QgsMapLayerRenderer
     //! Stop version 2 renderer and selected renderer (if required)
     void stopRenderer( QgsSingleSymbolRenderer *selRenderer );
 
+    /**
+     * Returns an iterator over the features of \a request read from the render cache of the layer,
+     * fetching them from the layer source and caching them first if needed.
+     */
+    QgsFeatureIterator cachedFeatures( const QgsFeatureRequest &request );
+
 
   protected:
 
@@ -121,7 +129,7 @@ class QgsVectorLayerRenderer : public QgsMapLayerRenderer
 
     QgsFields mFields; // TODO: use fields from mSource
 
-    QgsFeatureIds mSelectedFeatureIds;
+    QgsFeatureIdRanges mSelectedFeatureIds;
 
     QString mTemporalFilter;
 
@@ -168,6 +176,13 @@ class QgsVectorLayerRenderer : public QgsMapLayerRenderer
     QgsGeometry mLabelClipFeatureGeom;
     bool mApplyLabelClipGeometries = false;
 
+    //! Render cache of the layer, NULLPTR if this render is not cached
+    std::shared_ptr< QgsVectorLayerRenderCache > mRenderCache;
+    int mRenderCacheGeneration = 0;
+
+    //! Copy of the features of the shared cache of the layer, NULLPTR unless it holds all features
+    std::unique_ptr< QgsAbstractFeatureSource > mCachedSource;
+
 };
 
 
@@ -0,0 +1,46 @@
+/***************************************************************************
+                         qgsaveragerasterresampler.cpp
+                         -----------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsaveragerasterresampler.h"
+#include "qgsrasterresamplingkernel_p.h"
+#include <QImage>
+
+QgsAverageRasterResampler *QgsAverageRasterResampler::clone() const
+{
+  return new QgsAverageRasterResampler();
+}
+
+int QgsAverageRasterResampler::tileBufferPixels() const
+{
+  return 1;
+}
+
+Q_NOWARN_DEPRECATED_PUSH
+void QgsAverageRasterResampler::resample( const QImage &srcImage, QImage &dstImage )
+{
+  dstImage = resampleV2( srcImage, dstImage.size() );
+}
+Q_NOWARN_DEPRECATED_POP
+
+QImage QgsAverageRasterResampler::resampleV2( const QImage &source, const QSize &size )
+{
+  return QgsRasterResamplingKernel::resample( source, size, QgsRasterResamplingKernel::Box );
+}
+
+QString QgsAverageRasterResampler::type() const
+{
+  return QStringLiteral( "average" );
+}
@@ -0,0 +1,48 @@
+/***************************************************************************
+                         qgsaveragerasterresampler.h
+                         ---------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSAVERAGERASTERRESAMPLER_H
+#define QGSAVERAGERASTERRESAMPLER_H
+
+#include "qgsrasterresampler.h"
+#include "qgis_sip.h"
+#include "qgis.h"
+
+#include "qgis_core.h"
+
+/**
+ * \ingroup core
+ * Average raster resampler, which averages all pixels covered by each destination pixel.
+ * This avoids aliasing when zooming out and acts like nearest neighbour when zooming in.
+ * \since QGIS 3.16
+ */
+class CORE_EXPORT QgsAverageRasterResampler: public QgsRasterResamplerV2
+{
+  public:
+
+    /**
+     * Constructor for QgsAverageRasterResampler.
+     */
+    QgsAverageRasterResampler() = default;
+    Q_DECL_DEPRECATED void resample( const QImage &srcImage, QImage &dstImage ) override SIP_DEPRECATED;
+
+    QImage resampleV2( const QImage &source, const QSize &size ) override;
+    QString type() const override;
+    QgsAverageRasterResampler *clone() const override SIP_FACTORY;
+    int tileBufferPixels() const override;
+};
+
+#endif // QGSAVERAGERASTERRESAMPLER_H
@@ -16,9 +16,8 @@
  ***************************************************************************/
 
 #include "qgsbilinearrasterresampler.h"
-#include "qgsgdalutils.h"
+#include "qgsrasterresamplingkernel_p.h"
 #include <QImage>
-#include <cmath>
 
 QgsBilinearRasterResampler *QgsBilinearRasterResampler::clone() const
 {
@@ -33,13 +32,13 @@ int QgsBilinearRasterResampler::tileBufferPixels() const
 Q_NOWARN_DEPRECATED_PUSH
 void QgsBilinearRasterResampler::resample( const QImage &srcImage, QImage &dstImage )
 {
-  dstImage = QgsGdalUtils::resampleImage( srcImage, dstImage.size(), GRIORA_Bilinear );
+  dstImage = resampleV2( srcImage, dstImage.size() );
 }
 Q_NOWARN_DEPRECATED_POP
 
 QImage QgsBilinearRasterResampler::resampleV2( const QImage &source, const QSize &size )
 {
-  return source.scaled( size.width(), size.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+  return QgsRasterResamplingKernel::resample( source, size, QgsRasterResamplingKernel::Bilinear );
 }
 
 QString QgsBilinearRasterResampler::type() const
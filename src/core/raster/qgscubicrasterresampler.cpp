@@ -16,9 +16,8 @@
  ***************************************************************************/
 
 #include "qgscubicrasterresampler.h"
-#include "qgsgdalutils.h"
+#include "qgsrasterresamplingkernel_p.h"
 #include <QImage>
-#include <cmath>
 
 QgsCubicRasterResampler *QgsCubicRasterResampler::clone() const
 {
@@ -27,13 +26,13 @@ QgsCubicRasterResampler *QgsCubicRasterResampler::clone() const
 
 QImage QgsCubicRasterResampler::resampleV2( const QImage &source, const QSize &size )
 {
-  return QgsGdalUtils::resampleImage( source, size, GRIORA_Cubic );
+  return QgsRasterResamplingKernel::resample( source, size, QgsRasterResamplingKernel::Cubic );
 }
 
 Q_NOWARN_DEPRECATED_PUSH
 void QgsCubicRasterResampler::resample( const QImage &srcImage, QImage &dstImage )
 {
-  dstImage = QgsGdalUtils::resampleImage( srcImage, dstImage.size(), GRIORA_Cubic );
+  dstImage = resampleV2( srcImage, dstImage.size() );
 }
 Q_NOWARN_DEPRECATED_POP
 
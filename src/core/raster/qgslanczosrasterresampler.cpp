@@ -0,0 +1,46 @@
+/***************************************************************************
+                         qgslanczosrasterresampler.cpp
+                         -----------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgslanczosrasterresampler.h"
+#include "qgsrasterresamplingkernel_p.h"
+#include <QImage>
+
+QgsLanczosRasterResampler *QgsLanczosRasterResampler::clone() const
+{
+  return new QgsLanczosRasterResampler();
+}
+
+int QgsLanczosRasterResampler::tileBufferPixels() const
+{
+  return 3;
+}
+
+Q_NOWARN_DEPRECATED_PUSH
+void QgsLanczosRasterResampler::resample( const QImage &srcImage, QImage &dstImage )
+{
+  dstImage = resampleV2( srcImage, dstImage.size() );
+}
+Q_NOWARN_DEPRECATED_POP
+
+QImage QgsLanczosRasterResampler::resampleV2( const QImage &source, const QSize &size )
+{
+  return QgsRasterResamplingKernel::resample( source, size, QgsRasterResamplingKernel::Lanczos3 );
+}
+
+QString QgsLanczosRasterResampler::type() const
+{
+  return QStringLiteral( "lanczos" );
+}
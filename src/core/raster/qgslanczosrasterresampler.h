@@ -0,0 +1,48 @@
+/***************************************************************************
+                         qgslanczosrasterresampler.h
+                         ---------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSLANCZOSRASTERRESAMPLER_H
+#define QGSLANCZOSRASTERRESAMPLER_H
+
+#include "qgsrasterresampler.h"
+#include "qgis_sip.h"
+#include "qgis.h"
+
+#include "qgis_core.h"
+
+/**
+ * \ingroup core
+ * Lanczos raster resampler, a windowed sinc filter with a support of 3 pixels which keeps
+ * more detail than cubic resampling.
+ * \since QGIS 3.16
+ */
+class CORE_EXPORT QgsLanczosRasterResampler: public QgsRasterResamplerV2
+{
+  public:
+
+    /**
+     * Constructor for QgsLanczosRasterResampler.
+     */
+    QgsLanczosRasterResampler() = default;
+    Q_DECL_DEPRECATED void resample( const QImage &srcImage, QImage &dstImage ) override SIP_DEPRECATED;
+
+    QImage resampleV2( const QImage &source, const QSize &size ) override;
+    QString type() const override;
+    QgsLanczosRasterResampler *clone() const override SIP_FACTORY;
+    int tileBufferPixels() const override;
+};
+
+#endif // QGSLANCZOSRASTERRESAMPLER_H
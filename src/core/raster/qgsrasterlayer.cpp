@@ -37,6 +37,7 @@ email                : tim at linfiniti.com
 #include "qgsrasteriterator.h"
 #include "qgsrasterlayer.h"
 #include "qgsrasterlayerrenderer.h"
+#include "qgsrastertilecache_p.h"
 #include "qgsrasterprojector.h"
 #include "qgsrasterrange.h"
 #include "qgsrasterrendererregistry.h"
@@ -160,6 +161,7 @@ QgsRasterLayer *QgsRasterLayer::clone() const
     if ( mPipe.at( i ) )
       layer->pipe()->set( mPipe.at( i )->clone() );
   }
+  layer->setTileCacheEnabled( isTileCacheEnabled() );
 
   return layer;
 }
@@ -601,6 +603,13 @@ void QgsRasterLayer::init()
   //Initialize the last view port structure, should really be a class
   mLastViewPort.mWidth = 0;
   mLastViewPort.mHeight = 0;
+
+  // cached tiles are outdated as soon as anything which affects rendering changes
+  connect( this, &QgsMapLayer::repaintRequested, this, &QgsRasterLayer::clearTileCache, Qt::UniqueConnection );
+  connect( this, &QgsMapLayer::styleChanged, this, &QgsRasterLayer::clearTileCache, Qt::UniqueConnection );
+  connect( this, &QgsMapLayer::rendererChanged, this, &QgsRasterLayer::clearTileCache, Qt::UniqueConnection );
+  connect( this, &QgsMapLayer::dataChanged, this, &QgsRasterLayer::clearTileCache, Qt::UniqueConnection );
+  connect( this, &QgsMapLayer::crsChanged, this, &QgsRasterLayer::clearTileCache, Qt::UniqueConnection );
 }
 
 void QgsRasterLayer::setDataProvider( QString const &provider, const QgsDataProvider::ProviderOptions &options )
@@ -1676,6 +1685,29 @@ void QgsRasterLayer::setTransformContext( const QgsCoordinateTransformContext &t
 {
   if ( mDataProvider )
     mDataProvider->setTransformContext( transformContext );
+  clearTileCache();
+}
+
+void QgsRasterLayer::setTileCacheEnabled( bool enabled )
+{
+  if ( enabled == isTileCacheEnabled() )
+    return;
+
+  if ( enabled )
+    mTileCache = std::make_shared< QgsRasterTileCache >();
+  else
+    mTileCache.reset();
+}
+
+bool QgsRasterLayer::isTileCacheEnabled() const
+{
+  return static_cast< bool >( mTileCache );
+}
+
+void QgsRasterLayer::clearTileCache()
+{
+  if ( mTileCache )
+    mTileCache->clear();
 }
 
 QStringList QgsRasterLayer::subLayers() const
@@ -2023,6 +2055,8 @@ bool QgsRasterLayer::readXml( const QDomNode &layer_node, QgsReadWriteContext &c
     }
   }
 
+  setTileCacheEnabled( layer_node.firstChildElement( QStringLiteral( "tileCache" ) ).attribute( QStringLiteral( "enabled" ) ) == QLatin1String( "1" ) );
+
   readStyleManager( layer_node );
 
   return res;
@@ -2131,6 +2165,13 @@ bool QgsRasterLayer::writeXml( QDomNode &layer_node,
     layer_node.appendChild( noData );
   }
 
+  if ( isTileCacheEnabled() )
+  {
+    QDomElement tileCacheElement = document.createElement( QStringLiteral( "tileCache" ) );
+    tileCacheElement.setAttribute( QStringLiteral( "enabled" ), QStringLiteral( "1" ) );
+    layer_node.appendChild( tileCacheElement );
+  }
+
   writeStyleManager( layer_node, document );
 
   //write out the symbology
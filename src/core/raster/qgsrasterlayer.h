@@ -29,6 +29,7 @@
 #include <QMap>
 #include <QPair>
 #include <QVector>
+#include <memory>
 
 #include "qgis_sip.h"
 #include "qgsmaplayer.h"
@@ -43,6 +44,7 @@ class QgsMapToPixel;
 class QgsRasterRenderer;
 class QgsRectangle;
 class QgsRasterLayerTemporalProperties;
+class QgsRasterTileCache;
 
 class QImage;
 class QPixmap;
@@ -459,6 +461,46 @@ class CORE_EXPORT QgsRasterLayer : public QgsMapLayer
      */
     bool ignoreExtents() const;
 
+    /**
+     * Sets whether rendered tiles of the layer are cached.
+     *
+     * When enabled, the layer is rendered as tiles of a fixed grid in the destination CRS, with
+     * a resolution of a power of two map units per pixel on each zoom level. Tiles are kept in
+     * memory and reused by later renders, e.g. when panning the map or when a server renders
+     * the same area again, and are scaled to the map resolution when they are drawn.
+     *
+     * The cache is cleared whenever the layer is repainted because its style, renderer or data changed.
+     * Tiles are also keyed on the state of the renderer and the other pipe interfaces, so changes
+     * made to them in place, without a repaint, are rendered as new tiles. Layers whose renderer recalculates its min/max values from the current map extent and layers with
+     * an active temporal range are not cached.
+     *
+     * The tile cache is disabled by default.
+     *
+     * \see isTileCacheEnabled()
+     * \see clearTileCache()
+     * \since QGIS 3.16
+     */
+    void setTileCacheEnabled( bool enabled );
+
+    /**
+     * Returns TRUE if rendered tiles of the layer are cached.
+     *
+     * \see setTileCacheEnabled()
+     * \since QGIS 3.16
+     */
+    bool isTileCacheEnabled() const;
+
+    /**
+     * Removes all cached tiles of the layer.
+     *
+     * This is done automatically when the style, renderer or data of the layer change, or when
+     * a repaint of the layer is requested.
+     *
+     * \see setTileCacheEnabled()
+     * \since QGIS 3.16
+     */
+    void clearTileCache();
+
     QgsMapLayerTemporalProperties *temporalProperties() override;
 
   public slots:
@@ -546,6 +588,11 @@ class CORE_EXPORT QgsRasterLayer : public QgsMapLayer
 
     QDomDocument mOriginalStyleDocument;
     QDomElement mOriginalStyleElement;
+
+    //! Cache of rendered tiles, shared with the layer renderers. NULLPTR if the tile cache is disabled
+    std::shared_ptr< QgsRasterTileCache > mTileCache;
+
+    friend class QgsRasterLayerRenderer;
 };
 
 // clazy:excludeall=qstring-allocations
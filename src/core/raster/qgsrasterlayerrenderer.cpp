@@ -26,6 +26,15 @@
 #include "qgsexception.h"
 #include "qgsrasterlayertemporalproperties.h"
 #include "qgsmapclippingutils.h"
+#include "qgsrastertilecache_p.h"
+#include "qgsrasterrenderer.h"
+
+#include <QPainter>
+#include <cmath>
+#include <limits>
+#ifndef QT_NO_PRINTER
+#include <QPrinter>
+#endif
 
 ///@cond PRIVATE
 
@@ -258,6 +267,19 @@ QgsRasterLayerRenderer::QgsRasterLayerRenderer( QgsRasterLayer *layer, QgsRender
   }
 
   mClippingRegions = QgsMapClippingUtils::collectClippingRegionsForLayer( *renderContext(), layer );
+
+  // the tile cache can only be used if the rendered pixels do not depend on the map extent
+  if ( layer->mTileCache
+       && !( rasterRenderer && rasterRenderer->minMaxOrigin().limits() != QgsRasterMinMaxOrigin::None
+             && rasterRenderer->minMaxOrigin().extent() != QgsRasterMinMaxOrigin::WholeRaster )
+       && !( temporalProperties->isActive() && renderContext()->isTemporal() ) )
+  {
+    mTileCache = layer->mTileCache;
+    mTileCacheGeneration = mTileCache->generation();
+    mTileCacheCrs = mRasterViewPort->mDestCRS.toWkt( QgsCoordinateReferenceSystem::WKT_PREFERRED );
+    mTileCachePipe = QgsRasterTileCache::pipeKey( *mPipe );
+    mTileMapToPixel = mapToPixel;
+  }
 }
 
 QgsRasterLayerRenderer::~QgsRasterLayerRenderer()
@@ -313,10 +335,20 @@ bool QgsRasterLayerRenderer::render()
     projector->setCrs( mRasterViewPort->mSrcCRS, mRasterViewPort->mDestCRS, mRasterViewPort->mTransformContext );
   }
 
-  // Drawer to pipe?
-  QgsRasterIterator iterator( mPipe->last() );
-  QgsRasterDrawer drawer( &iterator );
-  drawer.draw( renderContext()->painter(), mRasterViewPort, &renderContext()->mapToPixel(), mFeedback );
+  bool useTileCache = static_cast< bool >( mTileCache );
+#ifndef QT_NO_PRINTER
+  // printed output is drawn at its full resolution
+  if ( dynamic_cast<QPrinter *>( renderContext()->painter()->device() ) )
+    useTileCache = false;
+#endif
+
+  if ( !useTileCache || !drawCachedTiles() )
+  {
+    // Drawer to pipe?
+    QgsRasterIterator iterator( mPipe->last() );
+    QgsRasterDrawer drawer( &iterator );
+    drawer.draw( renderContext()->painter(), mRasterViewPort, &renderContext()->mapToPixel(), mFeedback );
+  }
 
   if ( restoreOldResamplingStage )
   {
@@ -339,3 +371,81 @@ QgsFeedback *QgsRasterLayerRenderer::feedback() const
   return mFeedback;
 }
 
+bool QgsRasterLayerRenderer::drawCachedTiles()
+{
+  // if the view covers more tiles than this the resolution is likely very coarse for the layer (e.g.
+  // a geographic CRS near the poles), so it is rendered directly instead
+  const double maximumTileCount = 256;
+
+  const int zoom = QgsRasterTileCache::zoomForResolution( mTileMapToPixel.mapUnitsPerPixel() );
+  const double tileSize = QgsRasterTileCache::TILE_SIZE * QgsRasterTileCache::resolution( zoom );
+  const QgsRectangle &extent = mRasterViewPort->mDrawnExtent;
+
+  const double firstColumn = std::floor( extent.xMinimum() / tileSize );
+  const double lastColumn = std::ceil( extent.xMaximum() / tileSize ) - 1;
+  const double firstRow = std::floor( -extent.yMaximum() / tileSize );
+  const double lastRow = std::ceil( -extent.yMinimum() / tileSize ) - 1;
+  if ( !std::isfinite( firstColumn ) || !std::isfinite( lastColumn ) || !std::isfinite( firstRow ) || !std::isfinite( lastRow )
+       || ( lastColumn - firstColumn + 1 ) * ( lastRow - firstRow + 1 ) > maximumTileCount
+       || std::fabs( firstColumn ) > std::numeric_limits< int >::max() / 2 || std::fabs( lastColumn ) > std::numeric_limits< int >::max() / 2
+       || std::fabs( firstRow ) > std::numeric_limits< int >::max() / 2 || std::fabs( lastRow ) > std::numeric_limits< int >::max() / 2 )
+  {
+    return false;
+  }
+
+  QPainter *painter = renderContext()->painter();
+  QgsScopedQPainterState painterState( painter );
+  painter->setRenderHint( QPainter::Antialiasing, false );
+  painter->setRenderHint( QPainter::SmoothPixmapTransform, true );
+
+  const double rotation = renderContext()->mapToPixel().mapRotation();
+  if ( rotation )
+  {
+    // tiles are placed without rotation, the painter rotates them around the map center
+    const double cx = renderContext()->mapToPixel().mapWidth() / 2.0;
+    const double cy = renderContext()->mapToPixel().mapHeight() / 2.0;
+    painter->translate( cx, cy );
+    painter->rotate( rotation );
+    painter->translate( -cx, -cy );
+  }
+
+  QgsRasterTileCache::TileKey key;
+  key.crs = mTileCacheCrs;
+  key.pipe = mTileCachePipe;
+  key.zoom = zoom;
+  for ( int row = static_cast< int >( firstRow ); row <= static_cast< int >( lastRow ); ++row )
+  {
+    for ( int column = static_cast< int >( firstColumn ); column <= static_cast< int >( lastColumn ); ++column )
+    {
+      if ( mFeedback->isCanceled() )
+        return true;
+
+      key.column = column;
+      key.row = row;
+      const QgsRectangle tileExtent = QgsRasterTileCache::tileExtent( zoom, column, row );
+
+      QImage image;
+      if ( !mTileCache->tile( key, image ) )
+      {
+        std::unique_ptr< QgsRasterBlock > block( mPipe->last()->block( 1, tileExtent, QgsRasterTileCache::TILE_SIZE, QgsRasterTileCache::TILE_SIZE, mFeedback ) );
+        // a canceled request may have returned an incomplete tile, which must not be cached
+        if ( mFeedback->isCanceled() )
+          return true;
+        if ( !block || block->isEmpty() )
+          continue;
+
+        image = block->image();
+        if ( image.isNull() )
+          continue;
+
+        mTileCache->insert( key, image, mTileCacheGeneration );
+      }
+
+      const QPointF topLeft = mTileMapToPixel.transform( tileExtent.xMinimum(), tileExtent.yMaximum() ).toQPointF();
+      const QPointF bottomRight = mTileMapToPixel.transform( tileExtent.xMaximum(), tileExtent.yMinimum() ).toQPointF();
+      painter->drawImage( QRectF( topLeft, bottomRight ), image );
+    }
+  }
+  return true;
+}
+
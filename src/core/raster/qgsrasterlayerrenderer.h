@@ -21,6 +21,9 @@
 #include "qgsmaplayerrenderer.h"
 #include "qgsrasterdataprovider.h"
 #include "qgsmapclippingregion.h"
+#include "qgsmaptopixel.h"
+
+#include <memory>
 
 class QPainter;
 
@@ -29,6 +32,7 @@ class QgsRasterLayer;
 class QgsRasterPipe;
 struct QgsRasterViewPort;
 class QgsRenderContext;
+class QgsRasterTileCache;
 
 class QgsRasterLayerRenderer;
 
@@ -78,6 +82,12 @@ class CORE_EXPORT QgsRasterLayerRenderer : public QgsMapLayerRenderer
 
   private:
 
+    /**
+     * Draws the visible tiles of the tile cache grid, rendering the tiles which are not cached yet.
+     * Returns FALSE if the view covers too many tiles, in which case nothing is drawn.
+     */
+    bool drawCachedTiles();
+
     QgsRasterViewPort *mRasterViewPort = nullptr;
 
     QgsRasterPipe *mPipe = nullptr;
@@ -89,6 +99,17 @@ class CORE_EXPORT QgsRasterLayerRenderer : public QgsMapLayerRenderer
 
     QList< QgsMapClippingRegion > mClippingRegions;
 
+    //! Tile cache of the layer, NULLPTR if the render does not use the tile cache
+    std::shared_ptr< QgsRasterTileCache > mTileCache;
+    //! Generation of the tile cache when the render was prepared
+    int mTileCacheGeneration = 0;
+    //! Destination CRS of the cached tiles
+    QString mTileCacheCrs;
+    //! State of the pipe rendering the cached tiles
+    QString mTileCachePipe;
+    //! Map to pixel transform without rotation
+    QgsMapToPixel mTileMapToPixel;
+
     friend class QgsRasterLayerRendererFeedback;
 };
 
@@ -22,6 +22,10 @@
 #include "qgscoordinatetransform.h"
 #include "qgsexception.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <memory>
+
 Q_NOWARN_DEPRECATED_PUSH // because of deprecated members
 QgsRasterProjector::QgsRasterProjector()
   : QgsRasterInterface( nullptr )
@@ -90,6 +94,69 @@ void QgsRasterProjector::setCrs( const QgsCoordinateReferenceSystem &srcCRS, con
 }
 
 
+///@cond PRIVATE
+
+/**
+ * Control point grid calculated for a destination extent and size, shared between the
+ * ProjectorData objects created for repeated requests of the same block, e.g. for each
+ * band of a multiband raster or when a view is redrawn.
+ */
+struct ControlGrid
+{
+  //! Key of the transform, destination extent and size and precision of the grid, see controlGridKey()
+  QString key;
+  //! Hash of the key, compared before the key itself
+  uint keyHash = 0;
+
+  QList< QList<QgsPointXY> > cpMatrix;
+  QList< QList<bool> > cpLegalMatrix;
+  int cpRows = 0;
+  int cpCols = 0;
+  bool approximate = false;
+};
+
+/**
+ * Returns the key of the control point grid of the destination \a extent and size for the
+ * inverse transform \a ct, or an empty string if the grid cannot be cached.
+ *
+ * As in the transform cache of QgsCoordinateTransform, CRSs are identified by their authid,
+ * or by their WKT if they have none, which is much cheaper to compare than the CRSs themselves.
+ * The extent is written with full precision, so that only identical extents match.
+ */
+static QString controlGridKey( const QgsCoordinateTransform &ct, const QgsRectangle &extent, int rows, int cols, QgsRasterProjector::Precision precision )
+{
+  const QgsCoordinateReferenceSystem sourceCrs = ct.sourceCrs();
+  const QgsCoordinateReferenceSystem destinationCrs = ct.destinationCrs();
+  const QString sourceKey = sourceCrs.authid().isEmpty() ?
+                            sourceCrs.toWkt( QgsCoordinateReferenceSystem::WKT_PREFERRED ) : sourceCrs.authid();
+  const QString destinationKey = destinationCrs.authid().isEmpty() ?
+                                 destinationCrs.toWkt( QgsCoordinateReferenceSystem::WKT_PREFERRED ) : destinationCrs.authid();
+  if ( sourceKey.isEmpty() || destinationKey.isEmpty() )
+    return QString();
+
+  Q_NOWARN_DEPRECATED_PUSH
+  const int sourceDatumTransform = ct.sourceDatumTransformId();
+  const int destinationDatumTransform = ct.destinationDatumTransformId();
+  Q_NOWARN_DEPRECATED_POP
+  return ( QStringList() << sourceKey << destinationKey << ct.coordinateOperation()
+           << QString::number( sourceDatumTransform ) << QString::number( destinationDatumTransform )
+           << qgsDoubleToString( extent.xMinimum() ) << qgsDoubleToString( extent.yMinimum() )
+           << qgsDoubleToString( extent.xMaximum() ) << qgsDoubleToString( extent.yMaximum() )
+           << QString::number( rows ) << QString::number( cols ) << QString::number( static_cast< int >( precision ) ) ).join( '|' );
+}
+
+//! Maximum number of control point grids kept in the cache
+static const int MAX_CACHED_CONTROL_GRIDS = 32;
+
+//! Grids larger than this number of control points are not cached
+static const int MAX_CACHED_CONTROL_GRID_POINTS = 65536;
+
+//! Most recently used control point grids, most recent first
+static QList< std::shared_ptr< const ControlGrid > > sControlGridCache;
+static QMutex sControlGridCacheMutex;
+
+///@endcond
+
 ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height, QgsRasterInterface *input, const QgsCoordinateTransform &inverseCt, QgsRasterProjector::Precision precision, QgsRasterBlockFeedback *feedback )
   : mApproximate( false )
   , mInverseCt( inverseCt )
@@ -157,57 +224,63 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   }
 
   // Always try to calculate mCPMatrix, it is used in calcSrcExtent() for both Approximate and Exact
-  // Initialize the matrix by corners and middle points
-  mCPCols = mCPRows = 3;
-  for ( int i = 0; i < mCPRows; i++ )
-  {
-    QList<QgsPointXY> myRow;
-    myRow.append( QgsPointXY() );
-    myRow.append( QgsPointXY() );
-    myRow.append( QgsPointXY() );
-    mCPMatrix.insert( i, myRow );
-    // And the legal points
-    QList<bool> myLegalRow;
-    myLegalRow.append( bool( false ) );
-    myLegalRow.append( bool( false ) );
-    myLegalRow.append( bool( false ) );
-    mCPLegalMatrix.insert( i, myLegalRow );
-  }
-  for ( int i = 0; i < mCPRows; i++ )
-  {
-    calcRow( i, inverseCt );
-  }
-
-  while ( true )
+  const QString gridKey = controlGridKey( inverseCt, mDestExtent, mDestRows, mDestCols, precision );
+  if ( !readCachedControlGrid( gridKey ) )
   {
-    bool myColsOK = checkCols( inverseCt );
-    if ( !myColsOK )
+    // Initialize the matrix by corners and middle points
+    mCPCols = mCPRows = 3;
+    for ( int i = 0; i < mCPRows; i++ )
     {
-      insertRows( inverseCt );
-    }
-    bool myRowsOK = checkRows( inverseCt );
-    if ( !myRowsOK )
-    {
-      insertCols( inverseCt );
-    }
-    if ( myColsOK && myRowsOK )
-    {
-      QgsDebugMsgLevel( QStringLiteral( "CP matrix within tolerance" ), 4 );
-      break;
+      QList<QgsPointXY> myRow;
+      myRow.append( QgsPointXY() );
+      myRow.append( QgsPointXY() );
+      myRow.append( QgsPointXY() );
+      mCPMatrix.insert( i, myRow );
+      // And the legal points
+      QList<bool> myLegalRow;
+      myLegalRow.append( bool( false ) );
+      myLegalRow.append( bool( false ) );
+      myLegalRow.append( bool( false ) );
+      mCPLegalMatrix.insert( i, myLegalRow );
     }
-    // What is the maximum reasonable size of transformatio matrix?
-    // TODO: consider better when to break - ratio
-    if ( mCPRows * mCPCols > 0.25 * mDestRows * mDestCols )
-      //if ( mCPRows * mCPCols > mDestRows * mDestCols )
+    for ( int i = 0; i < mCPRows; i++ )
     {
-      QgsDebugMsgLevel( QStringLiteral( "Too large CP matrix" ), 4 );
-      mApproximate = false;
-      break;
+      calcRow( i, inverseCt );
     }
-    if ( feedback && feedback->isCanceled() )
+
+    while ( true )
     {
-      return;
+      bool myColsOK = checkCols( inverseCt );
+      if ( !myColsOK )
+      {
+        insertRows( inverseCt );
+      }
+      bool myRowsOK = checkRows( inverseCt );
+      if ( !myRowsOK )
+      {
+        insertCols( inverseCt );
+      }
+      if ( myColsOK && myRowsOK )
+      {
+        QgsDebugMsgLevel( QStringLiteral( "CP matrix within tolerance" ), 4 );
+        break;
+      }
+      // What is the maximum reasonable size of transformatio matrix?
+      // TODO: consider better when to break - ratio
+      if ( mCPRows * mCPCols > 0.25 * mDestRows * mDestCols )
+        //if ( mCPRows * mCPCols > mDestRows * mDestCols )
+      {
+        QgsDebugMsgLevel( QStringLiteral( "Too large CP matrix" ), 4 );
+        mApproximate = false;
+        break;
+      }
+      if ( feedback && feedback->isCanceled() )
+      {
+        return;
+      }
     }
+
+    cacheControlGrid( gridKey );
   }
   QgsDebugMsgLevel( QStringLiteral( "CPMatrix size: mCPRows = %1 mCPCols = %2" ).arg( mCPRows ).arg( mCPCols ), 4 );
   mDestRowsPerMatrixRow = static_cast< double >( mDestRows ) / ( mCPRows - 1 );
@@ -219,10 +292,12 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
 #endif
 
   // init helper points
-  pHelperTop = new QgsPointXY[mDestCols];
-  pHelperBottom = new QgsPointXY[mDestCols];
-  calcHelper( 0, pHelperTop );
-  calcHelper( 1, pHelperBottom );
+  mHelperTopX.resize( mDestCols );
+  mHelperTopY.resize( mDestCols );
+  mHelperBottomX.resize( mDestCols );
+  mHelperBottomY.resize( mDestCols );
+  calcHelper( 0, mHelperTopX.data(), mHelperTopY.data() );
+  calcHelper( 1, mHelperBottomX.data(), mHelperBottomY.data() );
   mHelperTopRow = 0;
 
   // Calculate source dimensions
@@ -232,10 +307,69 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   mSrcXRes = mSrcExtent.width() / mSrcCols;
 }
 
-ProjectorData::~ProjectorData()
+ProjectorData::~ProjectorData() = default;
+
+bool ProjectorData::readCachedControlGrid( const QString &key )
+{
+  if ( key.isEmpty() )
+    return false;
+
+  const uint keyHash = qHash( key );
+  std::shared_ptr< const ControlGrid > grid;
+  {
+    QMutexLocker locker( &sControlGridCacheMutex );
+    for ( int i = 0; i < sControlGridCache.size(); ++i )
+    {
+      const ControlGrid *candidate = sControlGridCache.at( i ).get();
+      if ( candidate->keyHash == keyHash && candidate->key == key )
+      {
+        grid = sControlGridCache.at( i );
+        sControlGridCache.move( i, 0 );
+        break;
+      }
+    }
+  }
+  if ( !grid )
+    return false;
+
+  mCPMatrix = grid->cpMatrix;
+  mCPLegalMatrix = grid->cpLegalMatrix;
+  mCPRows = grid->cpRows;
+  mCPCols = grid->cpCols;
+  mApproximate = grid->approximate;
+  return true;
+}
+
+void ProjectorData::cacheControlGrid( const QString &key ) const
 {
-  delete[] pHelperTop;
-  delete[] pHelperBottom;
+  if ( key.isEmpty() || mCPRows * mCPCols > MAX_CACHED_CONTROL_GRID_POINTS )
+    return;
+
+  std::shared_ptr< ControlGrid > grid = std::make_shared< ControlGrid >();
+  grid->key = key;
+  grid->keyHash = qHash( key );
+  grid->cpMatrix = mCPMatrix;
+  grid->cpLegalMatrix = mCPLegalMatrix;
+  grid->cpRows = mCPRows;
+  grid->cpCols = mCPCols;
+  grid->approximate = mApproximate;
+
+  QMutexLocker locker( &sControlGridCacheMutex );
+  sControlGridCache.prepend( grid );
+  while ( sControlGridCache.size() > MAX_CACHED_CONTROL_GRIDS )
+    sControlGridCache.removeLast();
+}
+
+void ProjectorData::clearControlGridCache()
+{
+  QMutexLocker locker( &sControlGridCacheMutex );
+  sControlGridCache.clear();
+}
+
+int ProjectorData::controlGridCacheSize()
+{
+  QMutexLocker locker( &sControlGridCacheMutex );
+  return sControlGridCache.size();
 }
 
 
@@ -417,7 +551,7 @@ inline int ProjectorData::matrixCol( int destCol )
   return static_cast< int >( std::floor( ( destCol + 0.5 ) / mDestColsPerMatrixCol ) );
 }
 
-void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
+void ProjectorData::calcHelper( int matrixRow, double *xPoints, double *yPoints )
 {
   // TODO?: should we also precalc dest cell center coordinates for x and y?
   for ( int myDestCol = 0; myDestCol < mDestCols; myDestCol++ )
@@ -438,19 +572,17 @@ void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
     double s = mySrcPoint0.x() + ( mySrcPoint1.x() - mySrcPoint0.x() ) * xfrac;
     double t = mySrcPoint0.y() + ( mySrcPoint1.y() - mySrcPoint0.y() ) * xfrac;
 
-    points[myDestCol].setX( s );
-    points[myDestCol].setY( t );
+    xPoints[myDestCol] = s;
+    yPoints[myDestCol] = t;
   }
 }
 
 void ProjectorData::nextHelper()
 {
-  // We just switch pHelperTop and pHelperBottom, memory is not lost
-  QgsPointXY *tmp = nullptr;
-  tmp = pHelperTop;
-  pHelperTop = pHelperBottom;
-  pHelperBottom = tmp;
-  calcHelper( mHelperTopRow + 2, pHelperBottom );
+  // We just switch top and bottom helpers, memory is not lost
+  mHelperTopX.swap( mHelperBottomX );
+  mHelperTopY.swap( mHelperBottomY );
+  calcHelper( mHelperTopRow + 2, mHelperBottomX.data(), mHelperBottomY.data() );
   mHelperTopRow++;
 }
 
@@ -466,6 +598,65 @@ bool ProjectorData::srcRowCol( int destRow, int destCol, int *srcRow, int *srcCo
   }
 }
 
+void ProjectorData::srcRowCols( int destRow, int *srcRows, int *srcCols )
+{
+  if ( !mApproximate )
+  {
+    for ( int destCol = 0; destCol < mDestCols; ++destCol )
+    {
+      if ( !preciseSrcRowCol( destRow, destCol, srcRows + destCol, srcCols + destCol ) )
+      {
+        srcRows[destCol] = -1;
+        srcCols[destCol] = -1;
+      }
+    }
+    return;
+  }
+
+  const int myMatrixRow = matrixRow( destRow );
+  if ( myMatrixRow > mHelperTopRow )
+  {
+    nextHelper();
+  }
+
+  // the interpolation factor between the helper rows is the same for all columns
+  const double myDestY = mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes;
+  double myDestXMin, myDestYMin, myDestXMax, myDestYMax;
+  destPointOnCPMatrix( myMatrixRow + 1, 0, &myDestXMin, &myDestYMin );
+  destPointOnCPMatrix( myMatrixRow, 1, &myDestXMax, &myDestYMax );
+  const double yfrac = ( myDestY - myDestYMin ) / ( myDestYMax - myDestYMin );
+
+  const double *topX = mHelperTopX.data();
+  const double *topY = mHelperTopY.data();
+  const double *bottomX = mHelperBottomX.data();
+  const double *bottomY = mHelperBottomY.data();
+  const double extentXMin = mExtent.xMinimum();
+  const double extentXMax = mExtent.xMaximum();
+  const double extentYMin = mExtent.yMinimum();
+  const double extentYMax = mExtent.yMaximum();
+  const double srcXMin = mSrcExtent.xMinimum();
+  const double srcYMax = mSrcExtent.yMaximum();
+  const double srcXRes = mSrcXRes;
+  const double srcYRes = mSrcYRes;
+  const int srcRowCount = mSrcRows;
+  const int srcColCount = mSrcCols;
+
+  // branch free loop over plain arrays, so that the compiler can vectorize it
+  for ( int destCol = 0; destCol < mDestCols; ++destCol )
+  {
+    const double mySrcX = bottomX[destCol] + ( topX[destCol] - bottomX[destCol] ) * yfrac;
+    const double mySrcY = bottomY[destCol] + ( topY[destCol] - bottomY[destCol] ) * yfrac;
+
+    const double row = std::floor( ( srcYMax - mySrcY ) / srcYRes );
+    const double col = std::floor( ( mySrcX - srcXMin ) / srcXRes );
+
+    const bool inside = extentXMin <= mySrcX && mySrcX <= extentXMax && extentYMin <= mySrcY && mySrcY <= extentYMax
+                        && row >= 0 && row < srcRowCount && col >= 0 && col < srcColCount;
+    srcRows[destCol] = inside ? static_cast< int >( row ) : -1;
+    srcCols[destCol] = inside ? static_cast< int >( col ) : -1;
+  }
+}
+
 bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
 {
 #if 0 // too slow, even if we only run it on debug builds!
@@ -544,17 +735,10 @@ bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow,
 
   double yfrac = ( myDestY - myDestYMin ) / ( myDestYMax - myDestYMin );
 
-  QgsPointXY &myTop = pHelperTop[destCol];
-  QgsPointXY &myBot = pHelperBottom[destCol];
-
-  // Warning: this is very SLOW compared to the following code!:
-  //double mySrcX = myBot.x() + (myTop.x() - myBot.x()) * yfrac;
-  //double mySrcY = myBot.y() + (myTop.y() - myBot.y()) * yfrac;
-
-  double tx = myTop.x();
-  double ty = myTop.y();
-  double bx = myBot.x();
-  double by = myBot.y();
+  double tx = mHelperTopX[destCol];
+  double ty = mHelperTopY[destCol];
+  double bx = mHelperBottomX[destCol];
+  double by = mHelperBottomY[destCol];
   double mySrcX = bx + ( tx - bx ) * yfrac;
   double mySrcY = by + ( ty - by ) * yfrac;
 
@@ -849,15 +1033,18 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
 
   outputBlock->setIsNoData();
 
-  int srcRow, srcCol;
+  std::vector< int > srcRows( static_cast< std::size_t >( width ) );
+  std::vector< int > srcCols( static_cast< std::size_t >( width ) );
   for ( int i = 0; i < height; ++i )
   {
     if ( feedback && feedback->isCanceled() )
       break;
+    pd.srcRowCols( i, srcRows.data(), srcCols.data() );
     for ( int j = 0; j < width; ++j )
     {
-      bool inside = pd.srcRowCol( i, j, &srcRow, &srcCol );
-      if ( !inside ) continue; // we have everything set to no data
+      const int srcRow = srcRows[j];
+      const int srcCol = srcCols[j];
+      if ( srcRow < 0 ) continue; // we have everything set to no data
 
       qgssize srcIndex = static_cast< qgssize >( srcRow * pd.srcCols() + srcCol );
 
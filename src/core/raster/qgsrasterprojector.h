@@ -34,6 +34,7 @@
 #include "qgsrasterinterface.h"
 
 #include <cmath>
+#include <vector>
 
 class QgsPointXY;
 
@@ -135,7 +136,7 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
  * QgsRasterProjector creates it and then keeps calling srcRowCol() to get source pixel position
  * for every destination pixel position.
  */
-class ProjectorData
+class CORE_EXPORT ProjectorData
 {
   public:
     //! Initialize reprojector and calculate matrix
@@ -152,10 +153,26 @@ class ProjectorData
      */
     bool srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
 
+    /**
+     * Calculates the source row and column indexes for all columns of destination row \a destRow,
+     * and stores them in \a srcRows and \a srcCols, which must have room for one entry per destination
+     * column. Both indexes are set to -1 for pixels outside the source.
+     *
+     * With approximate precision, all columns of a row are interpolated from the control point grid
+     * in a single pass. Rows should be requested in increasing order, as with srcRowCol().
+     */
+    void srcRowCols( int destRow, int *srcRows, int *srcCols );
+
     QgsRectangle srcExtent() const { return mSrcExtent; }
     int srcRows() const { return mSrcRows; }
     int srcCols() const { return mSrcCols; }
 
+    //! Removes all control point grids from the process wide grid cache
+    static void clearControlGridCache();
+
+    //! Returns the number of control point grids in the process wide grid cache
+    static int controlGridCacheSize();
+
   private:
 
     //! Returns the destination point for _current_ destination position.
@@ -206,8 +223,14 @@ class ProjectorData
     */
     bool checkRows( const QgsCoordinateTransform &ct );
 
-    //! Calculate array of src helper points
-    void calcHelper( int matrixRow, QgsPointXY *points );
+    //! Calculate arrays of src helper point coordinates
+    void calcHelper( int matrixRow, double *xPoints, double *yPoints );
+
+    //! Returns TRUE if the control point grid with the given \a key was found in the grid cache, and copies it
+    bool readCachedControlGrid( const QString &key );
+
+    //! Stores the current control point grid in the grid cache with the given \a key
+    void cacheControlGrid( const QString &key ) const;
 
     //! Calc / switch helper
     void nextHelper();
@@ -270,13 +293,14 @@ class ProjectorData
     /* Same size as mCPMatrix */
     QList< QList<bool> > mCPLegalMatrix;
 
-    //! Array of source points for each destination column on top of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPointXY *pHelperTop = nullptr;
+    //! Arrays of source point coordinates for each destination column on top of current CPMatrix grid row
+    /* Stored as separate x and y arrays, so that whole rows can be interpolated in a vectorized loop */
+    std::vector< double > mHelperTopX;
+    std::vector< double > mHelperTopY;
 
-    //! Array of source points for each destination column on bottom of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPointXY *pHelperBottom = nullptr;
+    //! Arrays of source point coordinates for each destination column on bottom of current CPMatrix grid row
+    std::vector< double > mHelperBottomX;
+    std::vector< double > mHelperBottomY;
 
     //! Current mHelperTop matrix row
     int mHelperTopRow;
@@ -26,6 +26,8 @@
 //resamplers
 #include "qgsbilinearrasterresampler.h"
 #include "qgscubicrasterresampler.h"
+#include "qgslanczosrasterresampler.h"
+#include "qgsaveragerasterresampler.h"
 
 #include <QDomDocument>
 #include <QDomElement>
@@ -299,6 +301,10 @@ void QgsRasterResampleFilter::readXml( const QDomElement &filterElem )
   {
     mZoomedInResampler.reset( new QgsCubicRasterResampler() );
   }
+  else if ( zoomedInResamplerType == QLatin1String( "lanczos" ) )
+  {
+    mZoomedInResampler.reset( new QgsLanczosRasterResampler() );
+  }
 
   QString zoomedOutResamplerType = filterElem.attribute( QStringLiteral( "zoomedOutResampler" ) );
   if ( zoomedOutResamplerType == QLatin1String( "bilinear" ) )
@@ -309,4 +315,12 @@ void QgsRasterResampleFilter::readXml( const QDomElement &filterElem )
   {
     mZoomedOutResampler.reset( new QgsCubicRasterResampler() );
   }
+  else if ( zoomedOutResamplerType == QLatin1String( "lanczos" ) )
+  {
+    mZoomedOutResampler.reset( new QgsLanczosRasterResampler() );
+  }
+  else if ( zoomedOutResamplerType == QLatin1String( "average" ) )
+  {
+    mZoomedOutResampler.reset( new QgsAverageRasterResampler() );
+  }
 }
@@ -35,6 +35,8 @@ class CORE_EXPORT QgsRasterResampler
 #ifdef SIP_RUN
 #include "qgsbilinearrasterresampler.h"
 #include "qgscubicrasterresampler.h"
+#include "qgslanczosrasterresampler.h"
+#include "qgsaveragerasterresampler.h"
 #endif
 
 
@@ -44,6 +46,10 @@ class CORE_EXPORT QgsRasterResampler
       sipType = sipType_QgsBilinearRasterResampler;
     else if ( dynamic_cast<QgsCubicRasterResampler *>( sipCpp ) != NULL )
       sipType = sipType_QgsCubicRasterResampler;
+    else if ( dynamic_cast<QgsLanczosRasterResampler *>( sipCpp ) != NULL )
+      sipType = sipType_QgsLanczosRasterResampler;
+    else if ( dynamic_cast<QgsAverageRasterResampler *>( sipCpp ) != NULL )
+      sipType = sipType_QgsAverageRasterResampler;
     else
       sipType = 0;
     SIP_END
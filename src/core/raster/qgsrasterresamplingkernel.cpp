@@ -0,0 +1,261 @@
+/***************************************************************************
+                         qgsrasterresamplingkernel.cpp
+                         -----------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrasterresamplingkernel_p.h"
+
+#include <QImage>
+#include <QSize>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// @cond PRIVATE
+
+// Compile the inner loops for several instruction sets, the variant matching the CPU
+// is selected by the dynamic loader. Other compilers and platforms get a single variant.
+#if defined( __GNUC__ ) && !defined( __clang__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __linux__ )
+#define RESAMPLING_TARGET_CLONES __attribute__(( target_clones( "avx2", "sse4.1", "default" ) ))
+#else
+#define RESAMPLING_TARGET_CLONES
+#endif
+
+//! Number of fractional bits of the fixed point weights
+static const int PRECISION_BITS = 14;
+
+//! Fixed point weights of the source pixels contributing to each destination pixel along one axis
+struct AxisWeights
+{
+  //! First source pixel of each destination pixel
+  std::vector< int > starts;
+  //! Number of source pixels of each destination pixel
+  std::vector< int > counts;
+  //! Weights of each destination pixel, maximumCount entries per destination pixel
+  std::vector< int > weights;
+  int maximumCount = 0;
+};
+
+static double filterSupport( QgsRasterResamplingKernel::Filter filter )
+{
+  switch ( filter )
+  {
+    case QgsRasterResamplingKernel::Box:
+      return 0.5;
+    case QgsRasterResamplingKernel::Bilinear:
+      return 1.0;
+    case QgsRasterResamplingKernel::Cubic:
+      return 2.0;
+    case QgsRasterResamplingKernel::Lanczos3:
+      return 3.0;
+  }
+  return 0.5;
+}
+
+static double sinc( double x )
+{
+  if ( x == 0.0 )
+    return 1.0;
+  x *= M_PI;
+  return std::sin( x ) / x;
+}
+
+static double cubic( double x )
+{
+  // Keys cubic convolution with a = -0.5
+  const double a = -0.5;
+  x = std::fabs( x );
+  if ( x < 1.0 )
+    return ( ( a + 2.0 ) * x - ( a + 3.0 ) ) * x * x + 1.0;
+  if ( x < 2.0 )
+    return ( ( ( x - 5.0 ) * x + 8.0 ) * x - 4.0 ) * a;
+  return 0.0;
+}
+
+static double filterValue( QgsRasterResamplingKernel::Filter filter, double x )
+{
+  switch ( filter )
+  {
+    case QgsRasterResamplingKernel::Box:
+      return x > -0.5 && x <= 0.5 ? 1.0 : 0.0;
+    case QgsRasterResamplingKernel::Bilinear:
+      return x > -1.0 && x < 1.0 ? 1.0 - std::fabs( x ) : 0.0;
+    case QgsRasterResamplingKernel::Cubic:
+      return cubic( x );
+    case QgsRasterResamplingKernel::Lanczos3:
+      return x > -3.0 && x < 3.0 ? sinc( x ) * sinc( x / 3.0 ) : 0.0;
+  }
+  return 0.0;
+}
+
+static AxisWeights calculateWeights( int sourceSize, int destinationSize, QgsRasterResamplingKernel::Filter filter )
+{
+  // when downsampling the filter is stretched over the source pixels covered by a destination pixel
+  const double scale = static_cast< double >( sourceSize ) / destinationSize;
+  const double filterScale = std::max( scale, 1.0 );
+  const double support = filterSupport( filter ) * filterScale;
+
+  AxisWeights result;
+  result.maximumCount = static_cast< int >( std::ceil( support ) ) * 2 + 1;
+  result.starts.resize( static_cast< std::size_t >( destinationSize ) );
+  result.counts.resize( static_cast< std::size_t >( destinationSize ) );
+  result.weights.assign( static_cast< std::size_t >( destinationSize ) * result.maximumCount, 0 );
+
+  std::vector< double > weights( static_cast< std::size_t >( result.maximumCount ) );
+  for ( int i = 0; i < destinationSize; ++i )
+  {
+    const double center = ( i + 0.5 ) * scale;
+    const int start = std::max( static_cast< int >( center - support + 0.5 ), 0 );
+    const int end = std::min( static_cast< int >( center + support + 0.5 ), sourceSize );
+    const int count = std::min( end - start, result.maximumCount );
+
+    double sum = 0;
+    for ( int k = 0; k < count; ++k )
+    {
+      weights[k] = filterValue( filter, ( start + k - center + 0.5 ) / filterScale );
+      sum += weights[k];
+    }
+
+    int *fixedWeights = result.weights.data() + static_cast< std::size_t >( i ) * result.maximumCount;
+    if ( count <= 0 || sum == 0.0 )
+    {
+      // degenerate filter, fall back to the nearest source pixel
+      result.starts[i] = std::min( std::max( static_cast< int >( center ), 0 ), sourceSize - 1 );
+      result.counts[i] = 1;
+      fixedWeights[0] = 1 << PRECISION_BITS;
+      continue;
+    }
+
+    result.starts[i] = start;
+    result.counts[i] = count;
+    for ( int k = 0; k < count; ++k )
+      fixedWeights[k] = static_cast< int >( std::lround( weights[k] / sum * ( 1 << PRECISION_BITS ) ) );
+  }
+  return result;
+}
+
+static inline unsigned char clampToByte( int value )
+{
+  return static_cast< unsigned char >( value < 0 ? 0 : ( value > 255 ? 255 : value ) );
+}
+
+RESAMPLING_TARGET_CLONES
+static void resampleRow( const unsigned char *source, unsigned char *destination, int destinationWidth,
+                         const int *starts, const int *counts, const int *weights, int maximumCount )
+{
+  for ( int x = 0; x < destinationWidth; ++x )
+  {
+    const unsigned char *pixel = source + static_cast< std::size_t >( starts[x] ) * 4;
+    const int *w = weights + static_cast< std::size_t >( x ) * maximumCount;
+    int c0 = 1 << ( PRECISION_BITS - 1 );
+    int c1 = c0;
+    int c2 = c0;
+    int c3 = c0;
+    for ( int k = 0; k < counts[x]; ++k )
+    {
+      c0 += pixel[0] * w[k];
+      c1 += pixel[1] * w[k];
+      c2 += pixel[2] * w[k];
+      c3 += pixel[3] * w[k];
+      pixel += 4;
+    }
+    unsigned char *out = destination + static_cast< std::size_t >( x ) * 4;
+    out[0] = clampToByte( c0 >> PRECISION_BITS );
+    out[1] = clampToByte( c1 >> PRECISION_BITS );
+    out[2] = clampToByte( c2 >> PRECISION_BITS );
+    out[3] = clampToByte( c3 >> PRECISION_BITS );
+  }
+}
+
+RESAMPLING_TARGET_CLONES
+static void resampleColumns( const unsigned char *source, int sourceStride, int start, int count, const int *weights,
+                             int *accumulator, unsigned char *destination, int byteCount )
+{
+  for ( int i = 0; i < byteCount; ++i )
+    accumulator[i] = 1 << ( PRECISION_BITS - 1 );
+
+  // accumulate whole source rows, which vectorizes well
+  for ( int k = 0; k < count; ++k )
+  {
+    const unsigned char *row = source + static_cast< std::size_t >( start + k ) * sourceStride;
+    const int weight = weights[k];
+    for ( int i = 0; i < byteCount; ++i )
+      accumulator[i] += row[i] * weight;
+  }
+
+  for ( int i = 0; i < byteCount; ++i )
+    destination[i] = clampToByte( accumulator[i] >> PRECISION_BITS );
+}
+
+void QgsRasterResamplingKernel::resample( const unsigned char *source, int sourceWidth, int sourceHeight, int sourceStride,
+    unsigned char *destination, int destinationWidth, int destinationHeight, int destinationStride,
+    int alphaIndex, Filter filter )
+{
+  if ( sourceWidth <= 0 || sourceHeight <= 0 || destinationWidth <= 0 || destinationHeight <= 0 )
+    return;
+
+  const AxisWeights horizontal = calculateWeights( sourceWidth, destinationWidth, filter );
+  const AxisWeights vertical = calculateWeights( sourceHeight, destinationHeight, filter );
+
+  // horizontal pass, into an intermediate image with the destination width and the source height
+  const int intermediateStride = destinationWidth * 4;
+  std::vector< unsigned char > intermediate( static_cast< std::size_t >( intermediateStride ) * sourceHeight );
+  for ( int y = 0; y < sourceHeight; ++y )
+  {
+    resampleRow( source + static_cast< std::size_t >( y ) * sourceStride, intermediate.data() + static_cast< std::size_t >( y ) * intermediateStride,
+                 destinationWidth, horizontal.starts.data(), horizontal.counts.data(), horizontal.weights.data(), horizontal.maximumCount );
+  }
+
+  // vertical pass
+  std::vector< int > accumulator( static_cast< std::size_t >( intermediateStride ) );
+  for ( int y = 0; y < destinationHeight; ++y )
+  {
+    unsigned char *row = destination + static_cast< std::size_t >( y ) * destinationStride;
+    resampleColumns( intermediate.data(), intermediateStride, vertical.starts[y], vertical.counts[y],
+                     vertical.weights.data() + static_cast< std::size_t >( y ) * vertical.maximumCount,
+                     accumulator.data(), row, intermediateStride );
+
+    // negative filter lobes may push color channels above alpha, which is invalid for premultiplied colors
+    for ( int x = 0; x < destinationWidth; ++x )
+    {
+      unsigned char *pixel = row + static_cast< std::size_t >( x ) * 4;
+      const unsigned char alpha = pixel[alphaIndex];
+      for ( int channel = 0; channel < 4; ++channel )
+      {
+        if ( channel != alphaIndex && pixel[channel] > alpha )
+          pixel[channel] = alpha;
+      }
+    }
+  }
+}
+
+QImage QgsRasterResamplingKernel::resample( const QImage &source, const QSize &size, Filter filter )
+{
+  if ( source.isNull() || size.isEmpty() )
+    return QImage();
+
+  const QImage sourceImage = source.format() == QImage::Format_ARGB32_Premultiplied ? source : source.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+  QImage result( size, QImage::Format_ARGB32_Premultiplied );
+  if ( result.isNull() )
+    return QImage();
+
+  // ARGB32 pixels are stored as native endian 32 bit integers
+  const int alphaIndex = Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 3 : 0;
+  resample( sourceImage.constBits(), sourceImage.width(), sourceImage.height(), sourceImage.bytesPerLine(),
+            result.bits(), result.width(), result.height(), result.bytesPerLine(), alphaIndex, filter );
+  return result;
+}
+
+/// @endcond
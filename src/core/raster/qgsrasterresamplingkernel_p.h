@@ -0,0 +1,78 @@
+/***************************************************************************
+                         qgsrasterresamplingkernel_p.h
+                         -----------------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERRESAMPLINGKERNEL_PRIVATE_H
+#define QGSRASTERRESAMPLINGKERNEL_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+
+class QImage;
+class QSize;
+
+/**
+ * Separable convolution resampling of 32 bit premultiplied ARGB images.
+ *
+ * Images are resampled in a horizontal and then a vertical pass, with fixed point weights
+ * precomputed once per output column and row. The inner loops work on plain byte arrays
+ * and are compiled for several instruction sets where the compiler supports it, with the
+ * best variant for the CPU selected at runtime.
+ */
+class CORE_EXPORT QgsRasterResamplingKernel
+{
+  public:
+
+    //! Resampling filter
+    enum Filter
+    {
+      Box, //!< Box filter, i.e. the average of the covered source pixels when downsampling
+      Bilinear, //!< Triangle filter, i.e. linear interpolation between the two nearest source pixels when upsampling
+      Cubic, //!< Cubic convolution filter (Catmull-Rom spline), as used by GDAL for cubic resampling
+      Lanczos3, //!< Lanczos filter with a support of 3 pixels
+    };
+
+    /**
+     * Resamples a \a source image to the specified \a size with a \a filter.
+     *
+     * The returned image has the Format_ARGB32_Premultiplied format. A null image is returned if
+     * the source image is null or the size is empty.
+     */
+    static QImage resample( const QImage &source, const QSize &size, Filter filter );
+
+    /**
+     * Resamples an image stored as 4 bytes per pixel, with the alpha channel at byte
+     * \a alphaIndex of each pixel and premultiplied color channels.
+     */
+    static void resample( const unsigned char *source, int sourceWidth, int sourceHeight, int sourceStride,
+                          unsigned char *destination, int destinationWidth, int destinationHeight, int destinationStride,
+                          int alphaIndex, Filter filter );
+};
+
+/// @endcond
+
+#endif // QGSRASTERRESAMPLINGKERNEL_PRIVATE_H
@@ -0,0 +1,104 @@
+/***************************************************************************
+                         qgsrastertilecache.cpp
+                         ----------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrastertilecache_p.h"
+#include "qgsrasterpipe.h"
+
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+
+/// @cond PRIVATE
+
+QgsRasterTileCache::QgsRasterTileCache( int maximumSizeKb )
+  : mTiles( maximumSizeKb )
+{
+}
+
+int QgsRasterTileCache::zoomForResolution( double mapUnitsPerPixel )
+{
+  // tiny epsilon so that resolutions which are exactly a power of two are not rounded down
+  return static_cast< int >( std::floor( std::log2( mapUnitsPerPixel ) + 1e-9 ) );
+}
+
+double QgsRasterTileCache::resolution( int zoom )
+{
+  return std::ldexp( 1.0, zoom );
+}
+
+QgsRectangle QgsRasterTileCache::tileExtent( int zoom, int column, int row )
+{
+  const double size = TILE_SIZE * resolution( zoom );
+  return QgsRectangle( column * size, -( row + 1 ) * size, ( column + 1 ) * size, -row * size );
+}
+
+QString QgsRasterTileCache::pipeKey( const QgsRasterPipe &pipe )
+{
+  // same serialization as the pipe of a layer style
+  QDomDocument document;
+  QDomElement pipeElement = document.createElement( QStringLiteral( "pipe" ) );
+  for ( int i = 0; i < pipe.size(); i++ )
+  {
+    QgsRasterInterface *interface = pipe.at( i );
+    if ( !interface )
+      continue;
+    interface->writeXml( document, pipeElement );
+  }
+  pipeElement.setAttribute( QStringLiteral( "resamplingStage" ), static_cast< int >( pipe.resamplingStage() ) );
+  document.appendChild( pipeElement );
+  return QString::fromLatin1( QCryptographicHash::hash( document.toByteArray(), QCryptographicHash::Md5 ).toHex() );
+}
+
+int QgsRasterTileCache::generation() const
+{
+  QMutexLocker locker( &mMutex );
+  return mGeneration;
+}
+
+bool QgsRasterTileCache::tile( const TileKey &key, QImage &image ) const
+{
+  QMutexLocker locker( &mMutex );
+  // QCache::object() updates the recently used order, which is not const
+  QImage *cached = const_cast< QCache< TileKey, QImage > & >( mTiles ).object( key );
+  if ( !cached )
+    return false;
+
+  image = *cached;
+  return true;
+}
+
+void QgsRasterTileCache::insert( const TileKey &key, const QImage &image, int generation )
+{
+  QMutexLocker locker( &mMutex );
+  if ( generation != mGeneration )
+    return;
+
+  // costs are in kilobytes, so that caches of several gigabytes do not overflow
+  const int cost = std::max( 1, static_cast< int >( static_cast< qint64 >( image.bytesPerLine() ) * image.height() / 1024 ) );
+  mTiles.insert( key, new QImage( image ), cost );
+}
+
+void QgsRasterTileCache::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mTiles.clear();
+  ++mGeneration;
+}
+
+/// @endcond
@@ -0,0 +1,135 @@
+/***************************************************************************
+                         qgsrastertilecache_p.h
+                         ----------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERTILECACHE_PRIVATE_H
+#define QGSRASTERTILECACHE_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+#include "qgsrectangle.h"
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+class QgsRasterPipe;
+
+/**
+ * Cache of rendered raster layer tiles, shared by the renderers of a raster layer.
+ *
+ * Tiles are TILE_SIZE pixels wide and high and lie on a fixed grid in the destination CRS,
+ * with a resolution of a power of two map units per pixel on each zoom level. Tile column 0
+ * starts at x = 0 and tile row 0 ends at y = 0, with rows increasing downwards.
+ *
+ * Tiles are also keyed on the state of the pipe which rendered them, see pipeKey(), so that
+ * changes made to the renderer or the other pipe interfaces in place, without a repaint of the
+ * layer, do not draw outdated tiles.
+ *
+ * Each call to clear() starts a new generation, and tiles rendered for an older generation
+ * are not inserted, so that a render which was started before the layer changed does not
+ * store outdated tiles.
+ *
+ * All methods are thread safe.
+ */
+class CORE_EXPORT QgsRasterTileCache
+{
+  public:
+
+    //! Width and height of tiles, in pixels
+    static const int TILE_SIZE = 256;
+
+    //! Identifies a tile of the grid
+    struct TileKey
+    {
+      //! Destination CRS, as WKT
+      QString crs;
+      //! State of the pipe which renders the tile, see pipeKey()
+      QString pipe;
+      //! Zoom level, with a resolution of 2^zoom map units per pixel
+      int zoom = 0;
+      int column = 0;
+      int row = 0;
+
+      bool operator==( const TileKey &other ) const
+      {
+        return zoom == other.zoom && column == other.column && row == other.row && crs == other.crs && pipe == other.pipe;
+      }
+    };
+
+    /**
+     * Constructor for QgsRasterTileCache, holding up to \a maximumSizeKb kilobytes of tiles.
+     */
+    explicit QgsRasterTileCache( int maximumSizeKb = 65536 );
+
+    //! Returns the zoom level whose resolution is the finest one not finer than \a mapUnitsPerPixel
+    static int zoomForResolution( double mapUnitsPerPixel );
+
+    //! Returns the resolution of a \a zoom level, in map units per pixel
+    static double resolution( int zoom );
+
+    //! Returns the extent of a tile, in map units
+    static QgsRectangle tileExtent( int zoom, int column, int row );
+
+    /**
+     * Returns a key identifying the state of all interfaces of a \a pipe, i.e. the provider
+     * no data settings, the renderer and the filters, as saved in a layer style.
+     */
+    static QString pipeKey( const QgsRasterPipe &pipe );
+
+    //! Returns the current generation, which must be passed to insert()
+    int generation() const;
+
+    /**
+     * Looks up the tile with a matching \a key, and if it exists copies it to \a image.
+     * Returns TRUE if the tile was found.
+     */
+    bool tile( const TileKey &key, QImage &image ) const;
+
+    //! Inserts a rendered tile, unless the cache was cleared since \a generation was retrieved
+    void insert( const TileKey &key, const QImage &image, int generation );
+
+    //! Removes all tiles and starts a new generation
+    void clear();
+
+  private:
+
+    mutable QMutex mMutex;
+    QCache< TileKey, QImage > mTiles;
+    int mGeneration = 0;
+};
+
+//! Hash of a raster tile key
+inline uint qHash( const QgsRasterTileCache::TileKey &key, uint seed = 0 )
+{
+  return qHash( key.crs, seed ) ^ qHash( key.pipe, seed ) * 7 ^ qHash( key.zoom, seed ) ^ qHash( key.column, seed ) * 31 ^ qHash( key.row, seed ) * 131;
+}
+
+/// @endcond
+
+#endif // QGSRASTERTILECACHE_PRIVATE_H
@@ -27,6 +27,9 @@
 #include <QDomElement>
 #include <QImage>
 
+#include <limits>
+#include <vector>
+
 QgsSingleBandPseudoColorRenderer::QgsSingleBandPseudoColorRenderer( QgsRasterInterface *input, int band, QgsRasterShader *shader )
   : QgsRasterRenderer( input, QStringLiteral( "singlebandpseudocolor" ) )
   , mShader( shader )
@@ -199,6 +202,66 @@ QgsRasterRenderer *QgsSingleBandPseudoColorRenderer::create( const QDomElement &
   return r;
 }
 
+///@cond PRIVATE
+
+/**
+ * Colors the pixels of an integer \a input block from a lookup table with an entry for each value of
+ * type T, shifted by \a offset. Entries are calculated with \a colorForValue when first needed, or
+ * up front when the block has more pixels than the table has entries.
+ */
+template <typename T, typename ColorFunction>
+static void shadeFromLookupTable( QgsRasterBlock &input, qgssize count, int offset, const ColorFunction &colorForValue, QRgb noDataColor, QRgb *output )
+{
+  const std::size_t tableSize = static_cast< std::size_t >( std::numeric_limits< T >::max() ) + offset + 1;
+  const T *data = reinterpret_cast< const T * >( input.bits() );
+  const bool hasNoDataValue = input.hasNoDataValue();
+  const double noDataValue = input.noDataValue();
+  // no data bitmaps are only used by blocks without a no data value
+  const bool hasNoDataBitmap = !hasNoDataValue && input.hasNoData();
+
+  auto tableEntry = [&colorForValue, hasNoDataValue, noDataValue, noDataColor]( T value ) -> QRgb
+  {
+    if ( hasNoDataValue && qgsDoubleNear( static_cast< double >( value ), noDataValue ) )
+      return noDataColor;
+    return colorForValue( static_cast< double >( value ), 1.0 );
+  };
+
+  std::vector< QRgb > table( tableSize );
+  if ( count >= tableSize )
+  {
+    for ( std::size_t i = 0; i < tableSize; ++i )
+      table[i] = tableEntry( static_cast< T >( static_cast< int >( i ) - offset ) );
+
+    for ( qgssize i = 0; i < count; ++i )
+      output[i] = table[ static_cast< int >( data[i] ) + offset ];
+  }
+  else
+  {
+    std::vector< char > calculated( tableSize, 0 );
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      const int index = static_cast< int >( data[i] ) + offset;
+      if ( !calculated[index] )
+      {
+        table[index] = tableEntry( data[i] );
+        calculated[index] = 1;
+      }
+      output[i] = table[index];
+    }
+  }
+
+  if ( hasNoDataBitmap )
+  {
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      if ( input.isNoData( i ) )
+        output[i] = noDataColor;
+    }
+  }
+}
+
+///@endcond
+
 QgsRasterBlock *QgsSingleBandPseudoColorRenderer::block( int bandNo, QgsRectangle  const &extent, int width, int height, QgsRasterBlockFeedback *feedback )
 {
   Q_UNUSED( bandNo )
@@ -243,22 +306,13 @@ QgsRasterBlock *QgsSingleBandPseudoColorRenderer::block( int bandNo, QgsRectangl
   QRgb *outputBlockData = outputBlock->colorData();
   const QgsRasterShaderFunction *fcn = mShader->rasterShaderFunction();
 
-  qgssize count = ( qgssize )width * height;
-  bool isNoData = false;
-  for ( qgssize i = 0; i < count; i++ )
+  // output color of a pixel value, with the opacity of the pixel in the alpha band (if any)
+  auto colorForValue = [this, fcn, hasTransparency, myDefaultColor]( double val, double alphaBandOpacity ) -> QRgb
   {
-    double val = inputBlock->valueAndNoData( i, isNoData );
-    if ( isNoData )
-    {
-      outputBlockData[i] = myDefaultColor;
-      continue;
-    }
-
     int red, green, blue, alpha;
     if ( !fcn->shade( val, &red, &green, &blue, &alpha ) )
     {
-      outputBlockData[i] = myDefaultColor;
-      continue;
+      return myDefaultColor;
     }
 
     if ( alpha < 255 )
@@ -271,23 +325,55 @@ QgsRasterBlock *QgsSingleBandPseudoColorRenderer::block( int bandNo, QgsRectangl
 
     if ( !hasTransparency )
     {
-      outputBlockData[i] = qRgba( red, green, blue, alpha );
+      return qRgba( red, green, blue, alpha );
     }
-    else
+
+    //opacity
+    double currentOpacity = mOpacity;
+    if ( mRasterTransparency )
     {
-      //opacity
-      double currentOpacity = mOpacity;
-      if ( mRasterTransparency )
-      {
-        currentOpacity = mRasterTransparency->alphaValue( val, mOpacity * 255 ) / 255.0;
-      }
-      if ( mAlphaBand > 0 )
-      {
-        currentOpacity *= alphaBlock->value( i ) / 255.0;
-      }
+      currentOpacity = mRasterTransparency->alphaValue( val, mOpacity * 255 ) / 255.0;
+    }
+    if ( mAlphaBand > 0 )
+    {
+      currentOpacity *= alphaBandOpacity;
+    }
+    return qRgba( currentOpacity * red, currentOpacity * green, currentOpacity * blue, currentOpacity * alpha );
+  };
+
+  qgssize count = ( qgssize )width * height;
 
-      outputBlockData[i] = qRgba( currentOpacity * red, currentOpacity * green, currentOpacity * blue, currentOpacity * alpha );
+  // without an alpha band the color only depends on the pixel value, so 8 and 16 bit integer
+  // rasters are colored from a lookup table with an entry for each possible value
+  if ( mAlphaBand <= 0 )
+  {
+    switch ( inputBlock->dataType() )
+    {
+      case Qgis::Byte:
+        shadeFromLookupTable< quint8 >( *inputBlock, count, 0, colorForValue, myDefaultColor, outputBlockData );
+        return outputBlock.release();
+      case Qgis::UInt16:
+        shadeFromLookupTable< quint16 >( *inputBlock, count, 0, colorForValue, myDefaultColor, outputBlockData );
+        return outputBlock.release();
+      case Qgis::Int16:
+        shadeFromLookupTable< qint16 >( *inputBlock, count, 32768, colorForValue, myDefaultColor, outputBlockData );
+        return outputBlock.release();
+      default:
+        break;
+    }
+  }
+
+  bool isNoData = false;
+  for ( qgssize i = 0; i < count; i++ )
+  {
+    double val = inputBlock->valueAndNoData( i, isNoData );
+    if ( isNoData )
+    {
+      outputBlockData[i] = myDefaultColor;
+      continue;
     }
+
+    outputBlockData[i] = colorForValue( val, mAlphaBand > 0 ? alphaBlock->value( i ) / 255.0 : 1.0 );
   }
 
   return outputBlock.release();
@@ -0,0 +1,128 @@
+/***************************************************************************
+                         qgsmarkerstamper.cpp
+                         --------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsmarkerstamper_p.h"
+#include "qgis.h"
+
+#include <QPaintEngine>
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+/// @cond PRIVATE
+
+// Multiplies the four channels of a premultiplied pixel by alpha / 255, with the rounding of the raster paint engine
+static inline quint32 byteMul( quint32 x, quint32 a )
+{
+  quint32 t = ( x & 0xff00ff ) * a;
+  t = ( t + ( ( t >> 8 ) & 0xff00ff ) + 0x800080 ) >> 8;
+  t &= 0xff00ff;
+  x = ( ( x >> 8 ) & 0xff00ff ) * a;
+  x = ( x + ( ( x >> 8 ) & 0xff00ff ) + 0x800080 );
+  x &= 0xff00ff00;
+  return x | t;
+}
+
+QgsMarkerStamper::QgsMarkerStamper( QPainter *painter, const QImage &marker )
+  : mMarker( marker )
+{
+  // single pixel images are filled as rectangles by the raster engine, so leave them to the painter
+  if ( !painter || !painter->isActive() || marker.width() < 2 || marker.height() < 2
+       || marker.format() != QImage::Format_ARGB32_Premultiplied || !qgsDoubleNear( marker.devicePixelRatioF(), 1.0 ) )
+    return;
+
+  QPaintDevice *device = painter->device();
+  if ( !device || device->devType() != QInternal::Image || !painter->paintEngine() || painter->paintEngine()->type() != QPaintEngine::Raster )
+    return;
+
+  if ( painter->hasClipping()
+       || painter->opacity() != 1.0
+       || painter->compositionMode() != QPainter::CompositionMode_SourceOver
+       || painter->testRenderHint( QPainter::SmoothPixmapTransform ) )
+    return;
+
+  const QTransform transform = painter->combinedTransform();
+  if ( transform.type() > QTransform::TxTranslate )
+    return;
+
+  QImage *target = static_cast< QImage * >( device );
+  if ( target->format() != QImage::Format_ARGB32_Premultiplied || !qgsDoubleNear( target->devicePixelRatioF(), 1.0 ) )
+    return;
+
+  mDx = transform.dx();
+  mDy = transform.dy();
+  mTargetWidth = target->width();
+  mTargetHeight = target->height();
+  mTargetBytesPerLine = target->bytesPerLine();
+  // an image being painted is never shared, so this does not detach it from the painter
+  mTargetBits = target->bits();
+}
+
+void QgsMarkerStamper::stamp( QPointF topLeft, QPointF translation )
+{
+  if ( !mTargetBits )
+    return;
+
+  // same arithmetic and rounding as the raster engine uses for positioning images
+  const double left = topLeft.x() + ( mDx + translation.x() );
+  const double top = topLeft.y() + ( mDy + translation.y() );
+  if ( !( std::fabs( left ) < 1e9 ) || !( std::fabs( top ) < 1e9 ) )
+    return;
+
+  int x = qRound( left );
+  int y = qRound( top );
+  int sourceX = 0;
+  int sourceY = 0;
+  int width = mMarker.width();
+  int height = mMarker.height();
+
+  // clip to the target image
+  if ( x < 0 )
+  {
+    sourceX = -x;
+    width += x;
+    x = 0;
+  }
+  if ( y < 0 )
+  {
+    sourceY = -y;
+    height += y;
+    y = 0;
+  }
+  width = std::min( width, mTargetWidth - x );
+  height = std::min( height, mTargetHeight - y );
+  if ( width <= 0 || height <= 0 )
+    return;
+
+  const int markerBytesPerLine = mMarker.bytesPerLine();
+  const uchar *markerBits = mMarker.constBits();
+  for ( int row = 0; row < height; ++row )
+  {
+    const quint32 *source = reinterpret_cast< const quint32 * >( markerBits + static_cast< std::size_t >( sourceY + row ) * markerBytesPerLine ) + sourceX;
+    quint32 *destination = reinterpret_cast< quint32 * >( mTargetBits + static_cast< std::size_t >( y + row ) * mTargetBytesPerLine ) + x;
+    for ( int column = 0; column < width; ++column )
+    {
+      const quint32 s = source[column];
+      if ( s >= 0xff000000 )
+        destination[column] = s;
+      else if ( s != 0 )
+        destination[column] = s + byteMul( destination[column], ( ~s ) >> 24 );
+    }
+  }
+}
+
+/// @endcond
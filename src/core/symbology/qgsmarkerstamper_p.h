@@ -0,0 +1,90 @@
+/***************************************************************************
+                         qgsmarkerstamper_p.h
+                         --------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSMARKERSTAMPER_PRIVATE_H
+#define QGSMARKERSTAMPER_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+
+#include <QImage>
+#include <QPointF>
+
+class QPainter;
+
+/**
+ * Stamps a pre-rendered marker image directly into the image a painter draws on.
+ *
+ * Stamping is only possible when the result is identical to QPainter::drawImage(), i.e. when
+ * the painter draws with the raster engine on a premultiplied ARGB32 image, with a translation
+ * only transform, no clipping, no smooth pixmap transformation, full opacity and the source over
+ * composition mode. The marker is then placed on the nearest whole pixel, clipped to the image
+ * and blended with the same arithmetic as the raster engine, skipping the per call overhead of
+ * the painter.
+ *
+ * Drawing to a target rectangle of the size of the marker image takes the same path in the raster
+ * engine, so stamping also matches QPainter::drawImage() with an unstretched QRectF target.
+ *
+ * The painter state must not change while a stamper is used.
+ */
+class CORE_EXPORT QgsMarkerStamper
+{
+  public:
+
+    /**
+     * Constructor for QgsMarkerStamper, for stamping the \a marker image with the current
+     * state of a \a painter.
+     */
+    QgsMarkerStamper( QPainter *painter, const QImage &marker );
+
+    //! Returns TRUE if the marker can be stamped, otherwise QPainter::drawImage() must be used
+    bool isValid() const { return mTargetBits; }
+
+    /**
+     * Stamps the marker with its top left corner at \a topLeft, in painter coordinates after
+     * applying an additional \a translation.
+     *
+     * The result is identical to translating the painter by \a translation and then calling
+     * QPainter::drawImage() with \a topLeft.
+     */
+    void stamp( QPointF topLeft, QPointF translation = QPointF() );
+
+  private:
+
+    QImage mMarker;
+    uchar *mTargetBits = nullptr;
+    int mTargetWidth = 0;
+    int mTargetHeight = 0;
+    int mTargetBytesPerLine = 0;
+    double mDx = 0;
+    double mDy = 0;
+};
+
+/// @endcond
+
+#endif // QGSMARKERSTAMPER_PRIVATE_H
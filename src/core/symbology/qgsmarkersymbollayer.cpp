@@ -1047,9 +1047,14 @@ void QgsSimpleMarkerSymbolLayer::renderPoint( QPointF point, QgsSymbolRenderCont
     double angle = 0;
     calculateOffsetAndRotation( context, scaledSize, hasDataDefinedRotation, offset, angle );
 
-    p->drawImage( QRectF( point.x() - s / 2.0 + offset.x(),
-                          point.y() - s / 2.0 + offset.y(),
-                          s, s ), img );
+    const QPointF topLeft( point.x() - s / 2.0 + offset.x(),
+                           point.y() - s / 2.0 + offset.y() );
+    // stamping matches drawing to the target rectangle only while the image is not stretched
+    QgsMarkerStamper stamper( p, img );
+    if ( img.height() == img.width() && stamper.isValid() )
+      stamper.stamp( topLeft );
+    else
+      p->drawImage( QRectF( topLeft.x(), topLeft.y(), s, s ), img );
   }
   else
   {
@@ -1948,7 +1953,31 @@ QString QgsSvgMarkerSymbolLayer::layerType() const
 void QgsSvgMarkerSymbolLayer::startRender( QgsSymbolRenderContext &context )
 {
   QgsMarkerSymbolLayer::startRender( context ); // get anchor point expressions
-  Q_UNUSED( context )
+
+  // unless the rendered image depends on the features, start rasterizing it while the features are fetched
+  if ( context.renderContext().forceVectorOutput()
+       || ( context.renderContext().flags() & QgsRenderContext::RenderBlocking )
+       || !qgsDoubleNear( mAngle, 0 )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyName )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertySize )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyWidth )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyHeight )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyAngle )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyStrokeWidth )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyFillColor )
+       || mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyStrokeColor ) )
+    return;
+
+  bool hasDataDefinedSize = false;
+  const double scaledSize = calculateSize( context, hasDataDefinedSize );
+  const double size = context.renderContext().convertToPainterUnits( scaledSize, mSizeUnit, mSizeMapUnitScale );
+  if ( static_cast< int >( size ) < 1 || 10000.0 < size )
+    return;
+
+  bool hasDataDefinedAspectRatio = false;
+  const double aspectRatio = calculateAspectRatio( context, scaledSize, hasDataDefinedAspectRatio );
+  const double strokeWidth = context.renderContext().convertToPainterUnits( mStrokeWidth, mStrokeWidthUnit, mStrokeWidthMapUnitScale );
+  QgsApplication::svgCache()->prepareImage( mPath, size, mColor, mStrokeColor, strokeWidth, context.renderContext().scaleFactor(), aspectRatio );
 }
 
 void QgsSvgMarkerSymbolLayer::stopRender( QgsSymbolRenderContext &context )
@@ -2039,14 +2068,17 @@ void QgsSvgMarkerSymbolLayer::renderPoint( QPointF point, QgsSymbolRenderContext
       //consider transparency
       if ( !qgsDoubleNear( context.opacity(), 1.0 ) )
       {
-        QImage transparentImage = img.copy();
-        QgsSymbolLayerUtils::multiplyImageOpacity( &transparentImage, context.opacity() );
-        p->drawImage( -transparentImage.width() / 2.0, -transparentImage.height() / 2.0, transparentImage );
+        img = img.copy();
+        QgsSymbolLayerUtils::multiplyImageOpacity( &img, context.opacity() );
       }
+
+      // the image is placed on whole painter units, as with QPainter::drawImage( int, int, ... )
+      const QPoint topLeft( static_cast< int >( -img.width() / 2.0 ), static_cast< int >( -img.height() / 2.0 ) );
+      QgsMarkerStamper stamper( p, img );
+      if ( stamper.isValid() )
+        stamper.stamp( topLeft );
       else
-      {
-        p->drawImage( -img.width() / 2.0, -img.height() / 2.0, img );
-      }
+        p->drawImage( topLeft, img );
     }
   }
 
@@ -36,6 +36,10 @@
 #include <QFileInfo>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QSaveFile>
+#include <QtConcurrentRun>
 
 ///@cond PRIVATE
 
@@ -119,66 +123,130 @@ QgsSvgCache::QgsSvgCache( QObject *parent )
   connect( this, &QgsAbstractContentCacheBase::remoteContentFetched, this, &QgsSvgCache::remoteSvgFetched );
 }
 
+QgsSvgCache::~QgsSvgCache()
+{
+  // pending images are rendered with this cache, so they must not outlive it
+  mPrepareImageThreadPool.clear();
+  mPrepareImageThreadPool.waitForDone();
+}
+
 QImage QgsSvgCache::svgAsImage( const QString &file, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
                                 double widthScaleFactor, bool &fitsInCache, double fixedAspectRatio, bool blocking )
 {
-  QMutexLocker locker( &mMutex );
-
   fitsInCache = true;
-  QgsSvgCacheEntry *currentEntry = cacheEntry( file, size, fill, stroke, strokeWidth, widthScaleFactor, fixedAspectRatio, blocking );
+
+  const QString key = renderedImageKey( file, size, fill, stroke, strokeWidth, widthScaleFactor, fixedAspectRatio );
+  const int generation = renderedImageGeneration();
 
   QImage result;
+  if ( renderedImage( key, result ) )
+    return result;
 
-  //if current entry image is 0: cache image for entry
-  // checks to see if image will fit into cache
-  //update stats for memory usage
-  if ( !currentEntry->image )
+  // the svg is rendered from a detached copy of the entry, without holding the cache lock
+  std::unique_ptr< QgsSvgCacheEntry > renderEntry;
+  QString diskCacheDirectory;
   {
-    QSvgRenderer r( currentEntry->svgContent );
-    double hwRatio = 1.0;
-    if ( r.viewBoxF().width() > 0 )
+    QMutexLocker locker( &mMutex );
+    QgsSvgCacheEntry *currentEntry = cacheEntry( file, size, fill, stroke, strokeWidth, widthScaleFactor, fixedAspectRatio, blocking );
+    if ( currentEntry->image )
     {
-      if ( currentEntry->fixedAspectRatio > 0 )
-      {
-        hwRatio = currentEntry->fixedAspectRatio;
-      }
-      else
-      {
-        hwRatio = r.viewBoxF().height() / r.viewBoxF().width();
-      }
+      result = *( currentEntry->image );
+      insertRenderedImage( key, result, currentEntry->isMissingImage, generation );
+      return result;
     }
-    long cachedDataSize = 0;
-    cachedDataSize += currentEntry->svgContent.size();
-    cachedDataSize += static_cast< int >( currentEntry->size * currentEntry->size * hwRatio * 32 );
-    if ( cachedDataSize > mMaxCacheSize / 2 )
-    {
-      fitsInCache = false;
-      currentEntry->image.reset();
 
-      // instead cache picture
-      if ( !currentEntry->picture )
-      {
-        cachePicture( currentEntry, false );
-      }
+    renderEntry = qgis::make_unique< QgsSvgCacheEntry >( file, size, strokeWidth, widthScaleFactor, fill, stroke, fixedAspectRatio );
+    renderEntry->svgContent = currentEntry->svgContent;
+    renderEntry->isMissingImage = currentEntry->isMissingImage;
+    diskCacheDirectory = mDiskCacheDirectory;
+  }
 
-      // ...and render cached picture to result image
-      result = imageFromCachedPicture( *currentEntry );
+  // checks to see if image will fit into cache
+  QSvgRenderer r( renderEntry->svgContent );
+  double hwRatio = 1.0;
+  if ( r.viewBoxF().width() > 0 )
+  {
+    if ( renderEntry->fixedAspectRatio > 0 )
+    {
+      hwRatio = renderEntry->fixedAspectRatio;
     }
     else
     {
-      cacheImage( currentEntry );
-      result = *( currentEntry->image );
+      hwRatio = r.viewBoxF().height() / r.viewBoxF().width();
+    }
+  }
+  long cachedDataSize = 0;
+  cachedDataSize += renderEntry->svgContent.size();
+  cachedDataSize += static_cast< int >( renderEntry->size * renderEntry->size * hwRatio * 32 );
+  if ( cachedDataSize > mMaxCacheSize / 2 )
+  {
+    fitsInCache = false;
+
+    QMutexLocker locker( &mMutex );
+    QgsSvgCacheEntry *currentEntry = cacheEntry( file, size, fill, stroke, strokeWidth, widthScaleFactor, fixedAspectRatio, blocking );
+    currentEntry->image.reset();
+
+    // instead cache picture
+    if ( !currentEntry->picture )
+    {
+      cachePicture( currentEntry, false );
     }
+
+    // ...and render cached picture to result image
+    result = imageFromCachedPicture( *currentEntry );
     trimToMaximumSize();
+    return result;
   }
-  else
+
+  result = renderImage( *renderEntry, diskCacheDirectory );
+
+  QMutexLocker locker( &mMutex );
+  // don't store images rendered from content which was replaced meanwhile, e.g. when a remote svg was fetched
+  if ( renderedImageGeneration() != generation )
+    return result;
+
+  //update stats for memory usage
+  QgsSvgCacheEntry *currentEntry = cacheEntry( file, size, fill, stroke, strokeWidth, widthScaleFactor, fixedAspectRatio, blocking );
+  if ( currentEntry->svgContent != renderEntry->svgContent )
+    return result;
+
+  if ( !currentEntry->image )
   {
-    result = *( currentEntry->image );
+    mTotalSize += ( result.width() * result.height() * 32 );
+    currentEntry->image = qgis::make_unique< QImage >( result );
+    trimToMaximumSize();
   }
+  insertRenderedImage( key, result, renderEntry->isMissingImage, generation );
 
   return result;
 }
 
+void QgsSvgCache::prepareImage( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
+                                double widthScaleFactor, double fixedAspectRatio )
+{
+  QImage image;
+  if ( path.isEmpty() || renderedImage( renderedImageKey( path, size, fill, stroke, strokeWidth, widthScaleFactor, fixedAspectRatio ), image ) )
+    return;
+
+  QtConcurrent::run( &mPrepareImageThreadPool, [ = ]
+  {
+    bool fitsInCache = true;
+    svgAsImage( path, size, fill, stroke, strokeWidth, widthScaleFactor, fitsInCache, fixedAspectRatio );
+  } );
+}
+
+void QgsSvgCache::setDiskCacheDirectory( const QString &directory )
+{
+  QMutexLocker locker( &mMutex );
+  mDiskCacheDirectory = directory;
+}
+
+QString QgsSvgCache::diskCacheDirectory() const
+{
+  QMutexLocker locker( &mMutex );
+  return mDiskCacheDirectory;
+}
+
 QPicture QgsSvgCache::svgAsPicture( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
                                     double widthScaleFactor, bool forceVectorOutput, double fixedAspectRatio, bool blocking )
 {
@@ -414,41 +482,58 @@ bool QgsSvgCache::checkReply( QNetworkReply *reply, const QString &path ) const
   return true;
 }
 
-void QgsSvgCache::cacheImage( QgsSvgCacheEntry *entry )
+QImage QgsSvgCache::renderImage( const QgsSvgCacheEntry &entry, const QString &diskCacheDirectory ) const
 {
-  if ( !entry )
-  {
-    return;
-  }
-
-  entry->image.reset();
-
   QSizeF viewBoxSize;
   QSizeF scaledSize;
-  QSize imageSize = sizeForImage( *entry, viewBoxSize, scaledSize );
+  QSize imageSize = sizeForImage( entry, viewBoxSize, scaledSize );
+
+  // rendered images are stored on disk by their content, which already has the colors and stroke width replaced
+  QString diskCachePath;
+  if ( !diskCacheDirectory.isEmpty() )
+  {
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( entry.svgContent );
+    hash.addData( QStringLiteral( "%1|%2|%3x%4" ).arg( QString::number( entry.size, 'g', 17 ),
+                  QString::number( entry.fixedAspectRatio, 'g', 17 ) ).arg( imageSize.width() ).arg( imageSize.height() ).toUtf8() );
+    diskCachePath = QDir( diskCacheDirectory ).filePath( QString::fromLatin1( hash.result().toHex() ) + QStringLiteral( ".png" ) );
+
+    QImage cachedImage;
+    if ( cachedImage.load( diskCachePath, "PNG" ) && cachedImage.size() == imageSize )
+      return cachedImage.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+  }
 
   // cast double image sizes to int for QImage
-  std::unique_ptr< QImage > image = qgis::make_unique< QImage >( imageSize, QImage::Format_ARGB32_Premultiplied );
-  image->fill( 0 ); // transparent background
+  QImage image( imageSize, QImage::Format_ARGB32_Premultiplied );
+  image.fill( 0 ); // transparent background
 
-  const bool isFixedAR = entry->fixedAspectRatio > 0;
+  const bool isFixedAR = entry.fixedAspectRatio > 0;
 
-  QPainter p( image.get() );
-  QSvgRenderer r( entry->svgContent );
-  if ( qgsDoubleNear( viewBoxSize.width(), viewBoxSize.height() ) )
   {
-    r.render( &p );
+    QPainter p( &image );
+    QSvgRenderer r( entry.svgContent );
+    if ( qgsDoubleNear( viewBoxSize.width(), viewBoxSize.height() ) )
+    {
+      r.render( &p );
+    }
+    else
+    {
+      QSizeF s( viewBoxSize );
+      s.scale( scaledSize.width(), scaledSize.height(), isFixedAR ? Qt::IgnoreAspectRatio : Qt::KeepAspectRatio );
+      QRectF rect( ( imageSize.width() - s.width() ) / 2, ( imageSize.height() - s.height() ) / 2, s.width(), s.height() );
+      r.render( &p, rect );
+    }
   }
-  else
+
+  if ( !diskCachePath.isEmpty() && QDir().mkpath( diskCacheDirectory ) )
   {
-    QSizeF s( viewBoxSize );
-    s.scale( scaledSize.width(), scaledSize.height(), isFixedAR ? Qt::IgnoreAspectRatio : Qt::KeepAspectRatio );
-    QRectF rect( ( imageSize.width() - s.width() ) / 2, ( imageSize.height() - s.height() ) / 2, s.width(), s.height() );
-    r.render( &p, rect );
+    // written atomically, so that concurrent QGIS instances never read a partially written image
+    QSaveFile file( diskCachePath );
+    if ( file.open( QIODevice::WriteOnly ) && image.save( &file, "PNG" ) )
+      file.commit();
   }
 
-  mTotalSize += ( image->width() * image->height() * 32 );
-  entry->image = std::move( image );
+  return image;
 }
 
 void QgsSvgCache::cachePicture( QgsSvgCacheEntry *entry, bool forceVectorOutput )
@@ -826,3 +911,11 @@ QImage QgsSvgCache::imageFromCachedPicture( const QgsSvgCacheEntry &entry ) cons
   return image;
 }
 
+QString QgsSvgCache::renderedImageKey( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
+                                       double widthScaleFactor, double fixedAspectRatio )
+{
+  return path + '\n' + QString::number( size, 'g', 17 ) + '\n' + fill.name( QColor::HexArgb ) + '\n' + stroke.name( QColor::HexArgb )
+         + '\n' + QString::number( strokeWidth, 'g', 17 ) + '\n' + QString::number( widthScaleFactor, 'g', 17 )
+         + '\n' + QString::number( fixedAspectRatio, 'g', 17 );
+}
+
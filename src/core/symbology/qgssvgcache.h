@@ -22,6 +22,7 @@
 #include "qgis.h"
 
 #include <QPicture>
+#include <QThreadPool>
 
 class QDomElement;
 
@@ -116,6 +117,8 @@ class CORE_EXPORT QgsSvgCache : public QgsAbstractContentCache< QgsSvgCacheEntry
      */
     QgsSvgCache( QObject *parent SIP_TRANSFERTHIS = nullptr );
 
+    ~QgsSvgCache() override;
+
     /**
      * Gets SVG as QImage.
      * \param path Absolute path to SVG file.
@@ -133,6 +136,49 @@ class CORE_EXPORT QgsSvgCache : public QgsAbstractContentCache< QgsSvgCacheEntry
     QImage svgAsImage( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
                        double widthScaleFactor, bool &fitsInCache, double fixedAspectRatio = 0, bool blocking = false );
 
+    /**
+     * Starts rendering the SVG at \a path as an image in a background thread, so that a later
+     * call to svgAsImage() with matching parameters finds the image already rendered.
+     *
+     * Symbol layers call this before drawing starts for the SVGs which do not depend on the
+     * rendered features, so that the distinct SVGs of a map are rasterized in parallel
+     * instead of one by one while drawing. Nothing is done if the image is already cached.
+     *
+     * \param path Absolute path to SVG file.
+     * \param size size of cached image
+     * \param fill color of fill
+     * \param stroke color of stroke
+     * \param strokeWidth width of stroke
+     * \param widthScaleFactor width scale factor
+     * \param fixedAspectRatio fixed aspect ratio (optional)
+     *
+     * \since QGIS 3.16
+     */
+    void prepareImage( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
+                       double widthScaleFactor, double fixedAspectRatio = 0 );
+
+    /**
+     * Sets a \a directory in which rendered SVG images are persistently stored as PNG files,
+     * so that they are not rendered again in later sessions.
+     *
+     * Images are identified by a hash of the SVG content (after replacing the fill, stroke and
+     * stroke width parameters) and the image size, so the same directory may be shared by several
+     * QGIS instances. An empty \a directory disables the disk cache, which is the default.
+     *
+     * \see diskCacheDirectory()
+     * \since QGIS 3.16
+     */
+    void setDiskCacheDirectory( const QString &directory );
+
+    /**
+     * Returns the directory in which rendered SVG images are persistently stored, or an empty
+     * string if the disk cache is disabled.
+     *
+     * \see setDiskCacheDirectory()
+     * \since QGIS 3.16
+     */
+    QString diskCacheDirectory() const;
+
     /**
      * Gets SVG  as QPicture&.
      * \param path Absolute path to SVG file.
@@ -269,7 +315,12 @@ class CORE_EXPORT QgsSvgCache : public QgsAbstractContentCache< QgsSvgCacheEntry
   private:
 
     void replaceParamsAndCacheSvg( QgsSvgCacheEntry *entry, bool blocking = false );
-    void cacheImage( QgsSvgCacheEntry *entry );
+
+    /**
+     * Renders the SVG content of a cache \a entry to an image, reading and storing it in
+     * \a diskCacheDirectory if it is not empty. Doesn't require the cache mutex to be locked.
+     */
+    QImage renderImage( const QgsSvgCacheEntry &entry, const QString &diskCacheDirectory ) const;
     void cachePicture( QgsSvgCacheEntry *entry, bool forceVectorOutput = false );
     //! Returns entry from cache or creates a new entry if it does not exist already
     QgsSvgCacheEntry *cacheEntry( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
@@ -299,11 +350,20 @@ class CORE_EXPORT QgsSvgCache : public QgsAbstractContentCache< QgsSvgCacheEntry
      */
     QImage imageFromCachedPicture( const QgsSvgCacheEntry &entry ) const;
 
+    //! Returns the key of a rendered image, as used by renderedImage()
+    static QString renderedImageKey( const QString &path, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
+                                     double widthScaleFactor, double fixedAspectRatio );
+
     //! SVG content to be rendered if SVG file was not found.
     QByteArray mMissingSvg;
 
     QByteArray mFetchingSvg;
 
+    QString mDiskCacheDirectory;
+
+    //! Renders images for prepareImage(), declared last so that it is destroyed first
+    QThreadPool mPrepareImageThreadPool;
+
     friend class TestQgsSvgCache;
 };
 
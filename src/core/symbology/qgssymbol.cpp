@@ -101,6 +101,37 @@ QgsSymbol::QgsSymbol( SymbolType type, const QgsSymbolLayerList &layers )
 }
 Q_NOWARN_DEPRECATED_POP
 
+//! Removes non-finite points, e.g. infinite or NaN points caused by reprojecting errors
+static void removeNonFinitePoints( QPolygonF &points )
+{
+  points.erase( std::remove_if( points.begin(), points.end(),
+                                []( const QPointF point )
+  {
+    return !std::isfinite( point.x() ) || !std::isfinite( point.y() );
+  } ), points.end() );
+}
+
+//! Transforms \a points from map coordinates to screen coordinates, reprojecting them first with \a ct
+static void transformToScreen( QPolygonF &points, const QgsCoordinateTransform &ct, const QgsMapToPixel &mtp )
+{
+  if ( !ct.isShortCircuited() )
+  {
+    try
+    {
+      ct.transformPolygon( points );
+    }
+    catch ( QgsCsException & )
+    {
+      // we don't abort the rendering here, instead we remove any invalid points and just plot those which ARE valid
+    }
+  }
+
+  // points which are not finite before the affine map to pixel transform are not finite afterwards either,
+  // so they are only looked for when the transform found some
+  if ( !mtp.transformInPlace( points.data(), points.size() ) )
+    removeNonFinitePoints( points );
+}
+
 QPolygonF QgsSymbol::_getLineString( QgsRenderContext &context, const QgsCurve &curve, bool clipToExtent )
 {
   const unsigned int nPoints = curve.numPoints();
@@ -116,39 +147,28 @@ QPolygonF QgsSymbol::_getLineString( QgsRenderContext &context, const QgsCurve &
     const double cw = e.width() / 10;
     const double ch = e.height() / 10;
     const QgsRectangle clipRect( e.xMinimum() - cw, e.yMinimum() - ch, e.xMaximum() + cw, e.yMaximum() + ch );
-    pts = QgsClipper::clippedLine( curve, clipRect );
-  }
-  else
-  {
-    pts = curve.asQPolygonF();
-  }
-
-  //transform the QPolygonF to screen coordinates
-  if ( ct.isValid() )
-  {
-    try
+    // clipping leaves lines within the clipping rectangle untouched
+    if ( !clipRect.contains( curve.boundingBox() ) )
     {
-      ct.transformPolygon( pts );
-    }
-    catch ( QgsCsException & )
-    {
-      // we don't abort the rendering here, instead we remove any invalid points and just plot those which ARE valid
+      pts = QgsClipper::clippedLine( curve, clipRect );
+      transformToScreen( pts, ct, mtp );
+      return pts;
     }
   }
 
-  // remove non-finite points, e.g. infinite or NaN points caused by reprojecting errors
-  pts.erase( std::remove_if( pts.begin(), pts.end(),
-                             []( const QPointF point )
+  // without reprojection, the vertices of line strings are transformed to screen coordinates in a single
+  // pass over their coordinate arrays
+  const QgsLineString *lineString = qgsgeometry_cast< const QgsLineString * >( &curve );
+  if ( lineString && ct.isShortCircuited() )
   {
-    return !std::isfinite( point.x() ) || !std::isfinite( point.y() );
-  } ), pts.end() );
-
-  QPointF *ptr = pts.data();
-  for ( int i = 0; i < pts.size(); ++i, ++ptr )
-  {
-    mtp.transformInPlace( ptr->rx(), ptr->ry() );
+    pts.resize( static_cast< int >( nPoints ) );
+    if ( !mtp.transformToPoints( lineString->xData(), lineString->yData(), pts.size(), pts.data() ) )
+      removeNonFinitePoints( pts );
+    return pts;
   }
 
+  pts = curve.asQPolygonF();
+  transformToScreen( pts, ct, mtp );
   return pts;
 }
 
@@ -156,56 +176,50 @@ QPolygonF QgsSymbol::_getPolygonRing( QgsRenderContext &context, const QgsCurve
 {
   const QgsCoordinateTransform ct = context.coordinateTransform();
   const QgsMapToPixel &mtp = context.mapToPixel();
-  const QgsRectangle &e = context.extent();
-  const double cw = e.width() / 10;
-  const double ch = e.height() / 10;
-  QgsRectangle clipRect( e.xMinimum() - cw, e.yMinimum() - ch, e.xMaximum() + cw, e.yMaximum() + ch );
-
-  QPolygonF poly = curve.asQPolygonF();
 
   if ( curve.numPoints() < 1 )
     return QPolygonF();
 
+  bool reverse = false;
   if ( correctRingOrientation )
   {
     // ensure consistent polygon ring orientation
     if ( isExteriorRing && curve.orientation() != QgsCurve::Clockwise )
-      std::reverse( poly.begin(), poly.end() );
+      reverse = true;
     else if ( !isExteriorRing && curve.orientation() != QgsCurve::CounterClockwise )
-      std::reverse( poly.begin(), poly.end() );
+      reverse = true;
   }
 
   //clip close to view extent, if needed
-  const QRectF ptsRect = poly.boundingRect();
-  if ( clipToExtent && !context.extent().contains( ptsRect ) )
+  const bool clip = clipToExtent && !context.extent().contains( curve.boundingBox() );
+
+  QPolygonF poly;
+  const QgsLineString *lineString = qgsgeometry_cast< const QgsLineString * >( &curve );
+  if ( !clip && lineString && ct.isShortCircuited() )
   {
-    QgsClipper::trimPolygon( poly, clipRect );
+    // without clipping or reprojection, transform to screen coordinates in a single pass over the coordinate arrays
+    poly.resize( lineString->numPoints() );
+    if ( !mtp.transformToPoints( lineString->xData(), lineString->yData(), poly.size(), poly.data() ) )
+      removeNonFinitePoints( poly );
+    if ( reverse )
+      std::reverse( poly.begin(), poly.end() );
   }
-
-  //transform the QPolygonF to screen coordinates
-  if ( ct.isValid() )
+  else
   {
-    try
-    {
-      ct.transformPolygon( poly );
-    }
-    catch ( QgsCsException & )
+    poly = curve.asQPolygonF();
+    if ( reverse )
+      std::reverse( poly.begin(), poly.end() );
+
+    if ( clip )
     {
-      // we don't abort the rendering here, instead we remove any invalid points and just plot those which ARE valid
+      const QgsRectangle &e = context.extent();
+      const double cw = e.width() / 10;
+      const double ch = e.height() / 10;
+      const QgsRectangle clipRect( e.xMinimum() - cw, e.yMinimum() - ch, e.xMaximum() + cw, e.yMaximum() + ch );
+      QgsClipper::trimPolygon( poly, clipRect );
     }
-  }
-
-  // remove non-finite points, e.g. infinite or NaN points caused by reprojecting errors
-  poly.erase( std::remove_if( poly.begin(), poly.end(),
-                              []( const QPointF point )
-  {
-    return !std::isfinite( point.x() ) || !std::isfinite( point.y() );
-  } ), poly.end() );
 
-  QPointF *ptr = poly.data();
-  for ( int i = 0; i < poly.size(); ++i, ++ptr )
-  {
-    mtp.transformInPlace( ptr->rx(), ptr->ry() );
+    transformToScreen( poly, ct, mtp );
   }
 
   if ( !poly.empty() && !poly.isClosed() )
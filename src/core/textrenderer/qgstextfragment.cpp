@@ -14,7 +14,7 @@
  ***************************************************************************/
 
 #include "qgstextfragment.h"
-#include <QFontMetricsF>
+#include "qgstextmetricscache_p.h"
 #include <QTextFragment>
 
 QgsTextFragment::QgsTextFragment( const QString &text, const QgsTextCharacterFormat &format )
@@ -48,23 +48,13 @@ double QgsTextFragment::horizontalAdvance( const QFont &font, bool fontHasBeenUp
 {
   if ( fontHasBeenUpdatedForFragment )
   {
-    QFontMetricsF fm( font );
-#if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
-    return fm.width( mText );
-#else
-    return fm.horizontalAdvance( mText );
-#endif
+    return QgsTextMetricsCache::instance()->horizontalAdvance( font, mText );
   }
   else
   {
     QFont updatedFont = font;
     mCharFormat.updateFontForFormat( updatedFont, scaleFactor );
-    QFontMetricsF fm( updatedFont );
-#if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
-    return fm.width( mText );
-#else
-    return fm.horizontalAdvance( mText );
-#endif
+    return QgsTextMetricsCache::instance()->horizontalAdvance( updatedFont, mText );
   }
 }
 
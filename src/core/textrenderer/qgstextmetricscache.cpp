@@ -0,0 +1,160 @@
+/***************************************************************************
+                         qgstextmetricscache.cpp
+                         -----------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstextmetricscache_p.h"
+
+#include <QFont>
+#include <QFontMetricsF>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+/// @cond PRIVATE
+
+Q_GLOBAL_STATIC( QgsTextMetricsCache, sTextMetricsCache )
+
+QgsTextMetricsCache::QgsTextMetricsCache( int maximumEntries )
+  : mMaximumShardEntries( std::max( 1, maximumEntries / SHARD_COUNT ) )
+{
+}
+
+QgsTextMetricsCache *QgsTextMetricsCache::instance()
+{
+  return sTextMetricsCache();
+}
+
+QString QgsTextMetricsCache::fontKey( const QFont &font )
+{
+  // QFont::toString() rounds the point size, and omits the spacing and shaping properties
+  return font.toString()
+         + ';' + QString::number( font.pointSizeF(), 'g', 17 )
+         + ';' + QString::number( font.letterSpacing(), 'g', 17 )
+         + ';' + QString::number( static_cast< int >( font.letterSpacingType() ) )
+         + ';' + QString::number( font.wordSpacing(), 'g', 17 )
+         + ';' + QString::number( static_cast< int >( font.capitalization() ) )
+         + ';' + QString::number( font.kerning() ? 1 : 0 )
+         + ';' + QString::number( static_cast< int >( font.hintingPreference() ) )
+         + ';' + QString::number( static_cast< int >( font.styleStrategy() ) );
+}
+
+double QgsTextMetricsCache::horizontalAdvance( const QString &fontKey, const QFontMetricsF &metrics, const QString &text )
+{
+  const QString key = fontKey + QChar( 0 ) + text;
+  double advance = 0;
+  if ( cachedAdvance( key, advance ) )
+    return advance;
+
+  const int generation = mGeneration.load();
+#if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
+  advance = metrics.width( text );
+#else
+  advance = metrics.horizontalAdvance( text );
+#endif
+  insertAdvance( key, advance, generation );
+  return advance;
+}
+
+double QgsTextMetricsCache::horizontalAdvance( const QFont &font, const QString &text )
+{
+  const QString key = fontKey( font ) + QChar( 0 ) + text;
+  double advance = 0;
+  if ( cachedAdvance( key, advance ) )
+    return advance;
+
+  const int generation = mGeneration.load();
+  const QFontMetricsF metrics( font );
+#if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
+  advance = metrics.width( text );
+#else
+  advance = metrics.horizontalAdvance( text );
+#endif
+  insertAdvance( key, advance, generation );
+  return advance;
+}
+
+int QgsTextMetricsCache::generation() const
+{
+  return mGeneration.load();
+}
+
+bool QgsTextMetricsCache::characterWidths( const QString &fontKey, bool curved, const QString &text, CharacterWidths &widths ) const
+{
+  const QString key = characterWidthsKey( fontKey, curved, text );
+  const Shard &keyShard = shard( key );
+  QMutexLocker locker( &keyShard.mutex );
+  auto it = keyShard.characterWidths.constFind( key );
+  if ( it == keyShard.characterWidths.constEnd() )
+    return false;
+
+  widths = *it;
+  return true;
+}
+
+void QgsTextMetricsCache::insertCharacterWidths( const QString &fontKey, bool curved, const QString &text, const CharacterWidths &widths, int generation )
+{
+  const QString key = characterWidthsKey( fontKey, curved, text );
+  Shard &keyShard = shard( key );
+  QMutexLocker locker( &keyShard.mutex );
+  // checked while holding the shard mutex, so that a concurrent clear() either removes these widths or rejects them
+  if ( generation != mGeneration.load() )
+    return;
+
+  if ( keyShard.characterWidths.size() >= mMaximumShardEntries )
+    keyShard.characterWidths.clear();
+  keyShard.characterWidths.insert( key, widths );
+}
+
+void QgsTextMetricsCache::clear()
+{
+  mGeneration.fetchAndAddOrdered( 1 );
+  for ( Shard &metricsShard : mShards )
+  {
+    QMutexLocker locker( &metricsShard.mutex );
+    metricsShard.advances.clear();
+    metricsShard.characterWidths.clear();
+  }
+}
+
+bool QgsTextMetricsCache::cachedAdvance( const QString &key, double &advance ) const
+{
+  const Shard &keyShard = shard( key );
+  QMutexLocker locker( &keyShard.mutex );
+  auto it = keyShard.advances.constFind( key );
+  if ( it == keyShard.advances.constEnd() )
+    return false;
+
+  advance = *it;
+  return true;
+}
+
+void QgsTextMetricsCache::insertAdvance( const QString &key, double advance, int generation )
+{
+  Shard &keyShard = shard( key );
+  QMutexLocker locker( &keyShard.mutex );
+  if ( generation != mGeneration.load() )
+    return;
+
+  if ( keyShard.advances.size() >= mMaximumShardEntries )
+    keyShard.advances.clear();
+  keyShard.advances.insert( key, advance );
+}
+
+QString QgsTextMetricsCache::characterWidthsKey( const QString &fontKey, bool curved, const QString &text )
+{
+  return ( curved ? QStringLiteral( "c" ) : QStringLiteral( "s" ) ) + fontKey + QChar( 0 ) + text;
+}
+
+/// @endcond
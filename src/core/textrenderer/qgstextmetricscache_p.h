@@ -0,0 +1,144 @@
+/***************************************************************************
+                         qgstextmetricscache_p.h
+                         -----------------------
+    begin                : July 2020
+    copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSTEXTMETRICSCACHE_PRIVATE_H
+#define QGSTEXTMETRICSCACHE_PRIVATE_H
+
+#define SIP_NO_FILE
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qgis_core.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QFont;
+class QFontMetricsF;
+
+/**
+ * Process wide cache of text measurements, shared by all render threads.
+ *
+ * Measuring text requires shaping it, which is costly compared to the rest of label
+ * registration. As the same strings are measured with the same fonts on every redraw
+ * of a map, the results are kept here, keyed by the font (see fontKey()) and the text.
+ *
+ * Only measurements made with font metrics which are not bound to a paint device may be
+ * cached, as the resolution of the device changes the results.
+ *
+ * Entries are split over SHARD_COUNT shards with their own mutex. A shard is emptied
+ * when it is full. Each call to clear() starts a new generation, and measurements made
+ * for an older generation are not inserted.
+ *
+ * All methods are thread safe.
+ *
+ * \since QGIS 3.16
+ */
+class CORE_EXPORT QgsTextMetricsCache
+{
+  public:
+
+    //! Number of shards
+    static const int SHARD_COUNT = 16;
+
+    //! Graphemes of a text and the width of each of them, in pixels
+    struct CharacterWidths
+    {
+      QStringList graphemes;
+      QVector< double > widths;
+    };
+
+    /**
+     * Constructor for QgsTextMetricsCache, holding up to \a maximumEntries measurements
+     * of each kind.
+     */
+    explicit QgsTextMetricsCache( int maximumEntries = 65536 );
+
+    //! Returns the cache shared by the whole application
+    static QgsTextMetricsCache *instance();
+
+    /**
+     * Returns a key identifying all properties of a \a font which change the size of text.
+     */
+    static QString fontKey( const QFont &font );
+
+    /**
+     * Returns the horizontal advance of \a text, as measured by \a metrics, which must have been
+     * created without a paint device from the font matching \a fontKey.
+     */
+    double horizontalAdvance( const QString &fontKey, const QFontMetricsF &metrics, const QString &text );
+
+    /**
+     * Returns the horizontal advance of \a text drawn with \a font, as measured by a QFontMetricsF
+     * created without a paint device.
+     */
+    double horizontalAdvance( const QFont &font, const QString &text );
+
+    //! Returns the current generation, which must be passed to insertCharacterWidths()
+    int generation() const;
+
+    /**
+     * Looks up the character widths of \a text for the font matching \a fontKey, as calculated
+     * for curved labels if \a curved is TRUE. Returns TRUE if they were found.
+     */
+    bool characterWidths( const QString &fontKey, bool curved, const QString &text, CharacterWidths &widths ) const;
+
+    //! Inserts character widths, unless the cache was cleared since \a generation was retrieved
+    void insertCharacterWidths( const QString &fontKey, bool curved, const QString &text, const CharacterWidths &widths, int generation );
+
+    /**
+     * Removes all measurements and starts a new generation. This must be called when the
+     * available fonts change.
+     */
+    void clear();
+
+  private:
+
+    struct Shard
+    {
+      mutable QMutex mutex;
+      QHash< QString, double > advances;
+      QHash< QString, CharacterWidths > characterWidths;
+    };
+
+    Shard &shard( const QString &key ) { return mShards[ qHash( key ) % SHARD_COUNT ]; }
+    const Shard &shard( const QString &key ) const { return mShards[ qHash( key ) % SHARD_COUNT ]; }
+
+    bool cachedAdvance( const QString &key, double &advance ) const;
+    void insertAdvance( const QString &key, double advance, int generation );
+    static QString characterWidthsKey( const QString &fontKey, bool curved, const QString &text );
+
+    Shard mShards[ SHARD_COUNT ];
+    QAtomicInt mGeneration;
+    int mMaximumShardEntries = 0;
+};
+
+/// @endcond
+
+#endif // QGSTEXTMETRICSCACHE_PRIVATE_H
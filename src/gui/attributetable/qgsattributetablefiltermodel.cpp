@@ -85,7 +85,7 @@ void QgsAttributeTableFilterModel::sort( int column, Qt::SortOrder order )
   else
   {
     int myColumn = mColumnMapping.at( column );
-    masterModel()->prefetchColumnData( myColumn );
+    masterModel()->prefetchColumnData( myColumn, order );
     QSortFilterProxyModel::sort( myColumn, order );
   }
   emit sortColumnChanged( column, order );
@@ -250,7 +250,7 @@ void QgsAttributeTableFilterModel::sort( const QString &expression, Qt::SortOrde
     order = Qt::AscendingOrder;
 
   QSortFilterProxyModel::sort( -1 );
-  masterModel()->prefetchSortData( expression );
+  masterModel()->prefetchSortData( expression, 0, order );
   QSortFilterProxyModel::sort( 0, order );
 }
 
@@ -315,6 +315,8 @@ void QgsAttributeTableFilterModel::setFilteredFeatures( const QgsFeatureIds &ids
 
 QgsFeatureIds QgsAttributeTableFilterModel::filteredFeatures()
 {
+  masterModel()->fetchAllRows();
+
   QgsFeatureIds ids;
   ids.reserve( rowCount() );
   for ( int i = 0; i < rowCount(); ++i )
@@ -41,11 +41,57 @@
 #include "qgstexteditwidgetfactory.h"
 #include "qgsexpressioncontextutils.h"
 #include "qgsvectorlayerutils.h"
+#include "qgsvectorlayereditbuffer.h"
+#include "qgsvectorlayerfeatureiterator.h"
+#include "qgstaskmanager.h"
 
 #include <QVariant>
 
 #include <limits>
 
+//! Number of rows around a displayed row whose features are fetched together
+static const int FEATURE_PAGE_SIZE = 100;
+
+///@cond PRIVATE
+
+/**
+ * Counts the features of a request in a background task.
+ */
+class QgsAttributeTableFeatureCountTask : public QgsTask
+{
+  public:
+
+    QgsAttributeTableFeatureCountTask( QgsVectorLayer *layer, const QgsFeatureRequest &request )
+      : QgsTask( QObject::tr( "Counting features of %1" ).arg( layer->name() ), QgsTask::CanCancel )
+      , mSource( qgis::make_unique< QgsVectorLayerFeatureSource >( layer ) )
+      , mRequest( request )
+    {
+    }
+
+    bool run() override
+    {
+      QgsFeatureIterator it = mSource->getFeatures( mRequest );
+      QgsFeature feature;
+      while ( it.nextFeature( feature ) )
+      {
+        if ( isCanceled() )
+          return false;
+        ++mCount;
+      }
+      return true;
+    }
+
+    long long count() const { return mCount; }
+
+  private:
+
+    std::unique_ptr< QgsVectorLayerFeatureSource > mSource;
+    QgsFeatureRequest mRequest;
+    long long mCount = 0;
+};
+
+///@endcond
+
 QgsAttributeTableModel::QgsAttributeTableModel( QgsVectorLayerCache *layerCache, QObject *parent )
   : QAbstractTableModel( parent )
   , mLayerCache( layerCache )
@@ -79,6 +125,12 @@ QgsAttributeTableModel::QgsAttributeTableModel( QgsVectorLayerCache *layerCache,
 
 }
 
+QgsAttributeTableModel::~QgsAttributeTableModel()
+{
+  if ( mFeatureCountTask )
+    mFeatureCountTask->cancel();
+}
+
 bool QgsAttributeTableModel::loadFeatureAtId( QgsFeatureId fid ) const
 {
   QgsDebugMsgLevel( QStringLiteral( "loading feature %1" ).arg( fid ), 3 );
@@ -88,6 +140,29 @@ bool QgsAttributeTableModel::loadFeatureAtId( QgsFeatureId fid ) const
     return false;
   }
 
+  const int row = mIdRowMap.value( fid, -1 );
+  if ( row >= 0 && !mLayerCache->isFidCached( fid ) )
+  {
+    // rows are usually displayed in sequence, fetch the page of rows around this one in a single request
+    QgsFeatureIds pageIds;
+    const int lastRow = std::min( row + FEATURE_PAGE_SIZE / 2, rowCount() );
+    for ( int pageRow = std::max( 0, row - FEATURE_PAGE_SIZE / 2 ); pageRow < lastRow; ++pageRow )
+    {
+      const QgsFeatureId pageId = mRowIdMap.value( pageRow );
+      if ( !mLayerCache->isFidCached( pageId ) )
+        pageIds.insert( pageId );
+    }
+
+    // the cache always fetches the attributes and geometries it holds
+    QgsFeatureIterator it = mLayerCache->getFeatures( QgsFeatureRequest( pageIds )
+                            .setFlags( QgsFeatureRequest::NoGeometry )
+                            .setSubsetOfAttributes( QgsAttributeList() ) );
+    QgsFeature feature;
+    while ( it.nextFeature( feature ) )
+    {
+    }
+  }
+
   return mLayerCache->featureAtId( fid, mFeat );
 }
 
@@ -225,22 +300,7 @@ void QgsAttributeTableModel::featureAdded( QgsFeatureId fid )
 
   if ( featOk && mFeatureRequest.acceptFeature( mFeat ) )
   {
-    for ( SortCache &cache : mSortCaches )
-    {
-      if ( cache.sortFieldIndex >= 0 )
-      {
-        QgsFieldFormatter *fieldFormatter = mFieldFormatters.at( cache.sortFieldIndex );
-        const QVariant &widgetCache = mAttributeWidgetCaches.at( cache.sortFieldIndex );
-        const QVariantMap &widgetConfig = mWidgetConfigs.at( cache.sortFieldIndex );
-        QVariant sortValue = fieldFormatter->representValue( layer(), cache.sortFieldIndex, widgetConfig, widgetCache, mFeat.attribute( cache.sortFieldIndex ) );
-        cache.sortCache.insert( mFeat.id(), sortValue );
-      }
-      else if ( cache.sortCacheExpression.isValid() )
-      {
-        mExpressionContext.setFeature( mFeat );
-        cache.sortCache[mFeat.id()] = cache.sortCacheExpression.evaluate( &mExpressionContext );
-      }
-    }
+    updateSortCaches( mFeat );
 
     // Skip if the fid is already in the map (do not add twice)!
     if ( ! mIdRowMap.contains( fid ) )
@@ -257,6 +317,27 @@ void QgsAttributeTableModel::featureAdded( QgsFeatureId fid )
   }
 }
 
+void QgsAttributeTableModel::updateSortCaches( const QgsFeature &feature )
+{
+  for ( SortCache &cache : mSortCaches )
+  {
+    if ( cache.sortFieldIndex >= 0 )
+    {
+      QgsFieldFormatter *fieldFormatter = mFieldFormatters.at( cache.sortFieldIndex );
+      const QVariant &widgetCache = mAttributeWidgetCaches.at( cache.sortFieldIndex );
+      const QVariantMap &widgetConfig = mWidgetConfigs.at( cache.sortFieldIndex );
+      // same values as prefetchSortData(), rows loaded page by page are compared with the rows loaded before
+      QVariant sortValue = fieldFormatter->sortValue( layer(), cache.sortFieldIndex, widgetConfig, widgetCache, feature.attribute( cache.sortFieldIndex ) );
+      cache.sortCache.insert( feature.id(), sortValue );
+    }
+    else if ( cache.sortCacheExpression.isValid() )
+    {
+      mExpressionContext.setFeature( feature );
+      cache.sortCache[feature.id()] = cache.sortCacheExpression.evaluate( &mExpressionContext );
+    }
+  }
+}
+
 void QgsAttributeTableModel::updatedFields()
 {
   loadAttributes();
@@ -286,6 +367,9 @@ void QgsAttributeTableModel::attributeDeleted( int idx )
 void QgsAttributeTableModel::layerDeleted()
 {
   mLayerCache = nullptr;
+  mRowsIterator = QgsFeatureIterator();
+  if ( mFeatureCountTask )
+    mFeatureCountTask->cancel();
   removeRows( 0, rowCount() );
 
   mAttributeWidgetCaches.clear();
@@ -449,41 +533,198 @@ void QgsAttributeTableModel::loadLayer()
     removeRows( 0, rowCount() );
   }
 
+  mRowsIterator = QgsFeatureIterator();
+  if ( mFeatureCountTask )
+    mFeatureCountTask->cancel();
+  mFeatureCount = -1;
+  // the current feature may be outdated or only hold the attributes used to list the rows
+  mFeat = QgsFeature();
+  mFeat.setId( std::numeric_limits<int>::min() );
+
   // Layer might have been deleted and cache set to nullptr!
   if ( mLayerCache )
   {
-    QgsFeatureIterator features = mLayerCache->getFeatures( mFeatureRequest );
+    if ( mLayerCache->hasFullCache() )
+    {
+      mRowsIterator = mLayerCache->getFeatures( mFeatureRequest );
+      fetchRows( 0 );
+    }
+    else
+    {
+      // only fetch what is needed to list and sort the rows, the features of the displayed
+      // rows are fetched page by page, see loadFeatureAtId()
+      mRowsIterator = layer()->getFeatures( rowsRequest() );
+      if ( fetchRows( mPageSize ) && mRowsIterator.isValid() )
+        startFeatureCount();
+    }
+
+    emit finished();
+    connect( mLayerCache, &QgsVectorLayerCache::invalidated, this, &QgsAttributeTableModel::loadLayer, Qt::UniqueConnection );
+  }
 
-    int i = 0;
+  endResetModel();
+
+  mResettingModel = false;
+}
 
-    QElapsedTimer t;
-    t.start();
 
-    while ( features.nextFeature( mFeat ) )
+bool QgsAttributeTableModel::fetchRows( int count )
+{
+  QgsFeatureList features;
+  QgsFeature feature;
+  bool canceled = false;
+  bool done = true;
+
+  QElapsedTimer t;
+  t.start();
+
+  const QgsVectorLayerEditBuffer *editBuffer = layer()->editBuffer();
+  while ( mRowsIterator.nextFeature( feature ) )
+  {
+    // features added or deleted since the iterator was created are handled by featureAdded() and featuresDeleted()
+    if ( !mIdRowMap.contains( feature.id() ) && !( editBuffer && editBuffer->isFeatureDeleted( feature.id() ) ) )
+      features << feature;
+
+    if ( t.elapsed() > 1000 )
     {
-      ++i;
+      emit progress( rowCount() + features.size(), canceled );
+      if ( canceled )
+        break;
 
-      if ( t.elapsed() > 1000 )
-      {
-        bool cancel = false;
-        emit progress( i, cancel );
-        if ( cancel )
-          break;
+      t.restart();
+    }
 
-        t.restart();
-      }
-      featureAdded( mFeat.id() );
+    if ( count > 0 && features.size() >= count )
+    {
+      done = false;
+      break;
     }
+  }
 
-    emit finished();
-    connect( mLayerCache, &QgsVectorLayerCache::invalidated, this, &QgsAttributeTableModel::loadLayer, Qt::UniqueConnection );
+  if ( done )
+    mRowsIterator = QgsFeatureIterator();
+
+  if ( features.isEmpty() )
+    return !canceled;
+
+  // insert the rows in a single batch, the filter model is invalidated for each insertion
+  const int firstRow = mRowIdMap.size();
+  if ( !mResettingModel )
+    beginInsertRows( QModelIndex(), firstRow, firstRow + features.size() - 1 );
+
+  for ( const QgsFeature &f : qgis::as_const( features ) )
+  {
+    updateSortCaches( f );
+    const int row = mRowIdMap.size();
+    mIdRowMap.insert( f.id(), row );
+    mRowIdMap.insert( row, f.id() );
   }
 
-  endResetModel();
+  if ( !mResettingModel )
+    endInsertRows();
 
-  mResettingModel = false;
+  return !canceled;
 }
 
+void QgsAttributeTableModel::startFeatureCount()
+{
+  QgsFeatureRequest request = rowsRequest();
+  request.setOrderBy( QgsFeatureRequest::OrderBy() );
+
+  if ( request.filterType() == QgsFeatureRequest::FilterNone && request.filterRect().isNull() )
+  {
+    // the layer already knows its feature count
+    mFeatureCount = layer()->featureCount();
+    if ( mFeatureCount >= 0 )
+    {
+      emit featureCountChanged();
+      return;
+    }
+  }
+
+  QgsAttributeTableFeatureCountTask *task = new QgsAttributeTableFeatureCountTask( layer(), request );
+  mFeatureCountTask = task;
+  connect( task, &QgsTask::taskCompleted, this, [ = ]
+  {
+    if ( mFeatureCountTask != task )
+      return;
+
+    mFeatureCount = task->count();
+    emit featureCountChanged();
+  } );
+  QgsApplication::taskManager()->addTask( task );
+}
+
+void QgsAttributeTableModel::setPageSize( int size )
+{
+  mPageSize = std::max( size, 0 );
+  if ( mPageSize == 0 )
+    fetchAllRows();
+}
+
+int QgsAttributeTableModel::pageSize() const
+{
+  return mPageSize;
+}
+
+bool QgsAttributeTableModel::canFetchMore( const QModelIndex &parent ) const
+{
+  return !parent.isValid() && mRowsIterator.isValid();
+}
+
+void QgsAttributeTableModel::fetchMore( const QModelIndex &parent )
+{
+  if ( !canFetchMore( parent ) )
+    return;
+
+  fetchRows( mPageSize );
+  emit finished();
+}
+
+void QgsAttributeTableModel::fetchAllRows()
+{
+  if ( !mRowsIterator.isValid() )
+    return;
+
+  fetchRows( 0 );
+  emit finished();
+}
+
+long long QgsAttributeTableModel::featureCount() const
+{
+  return mRowsIterator.isValid() ? mFeatureCount : rowCount();
+}
+
+QgsFeatureRequest QgsAttributeTableModel::rowsRequest() const
+{
+  QgsFeatureRequest request( mFeatureRequest );
+
+  QSet< int > attributes;
+  if ( mFeatureRequest.flags() & QgsFeatureRequest::SubsetOfAttributes )
+    attributes = qgis::listToSet( mFeatureRequest.subsetOfAttributes() );
+  bool needsGeometry = !mFeatureRequest.filterRect().isNull()
+                       || ( mFeatureRequest.filterExpression() && mFeatureRequest.filterExpression()->needsGeometry() );
+  for ( const SortCache &cache : mSortCaches )
+  {
+    attributes.unite( qgis::listToSet( cache.sortCacheAttributes ) );
+    if ( cache.sortFieldIndex == -1 && cache.sortCacheExpression.isValid() && cache.sortCacheExpression.needsGeometry() )
+      needsGeometry = true;
+  }
+  // deleted attributes of a sort expression are referenced as -1
+  attributes.remove( -1 );
+
+  request.setSubsetOfAttributes( qgis::setToList( attributes ) );
+  if ( !needsGeometry )
+    request.setFlags( request.flags() | QgsFeatureRequest::NoGeometry );
+
+  // rows loaded page by page come in the sort order, the providers able to order features do it themselves
+  if ( mPageSize > 0 && !mSortCaches.empty() && mSortCaches.front().sortCacheExpression.isValid() )
+  {
+    request.setOrderBy( QgsFeatureRequest::OrderBy( QList< QgsFeatureRequest::OrderByClause >()
+                        << QgsFeatureRequest::OrderByClause( mSortCaches.front().sortCacheExpression.expression(), mSortOrder == Qt::AscendingOrder ) ) );
+  }
+  return request;
+}
 
 void QgsAttributeTableModel::fieldConditionalStyleChanged( const QString &fieldName )
 {
@@ -862,19 +1103,19 @@ QgsFeature QgsAttributeTableModel::feature( const QModelIndex &idx ) const
   return f;
 }
 
-void QgsAttributeTableModel::prefetchColumnData( int column )
+void QgsAttributeTableModel::prefetchColumnData( int column, Qt::SortOrder order )
 {
   if ( column == -1 || column >= mAttributes.count() )
   {
-    prefetchSortData( QString() );
+    prefetchSortData( QString(), 0, order );
   }
   else
   {
-    prefetchSortData( QgsExpression::quotedColumnRef( mLayerCache->layer()->fields().at( mAttributes.at( column ) ).name() ) );
+    prefetchSortData( QgsExpression::quotedColumnRef( mLayerCache->layer()->fields().at( mAttributes.at( column ) ).name() ), 0, order );
   }
 }
 
-void QgsAttributeTableModel::prefetchSortData( const QString &expressionString, unsigned long cacheIndex )
+void QgsAttributeTableModel::prefetchSortData( const QString &expressionString, unsigned long cacheIndex, Qt::SortOrder order )
 {
   if ( cacheIndex >= mSortCaches.size() )
   {
@@ -923,10 +1164,22 @@ void QgsAttributeTableModel::prefetchSortData( const QString &expressionString,
     fieldFormatter = mFieldFormatters.at( cache.sortFieldIndex );
   }
 
+  if ( cacheIndex == 0 )
+    mSortOrder = order;
+
+  if ( cacheIndex == 0 && canFetchMore( QModelIndex() ) )
+  {
+    // instead of fetching the sort values of all features, reload the rows in the sort order,
+    // the sort values of the loaded rows are stored while loading them
+    loadLayer();
+    return;
+  }
+
   QgsFeatureRequest request = QgsFeatureRequest( mFeatureRequest )
                               .setFlags( QgsFeatureRequest::NoGeometry )
                               .setSubsetOfAttributes( cache.sortCacheAttributes );
-  QgsFeatureIterator it = mLayerCache->getFeatures( request );
+  // unless all features are cached anyway, only fetch the sort values instead of filling the cache
+  QgsFeatureIterator it = mLayerCache->hasFullCache() ? mLayerCache->getFeatures( request ) : layer()->getFeatures( request );
 
   QgsFeature f;
   while ( it.nextFeature( f ) )
@@ -24,6 +24,7 @@
 #include <QHash>
 #include <QQueue>
 #include <QMap>
+#include <QPointer>
 
 #include "qgsconditionalstyle.h"
 #include "qgsattributeeditorcontext.h"
@@ -34,6 +35,7 @@ class QgsMapCanvas;
 class QgsMapLayerAction;
 class QgsEditorWidgetFactory;
 class QgsFieldFormatter;
+class QgsTask;
 
 /**
  * \ingroup gui
@@ -69,6 +71,8 @@ class GUI_EXPORT QgsAttributeTableModel: public QAbstractTableModel
      */
     QgsAttributeTableModel( QgsVectorLayerCache *layerCache, QObject *parent = nullptr );
 
+    ~QgsAttributeTableModel() override;
+
     /**
      * Returns the number of rows
      * \param parent parent index
@@ -194,16 +198,20 @@ class GUI_EXPORT QgsAttributeTableModel: public QAbstractTableModel
      * Specify -1 as column to invalidate the cache
      *
      * \param column The column index of the field to catch
+     * \param order The sort order, used to fetch the rows when they are loaded page by page (since QGIS 3.16)
      */
-    void prefetchColumnData( int column );
+    void prefetchColumnData( int column, Qt::SortOrder order = Qt::AscendingOrder );
 
     /**
      * Prefetches the entire data for an \a expression. Based on this cached information
      * the sorting can later be done in a performant way. A \a cacheIndex can be specified
      * if multiple caches should be filled. In this case, the caches will be available
      * as ``QgsAttributeTableModel::SortRole + cacheIndex``.
+     *
+     * If rows are loaded page by page and not all rows are loaded yet, the rows are instead
+     * reloaded in the \a order of the expression, see setPageSize().
      */
-    void prefetchSortData( const QString &expression, unsigned long cacheIndex = 0 );
+    void prefetchSortData( const QString &expression, unsigned long cacheIndex = 0, Qt::SortOrder order = Qt::AscendingOrder );
 
     /**
      * The expression which was used to fill the sorting cache at index \a cacheIndex.
@@ -256,6 +264,48 @@ class GUI_EXPORT QgsAttributeTableModel: public QAbstractTableModel
      */
     void setExtraColumns( int extraColumns );
 
+    /**
+     * Sets the number of rows loaded at once by loadLayer() and fetchMore(). With a \a size of 0,
+     * loadLayer() loads all rows, and any row which is not loaded yet is loaded immediately.
+     *
+     * When rows are loaded page by page, the remaining rows are loaded when a view asks for them
+     * and are fetched in the order of the sort expression, which is pushed to the providers able to
+     * order features. The number of rows is then counted in a background task, see featureCount().
+     * Rows are not loaded page by page while all features are cached.
+     *
+     * \see pageSize()
+     * \since QGIS 3.16
+     */
+    void setPageSize( int size );
+
+    /**
+     * Returns the number of rows loaded at once, or 0 if all rows are loaded at once.
+     *
+     * \see setPageSize()
+     * \since QGIS 3.16
+     */
+    int pageSize() const;
+
+    bool canFetchMore( const QModelIndex &parent ) const override;
+    void fetchMore( const QModelIndex &parent ) override;
+
+    /**
+     * Loads all the rows which are not loaded yet.
+     *
+     * \see setPageSize()
+     * \since QGIS 3.16
+     */
+    void fetchAllRows();
+
+    /**
+     * Returns the number of features matching the request of the model, including the rows which
+     * are not loaded yet. Returns -1 while the rows are still being counted.
+     *
+     * \see featureCountChanged()
+     * \since QGIS 3.16
+     */
+    long long featureCount() const;
+
   public slots:
 
     /**
@@ -282,6 +332,14 @@ class GUI_EXPORT QgsAttributeTableModel: public QAbstractTableModel
     void progress( int i, bool &cancel ) SIP_SKIP;
     void finished();
 
+    /**
+     * Emitted when the rows which are not loaded yet have been counted.
+     *
+     * \see featureCount()
+     * \since QGIS 3.16
+     */
+    void featureCountChanged();
+
   private slots:
 
     /**
@@ -360,8 +418,33 @@ class GUI_EXPORT QgsAttributeTableModel: public QAbstractTableModel
      */
     virtual bool loadFeatureAtId( QgsFeatureId fid ) const;
 
+    /**
+     * Returns the request listing the rows of the model, which only fetches the attributes
+     * and geometries needed to filter and sort them.
+     */
+    QgsFeatureRequest rowsRequest() const;
+
+    /**
+     * Adds the next \a count rows of mRowsIterator, or all remaining rows if \a count is 0.
+     * Returns FALSE if loading was canceled.
+     */
+    bool fetchRows( int count );
+
+    //! Stores the sort values of a \a feature
+    void updateSortCaches( const QgsFeature &feature );
+
+    //! Counts the rows in a background task
+    void startFeatureCount();
+
     QgsFeatureRequest mFeatureRequest;
 
+    //! Iterator over the rows which are not loaded yet
+    QgsFeatureIterator mRowsIterator;
+    int mPageSize = 0;
+    Qt::SortOrder mSortOrder = Qt::AscendingOrder;
+    long long mFeatureCount = -1;
+    QPointer< QgsTask > mFeatureCountTask;
+
     struct SortCache
     {
       //! If it is set, a simple field is used for sorting, if it's -1 it's the mSortCacheExpression
@@ -351,6 +351,8 @@ void QgsAttributeTableView::repaintRequested()
 
 void QgsAttributeTableView::selectAll()
 {
+  mFilterModel->masterModel()->fetchAllRows();
+
   QItemSelection selection;
   selection.append( QItemSelectionRange( mFilterModel->index( 0, 0 ), mFilterModel->index( mFilterModel->rowCount() - 1, 0 ) ) );
   mFeatureSelectionModel->selectFeatures( selection, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows );
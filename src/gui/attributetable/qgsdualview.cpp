@@ -361,10 +361,14 @@ void QgsDualView::setFilterMode( QgsAttributeTableFilterModel::FilterMode filter
     mFilterModel->disconnectFilterModeConnections();
 
     mMasterModel->setRequest( r );
-    whileBlocking( mLayerCache )->setCacheGeometry( needsGeometry );
+    // the shared cache of the layer keeps caching geometries for its other consumers
+    if ( mLayerCache->parent() == this )
+      whileBlocking( mLayerCache )->setCacheGeometry( needsGeometry );
     mMasterModel->loadLayer();
   }
 
+  updatePageSize( filterMode, mFilterModel->selectedOnTop() );
+
   //update filter model
   mFilterModel->setFilterMode( filterMode );
   emit filterChanged();
@@ -372,19 +376,41 @@ void QgsDualView::setFilterMode( QgsAttributeTableFilterModel::FilterMode filter
 
 void QgsDualView::setSelectedOnTop( bool selectedOnTop )
 {
+  updatePageSize( mFilterModel->filterMode(), selectedOnTop );
   mFilterModel->setSelectedOnTop( selectedOnTop );
 }
 
+void QgsDualView::updatePageSize( QgsAttributeTableFilterModel::FilterMode filterMode, bool selectedOnTop )
+{
+  // the other filter modes filter the rows of the master model themselves, and all selected
+  // features are needed to list them on top
+  const bool paged = ( filterMode == QgsAttributeTableFilterModel::ShowAll || filterMode == QgsAttributeTableFilterModel::ShowSelected ) && !selectedOnTop;
+  const int pageSize = QgsSettings().value( QStringLiteral( "qgis/attributeTablePageSize" ), 10000 ).toInt();
+  mMasterModel->setPageSize( paged ? pageSize : 0 );
+}
+
 void QgsDualView::initLayerCache( bool cacheGeometry )
 {
   // Initialize the cache
   QgsSettings settings;
   int cacheSize = settings.value( QStringLiteral( "qgis/attributeTableRowCache" ), "10000" ).toInt();
-  mLayerCache = new QgsVectorLayerCache( mLayer, cacheSize, this );
-  mLayerCache->setCacheGeometry( cacheGeometry );
+
+  // the features fetched for the table are shared with the aggregates, identify results and renderer of the layer
+  mLayerCache = QgsVectorLayerCache::createSharedCache( mLayer );
+  if ( mLayerCache )
+  {
+    if ( mLayerCache->cacheSize() < cacheSize )
+      mLayerCache->setCacheSize( cacheSize );
+  }
+  else
+  {
+    mLayerCache = new QgsVectorLayerCache( mLayer, cacheSize, this );
+    mLayerCache->setCacheGeometry( cacheGeometry );
+  }
+
   if ( 0 == cacheSize || 0 == ( QgsVectorDataProvider::SelectAtId & mLayer->dataProvider()->capabilities() ) )
   {
-    connect( mLayerCache, &QgsVectorLayerCache::invalidated, this, &QgsDualView::rebuildFullLayerCache );
+    connect( mLayerCache, &QgsVectorLayerCache::invalidated, this, &QgsDualView::rebuildFullLayerCache, Qt::UniqueConnection );
     rebuildFullLayerCache();
   }
 }
@@ -399,9 +425,12 @@ void QgsDualView::initModels( QgsMapCanvas *mapCanvas, const QgsFeatureRequest &
   mMasterModel->setRequest( request );
   mMasterModel->setEditorContext( mEditorContext );
   mMasterModel->setExtraColumns( 1 ); // Add one extra column which we can "abuse" as an action column
+  updatePageSize( QgsAttributeTableFilterModel::ShowAll, false );
 
   connect( mMasterModel, &QgsAttributeTableModel::progress, this, &QgsDualView::progress );
   connect( mMasterModel, &QgsAttributeTableModel::finished, this, &QgsDualView::finished );
+  // the feature count is shown along with the filter
+  connect( mMasterModel, &QgsAttributeTableModel::featureCountChanged, this, &QgsDualView::filterChanged );
 
   connect( mConditionalFormatWidget, &QgsFieldConditionalFormatWidget::rulesUpdated, mMasterModel, &QgsAttributeTableModel::fieldConditionalStyleChanged );
 
@@ -710,11 +739,16 @@ void QgsDualView::previewColumnChanged( QAction *previewAction, const QString &e
 
 int QgsDualView::featureCount()
 {
-  return mMasterModel->rowCount();
+  // rows which are not loaded yet are counted in the background
+  return static_cast< int >( std::max( static_cast< long long >( mMasterModel->rowCount() ), mMasterModel->featureCount() ) );
 }
 
 int QgsDualView::filteredFeatureCount()
 {
+  // rows are only loaded page by page while the filter model does not filter them
+  if ( mMasterModel->canFetchMore( QModelIndex() ) )
+    return featureCount();
+
   return mFilterModel->rowCount();
 }
 
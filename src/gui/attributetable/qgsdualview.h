@@ -405,6 +405,9 @@ class GUI_EXPORT QgsDualView : public QStackedWidget, private Ui::QgsDualViewBas
     //! disable/enable the buttons of the browsing toolbar (feature list view)
     void setBrowsingAutoPanScaleAllowed( bool allowed );
 
+    //! Loads the rows of the master model page by page unless the filter model needs all of them
+    void updatePageSize( QgsAttributeTableFilterModel::FilterMode filterMode, bool selectedOnTop );
+
     //! Returns TRUE if the expression dialog has been accepted
     bool modifySort();
 
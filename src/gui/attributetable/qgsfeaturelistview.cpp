@@ -180,6 +180,8 @@ void QgsFeatureListView::editSelectionChanged( const QItemSelection &deselected,
 
 void QgsFeatureListView::selectAll()
 {
+  mModel->masterModel()->fetchAllRows();
+
   QItemSelection selection;
   selection.append( QItemSelectionRange( mModel->index( 0, 0 ), mModel->index( mModel->rowCount() - 1, 0 ) ) );
 
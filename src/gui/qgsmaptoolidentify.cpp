@@ -36,6 +36,7 @@
 #include "qgscoordinatereferencesystem.h"
 #include "qgsvectordataprovider.h"
 #include "qgsvectorlayer.h"
+#include "qgsvectorlayercache.h"
 #include "qgsvectortilelayer.h"
 #include "qgsvectortilemvtdecoder.h"
 #include "qgsvectortileutils.h"
@@ -559,7 +560,14 @@ bool QgsMapToolIdentify::identifyVectorLayer( QList<QgsMapToolIdentify::Identify
       }
     }
 
-    QgsFeatureIterator fit = layer->getFeatures( QgsFeatureRequest().setFilterRect( r ).setFlags( QgsFeatureRequest::ExactIntersect ) );
+    // once the shared cache of the layer holds all features, identify them without querying the provider
+    std::unique_ptr< QgsAbstractFeatureSource > cachedSource;
+    QgsVectorLayerCache *cache = QgsVectorLayerCache::sharedCache( layer );
+    if ( cache && cache->hasFullCache() && cache->cacheGeometry() )
+      cachedSource.reset( cache->createFeatureSource() );
+
+    const QgsFeatureRequest request = QgsFeatureRequest().setFilterRect( r ).setFlags( QgsFeatureRequest::ExactIntersect );
+    QgsFeatureIterator fit = cachedSource ? cachedSource->getFeatures( request ) : layer->getFeatures( request );
     QgsFeature f;
     while ( fit.nextFeature( f ) )
     {
@@ -21,6 +21,7 @@
 
 #include <QtGlobal>
 #include <QFileInfo>
+#include <QHash>
 #include <QDataStream>
 #include <QStringList>
 #include <QMessageBox>
@@ -899,6 +900,9 @@ bool QgsMssqlProvider::isValid() const
 
 bool QgsMssqlProvider::addFeatures( QgsFeatureList &flist, Flags flags )
 {
+  // prepared queries, shared by features inserting the same columns
+  QHash< QString, QSqlQuery > queries;
+
   for ( QgsFeatureList::iterator it = flist.begin(); it != flist.end(); ++it )
   {
     if ( it->hasGeometry() && mWkbType == QgsWkbTypes::NoGeometry )
@@ -929,8 +933,6 @@ bool QgsMssqlProvider::addFeatures( QgsFeatureList &flist, Flags flags )
     }
 
     bool first = true;
-    QSqlQuery query = createQuery();
-    query.setForwardOnly( true );
 
     QgsAttributes attrs = it->attributes();
 
@@ -1009,19 +1011,27 @@ bool QgsMssqlProvider::addFeatures( QgsFeatureList &flist, Flags flags )
     {
       statement += QStringLiteral( "; SELECT id FROM @px;" );
     }
-    // use prepared statement to prevent from sql injection
-    if ( !query.prepare( statement ) )
+    auto queryIt = queries.find( statement );
+    if ( queryIt == queries.end() )
     {
-      QString msg = query.lastError().text();
-      QgsDebugMsg( msg );
-      if ( !mSkipFailures )
+      QSqlQuery query = createQuery();
+      query.setForwardOnly( true );
+      // use prepared statement to prevent from sql injection
+      if ( !query.prepare( statement ) )
       {
-        pushError( msg );
-        return false;
+        QString msg = query.lastError().text();
+        QgsDebugMsg( msg );
+        if ( !mSkipFailures )
+        {
+          pushError( msg );
+          return false;
+        }
+        else
+          continue;
       }
-      else
-        continue;
+      queryIt = queries.insert( statement, query );
     }
+    QSqlQuery &query = *queryIt;
 
     for ( int i = 0; i < attrs.count(); ++i )
     {
@@ -1147,6 +1157,7 @@ bool QgsMssqlProvider::addFeatures( QgsFeatureList &flist, Flags flags )
       }
       it->setId( query.value( 0 ).toLongLong() );
     }
+    query.finish();
   }
 
   return true;
@@ -1235,6 +1246,9 @@ bool QgsMssqlProvider::changeAttributeValues( const QgsChangedAttributesMap &att
   if ( mFidColName.isEmpty() )
     return false;
 
+  // prepared queries, shared by features changing the same columns
+  QHash< QString, QSqlQuery > queries;
+
   for ( QgsChangedAttributesMap::const_iterator it = attr_map.begin(); it != attr_map.end(); ++it )
   {
     QgsFeatureId fid = it.key();
@@ -1250,8 +1264,6 @@ bool QgsMssqlProvider::changeAttributeValues( const QgsChangedAttributesMap &att
     QString statement = QStringLiteral( "UPDATE [%1].[%2] SET " ).arg( mSchemaName, mTableName );
 
     bool first = true;
-    QSqlQuery query = createQuery();
-    query.setForwardOnly( true );
 
     for ( QgsAttributeMap::const_iterator it2 = attrs.begin(); it2 != attrs.end(); ++it2 )
     {
@@ -1280,15 +1292,23 @@ bool QgsMssqlProvider::changeAttributeValues( const QgsChangedAttributesMap &att
     if ( first )
       return true; // no fields have been changed
 
-    // set attribute filter
-    statement += QStringLiteral( " WHERE [%1]=%2" ).arg( mFidColName, FID_TO_STRING( fid ) );
+    // set attribute filter, bound so that the statement does not depend on the feature
+    statement += QStringLiteral( " WHERE [%1]=?" ).arg( mFidColName );
 
-    // use prepared statement to prevent from sql injection
-    if ( !query.prepare( statement ) )
+    auto queryIt = queries.find( statement );
+    if ( queryIt == queries.end() )
     {
-      QgsDebugMsg( query.lastError().text() );
-      return false;
+      QSqlQuery query = createQuery();
+      query.setForwardOnly( true );
+      // use prepared statement to prevent from sql injection
+      if ( !query.prepare( statement ) )
+      {
+        QgsDebugMsg( query.lastError().text() );
+        return false;
+      }
+      queryIt = queries.insert( statement, query );
     }
+    QSqlQuery &query = *queryIt;
 
     for ( QgsAttributeMap::const_iterator it2 = attrs.begin(); it2 != attrs.end(); ++it2 )
     {
@@ -1350,12 +1370,14 @@ bool QgsMssqlProvider::changeAttributeValues( const QgsChangedAttributesMap &att
         query.addBindValue( *it2 );
       }
     }
+    query.addBindValue( fid );
 
     if ( !query.exec() )
     {
       QgsDebugMsg( query.lastError().text() );
       return false;
     }
+    query.finish();
   }
 
   return true;
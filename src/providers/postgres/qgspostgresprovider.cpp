@@ -17,6 +17,7 @@
 
 #include "qgsapplication.h"
 #include "qgsfeature.h"
+#include "qgsfeatureidranges.h"
 #include "qgsfield.h"
 #include "qgsgeometry.h"
 #include "qgsmessageoutput.h"
@@ -589,23 +590,14 @@ QString QgsPostgresUtils::whereClause( const QgsFeatureIds &featureIds, const Qg
     case PktOid:
     case PktInt:
     {
-      QString expr;
-
-      //simple primary key, so prefer to use an "IN (...)" query. These are much faster then multiple chained ...OR... clauses
-      if ( !featureIds.isEmpty() )
-      {
-        QString delim;
-        expr = QStringLiteral( "%1 IN (" ).arg( ( pkType == PktOid ? QStringLiteral( "oid" ) : QgsPostgresConn::quotedIdentifier( fields.at( pkAttrs[0] ).name() ) ) );
-
-        for ( const QgsFeatureId featureId : qgis::as_const( featureIds ) )
-        {
-          expr += delim + FID_TO_STRING( ( pkType == PktOid ? featureId : FID2PKINT( featureId ) ) );
-          delim = ',';
-        }
-        expr += ')';
-      }
+      //simple primary key, so prefer to use "IN (...)" and "BETWEEN" queries for runs of consecutive keys.
+      //These are much faster then multiple chained ...OR... clauses
+      QVector< QgsFeatureId > keys;
+      keys.reserve( featureIds.size() );
+      for ( const QgsFeatureId featureId : qgis::as_const( featureIds ) )
+        keys << ( pkType == PktOid ? featureId : FID2PKINT( featureId ) );
 
-      return expr;
+      return QgsFeatureIdRanges( keys ).sqlWhereClause( pkType == PktOid ? QStringLiteral( "oid" ) : QgsPostgresConn::quotedIdentifier( fields.at( pkAttrs[0] ).name() ) );
     }
     case PktInt64:
     case PktUint64:
@@ -19,6 +19,7 @@
 #include "qgsspatialiteprovider.h"
 #include "qgssqliteexpressioncompiler.h"
 
+#include "qgsfeatureidranges.h"
 #include "qgsgeometry.h"
 #include "qgslogger.h"
 #include "qgsmessagelog.h"
@@ -402,18 +403,8 @@ QString QgsSpatiaLiteFeatureIterator::whereClauseFid()
 
 QString QgsSpatiaLiteFeatureIterator::whereClauseFids()
 {
-  if ( mRequest.filterFids().isEmpty() )
-    return QString();
-
-  QString expr = QStringLiteral( "%1 IN (" ).arg( quotedPrimaryKey() ), delim;
-  const auto constFilterFids = mRequest.filterFids();
-  for ( const QgsFeatureId featureId : constFilterFids )
-  {
-    expr += delim + QString::number( featureId );
-    delim = ',';
-  }
-  expr += ')';
-  return expr;
+  // runs of consecutive ids are matched with BETWEEN, the others are listed in an IN clause
+  return QgsFeatureIdRanges( mRequest.filterFids() ).sqlWhereClause( quotedPrimaryKey() );
 }
 
 QString QgsSpatiaLiteFeatureIterator::whereClauseRect()
@@ -4114,6 +4114,61 @@ static void deleteWkbBlob( void *wkbBlob )
   delete[]( char * )wkbBlob;
 }
 
+/**
+ * Prepared statements of a single edit operation, keyed by their SQL.
+ *
+ * Features inserting or updating the same set of columns share one statement, instead
+ * of compiling a new one for each feature. Statements are finalized on destruction.
+ */
+class QgsSpatiaLitePreparedStatements
+{
+  public:
+
+    explicit QgsSpatiaLitePreparedStatements( sqlite3 *handle )
+      : mHandle( handle )
+    {}
+
+    ~QgsSpatiaLitePreparedStatements()
+    {
+      for ( sqlite3_stmt *stmt : qgis::as_const( mStatements ) )
+        sqlite3_finalize( stmt );
+    }
+
+    QgsSpatiaLitePreparedStatements( const QgsSpatiaLitePreparedStatements &other ) = delete;
+    QgsSpatiaLitePreparedStatements &operator=( const QgsSpatiaLitePreparedStatements &other ) = delete;
+
+    /**
+     * Returns the statement for \a sql, reset and without bindings, preparing it the first time.
+     * Returns NULLPTR and sets \a ret to the error code if the statement could not be prepared.
+     */
+    sqlite3_stmt *statement( const QString &sql, int &ret )
+    {
+      auto it = mStatements.constFind( sql );
+      if ( it != mStatements.constEnd() )
+      {
+        sqlite3_reset( *it );
+        sqlite3_clear_bindings( *it );
+        ret = SQLITE_OK;
+        return *it;
+      }
+
+      sqlite3_stmt *stmt = nullptr;
+      ret = sqlite3_prepare_v2( mHandle, sql.toUtf8().constData(), -1, &stmt, nullptr );
+      if ( ret != SQLITE_OK )
+      {
+        sqlite3_finalize( stmt );
+        return nullptr;
+      }
+      mStatements.insert( sql, stmt );
+      return stmt;
+    }
+
+  private:
+
+    sqlite3 *mHandle = nullptr;
+    QHash< QString, sqlite3_stmt * > mStatements;
+};
+
 bool QgsSpatiaLiteProvider::addFeatures( QgsFeatureList &flist, Flags flags )
 {
   sqlite3_stmt *stmt = nullptr;
@@ -4136,6 +4191,8 @@ bool QgsSpatiaLiteProvider::addFeatures( QgsFeatureList &flist, Flags flags )
   {
     toCommit = true;
 
+    QgsSpatiaLitePreparedStatements statements( sqliteHandle( ) );
+
     QString baseSql { QStringLiteral( "INSERT INTO %1(" ).arg( QgsSqliteUtils::quotedIdentifier( mTableName ) ) };
     baseValues = QStringLiteral( ") VALUES (" );
 
@@ -4188,8 +4245,8 @@ bool QgsSpatiaLiteProvider::addFeatures( QgsFeatureList &flist, Flags flags )
       sql += values;
       sql += ')';
 
-      // SQLite prepared statement
-      ret = sqlite3_prepare_v2( sqliteHandle( ), sql.toUtf8().constData(), -1, &stmt, nullptr );
+      // SQLite prepared statement, shared by features inserting the same columns
+      stmt = statements.statement( sql, ret );
       if ( ret == SQLITE_OK )
       {
 
@@ -4307,8 +4364,6 @@ bool QgsSpatiaLiteProvider::addFeatures( QgsFeatureList &flist, Flags flags )
         // performing actual row insert
         ret = sqlite3_step( stmt );
 
-        sqlite3_finalize( stmt );
-
         if ( ret == SQLITE_DONE || ret == SQLITE_ROW )
         {
           // update feature id
@@ -4598,12 +4653,15 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
     return false;
   }
 
+  QgsSpatiaLitePreparedStatements statements( sqliteHandle( ) );
+
   for ( QgsChangedAttributesMap::const_iterator iter = attr_map.begin(); iter != attr_map.end(); ++iter )
   {
     // Loop over all changed features
     //
     // For each changed feature, create an update string like
-    // "UPDATE table SET simple_column=23.5, complex_column=? WHERE primary_key=fid"
+    // "UPDATE table SET column_a=?, column_b=? WHERE primary_key=?"
+    // All values are bound, so that features changing the same columns share a prepared statement.
     // On any update failure, changes to all features will be rolled back
 
     QgsFeatureId fid = iter.key();
@@ -4616,12 +4674,11 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
     if ( attrs.isEmpty() )
       continue;
 
-    QString sql = QStringLiteral( "UPDATE %1 SET " ).arg( QgsSqliteUtils::quotedIdentifier( mTableName ) );
+    sql = QStringLiteral( "UPDATE %1 SET " ).arg( QgsSqliteUtils::quotedIdentifier( mTableName ) );
     bool first = true;
 
-    // keep track of map of parameter index to value
-    QMap<int, QVariant> bindings;
-    int bind_parameter_idx = 1;
+    // values to bind, in the order of the parameters
+    QVariantList bindings;
 
     // cycle through the changed attributes of the feature
     for ( QgsAttributeMap::const_iterator siter = attrs.begin(); siter != attrs.end(); ++siter )
@@ -4636,17 +4693,28 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
         else
           first = false;
 
+        sql += QStringLiteral( "%1=?" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ) );
+
         QVariant::Type type = fld.type();
 
         if ( val.isNull() || !val.isValid() )
         {
           // binding a NULL value
-          sql += QStringLiteral( "%1=NULL" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ) );
+          bindings << QVariant();
+        }
+        else if ( type == QVariant::Int || type == QVariant::LongLong )
+        {
+          // binding an INTEGER value, values which are not numbers are left to the column affinity
+          bool ok = false;
+          const qlonglong intVal = val.toLongLong( &ok );
+          bindings << ( ok ? QVariant( intVal ) : QVariant( val.toString() ) );
         }
-        else if ( type == QVariant::Int || type == QVariant::LongLong || type == QVariant::Double )
+        else if ( type == QVariant::Double )
         {
-          // binding a NUMERIC value
-          sql += QStringLiteral( "%1=%2" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ), val.toString() );
+          // binding a DOUBLE value
+          bool ok = false;
+          const double doubleVal = val.toDouble( &ok );
+          bindings << ( ok ? QVariant( doubleVal ) : QVariant( val.toString() ) );
         }
         else if ( type == QVariant::StringList || type == QVariant::List )
         {
@@ -4660,7 +4728,7 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
               throw json::parse_error::create( 0, 0, tr( "JSON value must be an array" ).toStdString() );
             }
             jRepr = QString::fromStdString( jObj.dump( ) );
-            sql += QStringLiteral( "%1=%2" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ),  QgsSqliteUtils::quotedString( jRepr ) );
+            bindings << jRepr;
           }
           catch ( json::exception &ex )
           {
@@ -4675,21 +4743,20 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
         else if ( type == QVariant::ByteArray )
         {
           // binding a BLOB value
-          sql += QStringLiteral( "%1=?" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ) );
-          bindings[ bind_parameter_idx++ ] = val;
+          bindings << val.toByteArray();
         }
         else if ( type == QVariant::DateTime )
         {
-          sql += QStringLiteral( "%1=%2" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ), QgsSqliteUtils::quotedString( val.toDateTime().toString( QStringLiteral( "yyyy-MM-ddThh:mm:ss" ) ) ) );
+          bindings << val.toDateTime().toString( QStringLiteral( "yyyy-MM-ddThh:mm:ss" ) );
         }
         else if ( type == QVariant::Date )
         {
-          sql += QStringLiteral( "%1=%2" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ), QgsSqliteUtils::quotedString( val.toDateTime().toString( QStringLiteral( "yyyy-MM-dd" ) ) ) );
+          bindings << val.toDateTime().toString( QStringLiteral( "yyyy-MM-dd" ) );
         }
         else
         {
           // binding a TEXT value
-          sql += QStringLiteral( "%1=%2" ).arg( QgsSqliteUtils::quotedIdentifier( fld.name() ), QgsSqliteUtils::quotedString( val.toString() ) );
+          bindings << val.toString();
         }
       }
       catch ( SLFieldNotFound )
@@ -4697,11 +4764,13 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
         // Field was missing - shouldn't happen
       }
     }
-    sql += QStringLiteral( " WHERE %1=%2" ).arg( QgsSqliteUtils::quotedIdentifier( mPrimaryKey ) ).arg( fid );
+    if ( bindings.isEmpty() )
+      continue;
+
+    sql += QStringLiteral( " WHERE %1=?" ).arg( QgsSqliteUtils::quotedIdentifier( mPrimaryKey ) );
 
-    // prepare SQLite statement
-    sqlite3_stmt *stmt = nullptr;
-    ret = sqlite3_prepare_v2( sqliteHandle( ), sql.toUtf8().constData(), -1, &stmt, nullptr );
+    // SQLite prepared statement, shared by features changing the same columns
+    sqlite3_stmt *stmt = statements.statement( sql, ret );
     if ( ret != SQLITE_OK )
     {
       // some unexpected error occurred during preparation
@@ -4712,25 +4781,36 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
       return false;
     }
 
-    // bind variables not handled directly in the string
-    for ( auto i = bindings.cbegin(); i != bindings.cend(); ++i )
+    int parameter_idx = 0;
+    for ( const QVariant &val : qgis::as_const( bindings ) )
     {
-      int parameter_idx = i.key();
-      const QVariant val = i.value();
       switch ( val.type() )
       {
+        case QVariant::Invalid:
+          ret = sqlite3_bind_null( stmt, ++parameter_idx );
+          break;
+
+        case QVariant::LongLong:
+          ret = sqlite3_bind_int64( stmt, ++parameter_idx, val.toLongLong() );
+          break;
+
+        case QVariant::Double:
+          ret = sqlite3_bind_double( stmt, ++parameter_idx, val.toDouble() );
+          break;
+
         case QVariant::ByteArray:
         {
           const QByteArray ba = val.toByteArray();
-          sqlite3_bind_blob( stmt, parameter_idx, ba.constData(), ba.size(), SQLITE_TRANSIENT );
+          ret = sqlite3_bind_blob( stmt, ++parameter_idx, ba.constData(), ba.size(), SQLITE_TRANSIENT );
           break;
         }
 
         default:
-          // This will only happen if the above code is changed to bind more types,
-          // but the programmer has forgotten to handle the type here. Fatal error.
-          sqlite3_finalize( stmt );
-          Q_ASSERT( false );
+        {
+          const QByteArray ba = val.toString().toUtf8();
+          ret = sqlite3_bind_text( stmt, ++parameter_idx, ba.constData(), ba.size(), SQLITE_TRANSIENT );
+          break;
+        }
       }
 
       if ( ret != SQLITE_OK )
@@ -4740,19 +4820,19 @@ bool QgsSpatiaLiteProvider::changeAttributeValues( const QgsChangedAttributesMap
         errMsg = static_cast<char *>( sqlite3_malloc( strlen( err ) + 1 ) );
         strcpy( errMsg, err );
         handleError( sql, errMsg, savepointId );
-        sqlite3_finalize( stmt );
         return false;
       }
     }
+    sqlite3_bind_int64( stmt, ++parameter_idx, FID_TO_NUMBER( fid ) );
 
     ret = sqlite3_step( stmt );
-    sqlite3_finalize( stmt );
     if ( ret != SQLITE_DONE )
     {
       // some unexpected error occurred during execution of update query
       const char *err = sqlite3_errmsg( sqliteHandle( ) );
       errMsg = static_cast<char *>( sqlite3_malloc( strlen( err ) + 1 ) );
       strcpy( errMsg, err );
+      sqlite3_reset( stmt );
       handleError( sql, errMsg, savepointId );
       return false;
     }
@@ -12,10 +12,21 @@ Email                : nyall dot dawson at gmail dot com
  *   (at your option) any later version.                                   *
  *                                                                         *
  ***************************************************************************/
+#include <QDir>
 #include "qgstest.h"
 
 #include "qgsapplication.h"
 #include "qgsdualedgetriangulation.h"
+#include "qgstininterpolator.h"
+#include "qgsidwinterpolator.h"
+#include "qgsgridfilewriter.h"
+#include "qgsvectorlayer.h"
+#include "qgsvectordataprovider.h"
+#include "qgsfeature.h"
+#include "qgsgeometry.h"
+#include "qgspoint.h"
+
+#include <random>
 
 class TestQgsInterpolator : public QObject
 {
@@ -29,10 +40,50 @@ class TestQgsInterpolator : public QObject
     void init() ;// will be called before each testfunction is executed.
     void cleanup() ;// will be called after every testfunction.
     void dualEdge();
+    void tinStreaming();
+    void idwNearestPoints();
+    void idwNearestPointsBruteForce();
+    void gridWriterBlockFailure();
+    void derivedBlockInterpolation();
 
   private:
 };
 
+//! Interpolator which fails to calculate any block
+class FailingInterpolator : public QgsInterpolator
+{
+  public:
+    FailingInterpolator()
+      : QgsInterpolator( QList< QgsInterpolator::LayerData >() )
+    {}
+
+    int interpolatePoint( double, double, double &, QgsFeedback * ) override
+    {
+      return 1;
+    }
+
+    int interpolateBlock( double, double, double, double, int, int, double *, QgsFeedback * ) override
+    {
+      return 1;
+    }
+};
+
+//! Interpolator derived from a built-in interpolator with its own point calculation
+template <class T>
+class DerivedInterpolator : public T
+{
+  public:
+    DerivedInterpolator()
+      : T( QList< QgsInterpolator::LayerData >() )
+    {}
+
+    int interpolatePoint( double x, double y, double &result, QgsFeedback * ) override
+    {
+      result = x + 10 * y;
+      return 0;
+    }
+};
+
 void  TestQgsInterpolator::initTestCase()
 {
   //
@@ -281,5 +332,247 @@ void TestQgsInterpolator::dualEdge()
 }
 
 
+void TestQgsInterpolator::tinStreaming()
+{
+  // irregular points with a few sparse areas, so that some tiles need a larger halo
+  QgsVectorLayer layer( QStringLiteral( "Point?crs=EPSG:3857&field=z:double" ), QStringLiteral( "points" ), QStringLiteral( "memory" ) );
+  QVERIFY( layer.isValid() );
+  QgsFeatureList features;
+  quint32 seed = 12345;
+  auto random = [&seed]()
+  {
+    seed = seed * 1103515245 + 12345;
+    return static_cast< double >( ( seed >> 8 ) & 0xffff ) / 0xffff;
+  };
+  for ( int i = 0; i < 3000; ++i )
+  {
+    const double x = random() * 1000;
+    const double y = random() * 600;
+    if ( x > 400 && x < 700 && y > 200 && y < 400 && i % 10 != 0 )
+      continue;
+
+    QgsFeature f( layer.fields() );
+    f.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( x, y ) ) );
+    f.setAttribute( 0, std::sin( x / 100 ) * 50 + y / 10 );
+    features << f;
+  }
+  QVERIFY( layer.dataProvider()->addFeatures( features ) );
+
+  QgsInterpolator::LayerData data;
+  data.source = &layer;
+  data.valueSource = QgsInterpolator::ValueAttribute;
+  data.interpolationAttribute = 0;
+  data.sourceType = QgsInterpolator::SourcePoints;
+
+  QgsTinInterpolator inMemory( QList< QgsInterpolator::LayerData >() << data );
+  QgsTinInterpolator streaming( QList< QgsInterpolator::LayerData >() << data );
+  streaming.setStreamingTriangulation( true );
+  QVERIFY( streaming.streamingTriangulation() );
+
+  // extent larger than the data, so that some cells are outside the convex hull
+  const int columns = 600;
+  const int rows = 400;
+  const double xMin = -50;
+  const double yMax = 650;
+  const double cellSize = 1100.0 / columns;
+  std::vector< double > expected( columns * rows );
+  std::vector< double > values( columns * rows );
+  QCOMPARE( inMemory.interpolateBlock( xMin, yMax, cellSize, cellSize, columns, rows, expected.data() ), 0 );
+  QCOMPARE( streaming.interpolateBlock( xMin, yMax, cellSize, cellSize, columns, rows, values.data() ), 0 );
+
+  int valid = 0;
+  for ( std::size_t i = 0; i < values.size(); ++i )
+  {
+    if ( std::isnan( expected[i] ) )
+    {
+      QVERIFY( std::isnan( values[i] ) );
+    }
+    else
+    {
+      QGSCOMPARENEAR( values[i], expected[i], 1e-6 );
+      valid++;
+    }
+  }
+  QVERIFY( valid > 0 );
+  QVERIFY( valid < columns * rows );
+}
+
+void TestQgsInterpolator::idwNearestPoints()
+{
+  QgsVectorLayer layer( QStringLiteral( "Point?crs=EPSG:3857&field=z:double" ), QStringLiteral( "points" ), QStringLiteral( "memory" ) );
+  QVERIFY( layer.isValid() );
+  QgsFeatureList features;
+  for ( int i = 0; i < 10; ++i )
+  {
+    QgsFeature f( layer.fields() );
+    f.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( i * 10, 0 ) ) );
+    f.setAttribute( 0, i * 2.0 );
+    features << f;
+  }
+  QVERIFY( layer.dataProvider()->addFeatures( features ) );
+
+  QgsInterpolator::LayerData data;
+  data.source = &layer;
+  data.valueSource = QgsInterpolator::ValueAttribute;
+  data.interpolationAttribute = 0;
+  data.sourceType = QgsInterpolator::SourcePoints;
+
+  QgsIDWInterpolator idw( QList< QgsInterpolator::LayerData >() << data );
+  double result = 0;
+
+  // exact point
+  QCOMPARE( idw.interpolatePoint( 30, 0, result ), 0 );
+  QCOMPARE( result, 6.0 );
+
+  // two nearest points, at equal distance
+  idw.setMaximumPoints( 2 );
+  QCOMPARE( idw.maximumPoints(), 2 );
+  QCOMPARE( idw.interpolatePoint( 35, 0, result ), 0 );
+  QGSCOMPARENEAR( result, 7.0, 0.000001 );
+
+  // three nearest points, weighted by inverse squared distance
+  idw.setMaximumPoints( 3 );
+  QCOMPARE( idw.interpolatePoint( 32, 0, result ), 0 );
+  const double w1 = 1 / 4.0;
+  const double w2 = 1 / 64.0;
+  const double w3 = 1 / 144.0;
+  QGSCOMPARENEAR( result, ( w1 * 6 + w2 * 8 + w3 * 4 ) / ( w1 + w2 + w3 ), 0.000001 );
+
+  // search radius only
+  idw.setMaximumPoints( 0 );
+  idw.setSearchRadius( 5 );
+  QCOMPARE( idw.searchRadius(), 5.0 );
+  QCOMPARE( idw.interpolatePoint( 32, 0, result ), 0 );
+  QCOMPARE( result, 6.0 );
+  QCOMPARE( idw.interpolatePoint( 45, 20, result ), 1 );
+
+  // block interpolation matches single points
+  idw.setSearchRadius( 25 );
+  idw.setMaximumPoints( 4 );
+  std::vector< double > values( 20 * 4 );
+  QCOMPARE( idw.interpolateBlock( -5, 10, 5, 5, 20, 4, values.data() ), 0 );
+  for ( int row = 0; row < 4; ++row )
+  {
+    for ( int column = 0; column < 20; ++column )
+    {
+      const double value = values[ row * 20 + column ];
+      if ( idw.interpolatePoint( -5 + ( column + 0.5 ) * 5, 10 - ( row + 0.5 ) * 5, result ) == 0 )
+        QCOMPARE( value, result );
+      else
+        QVERIFY( std::isnan( value ) );
+    }
+  }
+}
+
+void TestQgsInterpolator::idwNearestPointsBruteForce()
+{
+  // enough points for the index to split into several levels of nodes
+  QgsVectorLayer layer( QStringLiteral( "Point?crs=EPSG:3857&field=z:double" ), QStringLiteral( "points" ), QStringLiteral( "memory" ) );
+  QVERIFY( layer.isValid() );
+  std::mt19937 generator( 7 );
+  std::uniform_real_distribution< double > coordinate( 0, 100 );
+  std::uniform_real_distribution< double > value( -50, 50 );
+  QgsFeatureList features;
+  std::vector< QgsPoint > points;
+  for ( int i = 0; i < 600; ++i )
+  {
+    const QgsPoint point( coordinate( generator ), coordinate( generator ), value( generator ) );
+    points.push_back( point );
+    QgsFeature f( layer.fields() );
+    f.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( point.x(), point.y() ) ) );
+    f.setAttribute( 0, point.z() );
+    features << f;
+  }
+  QVERIFY( layer.dataProvider()->addFeatures( features ) );
+
+  QgsInterpolator::LayerData data;
+  data.source = &layer;
+  data.valueSource = QgsInterpolator::ValueAttribute;
+  data.interpolationAttribute = 0;
+  data.sourceType = QgsInterpolator::SourcePoints;
+
+  QgsIDWInterpolator idw( QList< QgsInterpolator::LayerData >() << data );
+
+  // query points inside and around the data extent
+  std::uniform_real_distribution< double > queryCoordinate( -20, 120 );
+  std::vector< std::pair< double, double > > distances;
+  for ( int maximumPoints : { 1, 5, 12, 64, 150 } )
+  {
+    for ( double searchRadius : { 0.0, 4.0, 15.0 } )
+    {
+      idw.setMaximumPoints( maximumPoints );
+      idw.setSearchRadius( searchRadius );
+      for ( int i = 0; i < 200; ++i )
+      {
+        const double x = queryCoordinate( generator );
+        const double y = queryCoordinate( generator );
+
+        distances.clear();
+        for ( const QgsPoint &point : points )
+        {
+          const double distance = std::sqrt( ( point.x() - x ) * ( point.x() - x ) + ( point.y() - y ) * ( point.y() - y ) );
+          if ( searchRadius <= 0 || distance <= searchRadius )
+            distances.emplace_back( distance, point.z() );
+        }
+        std::sort( distances.begin(), distances.end() );
+        if ( distances.size() > static_cast< std::size_t >( maximumPoints ) )
+          distances.resize( static_cast< std::size_t >( maximumPoints ) );
+
+        double result = 0;
+        if ( distances.empty() )
+        {
+          QCOMPARE( idw.interpolatePoint( x, y, result ), 1 );
+          continue;
+        }
+
+        double sumValues = 0;
+        double sumWeights = 0;
+        for ( const std::pair< double, double > &candidate : distances )
+        {
+          const double weight = 1 / ( candidate.first * candidate.first );
+          sumValues += weight * candidate.second;
+          sumWeights += weight;
+        }
+        QCOMPARE( idw.interpolatePoint( x, y, result ), 0 );
+        QGSCOMPARENEAR( result, sumValues / sumWeights, 1e-9 );
+      }
+    }
+  }
+}
+
+void TestQgsInterpolator::gridWriterBlockFailure()
+{
+  FailingInterpolator interpolator;
+  const QString outputPath = QDir::tempPath() + QStringLiteral( "/interpolator_failure.asc" );
+  QgsGridFileWriter writer( &interpolator, outputPath, QgsRectangle( 0, 0, 100, 100 ), 10, 10 );
+  QCOMPARE( writer.writeFile(), 4 );
+  QVERIFY( !QFile::exists( outputPath ) );
+}
+
+void TestQgsInterpolator::derivedBlockInterpolation()
+{
+  // blocks of interpolators derived from the built-in ones are calculated with their own point calculation
+  std::vector< double > values( 6 * 3 );
+
+  DerivedInterpolator< QgsIDWInterpolator > idw;
+  idw.setMaximumPoints( 4 );
+  QCOMPARE( idw.interpolateBlock( 0, 3, 1, 1, 6, 3, values.data() ), 0 );
+  for ( int row = 0; row < 3; ++row )
+  {
+    for ( int column = 0; column < 6; ++column )
+      QCOMPARE( values[ row * 6 + column ], column + 0.5 + 10 * ( 3 - ( row + 0.5 ) ) );
+  }
+
+  std::fill( values.begin(), values.end(), 0 );
+  DerivedInterpolator< QgsTinInterpolator > tin;
+  tin.setStreamingTriangulation( true );
+  QCOMPARE( tin.interpolateBlock( 0, 3, 1, 1, 6, 3, values.data() ), 0 );
+  for ( int row = 0; row < 3; ++row )
+  {
+    for ( int column = 0; column < 6; ++column )
+      QCOMPARE( values[ row * 6 + column ], column + 0.5 + 10 * ( 3 - ( row + 0.5 ) ) );
+  }
+}
+
 QGSTEST_MAIN( TestQgsInterpolator )
 #include "testqgsinterpolator.moc"
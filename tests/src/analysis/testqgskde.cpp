@@ -0,0 +1,168 @@
+/***************************************************************************
+     testqgskde.cpp
+     --------------
+    Date                 : July 2020
+    Copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QDir>
+#include "qgstest.h"
+
+#include "qgsapplication.h"
+#include "qgsgeometry.h"
+#include "qgskde.h"
+#include "qgsogrutils.h"
+#include "qgsvectorlayer.h"
+
+#include <gdal.h>
+#include <random>
+
+/**
+ * \ingroup UnitTests
+ * This is a unit test for the kernel density estimation class
+ */
+class TestQgsKde : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void tiledMatchesRun_data();
+    void tiledMatchesRun();
+
+  private:
+    std::unique_ptr< QgsVectorLayer > createPoints( int count ) const;
+    static std::vector< float > readRaster( const QString &path, int &columns, int &rows );
+};
+
+void TestQgsKde::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+}
+
+void TestQgsKde::cleanupTestCase()
+{
+  QgsApplication::exitQgis();
+}
+
+std::unique_ptr< QgsVectorLayer > TestQgsKde::createPoints( int count ) const
+{
+  std::unique_ptr< QgsVectorLayer > layer = qgis::make_unique< QgsVectorLayer >( QStringLiteral( "MultiPoint?crs=epsg:3857&field=radius:double&field=weight:double" ),
+      QStringLiteral( "points" ), QStringLiteral( "memory" ) );
+
+  std::mt19937 generator( 42 );
+  std::uniform_real_distribution< double > coordinate( 0, 100 );
+  std::uniform_real_distribution< double > radius( 1, 8 );
+  std::uniform_real_distribution< double > weight( 0.5, 3 );
+
+  QgsFeatureList features;
+  for ( int i = 0; i < count; ++i )
+  {
+    QgsFeature feature( layer->fields() );
+    QgsMultiPointXY points;
+    points << QgsPointXY( coordinate( generator ), coordinate( generator ) * 0.8 );
+    // a few multipoints with parts in distant bands
+    if ( i % 10 == 0 )
+      points << QgsPointXY( coordinate( generator ), coordinate( generator ) * 0.8 );
+    feature.setGeometry( QgsGeometry::fromMultiPointXY( points ) );
+    feature.setAttributes( QgsAttributes() << radius( generator ) << weight( generator ) );
+    features << feature;
+  }
+  layer->dataProvider()->addFeatures( features );
+  layer->updateExtents();
+  return layer;
+}
+
+std::vector< float > TestQgsKde::readRaster( const QString &path, int &columns, int &rows )
+{
+  gdal::dataset_unique_ptr dataset( GDALOpen( path.toUtf8().constData(), GA_ReadOnly ) );
+  if ( !dataset )
+    return std::vector< float >();
+
+  columns = GDALGetRasterXSize( dataset.get() );
+  rows = GDALGetRasterYSize( dataset.get() );
+  std::vector< float > values( static_cast< std::size_t >( columns ) * rows );
+  if ( GDALRasterIO( GDALGetRasterBand( dataset.get(), 1 ), GF_Read, 0, 0, columns, rows, values.data(), columns, rows, GDT_Float32, 0, 0 ) != CE_None )
+    return std::vector< float >();
+  return values;
+}
+
+void TestQgsKde::tiledMatchesRun_data()
+{
+  QTest::addColumn< int >( "shape" );
+  QTest::addColumn< bool >( "variableRadius" );
+  QTest::addColumn< int >( "tileSize" );
+  QTest::addColumn< int >( "maximumPointsInMemory" );
+
+  QTest::newRow( "quartic, fixed radius, spilled" ) << static_cast< int >( QgsKernelDensityEstimation::KernelQuartic ) << false << 16 << 50;
+  QTest::newRow( "triangular, variable radius, spilled" ) << static_cast< int >( QgsKernelDensityEstimation::KernelTriangular ) << true << 7 << 30;
+  QTest::newRow( "uniform, variable radius, in memory" ) << static_cast< int >( QgsKernelDensityEstimation::KernelUniform ) << true << 32 << 65536;
+}
+
+void TestQgsKde::tiledMatchesRun()
+{
+  QFETCH( int, shape );
+  QFETCH( bool, variableRadius );
+  QFETCH( int, tileSize );
+  QFETCH( int, maximumPointsInMemory );
+
+  std::unique_ptr< QgsVectorLayer > points = createPoints( 400 );
+  QVERIFY( points->isValid() );
+
+  QgsKernelDensityEstimation::Parameters parameters;
+  parameters.source = points.get();
+  parameters.radius = 6;
+  parameters.radiusField = variableRadius ? QStringLiteral( "radius" ) : QString();
+  parameters.weightField = QStringLiteral( "weight" );
+  parameters.pixelSize = 0.7;
+  parameters.shape = static_cast< QgsKernelDensityEstimation::KernelShape >( shape );
+  parameters.decayRatio = 0.2;
+  parameters.outputValues = QgsKernelDensityEstimation::OutputScaled;
+
+  const QString runPath = QDir::tempPath() + QStringLiteral( "/kde_run.tif" );
+  const QString tiledPath = QDir::tempPath() + QStringLiteral( "/kde_tiled.tif" );
+
+  QgsKernelDensityEstimation kde( parameters, runPath, QStringLiteral( "GTiff" ) );
+  QCOMPARE( kde.run(), QgsKernelDensityEstimation::Success );
+  QgsKernelDensityEstimation tiledKde( parameters, tiledPath, QStringLiteral( "GTiff" ) );
+  QCOMPARE( tiledKde.runTiled( nullptr, tileSize, maximumPointsInMemory ), QgsKernelDensityEstimation::Success );
+
+  int columns = 0;
+  int rows = 0;
+  const std::vector< float > expected = readRaster( runPath, columns, rows );
+  int tiledColumns = 0;
+  int tiledRows = 0;
+  const std::vector< float > tiled = readRaster( tiledPath, tiledColumns, tiledRows );
+  QVERIFY( !expected.empty() );
+  QCOMPARE( tiledColumns, columns );
+  QCOMPARE( tiledRows, rows );
+  // several bands and tiles of each band
+  QVERIFY( rows > 3 * tileSize );
+  QVERIFY( columns > 3 * tileSize );
+
+  int dataPixels = 0;
+  for ( std::size_t i = 0; i < expected.size(); ++i )
+  {
+    if ( expected[i] != -9999 )
+      ++dataPixels;
+    if ( tiled[i] != expected[i] )
+      QFAIL( QStringLiteral( "Pixel %1, %2 differs: %3 instead of %4" ).arg( i % columns ).arg( i / columns ).arg( tiled[i] ).arg( expected[i] ).toUtf8().constData() );
+  }
+  QVERIFY( dataPixels > 0 );
+
+  QFile::remove( runPath );
+  QFile::remove( tiledPath );
+}
+
+QGSTEST_MAIN( TestQgsKde )
+#include "testqgskde.moc"
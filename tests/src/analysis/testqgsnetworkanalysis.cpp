@@ -25,6 +25,12 @@ Email                : nyall dot dawson at gmail dot com
 #include "qgsgraphbuilder.h"
 #include "qgsgraph.h"
 #include "qgsgraphanalyzer.h"
+#include "qgscontractionhierarchy.h"
+#include "qgsgraphsearchengine.h"
+
+#include <QDir>
+
+#include <random>
 
 class TestQgsNetworkAnalysis : public QObject
 {
@@ -43,6 +49,10 @@ class TestQgsNetworkAnalysis : public QObject
     void dijkkjkjkskkjsktra();
     void testRouteFail();
     void testRouteFail2();
+    void contractionHierarchy();
+    void graphSearchEngine();
+    void directorCache();
+    void directorSnapping();
 
   private:
     std::unique_ptr< QgsVectorLayer > buildNetwork();
@@ -575,7 +585,351 @@ void TestQgsNetworkAnalysis::testRouteFail2()
   QCOMPARE( resultCost.at( endVertexIdx ), 9.01 );
 }
 
+void TestQgsNetworkAnalysis::contractionHierarchy()
+{
+  // directed grid with varying costs, some one way edges and an isolated vertex
+  const int size = 12;
+  QgsGraph graph;
+  for ( int row = 0; row < size; ++row )
+  {
+    for ( int col = 0; col < size; ++col )
+      graph.addVertex( QgsPointXY( col, row ) );
+  }
+  const int isolated = graph.addVertex( QgsPointXY( -10, -10 ) );
+  for ( int row = 0; row < size; ++row )
+  {
+    for ( int col = 0; col < size; ++col )
+    {
+      const int vertex = row * size + col;
+      if ( col + 1 < size )
+      {
+        graph.addEdge( vertex, vertex + 1, QVector< QVariant >() << 1 + ( vertex * 7 ) % 5 );
+        if ( ( row + col ) % 4 != 0 )
+          graph.addEdge( vertex + 1, vertex, QVector< QVariant >() << 1 + ( vertex * 3 ) % 7 );
+      }
+      if ( row + 1 < size )
+      {
+        graph.addEdge( vertex + size, vertex, QVector< QVariant >() << 1 + ( vertex * 5 ) % 3 );
+        if ( ( row * col ) % 3 != 1 )
+          graph.addEdge( vertex, vertex + size, QVector< QVariant >() << 0.5 + ( vertex * 11 ) % 6 );
+      }
+    }
+  }
+
+  QgsContractionHierarchy hierarchy;
+  QVERIFY( !hierarchy.isValid() );
+  QVERIFY( std::isinf( hierarchy.shortestPathCost( 0, 1 ) ) );
+  QVERIFY( hierarchy.build( &graph, 0 ) );
+  QVERIFY( hierarchy.isValid() );
+  QCOMPARE( hierarchy.vertexCount(), graph.vertexCount() );
+
+  const QString path = QDir::tempPath() + QStringLiteral( "/contraction_hierarchy.qch" );
+  QVERIFY( hierarchy.writeToFile( path ) );
+  QgsContractionHierarchy restored;
+  QVERIFY( restored.readFromFile( path ) );
+  QCOMPARE( restored.vertexCount(), hierarchy.vertexCount() );
+  QCOMPARE( restored.shortcutCount(), hierarchy.shortcutCount() );
+
+  // truncated and corrupt files are rejected
+  QFile file( path );
+  QVERIFY( file.open( QIODevice::ReadOnly ) );
+  const QByteArray content = file.readAll();
+  file.close();
+  const QString corruptPath = QDir::tempPath() + QStringLiteral( "/contraction_hierarchy_corrupt.qch" );
+  auto readCorrupt = [&corruptPath]( const QByteArray & data ) -> bool
+  {
+    QFile corruptFile( corruptPath );
+    if ( !corruptFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+      return true;
+    corruptFile.write( data );
+    corruptFile.close();
+    QgsContractionHierarchy corrupt;
+    return corrupt.readFromFile( corruptPath );
+  };
+  QVERIFY( !readCorrupt( content.left( content.size() - 1 ) ) );
+  QVERIFY( !readCorrupt( content.left( content.size() / 2 ) ) );
+  // values of the rank and the offsets of the forward graph, located after the header and the vector sizes
+  const int rankStart = 16 + 4;
+  const int offsetsStart = rankStart + graph.vertexCount() * 4 + 4;
+  auto setInt = []( QByteArray data, int position, qint32 value ) -> QByteArray
+  {
+    for ( int i = 0; i < 4; ++i )
+      data[ position + i ] = static_cast< char >( ( value >> ( 8 * ( 3 - i ) ) ) & 0xff );
+    return data;
+  };
+  QVERIFY( !readCorrupt( setInt( content, rankStart, -1 ) ) );
+  QVERIFY( !readCorrupt( setInt( content, rankStart, graph.vertexCount() ) ) );
+  QVERIFY( !readCorrupt( setInt( content, offsetsStart, 1 ) ) );
+  QVERIFY( !readCorrupt( setInt( content, offsetsStart + 8, -5 ) ) );
+  QVERIFY( readCorrupt( content ) );
+  QFile::remove( corruptPath );
+  QFile::remove( path );
+
+  for ( int from = 0; from < graph.vertexCount(); from += 7 )
+  {
+    QVector<double> expectedCost;
+    QgsGraphAnalyzer::dijkstra( &graph, from, 0, nullptr, &expectedCost );
+    for ( int to = 0; to < graph.vertexCount(); ++to )
+    {
+      QCOMPARE( hierarchy.shortestPathCost( from, to ), expectedCost.at( to ) );
+      QCOMPARE( restored.shortestPathCost( from, to ), expectedCost.at( to ) );
+
+      double cost = 0;
+      const QVector< int > route = hierarchy.shortestPath( from, to, cost );
+      QCOMPARE( cost, expectedCost.at( to ) );
+      if ( std::isinf( expectedCost.at( to ) ) )
+      {
+        QVERIFY( route.isEmpty() );
+        continue;
+      }
+
+      // the route must follow edges of the graph and add up to the shortest path cost
+      QCOMPARE( route.first(), from );
+      QCOMPARE( route.last(), to );
+      double routeCost = 0;
+      for ( int i = 1; i < route.size(); ++i )
+      {
+        double edgeCost = std::numeric_limits< double >::infinity();
+        for ( int edge : graph.vertex( route.at( i - 1 ) ).outgoingEdges() )
+        {
+          if ( graph.edge( edge ).toVertex() == route.at( i ) )
+            edgeCost = std::min( edgeCost, graph.edge( edge ).cost( 0 ).toDouble() );
+        }
+        QVERIFY( !std::isinf( edgeCost ) );
+        routeCost += edgeCost;
+      }
+      QCOMPARE( routeCost, expectedCost.at( to ) );
+    }
+  }
 
+  QVERIFY( std::isinf( hierarchy.shortestPathCost( 0, isolated ) ) );
+  QVERIFY( std::isinf( hierarchy.shortestPathCost( -1, 0 ) ) );
+
+  // an empty graph gives a valid, empty hierarchy
+  QgsGraph emptyGraph;
+  QgsContractionHierarchy emptyHierarchy;
+  QVERIFY( emptyHierarchy.build( &emptyGraph, 0 ) );
+  QVERIFY( emptyHierarchy.isValid() );
+  QCOMPARE( emptyHierarchy.vertexCount(), 0 );
+  QVERIFY( std::isinf( emptyHierarchy.shortestPathCost( 0, 0 ) ) );
+
+  // negative costs are not supported
+  graph.addEdge( 0, isolated, QVector< QVariant >() << -1 );
+  QVERIFY( !hierarchy.build( &graph, 0 ) );
+  QVERIFY( !hierarchy.isValid() );
+}
+
+void TestQgsNetworkAnalysis::graphSearchEngine()
+{
+  // 0 -> 1 -> 2 -> 3, with a slower detour 0 -> 4 -> 2 and a vertex 5 which only leads to 0
+  QgsGraph graph;
+  for ( int i = 0; i < 6; ++i )
+    graph.addVertex( QgsPointXY( i, 0 ) );
+  graph.addEdge( 0, 1, QVector< QVariant >() << 1 );
+  graph.addEdge( 1, 2, QVector< QVariant >() << 2 );
+  graph.addEdge( 2, 3, QVector< QVariant >() << 3 );
+  graph.addEdge( 0, 4, QVector< QVariant >() << 2 );
+  graph.addEdge( 4, 2, QVector< QVariant >() << 2 );
+  graph.addEdge( 5, 0, QVector< QVariant >() << 1 );
+
+  const QgsGraphSearchEngine engine( &graph, 0 );
+  QCOMPARE( engine.graph(), &graph );
+
+  const double inf = std::numeric_limits< double >::infinity();
+
+  // unlimited search matches QgsGraphAnalyzer
+  QVector< int > expectedTree;
+  QVector< double > expectedCost;
+  QgsGraphAnalyzer::dijkstra( &graph, 0, 0, &expectedTree, &expectedCost );
+  QVector< int > tree;
+  QVector< double > cost;
+  QVector< int > reached;
+  engine.dijkstra( 0, -1, &tree, &cost, &reached );
+  QCOMPARE( tree, expectedTree );
+  QCOMPARE( cost, expectedCost );
+  QCOMPARE( reached, QVector< int >() << 0 << 1 << 4 << 2 << 3 );
+
+  // limited search reports the reached vertices and the vertices one edge beyond them
+  engine.dijkstra( 0, 2.5, &tree, &cost, &reached );
+  QCOMPARE( reached, QVector< int >() << 0 << 1 << 4 );
+  QCOMPARE( cost, QVector< double >() << 0 << 1 << 3 << inf << 2 << inf );
+  QCOMPARE( tree, QVector< int >() << -1 << 0 << 1 << -1 << 3 << -1 );
+
+  QCOMPARE( engine.costs( 0, QVector< int >() << 3 << 5 << 2 ), QVector< double >() << 6 << inf << 3 );
+  QCOMPARE( engine.costs( 0, QVector< int >() << 3 << 2, 4 ), QVector< double >() << inf << 3 );
+  QCOMPARE( engine.costs( 5, QVector< int >() << 5 << 3 ), QVector< double >() << 0 << 7 );
+
+  const QVector< QVector< double > > matrix = engine.costMatrix( QVector< int >() << 5 << 0 << 3, QVector< int >() << 0 << 3 );
+  QCOMPARE( matrix.size(), 3 );
+  QCOMPARE( matrix.at( 0 ), QVector< double >() << 1 << 7 );
+  QCOMPARE( matrix.at( 1 ), QVector< double >() << 0 << 6 );
+  QCOMPARE( matrix.at( 2 ), QVector< double >() << inf << 0 );
+
+  const QVector< QVector< double > > limitedMatrix = engine.costMatrix( QVector< int >() << 5 << 0, QVector< int >() << 0 << 3, 6 );
+  QCOMPARE( limitedMatrix.at( 0 ), QVector< double >() << 1 << inf );
+  QCOMPARE( limitedMatrix.at( 1 ), QVector< double >() << 0 << 6 );
+  QVERIFY( engine.isValid() );
+
+  // negative and invalid costs are not supported, all vertices are unreachable
+  QgsGraph negativeGraph;
+  negativeGraph.addVertex( QgsPointXY( 0, 0 ) );
+  negativeGraph.addVertex( QgsPointXY( 1, 0 ) );
+  negativeGraph.addEdge( 0, 1, QVector< QVariant >() << -1 );
+  const QgsGraphSearchEngine negativeEngine( &negativeGraph, 0 );
+  QVERIFY( !negativeEngine.isValid() );
+  negativeEngine.dijkstra( 0, -1, &tree, &cost, &reached );
+  QCOMPARE( tree, QVector< int >() << -1 << -1 );
+  QCOMPARE( cost, QVector< double >() << inf << inf );
+  QVERIFY( reached.isEmpty() );
+  QCOMPARE( negativeEngine.costs( 0, QVector< int >() << 0 << 1 ), QVector< double >() << inf << inf );
+
+  QgsGraph invalidGraph;
+  invalidGraph.addVertex( QgsPointXY( 0, 0 ) );
+  invalidGraph.addVertex( QgsPointXY( 1, 0 ) );
+  invalidGraph.addEdge( 0, 1, QVector< QVariant >() << QStringLiteral( "not a number" ) );
+  QVERIFY( !QgsGraphSearchEngine( &invalidGraph, 0 ).isValid() );
+
+  QVERIFY( !QgsGraphSearchEngine( nullptr, 0 ).isValid() );
+
+  // an empty graph can be searched
+  QgsGraph emptyGraph;
+  QVERIFY( QgsGraphSearchEngine( &emptyGraph, 0 ).isValid() );
+}
+
+void TestQgsNetworkAnalysis::directorCache()
+{
+  std::unique_ptr<QgsVectorLayer> network = buildNetwork();
+  QgsVectorLayerDirector director( network.get(), -1, QString(), QString(), QString(), QgsVectorLayerDirector::DirectionBoth );
+  director.addStrategy( new QgsNetworkDistanceStrategy() );
+  QVERIFY( !director.isCacheEnabled() );
+
+  const QVector< QgsPointXY > points = QVector< QgsPointXY >() << QgsPointXY( 0.2, 0.1 ) << QgsPointXY( 10.1, 9 ) << QgsPointXY( 20, 20 );
+  QVector< QgsPointXY > expectedSnapped;
+  QgsGraphBuilder expectedBuilder( network->sourceCrs(), true, 0 );
+  director.makeGraph( &expectedBuilder, points, expectedSnapped );
+  QCOMPARE( expectedSnapped, QVector< QgsPointXY >() << QgsPointXY( 0.2, 0.0 ) << QgsPointXY( 10.0, 9 ) << QgsPointXY( 10, 10 ) );
+  std::unique_ptr< QgsGraph > expectedGraph( expectedBuilder.graph() );
+
+  // building twice from the cached topology must give the same graph as an uncached build
+  director.setCacheEnabled( true );
+  QVERIFY( director.isCacheEnabled() );
+  for ( int i = 0; i < 2; ++i )
+  {
+    QVector< QgsPointXY > snapped;
+    QgsGraphBuilder builder( network->sourceCrs(), true, 0 );
+    director.makeGraph( &builder, points, snapped );
+    QCOMPARE( snapped, expectedSnapped );
+    std::unique_ptr< QgsGraph > graph( builder.graph() );
+    QCOMPARE( graph->vertexCount(), expectedGraph->vertexCount() );
+    QCOMPARE( graph->edgeCount(), expectedGraph->edgeCount() );
+    for ( int v = 0; v < graph->vertexCount(); ++v )
+    {
+      QCOMPARE( graph->vertex( v ).point(), expectedGraph->vertex( v ).point() );
+      QCOMPARE( graph->vertex( v ).outgoingEdges(), expectedGraph->vertex( v ).outgoingEdges() );
+    }
+  }
+
+  // adding features invalidates the cache
+  QgsFeature feature( 0 );
+  feature.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "LineString(10 10, 20 10)" ) ) );
+  network->dataProvider()->addFeatures( QgsFeatureList() << feature );
+  QgsGraphBuilder updatedBuilder( network->sourceCrs(), true, 0 );
+  QVector< QgsPointXY > snapped;
+  director.makeGraph( &updatedBuilder, points, snapped );
+  QCOMPARE( snapped.at( 2 ), QgsPointXY( 20, 10 ) );
+  delete updatedBuilder.graph();
+
+  // editing the layer clears the cache, even when the feature count doesn't change
+  QgsFeature addedFeature;
+  QVERIFY( network->getFeatures( QgsFeatureRequest().setFilterRect( QgsRectangle( 15, 9, 25, 11 ) ) ).nextFeature( addedFeature ) );
+  QVERIFY( network->startEditing() );
+  QgsGeometry editedGeometry = QgsGeometry::fromWkt( QStringLiteral( "LineString(10 10, 20 20)" ) );
+  QVERIFY( network->changeGeometry( addedFeature.id(), editedGeometry ) );
+  QgsGraphBuilder editedBuilder( network->sourceCrs(), true, 0 );
+  director.makeGraph( &editedBuilder, points, snapped );
+  QCOMPARE( snapped.at( 2 ), QgsPointXY( 20, 20 ) );
+  delete editedBuilder.graph();
+  QVERIFY( network->rollBack() );
+  QgsGraphBuilder rolledBackBuilder( network->sourceCrs(), true, 0 );
+  director.makeGraph( &rolledBackBuilder, points, snapped );
+  QCOMPARE( snapped.at( 2 ), QgsPointXY( 20, 10 ) );
+  delete rolledBackBuilder.graph();
+
+  // cache is keyed on the topology tolerance
+  QgsGraphBuilder toleranceBuilder( network->sourceCrs(), true, 1 );
+  director.makeGraph( &toleranceBuilder, QVector< QgsPointXY >() << QgsPointXY( 0.2, 0.1 ), snapped );
+  QCOMPARE( snapped, QVector< QgsPointXY >() << QgsPointXY( 0, 0 ) );
+  delete toleranceBuilder.graph();
+
+  director.clearCache();
+  director.setCacheEnabled( false );
+  QVERIFY( !director.isCacheEnabled() );
+}
+
+void TestQgsNetworkAnalysis::directorSnapping()
+{
+  // many short random lines, so that the segment grid has many cells
+  std::unique_ptr< QgsVectorLayer > network = qgis::make_unique< QgsVectorLayer >( QStringLiteral( "LineString?crs=epsg:3857" ), QStringLiteral( "x" ), QStringLiteral( "memory" ) );
+  std::mt19937 generator( 11 );
+  std::uniform_real_distribution< double > coordinate( 0, 1000 );
+  std::uniform_real_distribution< double > step( -20, 20 );
+  QgsFeatureList features;
+  for ( int i = 0; i < 1500; ++i )
+  {
+    QgsPolylineXY line;
+    line << QgsPointXY( coordinate( generator ), coordinate( generator ) );
+    const int vertices = 2 + i % 3;
+    while ( line.size() < vertices )
+      line << QgsPointXY( line.last().x() + step( generator ), line.last().y() + step( generator ) );
+    QgsFeature feature;
+    feature.setGeometry( QgsGeometry::fromPolylineXY( line ) );
+    features << feature;
+  }
+  QVERIFY( network->dataProvider()->addFeatures( features ) );
+
+  QVector< QgsPointXY > points;
+  std::uniform_real_distribution< double > pointCoordinate( -100, 1100 );
+  for ( int i = 0; i < 300; ++i )
+    points << QgsPointXY( pointCoordinate( generator ), pointCoordinate( generator ) );
+
+  QgsVectorLayerDirector director( network.get(), -1, QString(), QString(), QString(), QgsVectorLayerDirector::DirectionBoth );
+  director.addStrategy( new QgsNetworkDistanceStrategy() );
+  QgsGraphBuilder builder( network->sourceCrs(), false, 0 );
+  QVector< QgsPointXY > snapped;
+  director.makeGraph( &builder, points, snapped );
+  delete builder.graph();
+  QCOMPARE( snapped.size(), points.size() );
+
+  // closest point on any segment of the network, of equally close segments the first one in source order
+  std::vector< std::pair< QgsPointXY, QgsPointXY > > segments;
+  QgsFeature feature;
+  QgsFeatureIterator it = network->getFeatures();
+  while ( it.nextFeature( feature ) )
+  {
+    const QgsPolylineXY line = feature.geometry().asPolyline();
+    for ( int i = 1; i < line.size(); ++i )
+      segments.emplace_back( line.at( i - 1 ), line.at( i ) );
+  }
+  QCOMPARE( segments.size(), static_cast< std::size_t >( 3000 ) );
+
+  for ( int i = 0; i < points.size(); ++i )
+  {
+    double closestDistance = std::numeric_limits< double >::max();
+    QgsPointXY expected;
+    for ( const std::pair< QgsPointXY, QgsPointXY > &segment : segments )
+    {
+      QgsPointXY segmentPoint;
+      const double distance = points.at( i ).sqrDistToSegment( segment.first.x(), segment.first.y(), segment.second.x(), segment.second.y(), segmentPoint, 0 );
+      if ( distance < closestDistance )
+      {
+        closestDistance = distance;
+        expected = segmentPoint;
+      }
+    }
+    QGSCOMPARENEAR( snapped.at( i ).x(), expected.x(), 1e-9 );
+    QGSCOMPARENEAR( snapped.at( i ).y(), expected.y(), 1e-9 );
+  }
+}
 
 QGSTEST_MAIN( TestQgsNetworkAnalysis )
 #include "testqgsnetworkanalysis.moc"
@@ -28,10 +28,53 @@
 #endif
 
 #include <QDir>
+#include <QThread>
 
 // If true regenerate raster reference images
 const bool REGENERATE_REFERENCES = false;
 
+//! Slope filter with its own cell calculation, which must be used instead of the built-in row calculation
+class DerivedSlopeFilter : public QgsSlopeFilter
+{
+  public:
+    DerivedSlopeFilter( const QString &inputFile, const QString &outputFile )
+      : QgsSlopeFilter( inputFile, outputFile, QStringLiteral( "GTiff" ) )
+    {}
+
+    float processNineCellWindow( float *, float *, float *, float *, float *x22, float *, float *, float *, float * ) override
+    {
+      if ( QThread::currentThread() != mThread )
+        ++mForeignThreadCalls;
+      ++mCalls;
+      return *x22;
+    }
+
+    QThread *mThread = QThread::currentThread();
+    int mCalls = 0;
+    int mForeignThreadCalls = 0;
+};
+
+//! Filter with per call state, which must not be called from worker threads
+class SerialTestFilter : public QgsNineCellFilter
+{
+  public:
+    SerialTestFilter( const QString &inputFile, const QString &outputFile )
+      : QgsNineCellFilter( inputFile, outputFile, QStringLiteral( "GTiff" ) )
+    {}
+
+    float processNineCellWindow( float *, float *, float *, float *, float *x22, float *, float *, float *, float * ) override
+    {
+      if ( QThread::currentThread() != mThread )
+        ++mForeignThreadCalls;
+      ++mCalls;
+      return *x22;
+    }
+
+    QThread *mThread = QThread::currentThread();
+    int mCalls = 0;
+    int mForeignThreadCalls = 0;
+};
+
 class TestNineCellFilters : public QObject
 {
     Q_OBJECT
@@ -47,6 +90,9 @@ class TestNineCellFilters : public QObject
     void testAspect();
     void testRuggedness();
     void testTotalCurvature();
+    void testRowProcessing();
+    void testSerialProcessing();
+    void testDerivedFilter();
 #ifdef HAVE_OPENCL
     void testHillshadeCl();
     void testSlopeCl();
@@ -60,6 +106,8 @@ class TestNineCellFilters : public QObject
 
     template <class T> void _testAlg( const QString &name, bool useOpenCl = false );
 
+    template <class T> void _testRow( T &filter );
+
     static QString referenceFile( const QString &name )
     {
       return QStringLiteral( "%1/analysis/%2.tif" ).arg( TEST_DATA_DIR, name );
@@ -215,6 +263,83 @@ void TestNineCellFilters::testTotalCurvature()
   _testAlg<QgsTotalCurvatureFilter>( QStringLiteral( "totalcurvature" ) );
 }
 
+template <class T>
+void TestNineCellFilters::_testRow( T &filter )
+{
+  filter.setCellSizeX( 2.5 );
+  filter.setCellSizeY( 3.0 );
+  filter.setZFactor( 1.5 );
+  filter.setInputNodataValue( -1.0 );
+  filter.setOutputNodataValue( -9999.0 );
+
+  // three scanlines with padding nodata columns, some nodata cells and some flat areas
+  const int width = 12;
+  std::vector< std::vector< float > > lines( 3, std::vector< float >( width + 2, -1.0f ) );
+  for ( int row = 0; row < 3; ++row )
+  {
+    for ( int i = 1; i <= width; ++i )
+    {
+      lines[row][i] = i < 4 ? 10.0f : static_cast< float >( ( i * 7 + row * 13 ) % 11 ) * 1.7f;
+    }
+  }
+  lines[0][6] = -1.0f;
+  lines[2][9] = -1.0f;
+  lines[1][11] = -1.0f;
+
+  std::vector< float > rowResult( width );
+  filter.processNineCellRow( lines[0].data(), lines[1].data(), lines[2].data(), rowResult.data(), width );
+  for ( int i = 0; i < width; ++i )
+  {
+    const float windowResult = filter.processNineCellWindow( &lines[0][i], &lines[0][i + 1], &lines[0][i + 2],
+                               &lines[1][i], &lines[1][i + 1], &lines[1][i + 2],
+                               &lines[2][i], &lines[2][i + 1], &lines[2][i + 2] );
+    QCOMPARE( rowResult[i], windowResult );
+  }
+}
+
+void TestNineCellFilters::testRowProcessing()
+{
+  // the row based calculation must give identical results to the cell by cell calculation
+  QgsSlopeFilter slope( SRC_FILE, QString(), QStringLiteral( "GTiff" ) );
+  QVERIFY( slope.supportsParallelRows() );
+  _testRow( slope );
+  QgsAspectFilter aspect( SRC_FILE, QString(), QStringLiteral( "GTiff" ) );
+  QVERIFY( aspect.supportsParallelRows() );
+  _testRow( aspect );
+  QgsHillshadeFilter hillshade( SRC_FILE, QString(), QStringLiteral( "GTiff" ) );
+  QVERIFY( hillshade.supportsParallelRows() );
+  _testRow( hillshade );
+  QgsRuggednessFilter ruggedness( SRC_FILE, QString(), QStringLiteral( "GTiff" ) );
+  QVERIFY( ruggedness.supportsParallelRows() );
+  _testRow( ruggedness );
+  QgsTotalCurvatureFilter totalCurvature( SRC_FILE, QString(), QStringLiteral( "GTiff" ) );
+  QVERIFY( totalCurvature.supportsParallelRows() );
+  _testRow( totalCurvature );
+}
+
+void TestNineCellFilters::testSerialProcessing()
+{
+  // filters which do not opt in to parallel rows are only called from the calling thread
+  SerialTestFilter filter( SRC_FILE, tempFile( QStringLiteral( "serial" ) ) );
+  QVERIFY( !filter.supportsParallelRows() );
+  QCOMPARE( filter.processRaster(), 0 );
+
+  QgsAlignRaster::RasterInfo in( SRC_FILE );
+  QCOMPARE( filter.mCalls, in.rasterSize().width() * in.rasterSize().height() );
+  QCOMPARE( filter.mForeignThreadCalls, 0 );
+}
+
+void TestNineCellFilters::testDerivedFilter()
+{
+  // classes derived from the built-in filters are calculated cell by cell with their own window calculation
+  DerivedSlopeFilter filter( SRC_FILE, tempFile( QStringLiteral( "derived" ) ) );
+  QVERIFY( !filter.supportsParallelRows() );
+  QCOMPARE( filter.processRaster(), 0 );
+
+  QgsAlignRaster::RasterInfo in( SRC_FILE );
+  QCOMPARE( filter.mCalls, in.rasterSize().width() * in.rasterSize().height() );
+  QCOMPARE( filter.mForeignThreadCalls, 0 );
+}
 
 QGSTEST_MAIN( TestNineCellFilters )
 
@@ -57,6 +57,7 @@ class TestQgsRasterCalculator : public QObject
 
     void calcWithLayers();
     void calcWithReprojectedLayers();
+    void calcWithMultipleTiles();
 
     void errors();
     void toString();
@@ -544,6 +545,47 @@ void TestQgsRasterCalculator::calcWithReprojectedLayers()
   delete block;
 }
 
+void TestQgsRasterCalculator::calcWithMultipleTiles()
+{
+  QgsRasterCalculatorEntry entry1;
+  entry1.bandNumber = 1;
+  entry1.raster = mpLandsatRasterLayer;
+  entry1.ref = QStringLiteral( "landsat@1" );
+
+  QVector<QgsRasterCalculatorEntry> entries;
+  entries << entry1;
+
+  // output large enough to be split into several tiles, with partial tiles on the right and bottom edges
+  const QgsRectangle extent = mpLandsatRasterLayer->extent();
+  const int columns = 1300;
+  const int rows = 700;
+
+  QTemporaryFile tmpFile;
+  tmpFile.open(); // fileName is not available until open
+  QString tmpName = tmpFile.fileName();
+  tmpFile.close();
+
+  QgsRasterCalculator rc( QStringLiteral( "2 + \"landsat@1\" * 2" ),
+                          tmpName,
+                          QStringLiteral( "GTiff" ),
+                          extent, mpLandsatRasterLayer->crs(), columns, rows, entries,
+                          QgsProject::instance()->transformContext() );
+  QCOMPARE( static_cast< int >( rc.processCalculation() ), 0 );
+
+  std::unique_ptr< QgsRasterLayer > result = qgis::make_unique< QgsRasterLayer >( tmpName, QStringLiteral( "result" ) );
+  QCOMPARE( result->width(), columns );
+  QCOMPARE( result->height(), rows );
+  std::unique_ptr< QgsRasterBlock > resultBlock( result->dataProvider()->block( 1, extent, columns, rows ) );
+  std::unique_ptr< QgsRasterBlock > sourceBlock( mpLandsatRasterLayer->dataProvider()->block( 1, extent, columns, rows ) );
+  for ( int row = 0; row < rows; ++row )
+  {
+    for ( int col = 0; col < columns; ++col )
+    {
+      QCOMPARE( resultBlock->value( row, col ), 2 + sourceBlock->value( row, col ) * 2 );
+    }
+  }
+}
+
 void TestQgsRasterCalculator::findNodes()
 {
 
@@ -18,6 +18,7 @@
 
 #include "qgsapplication.h"
 #include "qgsfeatureiterator.h"
+#include "qgsfeedback.h"
 #include "qgsvectorlayer.h"
 #include "qgsrasterlayer.h"
 #include "qgszonalstatistics.h"
@@ -43,6 +44,7 @@ class TestQgsZonalStatistics : public QObject
     void testNoData();
     void testSmallPolygons();
     void testShortName();
+    void testScanlineRasterization();
 
   private:
     QgsVectorLayer *mVectorLayer = nullptr;
@@ -360,5 +362,63 @@ void TestQgsZonalStatistics::testShortName()
   QCOMPARE( QgsZonalStatistics::shortName( QgsZonalStatistics::Variance ), QStringLiteral( "variance" ) );
 }
 
+void TestQgsZonalStatistics::testScanlineRasterization()
+{
+  QString myDataPath( TEST_DATA_DIR ); //defined in CmakeLists.txt
+  QString myTestDataPath = myDataPath + "/zonalstatistics/";
+
+  // scanline rasterization must give the same results as the cell center test, including for
+  // polygons with edges exactly on cell boundaries, nodata pixels and polygons smaller than a pixel
+  const QList< QPair< QString, QString > > datasets = QList< QPair< QString, QString > >()
+      << qMakePair( QStringLiteral( "polys.shp" ), QStringLiteral( "edge_problem.asc" ) )
+      << qMakePair( QStringLiteral( "polys2.shp" ), QStringLiteral( "raster.tif" ) )
+      << qMakePair( QStringLiteral( "small_polys.shp" ), QStringLiteral( "raster.tif" ) );
+
+  for ( const auto &dataset : datasets )
+  {
+    std::unique_ptr< QgsVectorLayer > sourceLayer = qgis::make_unique< QgsVectorLayer >( myTestDataPath + dataset.first, QStringLiteral( "poly" ), QStringLiteral( "ogr" ) );
+    std::unique_ptr< QgsVectorLayer > vectorLayer( sourceLayer->materialize( QgsFeatureRequest() ) );
+    std::unique_ptr< QgsRasterLayer > rasterLayer = qgis::make_unique< QgsRasterLayer >( myTestDataPath + dataset.second, QStringLiteral( "raster" ), QStringLiteral( "gdal" ) );
+
+    QgsZonalStatistics cellCenter( vectorLayer.get(), rasterLayer.get(), QStringLiteral( "c" ), 1, QgsZonalStatistics::All );
+    QCOMPARE( cellCenter.rasterizationMethod(), QgsZonalStatistics::CellCenterTest );
+    QCOMPARE( cellCenter.calculateStatistics( nullptr ), 0 );
+
+    QgsZonalStatistics scanline( vectorLayer.get(), rasterLayer.get(), QStringLiteral( "s" ), 1, QgsZonalStatistics::All );
+    scanline.setRasterizationMethod( QgsZonalStatistics::ScanlineRasterization );
+    QCOMPARE( scanline.rasterizationMethod(), QgsZonalStatistics::ScanlineRasterization );
+    QCOMPARE( scanline.calculateStatistics( nullptr ), 0 );
+
+    QgsFeature f;
+    QgsFeatureIterator it = vectorLayer->getFeatures();
+    while ( it.nextFeature( f ) )
+    {
+      for ( int stat = QgsZonalStatistics::Count; stat <= QgsZonalStatistics::Variance; stat <<= 1 )
+      {
+        const QString name = QgsZonalStatistics::shortName( static_cast< QgsZonalStatistics::Statistic >( stat ) );
+        QCOMPARE( f.attribute( QStringLiteral( "s" ) + name ).isNull(), f.attribute( QStringLiteral( "c" ) + name ).isNull() );
+        QGSCOMPARENEAR( f.attribute( QStringLiteral( "s" ) + name ).toDouble(), f.attribute( QStringLiteral( "c" ) + name ).toDouble(), 0.0000001 );
+      }
+    }
+  }
+
+  // a canceled calculation must not write partial statistics
+  std::unique_ptr< QgsVectorLayer > sourceLayer = qgis::make_unique< QgsVectorLayer >( myTestDataPath + QStringLiteral( "polys2.shp" ), QStringLiteral( "poly" ), QStringLiteral( "ogr" ) );
+  std::unique_ptr< QgsVectorLayer > vectorLayer( sourceLayer->materialize( QgsFeatureRequest() ) );
+  std::unique_ptr< QgsRasterLayer > rasterLayer = qgis::make_unique< QgsRasterLayer >( myTestDataPath + QStringLiteral( "raster.tif" ), QStringLiteral( "raster" ), QStringLiteral( "gdal" ) );
+  QgsZonalStatistics canceled( vectorLayer.get(), rasterLayer.get(), QStringLiteral( "x" ), 1, QgsZonalStatistics::Count | QgsZonalStatistics::Sum );
+  canceled.setRasterizationMethod( QgsZonalStatistics::ScanlineRasterization );
+  QgsFeedback feedback;
+  feedback.cancel();
+  QCOMPARE( canceled.calculateStatistics( &feedback ), 9 );
+  QgsFeature f;
+  QgsFeatureIterator it = vectorLayer->getFeatures();
+  while ( it.nextFeature( f ) )
+  {
+    QVERIFY( f.attribute( QStringLiteral( "xcount" ) ).isNull() );
+    QVERIFY( f.attribute( QStringLiteral( "xsum" ) ).isNull() );
+  }
+}
+
 QGSTEST_MAIN( TestQgsZonalStatistics )
 #include "testqgszonalstatistics.moc"
@@ -0,0 +1,176 @@
+/***************************************************************************
+     testqgsfeatureidranges.cpp
+     --------------------------
+    Date                 : July 2020
+    Copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "qgstest.h"
+#include <QObject>
+
+#include "qgsfeatureidranges.h"
+
+#include <limits>
+
+class TestQgsFeatureIdRanges: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void construct();
+    void containsAndCount();
+    void insertAndRemove();
+    void setOperations();
+    void sqlWhereClause();
+
+  private:
+    static QVector< QgsFeatureIdRanges::Range > ranges( const QgsFeatureIdRanges &ids )
+    {
+      return ids.ranges();
+    }
+};
+
+void TestQgsFeatureIdRanges::construct()
+{
+  QgsFeatureIdRanges empty;
+  QVERIFY( empty.isEmpty() );
+  QVERIFY( empty.ranges().isEmpty() );
+
+  const QgsFeatureIds ids = QgsFeatureIds() << 5 << 1 << 2 << 3 << 7 << 8 << -4;
+  QgsFeatureIdRanges fromSet( ids );
+  QCOMPARE( ranges( fromSet ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ -4, -4 } << QgsFeatureIdRanges::Range{ 1, 3 } << QgsFeatureIdRanges::Range{ 5, 5 } << QgsFeatureIdRanges::Range{ 7, 8 } );
+
+  // unsorted ids with duplicates
+  QgsFeatureIdRanges fromVector( QVector< QgsFeatureId >() << 8 << 7 << 5 << 3 << 2 << 1 << 2 << 3 << -4 );
+  QCOMPARE( fromVector, fromSet );
+
+  // ranges at the limits of the id type do not overflow
+  const QgsFeatureId max = std::numeric_limits< QgsFeatureId >::max();
+  QgsFeatureIdRanges limits( QVector< QgsFeatureId >() << max << max - 1 << max );
+  QCOMPARE( ranges( limits ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ max - 1, max } );
+
+  const QgsFeatureId min = std::numeric_limits< QgsFeatureId >::min();
+  QgsFeatureIdRanges lowest( QVector< QgsFeatureId >() << min + 1 << min );
+  QCOMPARE( ranges( lowest ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ min, min + 1 } );
+}
+
+void TestQgsFeatureIdRanges::containsAndCount()
+{
+  QgsFeatureIdRanges empty;
+  QCOMPARE( empty.count(), 0LL );
+  QVERIFY( !empty.contains( 1 ) );
+  QVERIFY( empty.toFeatureIds().isEmpty() );
+
+  const QgsFeatureIds ids = QgsFeatureIds() << -4 << 1 << 2 << 3 << 5 << 7 << 8;
+  QgsFeatureIdRanges set( ids );
+  QCOMPARE( set.count(), 7LL );
+  for ( QgsFeatureId id = -6; id < 11; ++id )
+    QCOMPARE( set.contains( id ), ids.contains( id ) );
+  QCOMPARE( set.toFeatureIds(), ids );
+
+  // a large set of consecutive ids is stored as a single range
+  QVector< QgsFeatureId > consecutive;
+  for ( QgsFeatureId id = 0; id < 100000; ++id )
+    consecutive << id;
+  QgsFeatureIdRanges large( consecutive );
+  QCOMPARE( large.ranges().size(), 1 );
+  QCOMPARE( large.count(), 100000LL );
+  QVERIFY( large.contains( 99999 ) );
+  QVERIFY( !large.contains( 100000 ) );
+}
+
+void TestQgsFeatureIdRanges::insertAndRemove()
+{
+  QgsFeatureIdRanges set;
+  set.insert( 5 );
+  set.insert( 3 );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ 3, 3 } << QgsFeatureIdRanges::Range{ 5, 5 } );
+  // joins both neighbors
+  set.insert( 4 );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ 3, 5 } );
+  set.insert( 4 );
+  set.insert( 6 );
+  set.insert( 2 );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ 2, 6 } );
+
+  // splits the range
+  set.remove( 4 );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ 2, 3 } << QgsFeatureIdRanges::Range{ 5, 6 } );
+  set.remove( 2 );
+  set.remove( 6 );
+  set.remove( 10 );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ 3, 3 } << QgsFeatureIdRanges::Range{ 5, 5 } );
+  set.remove( 3 );
+  set.remove( 5 );
+  QVERIFY( set.isEmpty() );
+
+  // no overflow at the limits of the id type
+  const QgsFeatureId max = std::numeric_limits< QgsFeatureId >::max();
+  const QgsFeatureId min = std::numeric_limits< QgsFeatureId >::min();
+  set.insert( max );
+  set.insert( max - 1 );
+  set.insert( min );
+  set.insert( min + 1 );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ min, min + 1 } << QgsFeatureIdRanges::Range{ max - 1, max } );
+  set.remove( max );
+  set.remove( min );
+  QCOMPARE( ranges( set ), QVector< QgsFeatureIdRanges::Range >() << QgsFeatureIdRanges::Range{ min + 1, min + 1 } << QgsFeatureIdRanges::Range{ max - 1, max - 1 } );
+}
+
+void TestQgsFeatureIdRanges::setOperations()
+{
+  // compare with the results of QSet on sets with overlapping, adjacent and disjoint ranges
+  const QList< QgsFeatureIds > sets
+  {
+    QgsFeatureIds(),
+    QgsFeatureIds() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10,
+    QgsFeatureIds() << 2 << 3 << 6 << 7 << 8 << 12,
+    QgsFeatureIds() << 0 << 1 << 4 << 5 << 9 << 10 << 11,
+    QgsFeatureIds() << -3 << 3 << 11 << 12 << 13,
+  };
+
+  for ( const QgsFeatureIds &a : sets )
+  {
+    for ( const QgsFeatureIds &b : sets )
+    {
+      QgsFeatureIdRanges result( a );
+      result.unite( QgsFeatureIdRanges( b ) );
+      QCOMPARE( result.toFeatureIds(), a + b );
+      QCOMPARE( result, QgsFeatureIdRanges( a + b ) );
+
+      result = QgsFeatureIdRanges( a );
+      result.intersect( QgsFeatureIdRanges( b ) );
+      QCOMPARE( result.toFeatureIds(), QgsFeatureIds( a ).intersect( b ) );
+      QCOMPARE( result, QgsFeatureIdRanges( QgsFeatureIds( a ).intersect( b ) ) );
+
+      result = QgsFeatureIdRanges( a );
+      result.subtract( QgsFeatureIdRanges( b ) );
+      QCOMPARE( result.toFeatureIds(), a - b );
+      QCOMPARE( result, QgsFeatureIdRanges( a - b ) );
+    }
+  }
+
+  QgsFeatureIdRanges cleared( sets.at( 1 ) );
+  cleared.clear();
+  QVERIFY( cleared.isEmpty() );
+}
+
+void TestQgsFeatureIdRanges::sqlWhereClause()
+{
+  QCOMPARE( QgsFeatureIdRanges().sqlWhereClause( QStringLiteral( "fid" ) ), QString() );
+  QCOMPARE( QgsFeatureIdRanges( QgsFeatureIds() << 3 << 1 ).sqlWhereClause( QStringLiteral( "fid" ) ), QStringLiteral( "fid IN (1,3)" ) );
+  QCOMPARE( QgsFeatureIdRanges( QgsFeatureIds() << 1 << 2 << 3 ).sqlWhereClause( QStringLiteral( "fid" ) ), QStringLiteral( "fid BETWEEN 1 AND 3" ) );
+  QCOMPARE( QgsFeatureIdRanges( QgsFeatureIds() << 1 << 2 << 3 << 5 << 6 << 10 << 11 << 12 << 13 ).sqlWhereClause( QStringLiteral( "fid" ) ),
+            QStringLiteral( "(fid IN (5,6) OR fid BETWEEN 1 AND 3 OR fid BETWEEN 10 AND 13)" ) );
+  QCOMPARE( QgsFeatureIdRanges( QgsFeatureIds() << 1 << 2 << 3 << 5 << 6 ).sqlWhereClause( QStringLiteral( "fid" ), 2 ),
+            QStringLiteral( "(fid BETWEEN 1 AND 3 OR fid BETWEEN 5 AND 6)" ) );
+}
+
+QGSTEST_MAIN( TestQgsFeatureIdRanges )
+#include "testqgsfeatureidranges.moc"
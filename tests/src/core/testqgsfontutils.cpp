@@ -20,6 +20,9 @@
 
 #include "qgsapplication.h"
 #include "qgsfontutils.h"
+#include "qgstextmetricscache_p.h"
+
+#include <QFontMetricsF>
 
 class TestQgsFontUtils: public QObject
 {
@@ -33,6 +36,7 @@ class TestQgsFontUtils: public QObject
     void xmlMethods(); //test saving and reading from xml
     void fromChildNode(); //test reading from child node
     void toCss(); //test converting font to CSS
+    void textMetricsCache();
 
   private:
 
@@ -163,5 +167,46 @@ void TestQgsFontUtils::toCss()
   QCOMPARE( QgsFontUtils::asCSS( f1, 10 ), QString( "font-family: QGIS Vera Sans;font-style: oblique;font-weight: 700;font-size: 125px;" ) );
 }
 
+void TestQgsFontUtils::textMetricsCache()
+{
+  QgsTextMetricsCache cache;
+
+  QFont f1 = QgsFontUtils::getStandardTestFont();
+  f1.setPixelSize( 20 );
+  const QFontMetricsF fm( f1 );
+  const QString key = QgsTextMetricsCache::fontKey( f1 );
+
+  // measurements must match the font metrics, whether they are cached or not
+  QCOMPARE( cache.horizontalAdvance( key, fm, QStringLiteral( "test string" ) ), fm.width( QStringLiteral( "test string" ) ) );
+  QCOMPARE( cache.horizontalAdvance( key, fm, QStringLiteral( "test string" ) ), fm.width( QStringLiteral( "test string" ) ) );
+  QCOMPARE( cache.horizontalAdvance( f1, QStringLiteral( "test string" ) ), fm.width( QStringLiteral( "test string" ) ) );
+
+  // spacing changes the key and the result
+  QFont f2 = f1;
+  f2.setLetterSpacing( QFont::AbsoluteSpacing, 5 );
+  QVERIFY( QgsTextMetricsCache::fontKey( f2 ) != key );
+  QCOMPARE( cache.horizontalAdvance( f2, QStringLiteral( "test string" ) ), QFontMetricsF( f2 ).width( QStringLiteral( "test string" ) ) );
+  QVERIFY( cache.horizontalAdvance( f2, QStringLiteral( "test string" ) ) > cache.horizontalAdvance( f1, QStringLiteral( "test string" ) ) );
+
+  QgsTextMetricsCache::CharacterWidths widths;
+  QVERIFY( !cache.characterWidths( key, true, QStringLiteral( "ab" ), widths ) );
+  widths.graphemes = QStringList() << QStringLiteral( "a" ) << QStringLiteral( "b" );
+  widths.widths = QVector< double >() << 1.5 << 2.5;
+  cache.insertCharacterWidths( key, true, QStringLiteral( "ab" ), widths, cache.generation() );
+
+  QgsTextMetricsCache::CharacterWidths cached;
+  QVERIFY( !cache.characterWidths( key, false, QStringLiteral( "ab" ), cached ) );
+  QVERIFY( cache.characterWidths( key, true, QStringLiteral( "ab" ), cached ) );
+  QCOMPARE( cached.graphemes, widths.graphemes );
+  QCOMPARE( cached.widths, widths.widths );
+
+  // widths measured before a clear are not inserted
+  const int generation = cache.generation();
+  cache.clear();
+  QVERIFY( !cache.characterWidths( key, true, QStringLiteral( "ab" ), cached ) );
+  cache.insertCharacterWidths( key, true, QStringLiteral( "ab" ), widths, generation );
+  QVERIFY( !cache.characterWidths( key, true, QStringLiteral( "ab" ), cached ) );
+}
+
 QGSTEST_MAIN( TestQgsFontUtils )
 #include "testqgsfontutils.moc"
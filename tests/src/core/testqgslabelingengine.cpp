@@ -90,6 +90,7 @@ class TestQgsLabelingEngine : public QObject
     void testLineAnchorHorizontal();
     void testLineAnchorHorizontalConstraints();
     void testShowAllLabelsWhenALabelHasNoCandidates();
+    void testSolveInParts();
 
   private:
     QgsVectorLayer *vl = nullptr;
@@ -3275,5 +3276,74 @@ void TestQgsLabelingEngine::testShowAllLabelsWhenALabelHasNoCandidates()
   QVERIFY( imageCheck( QStringLiteral( "show_all_labels_when_no_candidates" ), img, 20 ) );
 }
 
+void TestQgsLabelingEngine::testSolveInParts()
+{
+  // test a problem large enough to be split into parts which are solved concurrently
+  QgsPalLayerSettings settings;
+  setDefaultLabelParams( settings );
+
+  QgsTextFormat format = settings.format();
+  format.setSize( 8 );
+  format.setColor( QColor( 0, 0, 0 ) );
+  settings.setFormat( format );
+
+  settings.fieldName = QStringLiteral( "'x'" );
+  settings.isExpression = true;
+  settings.placement = QgsPalLayerSettings::AroundPoint;
+
+  std::unique_ptr< QgsVectorLayer> vl2( new QgsVectorLayer( QStringLiteral( "Point?crs=epsg:3857&field=id:integer" ), QStringLiteral( "vl" ), QStringLiteral( "memory" ) ) );
+  vl2->setRenderer( new QgsNullSymbolRenderer() );
+
+  // a grid of points far enough apart for their labels never to conflict, each with a second point
+  // at the same location whose label must be dropped
+  QgsFeatureList features;
+  for ( int row = 0; row < 40; ++row )
+  {
+    for ( int column = 0; column < 40; ++column )
+    {
+      for ( int copy = 0; copy < 2; ++copy )
+      {
+        QgsFeature f;
+        f.setAttributes( QgsAttributes() << row * 40 + column );
+        f.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( column * 1000 + 500, row * 1000 + 500 ) ) );
+        features << f;
+      }
+    }
+  }
+  QVERIFY( vl2->dataProvider()->addFeatures( features ) );
+  vl2->updateExtents();
+
+  vl2->setLabeling( new QgsVectorLayerSimpleLabeling( settings ) );  // TODO: this should not be necessary!
+  vl2->setLabelsEnabled( true );
+
+  QgsMapSettings mapSettings;
+  mapSettings.setLabelingEngineSettings( createLabelEngineSettings() );
+  mapSettings.setDestinationCrs( vl2->crs() );
+  mapSettings.setOutputSize( QSize( 1600, 1600 ) );
+  mapSettings.setExtent( QgsRectangle( 0, 0, 40000, 40000 ) );
+  mapSettings.setLayers( QList<QgsMapLayer *>() << vl2.get() );
+  mapSettings.setOutputDpi( 96 );
+
+  QgsLabelingEngineSettings engineSettings = mapSettings.labelingEngineSettings();
+  engineSettings.setFlag( QgsLabelingEngineSettings::DrawLabelRectOnly, true );
+  mapSettings.setLabelingEngineSettings( engineSettings );
+
+  QgsMapRendererSequentialJob job( mapSettings );
+  job.start();
+  job.waitForFinished();
+
+  std::unique_ptr< QgsLabelingResults > results( job.takeLabelingResults() );
+  QVERIFY( results );
+
+  const QList<QgsLabelPosition> labels = results->labelsWithinRect( mapSettings.extent() );
+  QCOMPARE( labels.count(), 1600 );
+
+  // exactly one label for each grid location
+  QSet< QPair< int, int > > labeledCells;
+  for ( const QgsLabelPosition &label : labels )
+    labeledCells.insert( qMakePair( static_cast< int >( label.labelRect.center().x() / 1000 ), static_cast< int >( label.labelRect.center().y() / 1000 ) ) );
+  QCOMPARE( labeledCells.count(), 1600 );
+}
+
 QGSTEST_MAIN( TestQgsLabelingEngine )
 #include "testqgslabelingengine.moc"
@@ -21,6 +21,8 @@
 #include <qgspoint.h>
 #include "qgslogger.h"
 
+#include <limits>
+
 class TestQgsMapToPixel: public QObject
 {
     Q_OBJECT
@@ -29,6 +31,7 @@ class TestQgsMapToPixel: public QObject
     void getters();
     void fromScale();
     void toMapCoordinates();
+    void transformPoints();
 };
 
 void TestQgsMapToPixel::rotation()
@@ -119,6 +122,39 @@ void TestQgsMapToPixel::toMapCoordinates()
   QCOMPARE( p, QgsPointXY( 20, 20 ) );
 }
 
+void TestQgsMapToPixel::transformPoints()
+{
+  QgsMapToPixel m2p( 0.5, 5, 5, 10, 10, 30 );
+  const QVector< double > x { 1, 5.5, -3, 7.25, 100, 0 };
+  const QVector< double > y { 2, -4, 8.5, 3, -50, 0 };
+
+  // batch transforms match transforming points one by one
+  QVector< QPointF > points( x.size() );
+  QVERIFY( m2p.transformToPoints( x.constData(), y.constData(), x.size(), points.data() ) );
+  QVector< QPointF > inPlace( x.size() );
+  for ( int i = 0; i < x.size(); ++i )
+    inPlace[i] = QPointF( x.at( i ), y.at( i ) );
+  QVERIFY( m2p.transformInPlace( inPlace.data(), inPlace.size() ) );
+  for ( int i = 0; i < x.size(); ++i )
+  {
+    const QgsPointXY expected = m2p.transform( x.at( i ), y.at( i ) );
+    QGSCOMPARENEAR( points.at( i ).x(), expected.x(), 1e-9 );
+    QGSCOMPARENEAR( points.at( i ).y(), expected.y(), 1e-9 );
+    QGSCOMPARENEAR( inPlace.at( i ).x(), expected.x(), 1e-9 );
+    QGSCOMPARENEAR( inPlace.at( i ).y(), expected.y(), 1e-9 );
+  }
+
+  // non finite points are reported
+  const QVector< double > badX { 1, std::numeric_limits< double >::quiet_NaN(), 3 };
+  const QVector< double > badY { 2, 4, std::numeric_limits< double >::infinity() };
+  points.resize( badX.size() );
+  QVERIFY( !m2p.transformToPoints( badX.constData(), badY.constData(), badX.size(), points.data() ) );
+  QVERIFY( !m2p.transformToPoints( badX.constData() + 1, badY.constData() + 1, 1, points.data() ) );
+  QVERIFY( m2p.transformToPoints( badX.constData(), badY.constData(), 1, points.data() ) );
+  inPlace = QVector< QPointF >() << QPointF( 1, 2 ) << QPointF( 3, std::numeric_limits< double >::infinity() );
+  QVERIFY( !m2p.transformInPlace( inPlace.data(), inPlace.size() ) );
+}
+
 QGSTEST_MAIN( TestQgsMapToPixel )
 #include "testqgsmaptopixel.moc"
 
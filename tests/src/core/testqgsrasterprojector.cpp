@@ -0,0 +1,168 @@
+/***************************************************************************
+     testqgsrasterprojector.cpp
+     --------------------------------------
+    Date                 : July 2020
+    Copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "qgstest.h"
+
+#include "qgsapplication.h"
+#include "qgscoordinatetransform.h"
+#include "qgsproject.h"
+#include "qgsrasterdataprovider.h"
+#include "qgsrasterlayer.h"
+#include "qgsrasterprojector.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * \ingroup UnitTests
+ * This is a unit test for the control point grid cache of the raster projector.
+ */
+class TestQgsRasterProjector : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void cachedControlGrid_data();
+    void cachedControlGrid();
+    void controlGridKey();
+
+  private:
+    //! Compares the source rows and columns of all destination pixels of \a projector with \a expected
+    static void compareSrcRowCols( ProjectorData &projector, ProjectorData &expected, int rows, int cols );
+
+    std::unique_ptr< QgsRasterLayer > mLayer;
+    QgsRectangle mDestExtent;
+    QgsCoordinateTransform mInverseCt;
+};
+
+void TestQgsRasterProjector::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+
+  const QString path = QStringLiteral( TEST_DATA_DIR ) + QStringLiteral( "/raster/band1_float32_noct_epsg4326.tif" );
+  mLayer = qgis::make_unique< QgsRasterLayer >( path, QStringLiteral( "raster" ), QStringLiteral( "gdal" ) );
+  QVERIFY( mLayer->isValid() );
+
+  const QgsCoordinateReferenceSystem mercator( QStringLiteral( "EPSG:3857" ) );
+  const QgsCoordinateTransform ct( mLayer->crs(), mercator, QgsProject::instance() );
+  mDestExtent = ct.transformBoundingBox( mLayer->extent() );
+  mInverseCt = QgsCoordinateTransform( mercator, mLayer->crs(), QgsProject::instance() );
+}
+
+void TestQgsRasterProjector::cleanupTestCase()
+{
+  mLayer.reset();
+  QgsApplication::exitQgis();
+}
+
+void TestQgsRasterProjector::init()
+{
+  ProjectorData::clearControlGridCache();
+}
+
+void TestQgsRasterProjector::compareSrcRowCols( ProjectorData &projector, ProjectorData &expected, int rows, int cols )
+{
+  std::vector< int > srcRows( static_cast< std::size_t >( cols ) );
+  std::vector< int > srcCols( static_cast< std::size_t >( cols ) );
+  std::vector< int > expectedSrcRows( static_cast< std::size_t >( cols ) );
+  std::vector< int > expectedSrcCols( static_cast< std::size_t >( cols ) );
+  int insideCount = 0;
+  for ( int row = 0; row < rows; ++row )
+  {
+    projector.srcRowCols( row, srcRows.data(), srcCols.data() );
+    expected.srcRowCols( row, expectedSrcRows.data(), expectedSrcCols.data() );
+    for ( int col = 0; col < cols; ++col )
+    {
+      if ( srcRows[col] != expectedSrcRows[col] || srcCols[col] != expectedSrcCols[col] )
+        QFAIL( QStringLiteral( "Pixel %1, %2 differs: %3, %4 instead of %5, %6" ).arg( col ).arg( row )
+               .arg( srcCols[col] ).arg( srcRows[col] ).arg( expectedSrcCols[col] ).arg( expectedSrcRows[col] ).toUtf8().constData() );
+      if ( srcRows[col] >= 0 )
+        ++insideCount;
+    }
+  }
+  QVERIFY( insideCount > 0 );
+}
+
+void TestQgsRasterProjector::cachedControlGrid_data()
+{
+  QTest::addColumn< int >( "precision" );
+
+  QTest::newRow( "approximate" ) << static_cast< int >( QgsRasterProjector::Approximate );
+  QTest::newRow( "exact" ) << static_cast< int >( QgsRasterProjector::Exact );
+}
+
+void TestQgsRasterProjector::cachedControlGrid()
+{
+  QFETCH( int, precision );
+  const QgsRasterProjector::Precision gridPrecision = static_cast< QgsRasterProjector::Precision >( precision );
+  const int rows = 100;
+  const int cols = 150;
+
+  ProjectorData uncached( mDestExtent, cols, rows, mLayer->dataProvider(), mInverseCt, gridPrecision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 1 );
+
+  // a grid read from the cache is not cached again
+  ProjectorData cached( mDestExtent, cols, rows, mLayer->dataProvider(), mInverseCt, gridPrecision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 1 );
+
+  QCOMPARE( cached.srcExtent(), uncached.srcExtent() );
+  QCOMPARE( cached.srcRows(), uncached.srcRows() );
+  QCOMPARE( cached.srcCols(), uncached.srcCols() );
+  compareSrcRowCols( cached, uncached, rows, cols );
+}
+
+void TestQgsRasterProjector::controlGridKey()
+{
+  const int rows = 100;
+  const int cols = 150;
+  const QgsRasterProjector::Precision precision = QgsRasterProjector::Approximate;
+
+  ProjectorData base( mDestExtent, cols, rows, mLayer->dataProvider(), mInverseCt, precision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 1 );
+
+  // other destination CRS, with the same numeric extent
+  const QgsCoordinateTransform worldMercatorCt( QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:3395" ) ), mLayer->crs(), QgsProject::instance() );
+  ProjectorData otherCrs( mDestExtent, cols, rows, mLayer->dataProvider(), worldMercatorCt, precision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 2 );
+
+  // extent shifted by a fraction of a pixel
+  QgsRectangle shiftedExtent = mDestExtent;
+  shiftedExtent.setXMinimum( mDestExtent.xMinimum() + mDestExtent.width() / cols / 10 );
+  ProjectorData otherExtent( shiftedExtent, cols, rows, mLayer->dataProvider(), mInverseCt, precision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 3 );
+
+  ProjectorData otherWidth( mDestExtent, cols + 1, rows, mLayer->dataProvider(), mInverseCt, precision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 4 );
+
+  ProjectorData otherHeight( mDestExtent, cols, rows + 1, mLayer->dataProvider(), mInverseCt, precision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 5 );
+
+  ProjectorData otherPrecision( mDestExtent, cols, rows, mLayer->dataProvider(), mInverseCt, QgsRasterProjector::Exact );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 6 );
+
+  // the original request still finds its own grid, and projects like a grid calculated from scratch
+  ProjectorData cached( mDestExtent, cols, rows, mLayer->dataProvider(), mInverseCt, precision );
+  QCOMPARE( ProjectorData::controlGridCacheSize(), 6 );
+  ProjectorData::clearControlGridCache();
+  ProjectorData uncached( mDestExtent, cols, rows, mLayer->dataProvider(), mInverseCt, precision );
+  QCOMPARE( cached.srcExtent(), uncached.srcExtent() );
+  compareSrcRowCols( cached, uncached, rows, cols );
+}
+
+QGSTEST_MAIN( TestQgsRasterProjector )
+#include "testqgsrasterprojector.moc"
@@ -0,0 +1,204 @@
+/***************************************************************************
+     testqgsrasterresamplingkernel.cpp
+     --------------------------------------
+    Date                 : July 2020
+    Copyright            : (C) 2020 by the QGIS project
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "qgstest.h"
+
+#include "qgsapplication.h"
+#include "qgsbilinearrasterresampler.h"
+#include "qgscubicrasterresampler.h"
+#include "qgsgdalutils.h"
+#include "qgsrasterresamplingkernel_p.h"
+
+#include <QImage>
+
+#include <cmath>
+
+/**
+ * \ingroup UnitTests
+ * This is a unit test for the separable resampling kernel used by the bilinear and cubic resamplers.
+ */
+class TestQgsRasterResamplingKernel : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void bilinear_data();
+    void bilinear();
+    void cubic_data();
+    void cubic();
+    void uniformImage();
+    void premultipliedColors();
+
+  private:
+    //! Returns an opaque test image with smoothly varying colors
+    static QImage sourceImage();
+
+    //! Returns the largest difference of a color channel between \a image and \a expected
+    static int maximumDifference( const QImage &image, const QImage &expected );
+
+    static void addSizes();
+};
+
+void TestQgsRasterResamplingKernel::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+}
+
+void TestQgsRasterResamplingKernel::cleanupTestCase()
+{
+  QgsApplication::exitQgis();
+}
+
+QImage TestQgsRasterResamplingKernel::sourceImage()
+{
+  QImage image( 37, 23, QImage::Format_ARGB32_Premultiplied );
+  for ( int y = 0; y < image.height(); ++y )
+  {
+    for ( int x = 0; x < image.width(); ++x )
+    {
+      const int red = static_cast< int >( 128 + 100 * std::sin( x / 5.0 ) * std::cos( y / 7.0 ) );
+      const int green = 4 * x + 3 * y;
+      const int blue = static_cast< int >( 128 + 90 * std::cos( ( x + y ) / 6.0 ) );
+      image.setPixel( x, y, qRgba( red, green, blue, 255 ) );
+    }
+  }
+  return image;
+}
+
+int TestQgsRasterResamplingKernel::maximumDifference( const QImage &image, const QImage &expected )
+{
+  int result = 0;
+  for ( int y = 0; y < image.height(); ++y )
+  {
+    for ( int x = 0; x < image.width(); ++x )
+    {
+      const QRgb pixel = image.pixel( x, y );
+      const QRgb expectedPixel = expected.pixel( x, y );
+      result = std::max( result, std::abs( qRed( pixel ) - qRed( expectedPixel ) ) );
+      result = std::max( result, std::abs( qGreen( pixel ) - qGreen( expectedPixel ) ) );
+      result = std::max( result, std::abs( qBlue( pixel ) - qBlue( expectedPixel ) ) );
+      result = std::max( result, std::abs( qAlpha( pixel ) - qAlpha( expectedPixel ) ) );
+    }
+  }
+  return result;
+}
+
+void TestQgsRasterResamplingKernel::addSizes()
+{
+  QTest::addColumn< QSize >( "size" );
+  QTest::addColumn< int >( "tolerance" );
+
+  // results are rounded to bytes after each pass, so upsampled values may differ by one level
+  QTest::newRow( "same size" ) << QSize( 37, 23 ) << 0;
+  QTest::newRow( "upsampled" ) << QSize( 100, 61 ) << 1;
+  QTest::newRow( "upsampled twice" ) << QSize( 74, 46 ) << 1;
+  QTest::newRow( "downsampled" ) << QSize( 15, 9 ) << 2;
+  QTest::newRow( "mixed" ) << QSize( 90, 10 ) << 2;
+}
+
+void TestQgsRasterResamplingKernel::bilinear_data()
+{
+  addSizes();
+}
+
+void TestQgsRasterResamplingKernel::bilinear()
+{
+  QFETCH( QSize, size );
+  QFETCH( int, tolerance );
+
+  // compare with the previous scalar implementation, i.e. GDAL bilinear resampling
+  const QImage source = sourceImage();
+  QgsBilinearRasterResampler resampler;
+  const QImage result = resampler.resampleV2( source, size );
+  QCOMPARE( result.size(), size );
+  QCOMPARE( result.format(), QImage::Format_ARGB32_Premultiplied );
+
+  const QImage expected = QgsGdalUtils::resampleImage( source, size, GRIORA_Bilinear );
+  QVERIFY( maximumDifference( result, expected ) <= tolerance );
+}
+
+void TestQgsRasterResamplingKernel::cubic_data()
+{
+  addSizes();
+}
+
+void TestQgsRasterResamplingKernel::cubic()
+{
+  QFETCH( QSize, size );
+  QFETCH( int, tolerance );
+
+  // compare with the previous scalar implementation, i.e. GDAL cubic resampling
+  const QImage source = sourceImage();
+  QgsCubicRasterResampler resampler;
+  const QImage result = resampler.resampleV2( source, size );
+  QCOMPARE( result.size(), size );
+  QCOMPARE( result.format(), QImage::Format_ARGB32_Premultiplied );
+
+  const QImage expected = QgsGdalUtils::resampleImage( source, size, GRIORA_Cubic );
+  QVERIFY( maximumDifference( result, expected ) <= tolerance );
+}
+
+void TestQgsRasterResamplingKernel::uniformImage()
+{
+  QImage source( 13, 7, QImage::Format_ARGB32_Premultiplied );
+  source.fill( qRgba( 40, 60, 80, 128 ) );
+  for ( QgsRasterResamplingKernel::Filter filter : { QgsRasterResamplingKernel::Box, QgsRasterResamplingKernel::Bilinear,
+        QgsRasterResamplingKernel::Cubic, QgsRasterResamplingKernel::Lanczos3
+                                                   } )
+  {
+    for ( const QSize &size : { QSize( 5, 3 ), QSize( 13, 7 ), QSize( 40, 25 ) } )
+    {
+      const QImage result = QgsRasterResamplingKernel::resample( source, size, filter );
+      QCOMPARE( result.size(), size );
+      for ( int y = 0; y < size.height(); ++y )
+      {
+        for ( int x = 0; x < size.width(); ++x )
+          QCOMPARE( result.pixel( x, y ), source.pixel( 0, 0 ) );
+      }
+    }
+  }
+}
+
+void TestQgsRasterResamplingKernel::premultipliedColors()
+{
+  // a sharp edge between an opaque and a transparent area makes the cubic and lanczos filters overshoot
+  QImage source( 8, 8, QImage::Format_ARGB32_Premultiplied );
+  source.fill( Qt::transparent );
+  for ( int y = 0; y < 8; ++y )
+  {
+    for ( int x = 0; x < 4; ++x )
+      source.setPixel( x, y, qRgba( 255, 255, 255, 255 ) );
+  }
+
+  for ( QgsRasterResamplingKernel::Filter filter : { QgsRasterResamplingKernel::Cubic, QgsRasterResamplingKernel::Lanczos3 } )
+  {
+    const QImage result = QgsRasterResamplingKernel::resample( source, QSize( 29, 29 ), filter );
+    for ( int y = 0; y < result.height(); ++y )
+    {
+      for ( int x = 0; x < result.width(); ++x )
+      {
+        const QRgb pixel = reinterpret_cast< const QRgb * >( result.constScanLine( y ) )[x];
+        QVERIFY( qRed( pixel ) <= qAlpha( pixel ) );
+        QVERIFY( qGreen( pixel ) <= qAlpha( pixel ) );
+        QVERIFY( qBlue( pixel ) <= qAlpha( pixel ) );
+      }
+    }
+  }
+}
+
+QGSTEST_MAIN( TestQgsRasterResamplingKernel )
+#include "testqgsrasterresamplingkernel.moc"
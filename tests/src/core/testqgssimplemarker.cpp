@@ -31,6 +31,7 @@
 #include <qgssinglesymbolrenderer.h>
 #include "qgsmarkersymbollayer.h"
 #include "qgsproperty.h"
+#include "qgsmarkerstamper_p.h"
 
 //qgis test includes
 #include "qgsrenderchecker.h"
@@ -81,6 +82,7 @@ class TestQgsSimpleMarkerSymbol : public QObject
     void boundsWithRotation();
     void boundsWithRotationAndOffset();
     void colors();
+    void stamper();
 
   private:
     bool mTestHasError =  false ;
@@ -333,6 +335,81 @@ void TestQgsSimpleMarkerSymbol::colors()
   QCOMPARE( marker.strokeColor(), QColor( 250, 250, 250 ) );
 }
 
+void TestQgsSimpleMarkerSymbol::stamper()
+{
+  // stamped markers must be identical to markers drawn with QPainter
+  QImage marker( 7, 5, QImage::Format_ARGB32_Premultiplied );
+  for ( int y = 0; y < marker.height(); ++y )
+  {
+    for ( int x = 0; x < marker.width(); ++x )
+    {
+      const int alpha = ( x * 40 + y * 11 ) % 256;
+      marker.setPixel( x, y, qRgba( alpha * x / 7, alpha * y / 5, alpha / 2, alpha ) );
+    }
+  }
+
+  QImage background( 20, 16, QImage::Format_ARGB32_Premultiplied );
+  background.fill( QColor( 30, 120, 200, 180 ) );
+
+  const QList< QPointF > positions { QPointF( 3, 4 ), QPointF( 3.5, 4.5 ), QPointF( 3.49, 4.51 ), QPointF( -3.7, -1.2 ), QPointF( 17.6, 13.4 ), QPointF( 40, 40 ) };
+  for ( const QPointF &position : positions )
+  {
+    QImage expected = background.copy();
+    QPainter expectedPainter( &expected );
+    expectedPainter.translate( 0.25, -0.5 );
+    expectedPainter.drawImage( position, marker );
+    expectedPainter.end();
+
+    QImage stamped = background.copy();
+    QPainter stampedPainter( &stamped );
+    stampedPainter.translate( 0.25, -0.5 );
+    QgsMarkerStamper stamper( &stampedPainter, marker );
+    QVERIFY( stamper.isValid() );
+    stamper.stamp( position );
+    stampedPainter.end();
+
+    QCOMPARE( stamped, expected );
+  }
+
+  // cached simple markers were drawn to a target rectangle of the size of the square image, at fractional positions
+  const QImage square = marker.copy( 0, 0, 5, 5 );
+  const QList< QPointF > rectPositions { QPointF( 3, 4 ), QPointF( 2.5, 6.5 ), QPointF( 2.51, 6.49 ), QPointF( 7.125, 3.875 ), QPointF( -2.5, -0.3 ), QPointF( 16.7, 12.2 ) };
+  for ( const QPointF &position : rectPositions )
+  {
+    QImage expected = background.copy();
+    QPainter expectedPainter( &expected );
+    expectedPainter.translate( 0.3, -0.45 );
+    expectedPainter.drawImage( QRectF( position.x(), position.y(), square.width(), square.width() ), square );
+    expectedPainter.end();
+
+    QImage stamped = background.copy();
+    QPainter stampedPainter( &stamped );
+    stampedPainter.translate( 0.3, -0.45 );
+    QgsMarkerStamper stamper( &stampedPainter, square );
+    QVERIFY( stamper.isValid() );
+    stamper.stamp( position );
+    stampedPainter.end();
+
+    QCOMPARE( stamped, expected );
+  }
+
+  // painters which could draw differently are left to QPainter
+  QImage image = background.copy();
+  QPainter painter( &image );
+  painter.setOpacity( 0.5 );
+  QVERIFY( !QgsMarkerStamper( &painter, marker ).isValid() );
+  painter.setOpacity( 1.0 );
+  painter.rotate( 10 );
+  QVERIFY( !QgsMarkerStamper( &painter, marker ).isValid() );
+  painter.resetTransform();
+  painter.setClipRect( 1, 1, 5, 5 );
+  QVERIFY( !QgsMarkerStamper( &painter, marker ).isValid() );
+  painter.setClipping( false );
+  painter.setRenderHint( QPainter::SmoothPixmapTransform );
+  QVERIFY( !QgsMarkerStamper( &painter, marker ).isValid() );
+  painter.end();
+}
+
 //
 // Private helper functions not called directly by CTest
 //
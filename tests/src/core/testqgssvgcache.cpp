@@ -24,6 +24,7 @@
 #include <QPainter>
 #include <QtConcurrent>
 #include <QElapsedTimer>
+#include <QTemporaryDir>
 #include "qgssvgcache.h"
 #include "qgsmultirenderchecker.h"
 #include "qgsapplication.h"
@@ -56,6 +57,8 @@ class TestQgsSvgCache : public QObject
     void replaceParams();
     void aspectRatio();
     void noViewBox();
+    void prepareImage();
+    void diskCache();
 
 };
 
@@ -362,6 +365,53 @@ void TestQgsSvgCache::noViewBox()
   QGSCOMPARENEAR( viewBoxSize.height(), 6.358467, 0.0001 );
 }
 
+void TestQgsSvgCache::prepareImage()
+{
+  QgsSvgCache cache;
+  const QString svgPath = TEST_DATA_DIR + QStringLiteral( "/sample_svg.svg" );
+  cache.prepareImage( svgPath, 100, QColor( 255, 0, 0 ), QColor( 0, 255, 0 ), 1, 1 );
+  cache.mPrepareImageThreadPool.waitForDone();
+
+  // the image was rendered in the background...
+  QImage prepared;
+  QVERIFY( cache.renderedImage( QgsSvgCache::renderedImageKey( svgPath, 100, QColor( 255, 0, 0 ), QColor( 0, 255, 0 ), 1, 1, 0 ), prepared ) );
+  QVERIFY( !prepared.isNull() );
+
+  // ...and is returned from the cache
+  bool fitsInCache = false;
+  const QImage image = cache.svgAsImage( svgPath, 100, QColor( 255, 0, 0 ), QColor( 0, 255, 0 ), 1, 1, fitsInCache );
+  QVERIFY( fitsInCache );
+  QCOMPARE( image, prepared );
+}
+
+void TestQgsSvgCache::diskCache()
+{
+  QTemporaryDir dir;
+  const QString originalImage = TEST_DATA_DIR + QStringLiteral( "/test_symbol_svg.svg" );
+  bool inCache = false;
+
+  QgsSvgCache cache;
+  QVERIFY( cache.diskCacheDirectory().isEmpty() );
+  cache.setDiskCacheDirectory( dir.path() );
+  QCOMPARE( cache.diskCacheDirectory(), dir.path() );
+  QImage img = cache.svgAsImage( originalImage, 200, QColor( 0, 0, 0 ), QColor( 0, 0, 0 ), 1.0,
+                                 1.0, inCache );
+  QVERIFY( imageCheck( "svgcache_changed_before", img, 30 ) );
+  QCOMPARE( QDir( dir.path() ).entryList( QStringList() << QStringLiteral( "*.png" ), QDir::Files ).count(), 1 );
+
+  // a new cache reads the rendered image back from disk
+  QgsSvgCache cache2;
+  cache2.setDiskCacheDirectory( dir.path() );
+  img = cache2.svgAsImage( originalImage, 200, QColor( 0, 0, 0 ), QColor( 0, 0, 0 ), 1.0,
+                           1.0, inCache );
+  QVERIFY( imageCheck( "svgcache_changed_before", img, 30 ) );
+
+  // other colors are stored separately
+  img = cache2.svgAsImage( originalImage, 200, QColor( 255, 0, 0 ), QColor( 0, 0, 0 ), 1.0,
+                           1.0, inCache );
+  QCOMPARE( QDir( dir.path() ).entryList( QStringList() << QStringLiteral( "*.png" ), QDir::Files ).count(), 2 );
+}
+
 bool TestQgsSvgCache::imageCheck( const QString &testName, QImage &image, int mismatchCount )
 {
   //draw background
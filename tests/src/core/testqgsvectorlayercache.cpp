@@ -26,8 +26,11 @@
 #include "qgsvectorlayereditbuffer.h"
 #include "qgscacheindexfeatureid.h"
 #include "qgsvectorlayer.h"
+#include "qgsvectorlayercachestorage_p.h"
+#include "qgsaggregatecalculator.h"
 
 #include <QDebug>
+#include <QPointer>
 
 /**
  * @ingroup UnitTests
@@ -56,6 +59,10 @@ class TestVectorLayerCache : public QObject
     void testCanUseCacheForRequest();
     void testCacheGeom();
     void testFullCacheWithRect(); // Test that if rect is set then no full cache can exist, see #19468
+    void testMemoryUsage();
+    void testColumnarStorage();
+    void testSharedCache();
+    void testCacheFeatureSource();
 
     void onCommittedFeaturesAdded( const QString &, const QgsFeatureList & );
 
@@ -420,6 +427,214 @@ void TestVectorLayerCache::testFullCacheWithRect()
 
 }
 
+void TestVectorLayerCache::testMemoryUsage()
+{
+  QgsVectorLayerCache cache( mPointsLayer, 2 );
+  QCOMPARE( cache.memoryUsage(), 0LL );
+  cache.setFullCache( true );
+  QVERIFY( cache.hasFullCache() );
+  const qint64 fullUsage = cache.memoryUsage();
+  QVERIFY( fullUsage > 0 );
+
+  // repeated text values are stored once
+  const int classIndex = mPointsLayer->fields().lookupField( QStringLiteral( "Class" ) );
+  QSet< QString > classValues;
+  QgsFeatureIterator it = cache.getFeatures();
+  QgsFeature f;
+  while ( it.nextFeature( f ) )
+    classValues.insert( f.attribute( classIndex ).toString() );
+  QCOMPARE( cache.mStorage->dictionarySize( classIndex ), classValues.size() );
+  QVERIFY( classValues.size() < mPointsLayer->featureCount() );
+
+  // a budget larger than the usage keeps all features
+  cache.setMaximumMemoryUsage( fullUsage * 2 );
+  QCOMPARE( cache.maximumMemoryUsage(), fullUsage * 2 );
+  QVERIFY( cache.hasFullCache() );
+  QCOMPARE( cache.memoryUsage(), fullUsage );
+
+  // a smaller budget evicts features
+  cache.setMaximumMemoryUsage( fullUsage / 2 );
+  QVERIFY( cache.memoryUsage() <= fullUsage / 2 );
+  QVERIFY( !cache.hasFullCache() );
+  QVERIFY( cache.cachedFeatureIds().count() < mPointsLayer->featureCount() );
+  // the shared values of evicted features are released, so about half of the features still fit
+  QVERIFY( cache.cachedFeatureIds().count() > mPointsLayer->featureCount() / 4 );
+
+  // the features which do not fit are still fetched from the layer
+  int count = 0;
+  it = cache.getFeatures();
+  while ( it.nextFeature( f ) )
+    count++;
+  QCOMPARE( count, static_cast< int >( mPointsLayer->featureCount() ) );
+  QVERIFY( cache.memoryUsage() <= fullUsage / 2 );
+
+  // shared values are released with the last feature using them
+  cache.setCacheSize( 0 );
+  QCOMPARE( cache.mCache.size(), 0 );
+  QCOMPARE( cache.memoryUsage(), 0LL );
+  QCOMPARE( cache.mStorage->dictionarySize( classIndex ), 0 );
+
+  cache.setMaximumMemoryUsage( 0 );
+  cache.setFullCache( true );
+  QVERIFY( cache.hasFullCache() );
+  QCOMPARE( cache.memoryUsage(), fullUsage );
+}
+
+void TestVectorLayerCache::testColumnarStorage()
+{
+  QgsVectorLayer layer( QStringLiteral( "Point?field=int:integer&field=dbl:double&field=str:string&field=date:date&field=var:string" ), QStringLiteral( "layer" ), QStringLiteral( "memory" ) );
+  QVERIFY( layer.isValid() );
+
+  QgsFeatureList features;
+  QgsFeature f( layer.fields() );
+  f.setAttributes( QgsAttributes() << 1 << 1.5 << QStringLiteral( "a" ) << QDate( 2020, 7, 1 ) << QStringLiteral( "x" ) );
+  f.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( 1, 2 ) ) );
+  features << f;
+  // null and empty values
+  f.setAttributes( QgsAttributes() << QVariant( QVariant::Int ) << QVariant( QVariant::Double ) << QString( "" ) << QVariant( QVariant::Date ) << QVariant() );
+  f.setGeometry( QgsGeometry() );
+  features << f;
+  f.setAttributes( QgsAttributes() << 2 << 2.5 << QString() << QDate( 2020, 7, 2 ) << 5 );
+  features << f;
+  f.setAttributes( QgsAttributes() << 3 << -0.25 << QString( "" ) << QDate( 2020, 7, 3 ) << QStringLiteral( "x" ) );
+  features << f;
+  QVERIFY( layer.dataProvider()->addFeatures( features ) );
+
+  QgsVectorLayerCache cache( &layer, 10 );
+  cache.setFullCache( true );
+
+  // features read from the cache are identical to the features of the layer, including types of null values
+  QgsFeatureIterator it = layer.getFeatures();
+  QgsFeature layerFeature;
+  while ( it.nextFeature( layerFeature ) )
+  {
+    QgsFeature cachedFeature;
+    QVERIFY( cache.featureAtId( layerFeature.id(), cachedFeature ) );
+    QCOMPARE( cachedFeature.geometry().asWkt(), layerFeature.geometry().asWkt() );
+    for ( int i = 0; i < layerFeature.attributes().count(); ++i )
+    {
+      QCOMPARE( cachedFeature.attribute( i ), layerFeature.attribute( i ) );
+      QCOMPARE( cachedFeature.attribute( i ).isNull(), layerFeature.attribute( i ).isNull() );
+      QCOMPARE( cachedFeature.attribute( i ).userType(), layerFeature.attribute( i ).userType() );
+    }
+  }
+  QCOMPARE( cache.mStorage->dictionarySize( 2 ), 2 );
+
+  // empty strings are released like any other string
+  cache.setCacheSize( 0 );
+  QCOMPARE( cache.mStorage->dictionarySize( 2 ), 0 );
+  QCOMPARE( cache.memoryUsage(), 0LL );
+
+  cache.setCacheSize( 10 );
+  cache.setFullCache( true );
+  const qint64 fullUsage = cache.memoryUsage();
+  for ( int i = 0; i < 5; ++i )
+  {
+    cache.setCacheSize( 0 );
+    cache.setCacheSize( 10 );
+    cache.setFullCache( true );
+  }
+  QCOMPARE( cache.memoryUsage(), fullUsage );
+  QCOMPARE( cache.mStorage->dictionarySize( 2 ), 2 );
+}
+
+void TestVectorLayerCache::testSharedCache()
+{
+  std::unique_ptr< QgsVectorLayer > layer = qgis::make_unique< QgsVectorLayer >( QStringLiteral( "Point?field=value:integer" ), QStringLiteral( "layer" ), QStringLiteral( "memory" ) );
+  QVERIFY( layer->isValid() );
+  QgsFeatureList features;
+  for ( int i = 1; i <= 5; ++i )
+  {
+    QgsFeature f( layer->fields() );
+    f.setAttributes( QgsAttributes() << i );
+    f.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( i, i ) ) );
+    features << f;
+  }
+  QVERIFY( layer->dataProvider()->addFeatures( features ) );
+
+  QVERIFY( !QgsVectorLayerCache::sharedCache( layer.get() ) );
+  QgsVectorLayerCache *cache = QgsVectorLayerCache::createSharedCache( layer.get() );
+  QVERIFY( cache );
+  QCOMPARE( cache->parent(), layer.get() );
+  QCOMPARE( cache->layer(), layer.get() );
+  QCOMPARE( QgsVectorLayerCache::sharedCache( layer.get() ), cache );
+  QCOMPARE( QgsVectorLayerCache::createSharedCache( layer.get() ), cache );
+
+  // aggregates are calculated from the shared cache once it holds all features
+  cache->setFullCache( true );
+  QgsAggregateCalculator calculator( layer.get() );
+  bool ok = false;
+  QCOMPARE( calculator.calculate( QgsAggregateCalculator::Sum, QStringLiteral( "value" ), nullptr, &ok ).toInt(), 15 );
+  QVERIFY( ok );
+
+  // edits made through the layer are reflected by the cache
+  layer->startEditing();
+  QgsFeatureId fid = features.at( 0 ).id();
+  QVERIFY( layer->changeAttributeValue( fid, 0, 11 ) );
+  QgsFeature f;
+  QVERIFY( cache->featureAtId( fid, f ) );
+  QCOMPARE( f.attribute( 0 ).toInt(), 11 );
+  QCOMPARE( calculator.calculate( QgsAggregateCalculator::Sum, QStringLiteral( "value" ), nullptr, &ok ).toInt(), 25 );
+  layer->rollBack();
+  QCOMPARE( calculator.calculate( QgsAggregateCalculator::Sum, QStringLiteral( "value" ), nullptr, &ok ).toInt(), 15 );
+
+  // the shared cache is deleted with the layer
+  QPointer< QgsVectorLayerCache > cachePointer( cache );
+  layer.reset();
+  QVERIFY( !cachePointer );
+}
+
+void TestVectorLayerCache::testCacheFeatureSource()
+{
+  QgsVectorLayerCache cache( mPointsLayer, 100 );
+  cache.setCacheGeometry( true );
+  cache.setFullCache( true );
+  std::unique_ptr< QgsAbstractFeatureSource > source( cache.createFeatureSource() );
+
+  // all features are returned
+  QgsFeatureIds ids;
+  QgsFeatureIterator it = source->getFeatures();
+  QgsFeature f;
+  while ( it.nextFeature( f ) )
+  {
+    QgsFeature layerFeature = mPointsLayer->getFeature( f.id() );
+    QCOMPARE( f.attributes(), layerFeature.attributes() );
+    QCOMPARE( f.geometry().asWkt(), layerFeature.geometry().asWkt() );
+    ids << f.id();
+  }
+  QCOMPARE( ids, mPointsLayer->allFeatureIds() );
+
+  // rect and fid filters
+  const QgsRectangle rect( -100, 30, -90, 40 );
+  QgsFeatureIds layerIds;
+  it = mPointsLayer->getFeatures( QgsFeatureRequest().setFilterRect( rect ).setNoAttributes() );
+  while ( it.nextFeature( f ) )
+    layerIds << f.id();
+  QVERIFY( !layerIds.isEmpty() );
+  QVERIFY( layerIds.count() < ids.count() );
+  ids.clear();
+  it = source->getFeatures( QgsFeatureRequest().setFilterRect( rect ) );
+  while ( it.nextFeature( f ) )
+    ids << f.id();
+  QCOMPARE( ids, layerIds );
+
+  it = source->getFeatures( QgsFeatureRequest().setFilterFid( 3 ) );
+  QVERIFY( it.nextFeature( f ) );
+  QCOMPARE( f.id(), 3LL );
+  QVERIFY( !it.nextFeature( f ) );
+
+  // the source is a snapshot, which is not affected by later edits
+  const QVariant original = mPointsLayer->getFeature( 3 ).attribute( 0 );
+  mPointsLayer->startEditing();
+  QVERIFY( mPointsLayer->changeAttributeValue( 3, 0, QStringLiteral( "changed" ) ) );
+  source->getFeatures( QgsFeatureRequest().setFilterFid( 3 ) ).nextFeature( f );
+  QCOMPARE( f.attribute( 0 ), original );
+  source.reset( cache.createFeatureSource() );
+  source->getFeatures( QgsFeatureRequest().setFilterFid( 3 ) ).nextFeature( f );
+  QCOMPARE( f.attribute( 0 ).toString(), QStringLiteral( "changed" ) );
+  mPointsLayer->rollBack();
+}
+
 void TestVectorLayerCache::onCommittedFeaturesAdded( const QString &layerId, const QgsFeatureList &features )
 {
   Q_UNUSED( layerId )
@@ -218,6 +218,10 @@ void TestQgsPostgresProvider::testQuotedValueBigInt()
 
   QCOMPARE( QgsPostgresUtils::whereClause( 42, fields, NULL, QgsPostgresPrimaryKeyType::PktInt, pkAttrs, std::shared_ptr<QgsPostgresSharedData>( sdata ) ), QString( "\"fld_integer\"=42" ) );
 
+  // runs of consecutive keys are matched with BETWEEN
+  QCOMPARE( QgsPostgresUtils::whereClause( QgsFeatureIds() << 1 << 2 << 3 << 4 << 7 << 9, fields, NULL, QgsPostgresPrimaryKeyType::PktInt, pkAttrs, std::shared_ptr<QgsPostgresSharedData>( sdata ) ), QString( "(\"fld_integer\" IN (7,9) OR \"fld_integer\" BETWEEN 1 AND 4)" ) );
+  QCOMPARE( QgsPostgresUtils::whereClause( QgsFeatureIds() << 42, fields, NULL, QgsPostgresPrimaryKeyType::PktInt, pkAttrs, std::shared_ptr<QgsPostgresSharedData>( sdata ) ), QString( "\"fld_integer\" IN (42)" ) );
+
   // 8 byte integer
   f1.setName( "fld_bigint" );
   f1.setType( QVariant::LongLong );
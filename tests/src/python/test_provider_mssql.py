@@ -514,6 +514,56 @@ class TestPyQgsMssqlProvider(unittest.TestCase, ProviderTestCase):
         self.assertTrue(vl.isValid())
         self.assertEqual(vl.dataProvider().extent().toString(1), 'Empty')
 
+    def testManyEdits(self):
+        """Test adding and changing many features, sharing prepared queries between features"""
+        self.execSQLCommand('DROP TABLE IF EXISTS qgis_test.many_edits')
+        self.execSQLCommand(
+            'CREATE TABLE qgis_test.many_edits (pk INTEGER IDENTITY(1,1) PRIMARY KEY, int_field integer, real_field float, text_field nvarchar(max))')
+
+        uri = '{} key=\'pk\' table="qgis_test"."many_edits" sql='.format(self.dbconn)
+        vl = QgsVectorLayer(uri, 'many_edits', 'mssql')
+        self.assertTrue(vl.isValid())
+
+        features = []
+        for i in range(200):
+            f = QgsFeature(vl.fields())
+            f.setAttribute('int_field', i)
+            f.setAttribute('real_field', i / 2)
+            # a different set of columns for odd features
+            if i % 2:
+                f.setAttribute('text_field', 'text {}'.format(i))
+            features.append(f)
+        self.assertTrue(vl.dataProvider().addFeatures(features))
+        self.assertEqual(sorted(f.id() for f in features), list(range(1, 201)))
+
+        self.assertTrue(vl.startEditing())
+        for f in vl.getFeatures():
+            i = f['int_field']
+            if i % 3 == 0:
+                self.assertTrue(vl.changeAttributeValue(f.id(), 1, i * 10))
+            elif i % 3 == 1:
+                self.assertTrue(vl.changeAttributeValue(f.id(), 1, i * 10))
+                self.assertTrue(vl.changeAttributeValue(f.id(), 3, None))
+            else:
+                self.assertTrue(vl.changeAttributeValue(f.id(), 2, i * 1.5))
+                self.assertTrue(vl.changeAttributeValue(f.id(), 3, "it's {}".format(i)))
+        self.assertTrue(vl.commitChanges())
+
+        vl = QgsVectorLayer(uri, 'many_edits', 'mssql')
+        self.assertEqual(vl.featureCount(), 200)
+        for f in vl.getFeatures():
+            i = f.id() - 1
+            if i % 3 == 0:
+                self.assertEqual(f.attributes()[1:3], [i * 10, i / 2])
+                self.assertEqual(f['text_field'], 'text {}'.format(i) if i % 2 else NULL)
+            elif i % 3 == 1:
+                self.assertEqual(f.attributes()[1:], [i * 10, i / 2, NULL])
+            else:
+                self.assertEqual(f.attributes()[1:], [i, i * 1.5, "it's {}".format(i)])
+
+        del vl
+        self.execSQLCommand('DROP TABLE IF EXISTS qgis_test.many_edits')
+
 
 if __name__ == '__main__':
     unittest.main()
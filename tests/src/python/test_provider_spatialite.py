@@ -35,7 +35,8 @@ from qgis.core import (QgsProviderRegistry,
                        QgsFeatureRequest,
                        QgsRectangle,
                        QgsVectorLayerExporter,
-                       QgsWkbTypes)
+                       QgsWkbTypes,
+                       NULL)
 
 from qgis.testing import start_app, unittest
 from utilities import unitTestDataPath
@@ -1451,6 +1452,67 @@ class TestQgsSpatialiteProvider(unittest.TestCase, ProviderTestCase):
         self.assertEqual(vl.getFeature(2).attributes(),
                          [2, 456, 'another note'])
 
+    def testManyEdits(self):
+        """Test adding and changing many features, sharing prepared statements between features"""
+
+        dbname = os.path.join(tempfile.gettempdir(), "test_many_edits.sqlite")
+        if os.path.exists(dbname):
+            os.remove(dbname)
+        con = spatialite_connect(dbname, isolation_level=None)
+        cur = con.cursor()
+        cur.execute("BEGIN")
+        sql = "SELECT InitSpatialMetadata()"
+        cur.execute(sql)
+        sql = """
+        CREATE TABLE "test_many_edits"(pkuid integer primary key autoincrement, "int_field" integer, "real_field" real, "text_field" text)
+        """
+        cur.execute(sql)
+        cur.execute("COMMIT")
+        con.close()
+
+        vl = QgsVectorLayer("dbname='%s' table='test_many_edits'" % dbname, 'test_many_edits', 'spatialite')
+        self.assertTrue(vl.isValid())
+
+        features = []
+        for i in range(200):
+            f = QgsFeature(vl.fields())
+            f.setAttribute('int_field', i)
+            f.setAttribute('real_field', i / 2)
+            # a different set of columns for odd features
+            if i % 2:
+                f.setAttribute('text_field', 'text {}'.format(i))
+            features.append(f)
+        self.assertTrue(vl.dataProvider().addFeatures(features))
+        self.assertEqual(vl.featureCount(), 200)
+
+        self.assertTrue(vl.startEditing())
+        for f in vl.getFeatures():
+            i = f['int_field']
+            if i % 3 == 0:
+                self.assertTrue(vl.changeAttributeValue(f.id(), 1, i * 10))
+            elif i % 3 == 1:
+                self.assertTrue(vl.changeAttributeValue(f.id(), 1, i * 10))
+                self.assertTrue(vl.changeAttributeValue(f.id(), 3, None))
+            else:
+                self.assertTrue(vl.changeAttributeValue(f.id(), 2, i * 1.5))
+                self.assertTrue(vl.changeAttributeValue(f.id(), 3, "it's {}".format(i)))
+        self.assertTrue(vl.commitChanges())
+
+        vl = QgsVectorLayer("dbname='%s' table='test_many_edits'" % dbname, 'test_many_edits', 'spatialite')
+        self.assertEqual(vl.featureCount(), 200)
+        for f in vl.getFeatures():
+            i = f.id() - 1
+            if i % 3 == 0:
+                self.assertEqual(f.attributes()[1:3], [i * 10, i / 2])
+                self.assertEqual(f['text_field'], 'text {}'.format(i) if i % 2 else NULL)
+            elif i % 3 == 1:
+                self.assertEqual(f.attributes()[1:], [i * 10, i / 2, NULL])
+            else:
+                self.assertEqual(f.attributes()[1:], [i, i * 1.5, "it's {}".format(i)])
+
+        del vl
+        os.remove(dbname)
+
     def testAddFeatureNoFields(self):
         """Test regression #34696"""
 
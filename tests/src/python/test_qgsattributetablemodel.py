@@ -22,6 +22,7 @@ from qgis.core import (
     QgsVectorLayerCache
 )
 
+from qgis.PyQt.QtCore import Qt, QModelIndex
 from qgis.testing import (start_app,
                           unittest
                           )
@@ -64,6 +65,88 @@ class TestQgsAttributeTableModel(unittest.TestCase):
         self.assertEqual(self.am.rowCount(), 10)
         self.assertEqual(self.am.columnCount(), 2)
 
+    def testPagedLoading(self):
+        layer = QgsVectorLayer("Point?field=fldtxt:string&field=fldint:integer",
+                               "paged", "memory")
+        features = list()
+        for i in range(300):
+            f = QgsFeature()
+            f.setAttributes(["test", i])
+            f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(i, i)))
+            features.append(f)
+        self.assertTrue(layer.dataProvider().addFeatures(features))
+
+        cache = QgsVectorLayerCache(layer, 1000)
+        am = QgsAttributeTableModel(cache)
+        am.loadLayer()
+        self.assertEqual(am.rowCount(), 300)
+        # rows are listed without caching their features
+        self.assertFalse(cache.cachedFeatureIds())
+
+        # displaying a row fetches the page of rows around it
+        self.assertEqual(am.data(am.index(150, 1), Qt.EditRole), am.rowToId(150) - 1)
+        cached = cache.cachedFeatureIds()
+        self.assertEqual(len(cached), 100)
+        self.assertEqual(cached, set(am.rowToId(row) for row in range(100, 200)))
+
+        # a row of the same page is read from the cache
+        self.assertEqual(am.data(am.index(199, 1), Qt.EditRole), am.rowToId(199) - 1)
+        self.assertEqual(cache.cachedFeatureIds(), cached)
+
+        # the next page only fetches the rows which are not cached yet
+        self.assertEqual(am.data(am.index(220, 1), Qt.EditRole), am.rowToId(220) - 1)
+        self.assertEqual(len(cache.cachedFeatureIds()), 170)
+
+    def testPageSize(self):
+        layer = QgsVectorLayer("Point?field=fldtxt:string&field=fldint:integer",
+                               "paged", "memory")
+        features = list()
+        for i in range(250):
+            f = QgsFeature()
+            f.setAttributes(["test", i])
+            features.append(f)
+        self.assertTrue(layer.dataProvider().addFeatures(features))
+
+        cache = QgsVectorLayerCache(layer, 1000)
+        am = QgsAttributeTableModel(cache)
+        am.setPageSize(100)
+        self.assertEqual(am.pageSize(), 100)
+        am.loadLayer()
+
+        # only the first page is loaded, the layer knows the total count
+        self.assertEqual(am.rowCount(), 100)
+        self.assertTrue(am.canFetchMore(QModelIndex()))
+        self.assertEqual(am.featureCount(), 250)
+
+        am.fetchMore(QModelIndex())
+        self.assertEqual(am.rowCount(), 200)
+        am.fetchMore(QModelIndex())
+        self.assertEqual(am.rowCount(), 250)
+        self.assertFalse(am.canFetchMore(QModelIndex()))
+        self.assertEqual(am.featureCount(), 250)
+
+        # sorting reloads the first page in the sort order
+        am.loadLayer()
+        self.assertEqual(am.rowCount(), 100)
+        am.prefetchSortData('"fldint"', 0, Qt.DescendingOrder)
+        self.assertEqual(am.rowCount(), 100)
+        self.assertEqual([am.data(am.index(row, 1), Qt.EditRole) for row in range(3)], [249, 248, 247])
+        self.assertEqual(am.data(am.index(0, 0), QgsAttributeTableModel.SortRole), 249)
+
+        # rows deleted before they are loaded are skipped
+        layer.startEditing()
+        self.assertTrue(layer.deleteFeature(11))
+        am.fetchAllRows()
+        self.assertEqual(am.rowCount(), 249)
+        self.assertFalse(am.canFetchMore(QModelIndex()))
+        layer.rollBack()
+
+        # a page size of 0 loads all rows
+        am.setPageSize(0)
+        am.loadLayer()
+        self.assertEqual(am.rowCount(), 250)
+        self.assertFalse(am.canFetchMore(QModelIndex()))
+
     def testRemove(self):
         self.layer.startEditing()
         self.layer.deleteFeature(5)
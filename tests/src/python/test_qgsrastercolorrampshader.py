@@ -13,11 +13,21 @@ __copyright__ = 'Copyright 2016, The QGIS Project'
 
 import qgis  # NOQA
 
+import os
+import random
+import struct
+import tempfile
 
+from osgeo import gdal
 from qgis.PyQt.QtGui import QColor
 
-from qgis.core import (QgsColorRampShader)
-from qgis.testing import unittest
+from qgis.core import (QgsColorRampShader,
+                       QgsRasterLayer,
+                       QgsRasterShader,
+                       QgsSingleBandPseudoColorRenderer)
+from qgis.testing import start_app, unittest
+
+start_app()
 
 
 class TestQgsRasterColorRampShader(unittest.TestCase):
@@ -31,6 +41,96 @@ class TestQgsRasterColorRampShader(unittest.TestCase):
         self.assertFalse(shader.shade(float('NaN'))[0])
         self.assertFalse(shader.shade(float("inf"))[0])
 
+    def testPseudoColorRendererIntegerLookup(self):
+        """
+        Integer rasters are colored from a lookup table, which must match shading each pixel
+        """
+        temp_folder = tempfile.mkdtemp()
+        for data_type, fmt, values, nodata in ((gdal.GDT_Byte, 'B', [0, 3, 10, 17, 255, 17, 3, 255, 1], 255),
+                                               (gdal.GDT_Int16, 'h', [-20, -1, 0, 3, 10, 32767, -32768, 10, -1], -1),
+                                               (gdal.GDT_UInt16, 'H', [0, 3, 10, 65535, 17, 300, 3, 20, 65535], 65535)):
+            path = os.path.join(temp_folder, 'lookup_{}.tif'.format(fmt))
+            ds = gdal.GetDriverByName('GTiff').Create(path, 3, 3, 1, data_type)
+            ds.SetGeoTransform([0, 1, 0, 3, 0, -1])
+            ds.GetRasterBand(1).SetNoDataValue(nodata)
+            ds.WriteRaster(0, 0, 3, 3, struct.pack(fmt * 9, *values))
+            ds = None
+
+            layer = QgsRasterLayer(path, 'test')
+            self.assertTrue(layer.isValid())
+
+            shader_function = QgsColorRampShader(0, 20)
+            shader_function.setColorRampItemList([QgsColorRampShader.ColorRampItem(0, QColor(255, 0, 0)),
+                                                  QgsColorRampShader.ColorRampItem(10, QColor(0, 255, 0, 100)),
+                                                  QgsColorRampShader.ColorRampItem(20, QColor(0, 0, 255))])
+            shader_function.setClip(True)
+            shader = QgsRasterShader()
+            shader.setRasterShaderFunction(shader_function)
+            renderer = QgsSingleBandPseudoColorRenderer(layer.dataProvider(), 1, shader)
+            renderer.setOpacity(0.5)
+
+            block = renderer.block(1, layer.extent(), 3, 3)
+            for i, value in enumerate(values):
+                color = block.color(i // 3, i % 3)
+                ok, red, green, blue, alpha = shader_function.shade(value)
+                if value == nodata or not ok:
+                    # transparent, as no nodata color is set
+                    self.assertEqual(color, 0, value)
+                    continue
+                if alpha < 255:
+                    red, green, blue = int(red * (alpha / 255.0)), int(green * (alpha / 255.0)), int(blue * (alpha / 255.0))
+                self.assertEqual(color, QColor(int(0.5 * red), int(0.5 * green), int(0.5 * blue), int(0.5 * alpha)).rgba(), value)
+
+    def testPseudoColorRendererIntegerLookupFullTable(self):
+        """
+        Blocks with at least as many pixels as possible values fill the whole lookup table up front,
+        which must match shading each pixel of the same values stored as floating point values
+        """
+        temp_folder = tempfile.mkdtemp()
+        for data_type, fmt, size, lo, hi, nodata in ((gdal.GDT_Byte, 'B', 16, 0, 255, 7),
+                                                     (gdal.GDT_Int16, 'h', 256, -32768, 32767, -5),
+                                                     (gdal.GDT_UInt16, 'H', 256, 0, 65535, 40000)):
+            # every possible value once, in a shuffled order
+            values = list(range(lo, hi + 1))
+            random.Random(size).shuffle(values)
+            self.assertEqual(len(values), size * size)
+
+            layers = []
+            for suffix, layer_type, layer_fmt in (('int', data_type, fmt), ('float', gdal.GDT_Float32, 'f')):
+                path = os.path.join(temp_folder, 'full_table_{}_{}.tif'.format(fmt, suffix))
+                ds = gdal.GetDriverByName('GTiff').Create(path, size, size, 1, layer_type)
+                ds.SetGeoTransform([0, 1, 0, size, 0, -1])
+                ds.GetRasterBand(1).SetNoDataValue(nodata)
+                ds.WriteRaster(0, 0, size, size, struct.pack(layer_fmt * len(values), *values))
+                ds = None
+
+                layer = QgsRasterLayer(path, 'test')
+                self.assertTrue(layer.isValid())
+                layers.append(layer)
+
+            shader_function = QgsColorRampShader(lo, hi)
+            shader_function.setColorRampItemList([QgsColorRampShader.ColorRampItem(lo, QColor(255, 0, 0)),
+                                                  QgsColorRampShader.ColorRampItem((lo + hi) // 2, QColor(0, 255, 0, 100)),
+                                                  QgsColorRampShader.ColorRampItem(hi - 10, QColor(0, 0, 255))])
+            shader_function.setClip(True)
+
+            blocks = []
+            for layer in layers:
+                shader = QgsRasterShader()
+                shader.setRasterShaderFunction(QgsColorRampShader(shader_function))
+                renderer = QgsSingleBandPseudoColorRenderer(layer.dataProvider(), 1, shader)
+                renderer.setOpacity(0.5)
+                blocks.append(renderer.block(1, layers[0].extent(), size, size))
+
+            lookup_block, pixel_block = blocks
+            self.assertEqual(lookup_block.width(), size)
+            self.assertEqual(lookup_block.height(), size)
+            self.assertEqual(lookup_block.data(), pixel_block.data())
+            # no data and clipped values are transparent, other values are not
+            self.assertEqual(lookup_block.color(values.index(nodata) // size, values.index(nodata) % size), 0)
+            self.assertEqual(lookup_block.color(values.index(hi) // size, values.index(hi) % size), 0)
+            self.assertNotEqual(lookup_block.color(values.index(lo) // size, values.index(lo) % size), 0)
+
 
 if __name__ == '__main__':
     unittest.main()
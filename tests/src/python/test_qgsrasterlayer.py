@@ -52,7 +52,8 @@ from qgis.core import (QgsRaster,
                        QgsRasterHistogram,
                        QgsCubicRasterResampler,
                        QgsBilinearRasterResampler,
-                       QgsLayerDefinition
+                       QgsLayerDefinition,
+                       QgsMapRendererSequentialJob
                        )
 from utilities import unitTestDataPath
 from qgis.testing import start_app, unittest
@@ -851,6 +852,65 @@ class TestQgsRasterLayer(unittest.TestCase):
         # compare xml documents
         self.assertEqual(layer_doc.toString(), clone_doc.toString())
 
+    def testTileCache(self):
+        path = os.path.join(unitTestDataPath('raster'),
+                            'band1_float32_noct_epsg4326.tif')
+        layer = QgsRasterLayer(path, 'test')
+        self.assertTrue(layer.isValid())
+        self.assertFalse(layer.isTileCacheEnabled())
+
+        layer.setTileCacheEnabled(True)
+        self.assertTrue(layer.isTileCacheEnabled())
+
+        # setting is persisted and cloned
+        self.assertTrue(layer.clone().isTileCacheEnabled())
+        doc = QDomDocument("doc")
+        elem = doc.createElement("maplayer")
+        layer.writeLayerXml(elem, doc, QgsReadWriteContext())
+        restored = QgsRasterLayer()
+        restored.readLayerXml(elem, QgsReadWriteContext())
+        self.assertTrue(restored.isTileCacheEnabled())
+
+        ms = QgsMapSettings()
+        ms.setOutputSize(QSize(200, 200))
+        ms.setLayers([layer])
+        ms.setExtent(layer.extent())
+
+        def render():
+            job = QgsMapRendererSequentialJob(ms)
+            job.start()
+            job.waitForFinished()
+            return job.renderedImage()
+
+        image = render()
+        self.assertFalse(image.isNull())
+
+        # cached tiles are drawn again
+        self.assertEqual(render(), image)
+
+        # changing the renderer in place, without a repaint, does not draw the outdated tiles
+        layer.renderer().setOpacity(0.3)
+        transparent = render()
+        self.assertNotEqual(transparent, image)
+
+        # neither does changing another interface of the pipe in place
+        layer.brightnessFilter().setBrightness(100)
+        brighter = render()
+        self.assertNotEqual(brighter, transparent)
+        layer.brightnessFilter().setBrightness(0)
+        self.assertEqual(render(), transparent)
+
+        # an explicit repaint clears the cache too
+        layer.renderer().setOpacity(1)
+        layer.triggerRepaint()
+        self.assertEqual(render(), image)
+
+        layer.clearTileCache()
+        self.assertEqual(render(), image)
+
+        layer.setTileCacheEnabled(False)
+        self.assertFalse(layer.isTileCacheEnabled())
+
     def testSetDataSource(self):
         """Test change data source"""
 
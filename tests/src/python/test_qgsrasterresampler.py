@@ -21,7 +21,8 @@ import qgis  # NOQA
 
 import os
 
-from qgis.PyQt.QtGui import qRed
+from qgis.PyQt.QtCore import QSize
+from qgis.PyQt.QtGui import qRed, QImage, QColor
 
 from qgis.core import (QgsRasterLayer,
                        QgsRectangle,
@@ -29,6 +30,8 @@ from qgis.core import (QgsRasterLayer,
                        QgsSingleBandGrayRenderer,
                        QgsCubicRasterResampler,
                        QgsBilinearRasterResampler,
+                       QgsLanczosRasterResampler,
+                       QgsAverageRasterResampler,
                        QgsRasterDataProvider
                        )
 from utilities import unitTestDataPath
@@ -41,11 +44,19 @@ start_app()
 
 class TestQgsRasterResampler(unittest.TestCase):
 
-    def checkBlockContents(self, block, expected):
+    def checkBlockContents(self, block, expected, tolerance=0):
         res = []
         for r in range(block.height()):
             res.append([qRed(block.color(r, c)) for c in range(block.width())])
-        self.assertEqual(res, expected)
+        if tolerance == 0:
+            self.assertEqual(res, expected)
+            return
+
+        self.assertEqual(len(res), len(expected))
+        for row, expected_row in zip(res, expected):
+            self.assertEqual(len(row), len(expected_row))
+            for value, expected_value in zip(row, expected_row):
+                self.assertLessEqual(abs(value - expected_value), tolerance, res)
 
     def testBilinearResample(self):
         path = os.path.join(unitTestDataPath(), 'landsat.tif')
@@ -84,14 +95,14 @@ class TestQgsRasterResampler(unittest.TestCase):
         # with resampling
         filter.setZoomedInResampler(QgsBilinearRasterResampler())
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[124, 127], [125, 126]])
+        self.checkBlockContents(block, [[124, 127], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[124, 124, 126, 126],
                                  [124, 124, 125, 126],
                                  [124, 124, 125, 126],
-                                 [125, 125, 125, 126]]
+                                 [125, 125, 125, 126]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -103,20 +114,20 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [124, 124, 124, 124, 125, 125, 126, 126],
                                  [124, 124, 124, 124, 125, 125, 126, 126],
                                  [125, 125, 125, 125, 125, 125, 126, 126],
-                                 [125, 125, 125, 125, 125, 125, 126, 126]]
+                                 [125, 125, 125, 125, 125, 125, 126, 126]], tolerance=1
                                 )
 
         # with oversampling
         extent = QgsRectangle(785878.92593475803732872, 3346136.27493690419942141, 786223.56509550288319588, 3346477.7564090033993125)
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[127, 126], [125, 126]])
+        self.checkBlockContents(block, [[127, 126], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[125, 127, 127, 127],
                                  [126, 127, 127, 126],
                                  [125, 126, 126, 126],
-                                 [127, 125, 125, 125]]
+                                 [127, 125, 125, 125]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -128,19 +139,19 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [125, 125, 124, 124, 124, 126, 126, 126],
                                  [125, 125, 125, 125, 125, 126, 126, 126],
                                  [125, 125, 125, 125, 125, 126, 126, 126],
-                                 [125, 125, 126, 126, 125, 125, 125, 125]]
+                                 [125, 125, 126, 126, 125, 125, 125, 125]], tolerance=1
                                 )
 
         filter.setMaxOversampling(2)
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[127, 126], [125, 126]])
+        self.checkBlockContents(block, [[127, 126], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[125, 127, 127, 127],
                                  [126, 127, 127, 126],
                                  [125, 126, 126, 126],
-                                 [127, 125, 125, 125]]
+                                 [127, 125, 125, 125]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -152,19 +163,19 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [125, 125, 124, 124, 124, 126, 126, 126],
                                  [125, 125, 125, 125, 125, 126, 126, 126],
                                  [125, 125, 125, 125, 125, 126, 126, 126],
-                                 [125, 125, 126, 126, 125, 125, 125, 125]]
+                                 [125, 125, 126, 126, 125, 125, 125, 125]], tolerance=1
                                 )
 
         filter.setMaxOversampling(4)
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[127, 126], [125, 126]])
+        self.checkBlockContents(block, [[127, 126], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[125, 127, 127, 127],
                                  [126, 127, 127, 126],
                                  [125, 126, 126, 126],
-                                 [127, 125, 125, 125]]
+                                 [127, 125, 125, 125]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -176,7 +187,7 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [125, 125, 124, 124, 124, 126, 126, 126],
                                  [125, 125, 125, 125, 125, 126, 126, 126],
                                  [125, 125, 125, 125, 125, 126, 126, 126],
-                                 [125, 125, 126, 126, 125, 125, 125, 125]]
+                                 [125, 125, 126, 126, 125, 125, 125, 125]], tolerance=1
                                 )
 
     def testCubicResample(self):
@@ -216,14 +227,14 @@ class TestQgsRasterResampler(unittest.TestCase):
         # with resampling
         filter.setZoomedInResampler(QgsCubicRasterResampler())
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[124, 127], [125, 126]])
+        self.checkBlockContents(block, [[124, 127], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[124, 125, 127, 127],
                                  [124, 125, 126, 127],
                                  [125, 125, 126, 126],
-                                 [125, 125, 126, 126]]
+                                 [125, 125, 126, 126]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -235,20 +246,20 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [125, 125, 125, 125, 126, 126, 126, 126],
                                  [125, 125, 125, 125, 126, 126, 126, 126],
                                  [125, 125, 125, 125, 126, 126, 126, 126],
-                                 [125, 125, 125, 125, 126, 126, 126, 126]]
+                                 [125, 125, 125, 125, 126, 126, 126, 126]], tolerance=1
                                 )
 
         # with oversampling
         extent = QgsRectangle(785878.92593475803732872, 3346136.27493690419942141, 786223.56509550288319588, 3346477.7564090033993125)
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[127, 126], [125, 126]])
+        self.checkBlockContents(block, [[127, 126], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[125, 127, 127, 127],
                                  [126, 127, 127, 126],
                                  [125, 126, 126, 126],
-                                 [127, 125, 125, 125]]
+                                 [127, 125, 125, 125]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -260,19 +271,19 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [126, 126, 125, 124, 125, 126, 126, 127],
                                  [126, 126, 125, 125, 125, 126, 127, 127],
                                  [126, 125, 127, 125, 125, 127, 128, 126],
-                                 [126, 125, 127, 127, 126, 125, 125, 126]]
+                                 [126, 125, 127, 127, 126, 125, 125, 126]], tolerance=1
                                 )
 
         filter.setMaxOversampling(2)
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[127, 126], [125, 126]])
+        self.checkBlockContents(block, [[127, 126], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[125, 127, 127, 127],
                                  [126, 127, 127, 126],
                                  [125, 126, 126, 126],
-                                 [127, 125, 125, 125]]
+                                 [127, 125, 125, 125]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -284,19 +295,19 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [126, 126, 125, 124, 125, 126, 126, 127],
                                  [126, 126, 125, 125, 125, 126, 127, 127],
                                  [126, 125, 127, 125, 125, 127, 128, 126],
-                                 [126, 125, 127, 127, 126, 125, 125, 126]]
+                                 [126, 125, 127, 127, 126, 125, 125, 126]], tolerance=1
                                 )
 
         filter.setMaxOversampling(4)
         block = filter.block(1, extent, 2, 2)
-        self.checkBlockContents(block, [[127, 126], [125, 126]])
+        self.checkBlockContents(block, [[127, 126], [125, 126]], tolerance=1)
 
         block = filter.block(1, extent, 4, 4)
         self.checkBlockContents(block,
                                 [[125, 127, 127, 127],
                                  [126, 127, 127, 126],
                                  [125, 126, 126, 126],
-                                 [127, 125, 125, 125]]
+                                 [127, 125, 125, 125]], tolerance=1
                                 )
 
         block = filter.block(1, extent, 8, 8)
@@ -308,9 +319,38 @@ class TestQgsRasterResampler(unittest.TestCase):
                                  [126, 126, 125, 124, 125, 126, 126, 127],
                                  [126, 126, 125, 125, 125, 126, 127, 127],
                                  [126, 125, 127, 125, 125, 127, 128, 126],
-                                 [126, 125, 127, 127, 126, 125, 125, 126]]
+                                 [126, 125, 127, 127, 126, 125, 125, 126]], tolerance=1
                                 )
 
+    def testLanczosResampleImage(self):
+        resampler = QgsLanczosRasterResampler()
+        self.assertEqual(resampler.type(), 'lanczos')
+        self.assertEqual(resampler.clone().type(), 'lanczos')
+
+        source = QImage(17, 11, QImage.Format_ARGB32_Premultiplied)
+        source.fill(QColor(10, 120, 200))
+        for size in (QSize(5, 3), QSize(17, 11), QSize(40, 25)):
+            result = resampler.resampleV2(source, size)
+            self.assertEqual(result.size(), size)
+            # a uniform image stays uniform, whatever the scale
+            for x, y in ((0, 0), (size.width() - 1, size.height() - 1), (size.width() // 2, size.height() // 2)):
+                self.assertEqual(result.pixelColor(x, y), QColor(10, 120, 200))
+
+    def testAverageResampleImage(self):
+        resampler = QgsAverageRasterResampler()
+        self.assertEqual(resampler.type(), 'average')
+        self.assertEqual(resampler.clone().type(), 'average')
+
+        source = QImage(4, 2, QImage.Format_ARGB32_Premultiplied)
+        for x in range(4):
+            for y in range(2):
+                source.setPixelColor(x, y, QColor(40 * x + 20 * y, 0, 0))
+        result = resampler.resampleV2(source, QSize(2, 1))
+        self.assertEqual(result.size(), QSize(2, 1))
+        # each destination pixel is the average of the 2x2 source pixels it covers
+        self.assertEqual(result.pixelColor(0, 0).red(), 30)
+        self.assertEqual(result.pixelColor(1, 0).red(), 110)
+
     @contextmanager
     def setupGDALResampling(self):
 
@@ -16,7 +16,7 @@ import os
 import tempfile
 import shutil
 
-from qgis.PyQt.QtCore import QDate, QDateTime, QVariant, Qt, QDateTime, QDate, QTime
+from qgis.PyQt.QtCore import QDate, QDateTime, QVariant, Qt, QDateTime, QDate, QTime, QSize
 from qgis.PyQt.QtGui import QPainter, QColor
 from qgis.PyQt.QtXml import QDomDocument
 
@@ -58,6 +58,13 @@ from qgis.core import (QgsWkbTypes,
                        QgsTextFormat,
                        QgsVectorLayerSelectedFeatureSource,
                        QgsExpression,
+                       QgsMapSettings,
+                       QgsMapRendererSequentialJob,
+                       QgsMarkerSymbol,
+                       QgsSimplifyMethod,
+                       QgsVectorFileWriter,
+                       QgsProperty,
+                       QgsSymbolLayer,
                        NULL)
 from qgis.gui import (QgsAttributeTableModel,
                       QgsGui
@@ -915,6 +922,47 @@ class TestQgsVectorLayer(unittest.TestCase, FeatureSourceTestCase):
         self.assertTrue(layer.commitChanges())
         checkAfter()
 
+    def test_ChangeManyGeometries(self):
+        layer = QgsVectorLayer("Point?field=name:string&field=value:integer", "many", "memory")
+        features = []
+        for i in range(1, 2501):
+            f = QgsFeature()
+            f.setAttributes([str(i), i])
+            f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(i, 0)))
+            features.append(f)
+        self.assertTrue(layer.dataProvider().addFeatures(features))
+
+        # more changed geometries than fetched at once with their attributes
+        layer.startEditing()
+        for fid in range(2, 2501, 2):
+            self.assertTrue(layer.changeGeometry(fid, QgsGeometry.fromPointXY(QgsPointXY(fid, 1000))))
+        self.assertTrue(layer.changeAttributeValue(10, 0, 'changed'))
+        self.assertTrue(layer.deleteFeature(20))
+
+        def expected(fid):
+            return ['changed' if fid == 10 else str(fid), fid]
+
+        # changed geometries inside the filter rectangle
+        features = {f.id(): f for f in layer.getFeatures(QgsFeatureRequest().setFilterRect(QgsRectangle(0, 900, 1500, 1100)))}
+        self.assertEqual(set(features.keys()), set(range(2, 1501, 2)) - {20})
+        for fid, f in features.items():
+            self.assertEqual(f.attributes(), expected(fid))
+            self.assertEqual(f.geometry().asPoint(), QgsPointXY(fid, 1000))
+
+        # all features
+        features = {f.id(): f for f in layer.getFeatures()}
+        self.assertEqual(set(features.keys()), set(range(1, 2501)) - {20})
+        for fid, f in features.items():
+            self.assertEqual(f.attributes(), expected(fid))
+            self.assertEqual(f.geometry().asPoint(), QgsPointXY(fid, 1000 if fid % 2 == 0 else 0))
+
+        # subset of attributes
+        request = QgsFeatureRequest().setFilterRect(QgsRectangle(0, 900, 100, 1100)).setSubsetOfAttributes([1])
+        values = {f.id(): f[1] for f in layer.getFeatures(request)}
+        self.assertEqual(values, {fid: fid for fid in range(2, 101, 2) if fid != 20})
+
+        layer.rollBack()
+
     def test_ChangeGeometryAfterAddFeature(self):
         layer = createLayerWithOnePoint()
         layer.dataProvider().deleteFeatures([1])  # no need for this feature
@@ -3490,6 +3538,255 @@ class TestQgsVectorLayerTransformContext(unittest.TestCase):
         vl2.readXml(elem, QgsReadWriteContext())
         self.assertEqual(vl2.subsetString(), 'xxxxxxxxx')
 
+    def testRenderCache(self):
+        vl = QgsVectorLayer('Point?crs=epsg:3857&field=pk:integer', 'test', 'memory')
+        f = QgsFeature(vl.fields())
+        f.setAttributes([1])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(-5, -5)))
+        self.assertTrue(vl.dataProvider().addFeatures([f]))
+        vl.updateExtents()
+        self.assertFalse(vl.isRenderCacheEnabled())
+
+        vl.setRenderCacheEnabled(True)
+        self.assertTrue(vl.isRenderCacheEnabled())
+
+        # setting is persisted and cloned
+        self.assertTrue(vl.clone().isRenderCacheEnabled())
+        doc = QDomDocument("testdoc")
+        elem = doc.createElement("maplayer")
+        self.assertTrue(vl.writeXml(elem, doc, QgsReadWriteContext()))
+        vl2 = QgsVectorLayer('Point?crs=epsg:3857&field=pk:integer', 'test', 'memory')
+        vl2.readXml(elem, QgsReadWriteContext())
+        self.assertTrue(vl2.isRenderCacheEnabled())
+
+        vl.setRenderer(QgsSingleSymbolRenderer(QgsMarkerSymbol.createSimple({'color': '#ff0000', 'outline_style': 'no', 'size': '5'})))
+
+        ms = QgsMapSettings()
+        ms.setOutputSize(QSize(200, 200))
+        ms.setBackgroundColor(QColor(255, 255, 255))
+        ms.setLayers([vl])
+        ms.setExtent(QgsRectangle(-10, -10, 10, 10))
+
+        def render():
+            job = QgsMapRendererSequentialJob(ms)
+            job.start()
+            job.waitForFinished()
+            return job.renderedImage()
+
+        def color_at(image, x, y):
+            point = ms.mapToPixel().transform(x, y)
+            return image.pixelColor(int(point.x()), int(point.y())).name()
+
+        image = render()
+        self.assertEqual(color_at(image, -5, -5), '#ff0000')
+        self.assertEqual(color_at(image, 5, 5), '#ffffff')
+
+        # features added to the provider directly do not notify the layer, so the cached features are rendered
+        f.setAttributes([2])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(5, 5)))
+        self.assertTrue(vl.dataProvider().addFeatures([f]))
+        image = render()
+        self.assertEqual(color_at(image, 5, 5), '#ffffff')
+
+        # restyling re-renders the cached features
+        vl.setRenderer(QgsSingleSymbolRenderer(QgsMarkerSymbol.createSimple({'color': '#0000ff', 'outline_style': 'no', 'size': '5'})))
+        image = render()
+        self.assertEqual(color_at(image, -5, -5), '#0000ff')
+        self.assertEqual(color_at(image, 5, 5), '#ffffff')
+
+        # reloading the data clears the cache
+        vl.reload()
+        image = render()
+        self.assertEqual(color_at(image, -5, -5), '#0000ff')
+        self.assertEqual(color_at(image, 5, 5), '#0000ff')
+
+        # changing the subset string clears the cache
+        vl.setSubsetString('"pk" = 2')
+        image = render()
+        self.assertEqual(color_at(image, -5, -5), '#ffffff')
+        self.assertEqual(color_at(image, 5, 5), '#0000ff')
+
+        vl.setRenderCacheEnabled(False)
+        self.assertFalse(vl.isRenderCacheEnabled())
+
+    def testRenderCacheJoinedFields(self):
+        vl = QgsVectorLayer('Point?crs=epsg:3857&field=pk:integer', 'test', 'memory')
+        f = QgsFeature(vl.fields())
+        f.setAttributes([1])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(-5, -5)))
+        self.assertTrue(vl.dataProvider().addFeatures([f]))
+        vl.updateExtents()
+
+        colors = QgsVectorLayer('None?field=id:integer&field=color:string', 'colors', 'memory')
+        f = QgsFeature(colors.fields())
+        f.setAttributes([1, '#ff0000'])
+        self.assertTrue(colors.dataProvider().addFeatures([f]))
+        QgsProject.instance().addMapLayer(colors)
+
+        join = QgsVectorLayerJoinInfo()
+        join.setTargetFieldName('pk')
+        join.setJoinLayer(colors)
+        join.setJoinFieldName('id')
+        join.setUsingMemoryCache(False)
+        join.setPrefix('j_')
+        self.assertTrue(vl.addJoin(join))
+
+        vl.setRenderCacheEnabled(True)
+        symbol = QgsMarkerSymbol.createSimple({'color': '#000000', 'outline_style': 'no', 'size': '5'})
+        symbol.symbolLayer(0).setDataDefinedProperty(QgsSymbolLayer.PropertyFillColor, QgsProperty.fromField('j_color'))
+        vl.setRenderer(QgsSingleSymbolRenderer(symbol))
+
+        ms = QgsMapSettings()
+        ms.setOutputSize(QSize(200, 200))
+        ms.setBackgroundColor(QColor(255, 255, 255))
+        ms.setLayers([vl])
+        ms.setExtent(QgsRectangle(-10, -10, 10, 10))
+
+        def render():
+            job = QgsMapRendererSequentialJob(ms)
+            job.start()
+            job.waitForFinished()
+            point = ms.mapToPixel().transform(-5, -5)
+            return job.renderedImage().pixelColor(int(point.x()), int(point.y())).name()
+
+        self.assertEqual(render(), '#ff0000')
+
+        # changes to the joined layer are not notified to the layer, so layers with joined fields are never cached
+        self.assertTrue(colors.dataProvider().changeAttributeValues({next(colors.getFeatures()).id(): {1: '#0000ff'}}))
+        self.assertEqual(render(), '#0000ff')
+
+        QgsProject.instance().removeMapLayer(colors)
+
+    def testGeneralizedGeometries(self):
+        vl = QgsVectorLayer('Polygon?crs=epsg:3857&field=pk:integer', 'test', 'memory')
+        f = QgsFeature(vl.fields())
+        f.setAttributes([1])
+        # a circle with many vertices
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(0, 0)).buffer(1000, 2500))
+        self.assertTrue(vl.dataProvider().addFeatures([f]))
+        vl.updateExtents()
+        full_vertices = len(list(f.geometry().vertices()))
+        self.assertFalse(vl.hasGeneralizedGeometries())
+
+        self.assertTrue(vl.buildGeneralizedGeometries())
+        self.assertTrue(vl.hasGeneralizedGeometries())
+
+        def vertex_count(tolerance=None):
+            request = QgsFeatureRequest()
+            if tolerance is not None:
+                method = QgsSimplifyMethod()
+                method.setMethodType(QgsSimplifyMethod.OptimizeForRendering)
+                method.setTolerance(tolerance)
+                request.setSimplifyMethod(method)
+            features = list(vl.getFeatures(request))
+            self.assertEqual(len(features), 1)
+            self.assertEqual(features[0]['pk'], 1)
+            return len(list(features[0].geometry().vertices()))
+
+        # full resolution geometries are still returned without simplification, or when no level is coarse enough
+        self.assertEqual(vertex_count(), full_vertices)
+        self.assertEqual(vertex_count(0.0001), full_vertices)
+        # a generalized level is used for larger tolerances
+        self.assertLess(vertex_count(20), full_vertices / 2)
+
+        # changing the data discards the pyramid
+        vl.reload()
+        self.assertFalse(vl.hasGeneralizedGeometries())
+        self.assertEqual(vertex_count(20), full_vertices)
+
+        self.assertTrue(vl.buildGeneralizedGeometries())
+        vl.removeGeneralizedGeometries()
+        self.assertFalse(vl.hasGeneralizedGeometries())
+
+        # no pyramid for points
+        points = QgsVectorLayer('Point?crs=epsg:3857', 'test', 'memory')
+        self.assertFalse(points.buildGeneralizedGeometries())
+
+    def generalizedVertexCounts(self, vl, tolerance):
+        method = QgsSimplifyMethod()
+        method.setMethodType(QgsSimplifyMethod.OptimizeForRendering)
+        method.setTolerance(tolerance)
+        request = QgsFeatureRequest().setSimplifyMethod(method)
+        return {f['pk']: len(list(f.geometry().vertices())) for f in vl.getFeatures(request)}
+
+    def testGeneralizedGeometriesMissingFeatures(self):
+        vl = QgsVectorLayer('Polygon?crs=epsg:3857&field=pk:integer', 'test', 'memory')
+        f = QgsFeature(vl.fields())
+        f.setAttributes([1])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(0, 0)).buffer(1000, 2500))
+        self.assertTrue(vl.dataProvider().addFeatures([f]))
+        vl.updateExtents()
+        self.assertTrue(vl.buildGeneralizedGeometries())
+        counts = self.generalizedVertexCounts(vl, 20)
+        self.assertEqual(list(counts.keys()), [1])
+
+        # a feature added through the provider is missing from the pyramid, its provider geometry is used
+        f.setAttributes([2])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(100, 100)).buffer(500, 2500))
+        self.assertTrue(vl.dataProvider().addFeatures([f]))
+        self.assertTrue(vl.hasGeneralizedGeometries())
+        counts = self.generalizedVertexCounts(vl, 20)
+        self.assertEqual(sorted(counts.keys()), [1, 2])
+        self.assertGreater(counts[2], 0)
+
+        # changing the subset string discards the pyramid
+        self.assertTrue(vl.setSubsetString('"pk" = 2'))
+        self.assertFalse(vl.hasGeneralizedGeometries())
+        self.assertEqual(list(self.generalizedVertexCounts(vl, 20).keys()), [2])
+
+    def testGeneralizedGeometriesSidecar(self):
+        memory = QgsVectorLayer('Polygon?crs=epsg:3857&field=pk:integer', 'test', 'memory')
+        f = QgsFeature(memory.fields())
+        f.setAttributes([1])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(0, 0)).buffer(1000, 2500))
+        self.assertTrue(memory.dataProvider().addFeatures([f]))
+        f.setAttributes([2])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(5000, 0)).buffer(1000, 2500))
+        self.assertTrue(memory.dataProvider().addFeatures([f]))
+        full_vertices = len(list(f.geometry().vertices()))
+
+        temp_dir = tempfile.mkdtemp()
+        path = os.path.join(temp_dir, 'generalized.gpkg')
+        options = QgsVectorFileWriter.SaveVectorOptions()
+        options.driverName = 'GPKG'
+        options.layerName = 'polys'
+        err, _ = QgsVectorFileWriter.writeAsVectorFormatV2(memory, path, memory.transformContext(), options)
+        self.assertEqual(err, QgsVectorFileWriter.NoError)
+        uri = path + '|layername=polys'
+
+        vl = QgsVectorLayer(uri, 'test', 'ogr')
+        self.assertTrue(vl.isValid())
+        self.assertTrue(vl.buildGeneralizedGeometries())
+        sidecars = [name for name in os.listdir(temp_dir) if name.endswith('.qggp')]
+        self.assertEqual(len(sidecars), 1)
+
+        # the sidecar is read by layers with the same subset string only
+        vl = QgsVectorLayer(uri, 'test', 'ogr')
+        self.assertTrue(vl.hasGeneralizedGeometries())
+        self.assertLess(self.generalizedVertexCounts(vl, 20)[1], full_vertices / 2)
+        vl.setSubsetString('"pk" = 1')
+        self.assertFalse(vl.hasGeneralizedGeometries())
+        self.assertEqual(self.generalizedVertexCounts(vl, 20), {1: full_vertices})
+
+        # a layer filtered when building keeps its own sidecar, which lacks the other features
+        self.assertTrue(vl.buildGeneralizedGeometries())
+        vl = QgsVectorLayer(uri, 'test', 'ogr')
+        self.assertTrue(vl.hasGeneralizedGeometries())
+        counts = self.generalizedVertexCounts(vl, 20)
+        self.assertLess(counts[1], full_vertices / 2)
+        self.assertLess(counts[2], full_vertices / 2)
+
+        # truncated sidecars are ignored
+        sidecar = os.path.join(temp_dir, sidecars[0])
+        with open(sidecar, 'rb') as f:
+            content = f.read()
+        with open(sidecar, 'wb') as f:
+            f.write(content[:len(content) // 2])
+        vl = QgsVectorLayer(uri, 'test', 'ogr')
+        self.assertEqual(self.generalizedVertexCounts(vl, 20), {1: full_vertices, 2: full_vertices})
+
+        shutil.rmtree(temp_dir, True)
+
 
 # TODO:
 # - fetch rect: feat with changed geometry: 1. in rect, 2. out of rect